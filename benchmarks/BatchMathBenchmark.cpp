@@ -0,0 +1,239 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include "math/BatchMath.hpp"
+#include "math/ConvexVolume.hpp"
+
+using namespace ouzel;
+
+static const size_t COUNT = 10000;
+static const int REPETITIONS = 200;
+
+template<class F>
+static double measure(F function)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < REPETITIONS; ++i) function();
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / REPETITIONS;
+}
+
+static bool isClose(float a, float b)
+{
+    return std::fabs(a - b) <= 1e-3F * (1.0F + std::fabs(a) + std::fabs(b));
+}
+
+class Data final
+{
+public:
+    Data()
+    {
+        std::mt19937 generator(1);
+        std::uniform_real_distribution<float> distribution(-10.0F, 10.0F);
+
+        for (float& value : matrix.m) value = distribution(generator);
+
+        points.resize(COUNT);
+        for (Vector3<float>& point : points)
+            point = Vector3<float>(distribution(generator), distribution(generator), distribution(generator));
+
+        boxes.resize(COUNT);
+        for (size_t i = 0; i < COUNT; ++i)
+        {
+            if (i % 97 == 0) continue; // keep some empty boxes
+
+            Vector3<float> min(distribution(generator), distribution(generator), distribution(generator));
+            Vector3<float> max(min.v[0] + std::fabs(distribution(generator)),
+                               min.v[1] + std::fabs(distribution(generator)),
+                               min.v[2] + std::fabs(distribution(generator)));
+            boxes[i] = Box3<float>(min, max);
+        }
+
+        matrices1.resize(COUNT);
+        matrices2.resize(COUNT);
+        for (size_t i = 0; i < COUNT; ++i)
+        {
+            for (float& value : matrices1[i].m) value = distribution(generator);
+            for (float& value : matrices2[i].m) value = distribution(generator);
+        }
+
+        Matrix4<float> projection;
+        Matrix4<float>::createPerspective(1.0F, 1.5F, 0.5F, 50.0F, projection);
+        Matrix4<float> view;
+        Matrix4<float>::createTranslation(0.0F, 0.0F, -3.0F, view);
+        viewProjection = projection * view;
+    }
+
+    Matrix4<float> matrix;
+    Matrix4<float> viewProjection;
+    std::vector<Vector3<float>> points;
+    std::vector<Box3<float>> boxes;
+    std::vector<Matrix4<float>> matrices1;
+    std::vector<Matrix4<float>> matrices2;
+};
+
+// compares the batch results with the per-element functions, returns the number of mismatches
+static size_t verify(const Data& data)
+{
+    size_t failures = 0;
+
+    std::vector<Vector3<float>> points(COUNT);
+    transformPoints(data.matrix, data.points.data(), points.data(), COUNT);
+
+    for (size_t i = 0; i < COUNT; ++i)
+    {
+        Vector3<float> expected;
+        data.matrix.transformPoint(data.points[i], expected);
+        for (size_t c = 0; c < 3; ++c)
+            if (!isClose(expected.v[c], points[i].v[c])) ++failures;
+    }
+
+    std::vector<Box3<float>> boxes(COUNT);
+    transformBoxes(data.matrix, data.boxes.data(), boxes.data(), COUNT);
+
+    for (size_t i = 0; i < COUNT; ++i)
+    {
+        if (data.boxes[i].isEmpty())
+        {
+            if (!boxes[i].isEmpty()) ++failures;
+            continue;
+        }
+
+        Vector3<float> corners[8];
+        data.boxes[i].getCorners(corners);
+
+        Box3<float> expected;
+        for (const Vector3<float>& corner : corners)
+        {
+            Vector3<float> point;
+            data.matrix.transformPoint(corner, point);
+            expected.insertPoint(point);
+        }
+
+        for (size_t c = 0; c < 3; ++c)
+            if (!isClose(expected.min.v[c], boxes[i].min.v[c]) ||
+                !isClose(expected.max.v[c], boxes[i].max.v[c])) ++failures;
+    }
+
+    std::vector<Matrix4<float>> matrices(COUNT);
+    multiplyMatrices(data.matrices1.data(), data.matrices2.data(), matrices.data(), COUNT);
+
+    for (size_t i = 0; i < COUNT; ++i)
+    {
+        Matrix4<float> expected;
+        Matrix4<float>::multiply(data.matrices1[i], data.matrices2[i], expected);
+        for (size_t c = 0; c < 16; ++c)
+            if (!isClose(expected.m[c], matrices[i].m[c])) ++failures;
+    }
+
+    Frustum frustum(data.viewProjection);
+    ConvexVolume<float> volume = data.viewProjection.getFrustum();
+    std::vector<uint8_t> visible(COUNT);
+    cullBoxes(frustum, data.boxes.data(), visible.data(), COUNT);
+
+    for (size_t i = 0; i < COUNT; ++i)
+    {
+        bool expected = !data.boxes[i].isEmpty() && volume.isBoxInside(data.boxes[i]);
+        if ((visible[i] != 0) != expected) ++failures;
+    }
+
+    return failures;
+}
+
+static size_t run(const Data& data, const char* name)
+{
+    std::vector<Vector3<float>> points(COUNT);
+    std::vector<Box3<float>> boxes(COUNT);
+    std::vector<Matrix4<float>> matrices(COUNT);
+    std::vector<uint8_t> visible(COUNT);
+    Frustum frustum(data.viewProjection);
+
+    size_t failures = verify(data);
+
+    double pointsTime = measure([&]() {
+        transformPoints(data.matrix, data.points.data(), points.data(), COUNT);
+    });
+    double boxesTime = measure([&]() {
+        transformBoxes(data.matrix, data.boxes.data(), boxes.data(), COUNT);
+    });
+    double matricesTime = measure([&]() {
+        multiplyMatrices(data.matrices1.data(), data.matrices2.data(), matrices.data(), COUNT);
+    });
+    double cullTime = measure([&]() {
+        cullBoxes(frustum, data.boxes.data(), visible.data(), COUNT);
+    });
+
+    std::printf("%-8s %10.1f %10.1f %10.1f %10.1f %9zu\n", name, pointsTime, boxesTime, matricesTime, cullTime, failures);
+
+    return failures;
+}
+
+int main()
+{
+    Data data;
+
+    std::printf("%zu elements, average of %d runs in microseconds\n", COUNT, REPETITIONS);
+    std::printf("%-8s %10s %10s %10s %10s %9s\n", "", "points", "boxes", "matrices", "culling", "failures");
+
+    // the per-element functions that the batch versions replace
+    {
+        std::vector<Vector3<float>> points(COUNT);
+        std::vector<Matrix4<float>> matrices(COUNT);
+        std::vector<uint8_t> visible(COUNT);
+        ConvexVolume<float> volume = data.viewProjection.getFrustum();
+
+        double pointsTime = measure([&]() {
+            for (size_t i = 0; i < COUNT; ++i) data.matrix.transformPoint(data.points[i], points[i]);
+        });
+        double matricesTime = measure([&]() {
+            for (size_t i = 0; i < COUNT; ++i) Matrix4<float>::multiply(data.matrices1[i], data.matrices2[i], matrices[i]);
+        });
+        double cullTime = measure([&]() {
+            for (size_t i = 0; i < COUNT; ++i) visible[i] = volume.isBoxInside(data.boxes[i]) ? 1 : 0;
+        });
+
+        std::printf("%-8s %10.1f %10s %10.1f %10.1f %9s\n", "single", pointsTime, "-", matricesTime, cullTime, "-");
+    }
+
+    SimdInstructionSet selected = getBatchInstructionSet();
+
+    const struct
+    {
+        SimdInstructionSet instructionSet;
+        const char* name;
+    } instructionSets[] = {
+        {SimdInstructionSet::NONE, "scalar"},
+        {SimdInstructionSet::SSE, "sse"},
+        {SimdInstructionSet::AVX, "avx"},
+        {SimdInstructionSet::NEON, "neon"}
+    };
+
+    size_t failures = 0;
+
+    for (const auto& instructionSet : instructionSets)
+    {
+        try
+        {
+            setBatchInstructionSet(instructionSet.instructionSet);
+        }
+        catch (const std::exception&)
+        {
+            continue; // not supported by this build or CPU
+        }
+
+        failures += run(data, instructionSet.name);
+    }
+
+    setBatchInstructionSet(selected);
+
+    for (const auto& instructionSet : instructionSets)
+        if (instructionSet.instructionSet == selected)
+            std::printf("selected at runtime: %s\n", instructionSet.name);
+
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,153 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+#include "audio/Convolver.hpp"
+#include "audio/Hrtf.hpp"
+
+using namespace ouzel;
+
+// cost of the binaural rendering of many voices, every voice has its own convolver like every spatializer
+static const uint32_t SAMPLE_RATE = 48000;
+static const uint32_t BLOCK_SIZE = 128;
+static const uint32_t VOICE_COUNT = 64;
+static const uint32_t BLOCK_COUNT = 500;
+
+static const float PI = 3.14159265358979323846F;
+
+using Clock = std::chrono::steady_clock;
+
+class Voices final
+{
+public:
+    explicit Voices(const std::shared_ptr<const audio::Hrtf>& hrtf):
+        input(VOICE_COUNT * BLOCK_SIZE),
+        left(VOICE_COUNT * BLOCK_SIZE),
+        right(VOICE_COUNT * BLOCK_SIZE)
+    {
+        std::mt19937 generator(1);
+        std::uniform_real_distribution<float> distribution(-1.0F, 1.0F);
+        for (float& sample : input) sample = distribution(generator);
+
+        for (uint32_t voice = 0; voice < VOICE_COUNT; ++voice)
+        {
+            convolvers.push_back(audio::HrtfConvolver(hrtf));
+            convolvers.back().setDirection(getDirection(voice, 0));
+        }
+    }
+
+    // voices are spread around the listener and circle it when moving
+    static Vector3<float> getDirection(uint32_t voice, uint32_t block)
+    {
+        float angle = 2.0F * PI * voice / VOICE_COUNT + 0.01F * block;
+        return Vector3<float>(std::sin(angle), 0.2F * std::sin(angle * 3.0F), std::cos(angle));
+    }
+
+    // returns microseconds per voice per block
+    double run(bool moving)
+    {
+        auto start = Clock::now();
+
+        for (uint32_t block = 0; block < BLOCK_COUNT; ++block)
+            for (uint32_t voice = 0; voice < VOICE_COUNT; ++voice)
+            {
+                // a spatializer passes the direction on when the source or the listener moved
+                if (moving) convolvers[voice].setDirection(getDirection(voice, block));
+
+                convolvers[voice].process(&input[voice * BLOCK_SIZE],
+                                          &left[voice * BLOCK_SIZE],
+                                          &right[voice * BLOCK_SIZE]);
+            }
+
+        return std::chrono::duration<double, std::micro>(Clock::now() - start).count() / (BLOCK_COUNT * VOICE_COUNT);
+    }
+
+    std::vector<audio::HrtfConvolver> convolvers;
+    std::vector<float> input;
+    std::vector<float> left;
+    std::vector<float> right;
+};
+
+// energy of both ears for a noise source from the direction, after the convolution has settled
+static void getEnergy(const std::shared_ptr<const audio::Hrtf>& hrtf, const Vector3<float>& direction,
+                      float& leftEnergy, float& rightEnergy)
+{
+    audio::HrtfConvolver convolver(hrtf);
+    convolver.setDirection(direction);
+
+    std::mt19937 generator(2);
+    std::uniform_real_distribution<float> distribution(-1.0F, 1.0F);
+    std::vector<float> input(BLOCK_SIZE);
+    std::vector<float> left(BLOCK_SIZE);
+    std::vector<float> right(BLOCK_SIZE);
+
+    leftEnergy = 0.0F;
+    rightEnergy = 0.0F;
+
+    for (uint32_t block = 0; block < 100; ++block)
+    {
+        for (float& sample : input) sample = distribution(generator);
+        convolver.process(input.data(), left.data(), right.data());
+
+        if (block < 20) continue;
+
+        for (uint32_t i = 0; i < BLOCK_SIZE; ++i)
+        {
+            leftEnergy += left[i] * left[i];
+            rightEnergy += right[i] * right[i];
+        }
+    }
+}
+
+int main()
+{
+    std::shared_ptr<const audio::Hrtf> hrtf = std::make_shared<audio::Hrtf>(SAMPLE_RATE, BLOCK_SIZE);
+
+    // a source on the right must be louder in the right ear and the other way around
+    float leftEnergy;
+    float rightEnergy;
+    getEnergy(hrtf, Vector3<float>(1.0F, 0.0F, 0.0F), leftEnergy, rightEnergy);
+    bool result = rightEnergy > leftEnergy * 2.0F;
+    getEnergy(hrtf, Vector3<float>(-1.0F, 0.0F, 0.0F), leftEnergy, rightEnergy);
+    result &= leftEnergy > rightEnergy * 2.0F;
+    if (!result) std::printf("The louder ear does not match the direction of the source\n");
+
+    const double blockTime = 1000000.0 * BLOCK_SIZE / SAMPLE_RATE;
+
+    std::printf("%u voices, blocks of %u samples at %u Hz (%.0f us), %u partitions of the spherical head model\n",
+                VOICE_COUNT, BLOCK_SIZE, SAMPLE_RATE, blockTime, hrtf->getPartitionCount());
+    std::printf("%-12s %16s %16s %18s\n", "", "us / voice block", "us / block", "block budget used");
+
+    Voices voices(hrtf);
+    voices.run(false); // warm up the caches
+
+    double staticTime = voices.run(false);
+    std::printf("%-12s %16.2f %16.1f %17.1f%%\n", "static", staticTime,
+                staticTime * VOICE_COUNT, staticTime * VOICE_COUNT / blockTime * 100.0);
+
+    // moving voices interpolate the responses and crossfade between the old and the new filter
+    double movingTime = voices.run(true);
+    std::printf("%-12s %16.2f %16.1f %17.1f%%\n", "moving", movingTime,
+                movingTime * VOICE_COUNT, movingTime * VOICE_COUNT / blockTime * 100.0);
+
+    // a mono convolver with a response of the same length, e.g. of a reverb
+    std::vector<float> response(hrtf->getPartitionCount() * BLOCK_SIZE, 0.0F);
+    response[0] = 1.0F;
+    std::vector<audio::Convolver> convolvers(VOICE_COUNT, audio::Convolver(response.data(),
+                                                                           static_cast<uint32_t>(response.size()),
+                                                                           BLOCK_SIZE));
+    auto start = Clock::now();
+    for (uint32_t block = 0; block < BLOCK_COUNT; ++block)
+        for (uint32_t voice = 0; voice < VOICE_COUNT; ++voice)
+            convolvers[voice].process(&voices.input[voice * BLOCK_SIZE], &voices.left[voice * BLOCK_SIZE]);
+    double monoTime = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / (BLOCK_COUNT * VOICE_COUNT);
+    std::printf("%-12s %16.2f %16.1f %17.1f%%\n", "mono", monoTime,
+                monoTime * VOICE_COUNT, monoTime * VOICE_COUNT / blockTime * 100.0);
+
+    return result ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,180 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include "utils/OBFSchema.hpp"
+
+using namespace ouzel;
+
+// compares schema deltas with encoding the whole state as OBF for every snapshot of a game world
+static const uint32_t ENTITY_COUNT = 200;
+static const uint32_t SNAPSHOT_COUNT = 600;
+
+enum Field: uint32_t
+{
+    ID,
+    X,
+    Y,
+    Z,
+    YAW,
+    HEALTH,
+    NAME,
+    FLAGS
+};
+
+using Clock = std::chrono::steady_clock;
+
+static double getMicroseconds(Clock::time_point start, Clock::time_point end)
+{
+    return std::chrono::duration<double, std::micro>(end - start).count();
+}
+
+// the const operator[] of Value returns copies, so the values are accessed through non-const references
+static bool matches(obf::Value& state, obf::Value& decoded)
+{
+    if (decoded[0].as<uint32_t>() != state[0].as<uint32_t>()) return false;
+
+    obf::Value::Array& entities = state[1].as<obf::Value::Array>();
+    obf::Value::Array& decodedEntities = decoded[1].as<obf::Value::Array>();
+    if (entities.size() != decodedEntities.size()) return false;
+
+    for (size_t i = 0; i < entities.size(); ++i)
+    {
+        obf::Value& entity = entities[i];
+        obf::Value& decodedEntity = decodedEntities[i];
+
+        // the positions and angles are quantized
+        if (std::fabs(entity[X].as<double>() - decodedEntity[X].as<double>()) > 0.0051 ||
+            std::fabs(entity[YAW].as<double>() - decodedEntity[YAW].as<double>()) > 0.00051 ||
+            entity[ID].as<uint32_t>() != decodedEntity[ID].as<uint32_t>() ||
+            entity[HEALTH].as<uint32_t>() != decodedEntity[HEALTH].as<uint32_t>() ||
+            entity[NAME].as<std::string>() != decodedEntity[NAME].as<std::string>() ||
+            static_cast<int64_t>(decodedEntity[FLAGS].as<uint64_t>()) != -3)
+            return false;
+    }
+
+    return true;
+}
+
+int main()
+{
+    obf::Schema entitySchema = obf::Schema::object();
+    entitySchema.add(ID, obf::Schema::integer(16))
+        .add(X, obf::Schema::quantized(-1024.0, 1024.0, 0.01))
+        .add(Y, obf::Schema::quantized(-1024.0, 1024.0, 0.01))
+        .add(Z, obf::Schema::quantized(-1024.0, 1024.0, 0.01))
+        .add(YAW, obf::Schema::quantized(0.0, 6.2832, 0.001))
+        .add(HEALTH, obf::Schema::integer(8))
+        .add(NAME, obf::Schema::string(64))
+        .add(FLAGS, obf::Schema::integer(8, true));
+
+    obf::Schema worldSchema = obf::Schema::object();
+    worldSchema.add(0, obf::Schema::integer(32))
+        .add(1, obf::Schema::array(entitySchema, 1024));
+
+    std::mt19937 generator(7);
+    std::uniform_real_distribution<float> position(-1000.0F, 1000.0F);
+    std::uniform_real_distribution<float> random(0.0F, 1.0F);
+
+    obf::Value state = obf::Value::Object();
+    state[0] = uint32_t(0);
+    state[1] = obf::Value::Array();
+
+    for (uint32_t i = 0; i < ENTITY_COUNT; ++i)
+    {
+        obf::Value entity = obf::Value::Object();
+        entity[ID] = i;
+        entity[X] = position(generator);
+        entity[Y] = position(generator);
+        entity[Z] = position(generator);
+        entity[YAW] = random(generator) * 6.28F;
+        entity[HEALTH] = uint32_t(100);
+        entity[NAME] = "entity" + std::to_string(i);
+        entity[FLAGS] = static_cast<uint64_t>(-3);
+        state[1].as<obf::Value::Array>().push_back(entity);
+    }
+
+    obf::Value base;
+    obf::Value decoded;
+    std::vector<uint8_t> buffer;
+
+    double deltaEncodeTime = 0.0;
+    double deltaDecodeTime = 0.0;
+    double fullEncodeTime = 0.0;
+    double fullDecodeTime = 0.0;
+    size_t deltaBytes = 0;
+    size_t fullBytes = 0;
+    size_t firstBytes = 0;
+    uint32_t failures = 0;
+
+    for (uint32_t snapshot = 0; snapshot < SNAPSHOT_COUNT; ++snapshot)
+    {
+        // a tenth of the entities move each snapshot
+        obf::Value::Array& entities = state[1].as<obf::Value::Array>();
+        for (obf::Value& entity : entities)
+        {
+            if (random(generator) < 0.1F)
+            {
+                entity[X] = entity[X].as<float>() + 0.3F;
+                entity[YAW] = std::fmod(entity[YAW].as<float>() + 0.1F, 6.28F);
+                if (random(generator) < 0.1F) entity[HEALTH] = entity[HEALTH].as<uint32_t>() - 1;
+            }
+        }
+
+        if (snapshot % 100 == 50) entities.pop_back();
+        state[0] = snapshot;
+
+        buffer.clear();
+        Clock::time_point start = Clock::now();
+        worldSchema.encodeDelta(base, state, buffer);
+        Clock::time_point encoded = Clock::now();
+        worldSchema.decodeDelta(buffer, decoded);
+        Clock::time_point end = Clock::now();
+
+        // the first snapshot has no base
+        if (snapshot == 0)
+            firstBytes = buffer.size();
+        else
+        {
+            deltaEncodeTime += getMicroseconds(start, encoded);
+            deltaDecodeTime += getMicroseconds(encoded, end);
+            deltaBytes += buffer.size();
+        }
+
+        std::vector<uint8_t> full;
+        obf::Value fullDecoded;
+        start = Clock::now();
+        state.encode(full);
+        encoded = Clock::now();
+        fullDecoded.decode(full);
+        end = Clock::now();
+
+        fullEncodeTime += getMicroseconds(start, encoded);
+        fullDecodeTime += getMicroseconds(encoded, end);
+        fullBytes += full.size();
+
+        if (!matches(state, decoded)) ++failures;
+
+        base = state;
+    }
+
+    std::printf("%u entities, %u snapshots, a tenth of the entities change per snapshot\n", ENTITY_COUNT, SNAPSHOT_COUNT);
+    std::printf("%-10s %16s %12s %12s\n", "", "bytes/snapshot", "encode (us)", "decode (us)");
+    std::printf("%-10s %16.1f %12.1f %12.1f\n", "delta",
+                static_cast<double>(deltaBytes) / (SNAPSHOT_COUNT - 1),
+                deltaEncodeTime / (SNAPSHOT_COUNT - 1),
+                deltaDecodeTime / (SNAPSHOT_COUNT - 1));
+    std::printf("%-10s %16.1f %12.1f %12.1f\n", "full OBF",
+                static_cast<double>(fullBytes) / SNAPSHOT_COUNT,
+                fullEncodeTime / SNAPSHOT_COUNT,
+                fullDecodeTime / SNAPSHOT_COUNT);
+    std::printf("first snapshot without a base: %zu bytes\n", firstBytes);
+    std::printf("mismatched snapshots: %u\n", failures);
+
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,110 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include "audio/PitchShifter.hpp"
+#include "smbPitchShift.hpp"
+
+using namespace ouzel;
+
+// compares the pitch shifter modes with the smbPitchShift code that the phase vocoder replaced,
+// one channel is processed in blocks like the mixer does
+static const uint32_t SAMPLE_RATE = 44100;
+static const uint32_t BLOCK_SIZE = 512;
+static const uint32_t BLOCK_COUNT = SAMPLE_RATE * 10 / BLOCK_SIZE;
+static const uint32_t FRAME_SIZE = 1024;
+static const uint32_t OVERSAMPLING = 4;
+static const float PITCH = 1.5F;
+static const float FREQUENCY = 440.0F;
+
+static const float PI = 3.14159265358979323846F;
+
+static std::vector<float> getInput()
+{
+    std::vector<float> samples(BLOCK_COUNT * BLOCK_SIZE);
+    for (size_t i = 0; i < samples.size(); ++i)
+        samples[i] = 0.5F * std::sin(2.0F * PI * FREQUENCY * i / SAMPLE_RATE);
+    return samples;
+}
+
+// frequency of the tone in the last second, from the number of rising zero crossings
+static float getFrequency(const std::vector<float>& samples)
+{
+    size_t start = samples.size() - SAMPLE_RATE;
+    uint32_t crossings = 0;
+    for (size_t i = start + 1; i < samples.size(); ++i)
+        if (samples[i - 1] < 0.0F && samples[i] >= 0.0F) ++crossings;
+    return static_cast<float>(crossings);
+}
+
+// processes the input block by block, returns false if the output does not have the shifted pitch
+static bool run(const char* name, const std::vector<float>& input,
+                const std::function<void(float*, uint32_t)>& process)
+{
+    std::vector<float> samples = input;
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t block = 0; block < BLOCK_COUNT; ++block)
+        process(samples.data() + block * BLOCK_SIZE, BLOCK_SIZE);
+    double time = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+    float frequency = getFrequency(samples);
+    bool shifted = std::fabs(frequency - FREQUENCY * PITCH) < FREQUENCY * PITCH * 0.05F;
+
+    double seconds = static_cast<double>(input.size()) / SAMPLE_RATE;
+    std::printf("%-14s %12.2f %12.1f %10.1f %8s\n", name, time / BLOCK_COUNT,
+                seconds * 1000000.0 / time, frequency, shifted ? "yes" : "no");
+
+    return shifted;
+}
+
+int main()
+{
+    std::vector<float> input = getInput();
+    bool result = true;
+
+    std::printf("%u blocks of %u samples, frame size %u, pitch %.2f of a %.0f Hz tone\n",
+                BLOCK_COUNT, BLOCK_SIZE, FRAME_SIZE, PITCH, FREQUENCY);
+    std::printf("%-14s %12s %12s %10s %8s\n", "", "us / block", "x realtime", "output Hz", "shifted");
+
+    // the arrays of the reference code do not fit on the stack
+    std::unique_ptr<smb::PitchShift> reference(new smb::PitchShift());
+    std::vector<float> output(BLOCK_SIZE);
+    result &= run("smbPitchShift", input, [&reference, &output](float* samples, uint32_t count) {
+        reference->process(PITCH, count, FRAME_SIZE, OVERSAMPLING, static_cast<float>(SAMPLE_RATE),
+                           samples, output.data());
+        std::copy(output.begin(), output.begin() + count, samples);
+    });
+
+    audio::PitchShifter phaseVocoder(audio::PitchShifter::Mode::PHASE_VOCODER, FRAME_SIZE);
+    result &= run("phase vocoder", input, [&phaseVocoder](float* samples, uint32_t count) {
+        phaseVocoder.process(PITCH, samples, count, 1);
+    });
+
+    audio::PitchShifter wsola(audio::PitchShifter::Mode::WSOLA, FRAME_SIZE);
+    result &= run("WSOLA", input, [&wsola](float* samples, uint32_t count) {
+        wsola.process(PITCH, samples, count, 1);
+    });
+
+    // frame sizes that can not be rounded up to a power of two are rejected
+    bool thrown = false;
+    try
+    {
+        audio::PitchShifter invalid(audio::PitchShifter::Mode::WSOLA, 0x80000001U);
+    }
+    catch (const std::invalid_argument&)
+    {
+        thrown = true;
+    }
+    if (!thrown) std::printf("Frame size above the maximum was accepted\n");
+    result &= thrown;
+
+    return result ? EXIT_SUCCESS : EXIT_FAILURE;
+}
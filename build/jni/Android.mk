@@ -52,12 +52,16 @@ LOCAL_SRC_FILES :=../../ouzel/animators/Animator.cpp \
     ../../ouzel/audio/Audio.cpp \
     ../../ouzel/audio/AudioDevice.cpp \
 	../../ouzel/audio/Containers.cpp \
+	../../ouzel/audio/Convolver.cpp \
+	../../ouzel/audio/FFT.cpp \
 	../../ouzel/audio/Filter.cpp \
 	../../ouzel/audio/Filters.cpp \
+	../../ouzel/audio/Hrtf.cpp \
     ../../ouzel/audio/Listener.cpp \
 	../../ouzel/audio/Mix.cpp \
     ../../ouzel/audio/OscillatorSound.cpp \
     ../../ouzel/audio/PCMSound.cpp \
+    ../../ouzel/audio/PitchShifter.cpp \
 	../../ouzel/audio/SilenceSound.cpp \
     ../../ouzel/audio/Sound.cpp \
     ../../ouzel/audio/Submix.cpp \
@@ -76,6 +80,7 @@ LOCAL_SRC_FILES :=../../ouzel/animators/Animator.cpp \
     ../../ouzel/events/EventHandler.cpp \
     ../../ouzel/files/Archive.cpp \
     ../../ouzel/files/File.cpp \
+    ../../ouzel/files/MappedFile.cpp \
     ../../ouzel/files/FileSystem.cpp \
     ../../ouzel/graphics/empty/EmptyRenderDevice.cpp \
     ../../ouzel/graphics/opengl/android/OGLRenderDeviceAndroid.cpp \
@@ -98,8 +103,11 @@ LOCAL_SRC_FILES :=../../ouzel/animators/Animator.cpp \
     ../../ouzel/graphics/Shader.cpp \
     ../../ouzel/graphics/Texture.cpp \
     ../../ouzel/graphics/Vertex.cpp \
+    ../../ouzel/graphics/VertexLayout.cpp \
+    ../../ouzel/graphics/Instance.cpp \
     ../../ouzel/gui/BMFont.cpp \
     ../../ouzel/gui/TTFont.cpp \
+    ../../ouzel/gui/GlyphAtlas.cpp \
     ../../ouzel/gui/Button.cpp \
     ../../ouzel/gui/CheckBox.cpp \
     ../../ouzel/gui/ComboBox.cpp \
@@ -134,12 +142,14 @@ LOCAL_SRC_FILES :=../../ouzel/animators/Animator.cpp \
     ../../ouzel/math/Color.cpp \
     ../../ouzel/math/MathUtils.cpp \
     ../../ouzel/math/Matrix4.cpp \
+    ../../ouzel/math/BatchMath.cpp \
     ../../ouzel/math/Size2.cpp \
     ../../ouzel/math/Size3.cpp \
     ../../ouzel/math/Vector2.cpp \
     ../../ouzel/math/Vector3.cpp \
     ../../ouzel/math/Vector4.cpp \
     ../../ouzel/network/Client.cpp \
+    ../../ouzel/network/Connection.cpp \
     ../../ouzel/network/Network.cpp \
     ../../ouzel/network/Socket.cpp \
     ../../ouzel/scene/Actor.cpp \
@@ -161,7 +171,11 @@ LOCAL_SRC_FILES :=../../ouzel/animators/Animator.cpp \
     ../../ouzel/scene/StaticMeshRenderer.cpp \
     ../../ouzel/scene/TextRenderer.cpp \
     ../../ouzel/utils/Log.cpp \
+    ../../ouzel/utils/ThreadPool.cpp \
     ../../ouzel/utils/OBF.cpp \
+    ../../ouzel/utils/OBFWriter.cpp \
+    ../../ouzel/utils/OBFView.cpp \
+    ../../ouzel/utils/OBFSchema.cpp \
     ../../ouzel/utils/Utils.cpp \
     ../../ouzel/utils/XML.cpp
 
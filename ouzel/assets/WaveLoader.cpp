@@ -8,7 +8,8 @@
 enum WaveFormat
 {
     PCM = 1,
-    IEEE_FLOAT = 3
+    IEEE_FLOAT = 3,
+    IMA_ADPCM = 0x11
 };
 
 namespace ouzel
@@ -24,9 +25,8 @@ namespace ouzel
         {
             try
             {
-                uint16_t channels;
-                uint32_t sampleRate;
-                std::vector<float> samples;
+                uint16_t channels = 0;
+                uint32_t sampleRate = 0;
 
                 uint32_t offset = 0;
 
@@ -64,6 +64,7 @@ namespace ouzel
                 bool dataChunkFound = false;
 
                 uint16_t bitsPerSample = 0;
+                uint16_t blockAlign = 0;
                 uint16_t formatTag = 0;
                 std::vector<uint8_t> soundData;
 
@@ -112,7 +113,9 @@ namespace ouzel
 
                         i += 4; // average bytes per second
 
-                        i += 2; // block align
+                        blockAlign = static_cast<uint16_t>(data[i + 0] |
+                                                           (data[i + 1] << 8));
+                        i += 2;
 
                         bitsPerSample = static_cast<uint16_t>(data[i + 0] |
                                                               (data[i + 1] << 8));
@@ -136,59 +139,44 @@ namespace ouzel
                 if (!dataChunkFound)
                     throw std::runtime_error("Failed to load sound file, failed to find a data chunk");
 
-                if (bitsPerSample != 8 && bitsPerSample != 16 &&
-                    bitsPerSample != 24 && bitsPerSample != 32)
-                    throw std::runtime_error("Failed to load sound file, unsupported bit depth");
+                if (channels == 0)
+                    throw std::runtime_error("Failed to load sound file, invalid channel count");
 
-                uint32_t bytesPerSample = bitsPerSample / 8;
-                uint32_t sampleCount = static_cast<uint32_t>(soundData.size() / bytesPerSample);
-                samples.resize(sampleCount);
+                // the samples are kept in their encoding and converted while mixing
+                audio::PCMSound::Encoding encoding;
 
                 if (formatTag == PCM)
                 {
                     if (bitsPerSample == 8)
-                    {
-                        for (uint32_t i = 0; i < sampleCount; ++i)
-                            samples[i] = 2.0F * soundData[i] / 255.0F - 1.0F;
-                    }
+                        encoding = audio::PCMSound::Encoding::UNSIGNED8;
                     else if (bitsPerSample == 16)
-                    {
-                        for (uint32_t i = 0; i < sampleCount; ++i)
-                            samples[i] = static_cast<int16_t>(soundData[i * 2] |
-                                                              (soundData[i * 2 + 1] << 8)) / 32767.0F;
-                    }
+                        encoding = audio::PCMSound::Encoding::SIGNED16;
                     else if (bitsPerSample == 24)
-                    {
-                        for (uint32_t i = 0; i < sampleCount; ++i)
-                            samples[i] = static_cast<float>(static_cast<int32_t>((soundData[i * 3] << 8) |
-                                                                                 (soundData[i * 3 + 1] << 16) |
-                                                                                 (soundData[i * 3 + 2] << 24)) / 2147483648.0);
-                    }
+                        encoding = audio::PCMSound::Encoding::SIGNED24;
                     else if (bitsPerSample == 32)
-                    {
-                        for (uint32_t i = 0; i < sampleCount; ++i)
-                            samples[i] = static_cast<float>(static_cast<int32_t>(soundData[i * 4] |
-                                                                                 (soundData[i * 4 + 1] << 8) |
-                                                                                 (soundData[i * 4 + 2] << 16) |
-                                                                                 (soundData[i * 4 + 2] << 24)) / 2147483648.0);
-                    }
+                        encoding = audio::PCMSound::Encoding::SIGNED32;
                     else
                         throw std::runtime_error("Failed to load sound file, unsupported bit depth");
                 }
                 else if (formatTag == IEEE_FLOAT)
                 {
                     if (bitsPerSample == 32)
-                    {
-                        for (uint32_t i = 0; i < sampleCount; ++i)
-                            samples[i] = reinterpret_cast<float*>(soundData.data())[i];
-                    }
+                        encoding = audio::PCMSound::Encoding::FLOAT32;
                     else
                         throw std::runtime_error("Failed to load sound file, unsupported bit depth");
                 }
+                else if (formatTag == IMA_ADPCM)
+                {
+                    if (bitsPerSample == 4 && blockAlign > channels * 4)
+                        encoding = audio::PCMSound::Encoding::IMA_ADPCM;
+                    else
+                        throw std::runtime_error("Failed to load sound file, unsupported IMA ADPCM format");
+                }
                 else
                     throw std::runtime_error("Failed to load sound file, unsupported format");
 
-                std::shared_ptr<audio::Sound> sound = std::make_shared<audio::PCMSound>(*engine->getAudio(), channels, sampleRate, samples);
+                std::shared_ptr<audio::Sound> sound = std::make_shared<audio::PCMSound>(*engine->getAudio(), channels, sampleRate,
+                                                                                       encoding, std::move(soundData), blockAlign);
                 bundle.setSound(filename, sound);
             }
             catch (const std::exception&)
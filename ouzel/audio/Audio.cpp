@@ -4,7 +4,10 @@
 #include "core/Setup.h"
 #include "Audio.hpp"
 #include "AudioDevice.hpp"
+#include "Filters.hpp"
 #include "Listener.hpp"
+#include "Sound.hpp"
+#include "Voice.hpp"
 #include "alsa/ALSAAudioDevice.hpp"
 #include "core/Engine.hpp"
 #include "coreaudio/CAAudioDevice.hpp"
@@ -153,7 +156,6 @@ namespace ouzel
         }
 
         Audio::Audio(Driver driver, bool debugAudio, Window* window):
-            mixer(std::bind(&Audio::eventCallback, this, std::placeholders::_1)),
             masterMix(*this),
             device(createAudioDevice(driver, mixer, debugAudio, window))
         {
@@ -166,7 +168,23 @@ namespace ouzel
 
         void Audio::update()
         {
-            // TODO: handle events from the audio device
+            mixer.deleteProcessedCommands();
+
+            // the events are logged here, because the audio thread must not wait for the log
+            mixer::Mixer::Event event;
+            while (mixer.getEvent(event))
+                handleEvent(event);
+
+            // the voice may have been played again after the stream finished, then the play ids differ
+            for (Voice* voice : voices)
+                if (voice->playing && voice->streamId &&
+                    streamFinishedPlayIds[voice->streamId]->load(std::memory_order_acquire) == voice->playId)
+                    voice->finish();
+
+            for (Spatializer* spatializer : spatializers)
+                spatializer->updateListener();
+
+            updateVoices();
         }
 
         void Audio::deleteObject(uintptr_t objectId)
@@ -181,13 +199,52 @@ namespace ouzel
             return busId;
         }
 
-        uintptr_t Audio::initStream(uintptr_t sourceId)
+        uintptr_t Audio::initStream(const Sound& sound)
         {
+            auto i = streamPool.find(sound.getSourceId());
+            if (i != streamPool.end() && !i->second.empty())
+            {
+                uintptr_t streamId = i->second.back();
+                i->second.pop_back();
+                return streamId;
+            }
+
             uintptr_t streamId = mixer.getObjectId();
-            mixer.addCommand(std::unique_ptr<mixer::Command>(new mixer::InitStreamCommand(streamId, sourceId)));
+            std::unique_ptr<std::atomic<uint32_t>> finishedPlayId(new std::atomic<uint32_t>(0));
+            streamFinishedPlayIds[streamId] = finishedPlayId.get();
+            mixer.addCommand(std::unique_ptr<mixer::Command>(new mixer::InitStreamCommand(streamId,
+                                                                                          sound.getSourceId(),
+                                                                                          sound.getStreamInitFunction(),
+                                                                                          std::move(finishedPlayId))));
             return streamId;
         }
 
+        void Audio::releaseStream(uintptr_t sourceId, uintptr_t streamId)
+        {
+            mixer.addCommand(std::unique_ptr<mixer::Command>(new mixer::StopStreamCommand(streamId, true)));
+            mixer.addCommand(std::unique_ptr<mixer::Command>(new mixer::SetStreamOutputCommand(streamId, 0)));
+            mixer.addCommand(std::unique_ptr<mixer::Command>(new mixer::SetStreamVirtualCommand(streamId, false)));
+
+            streamPool[sourceId].push_back(streamId);
+        }
+
+        void Audio::deleteSource(uintptr_t sourceId)
+        {
+            auto i = streamPool.find(sourceId);
+            if (i != streamPool.end())
+            {
+                for (uintptr_t streamId : i->second)
+                {
+                    streamFinishedPlayIds.erase(streamId);
+                    deleteObject(streamId);
+                }
+
+                streamPool.erase(i);
+            }
+
+            deleteObject(sourceId);
+        }
+
         uintptr_t Audio::initSource(const std::function<std::unique_ptr<mixer::Source>()>& initFunction)
         {
             uintptr_t sourceId = mixer.getObjectId();
@@ -215,9 +272,67 @@ namespace ouzel
             mixer.getData(frames, channels, sampleRate, samples);
         }
 
-        void Audio::eventCallback(const mixer::Mixer::Event& event)
+        void Audio::addVoice(Voice* voice)
         {
+            voices.push_back(voice);
+        }
 
+        void Audio::removeVoice(Voice* voice)
+        {
+            auto i = std::find(voices.begin(), voices.end(), voice);
+            if (i != voices.end()) voices.erase(i);
+        }
+
+        void Audio::addSpatializer(Spatializer* spatializer)
+        {
+            spatializers.push_back(spatializer);
+        }
+
+        void Audio::removeSpatializer(Spatializer* spatializer)
+        {
+            auto i = std::find(spatializers.begin(), spatializers.end(), spatializer);
+            if (i != spatializers.end()) spatializers.erase(i);
+        }
+
+        void Audio::updateVoices()
+        {
+            playingVoices.clear();
+
+            for (Voice* voice : voices)
+                if (voice->isPlaying())
+                    playingVoices.push_back(std::make_pair(voice->getEstimatedLoudness(), voice));
+
+            const float threshold = audibilityThreshold;
+
+            // audible voices first, then by priority and loudness
+            std::sort(playingVoices.begin(), playingVoices.end(),
+                      [threshold](const std::pair<float, Voice*>& a, const std::pair<float, Voice*>& b) {
+                          bool audibleA = a.first >= threshold;
+                          bool audibleB = b.first >= threshold;
+                          if (audibleA != audibleB) return audibleA;
+                          if (a.second->getPriority() != b.second->getPriority())
+                              return a.second->getPriority() > b.second->getPriority();
+                          return a.first > b.first;
+                      });
+
+            for (size_t i = 0; i < playingVoices.size(); ++i)
+            {
+                Voice* voice = playingVoices[i].second;
+                bool virtualized = i >= maxRealVoices || playingVoices[i].first < threshold;
+
+                if (voice->virtualized != virtualized)
+                {
+                    voice->virtualized = virtualized;
+                    mixer.addCommand(std::unique_ptr<mixer::Command>(new mixer::SetStreamVirtualCommand(voice->streamId,
+                                                                                                         virtualized)));
+                }
+            }
+        }
+
+        void Audio::handleEvent(const mixer::Mixer::Event& event)
+        {
+            if (event.type == mixer::Mixer::Event::Type::STARVATION)
+                engine->log(Log::Level::WARN) << "Audio stream " << event.objectId << " is starving";
         }
     } // namespace audio
 } // namespace ouzel
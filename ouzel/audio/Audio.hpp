@@ -3,8 +3,10 @@
 #ifndef OUZEL_AUDIO_AUDIO_HPP
 #define OUZEL_AUDIO_AUDIO_HPP
 
+#include <atomic>
 #include <cstdint>
 #include <functional>
+#include <map>
 #include <memory>
 #include <set>
 #include <vector>
@@ -23,9 +25,14 @@ namespace ouzel
     {
         class AudioDevice;
         class Listener;
+        class Sound;
+        class Spatializer;
+        class Voice;
 
         class Audio final
         {
+            friend Spatializer;
+            friend Voice;
         public:
             Audio(Driver driver, bool debugAudio, Window* window);
             ~Audio();
@@ -45,20 +52,52 @@ namespace ouzel
 
             void deleteObject(uintptr_t objectId);
             uintptr_t initBus();
-            uintptr_t initStream(uintptr_t sourceId);
+            // reuses a released stream of the sound if there is one
+            uintptr_t initStream(const Sound& sound);
+            // stops the stream and keeps it for the next initStream call with the same source
+            void releaseStream(uintptr_t sourceId, uintptr_t streamId);
+            // deletes the source and all its released streams
+            void deleteSource(uintptr_t sourceId);
             uintptr_t initSource(const std::function<std::unique_ptr<mixer::Source>()>& initFunction);
             uintptr_t initProcessor(std::unique_ptr<mixer::Processor>&& processor);
+            // for structural changes, numeric values are set through the mixer::Parameter members of the processors,
+            // the function and everything it captures is destroyed on the game thread after the audio thread has run it
             void updateProcessor(uintptr_t processorId, const std::function<void(mixer::Processor*)>& updateFunction);
 
             Mix& getMasterMix() { return masterMix; }
 
+            // playing voices beyond the limit and the inaudible ones are virtualized,
+            // they keep their play position without being decoded or mixed
+            inline uint32_t getMaxRealVoices() const { return maxRealVoices; }
+            inline void setMaxRealVoices(uint32_t newMaxRealVoices) { maxRealVoices = newMaxRealVoices; }
+
+            // estimated loudness (linear) below which a voice is considered inaudible
+            inline float getAudibilityThreshold() const { return audibilityThreshold; }
+            inline void setAudibilityThreshold(float newAudibilityThreshold) { audibilityThreshold = newAudibilityThreshold; }
+
         private:
             void getData(uint32_t frames, uint16_t channels, uint32_t sampleRate, std::vector<float>& samples);
-            void eventCallback(const mixer::Mixer::Event& event);
+            void handleEvent(const mixer::Mixer::Event& event);
+
+            void addVoice(Voice* voice);
+            void removeVoice(Voice* voice);
+            void updateVoices();
+
+            void addSpatializer(Spatializer* spatializer);
+            void removeSpatializer(Spatializer* spatializer);
 
             mixer::Mixer mixer;
             Mix masterMix;
             std::unique_ptr<AudioDevice> device;
+
+            std::vector<Voice*> voices;
+            std::vector<Spatializer*> spatializers;
+            std::vector<std::pair<float, Voice*>> playingVoices;
+            std::map<uintptr_t, std::vector<uintptr_t>> streamPool;
+            std::map<uintptr_t, const std::atomic<uint32_t>*> streamFinishedPlayIds; // owned by the streams
+            uint32_t lastPlayId = 0;
+            uint32_t maxRealVoices = 64;
+            float audibilityThreshold = 0.001F; // -60 dB
         };
     } // namespace audio
 } // namespace ouzel
@@ -0,0 +1,75 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#include <algorithm>
+#include "Convolver.hpp"
+
+namespace ouzel
+{
+    namespace audio
+    {
+        Convolver::Convolver(const float* impulseResponse, uint32_t length, uint32_t initBlockSize):
+            blockSize(std::max(initBlockSize, 4U)),
+            binStride((blockSize + 1 + 3) & ~3U),
+            partitionCount(std::max((length + blockSize - 1) / blockSize, 1U)),
+            fft(blockSize * 2)
+        {
+            timeBuffer.resize(blockSize * 2);
+            outputBuffer.resize(blockSize * 2);
+            inputReal.resize(partitionCount * binStride);
+            inputImag.resize(partitionCount * binStride);
+            filterReal.resize(partitionCount * binStride);
+            filterImag.resize(partitionCount * binStride);
+            sumReal.resize(binStride);
+            sumImag.resize(binStride);
+
+            // the 1 / blockSize scale of the inverse transform is applied to the filter
+            const float scale = 1.0F / blockSize;
+
+            for (uint32_t partition = 0; partition < partitionCount; ++partition)
+            {
+                std::fill(timeBuffer.begin(), timeBuffer.end(), 0.0F);
+                for (uint32_t i = 0; i < blockSize && partition * blockSize + i < length; ++i)
+                    timeBuffer[i] = impulseResponse[partition * blockSize + i] * scale;
+
+                fft.forward(timeBuffer.data(), &filterReal[partition * binStride], &filterImag[partition * binStride]);
+            }
+
+            std::fill(timeBuffer.begin(), timeBuffer.end(), 0.0F);
+        }
+
+        void Convolver::process(const float* input, float* output)
+        {
+            if (!blockSize) return;
+
+            std::copy(timeBuffer.begin() + blockSize, timeBuffer.end(), timeBuffer.begin());
+            std::copy(input, input + blockSize, timeBuffer.begin() + blockSize);
+
+            fft.forward(timeBuffer.data(), &inputReal[currentPartition * binStride], &inputImag[currentPartition * binStride]);
+
+            std::fill(sumReal.begin(), sumReal.end(), 0.0F);
+            std::fill(sumImag.begin(), sumImag.end(), 0.0F);
+
+            for (uint32_t partition = 0; partition < partitionCount; ++partition)
+            {
+                uint32_t inputPartition = (currentPartition + partitionCount - partition) % partitionCount;
+                FFT::multiplyAccumulate(&inputReal[inputPartition * binStride], &inputImag[inputPartition * binStride],
+                                        &filterReal[partition * binStride], &filterImag[partition * binStride],
+                                        sumReal.data(), sumImag.data(), binStride);
+            }
+
+            // overlap-save keeps only the second half
+            fft.inverse(sumReal.data(), sumImag.data(), outputBuffer.data());
+            std::copy(outputBuffer.begin() + blockSize, outputBuffer.end(), output);
+
+            currentPartition = (currentPartition + 1) % partitionCount;
+        }
+
+        void Convolver::reset()
+        {
+            std::fill(timeBuffer.begin(), timeBuffer.end(), 0.0F);
+            std::fill(inputReal.begin(), inputReal.end(), 0.0F);
+            std::fill(inputImag.begin(), inputImag.end(), 0.0F);
+            currentPartition = 0;
+        }
+    } // namespace audio
+} // namespace ouzel
@@ -0,0 +1,51 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_AUDIO_CONVOLVER_HPP
+#define OUZEL_AUDIO_CONVOLVER_HPP
+
+#include <cstdint>
+#include <vector>
+#include "audio/FFT.hpp"
+
+namespace ouzel
+{
+    namespace audio
+    {
+        // Uniformly partitioned overlap-save FFT convolution of one channel. The impulse response is split
+        // into partitions of blockSize samples, so every block costs the same regardless of the response length.
+        // All memory is allocated in the constructor.
+        class Convolver final
+        {
+        public:
+            Convolver() = default;
+            // blockSize must be a power of two
+            Convolver(const float* impulseResponse, uint32_t length, uint32_t initBlockSize);
+
+            inline uint32_t getBlockSize() const { return blockSize; }
+            inline uint32_t getPartitionCount() const { return partitionCount; }
+
+            // convolves blockSize samples, input and output may be the same buffer
+            void process(const float* input, float* output);
+            void reset();
+
+        private:
+            uint32_t blockSize = 0;
+            uint32_t binStride = 0; // blockSize + 1 bins rounded up to a multiple of 4
+            uint32_t partitionCount = 0;
+            uint32_t currentPartition = 0;
+
+            FFT fft;
+
+            std::vector<float> timeBuffer; // previous and current input block
+            std::vector<float> outputBuffer;
+            std::vector<float> inputReal; // spectra of the last partitionCount input blocks
+            std::vector<float> inputImag;
+            std::vector<float> filterReal;
+            std::vector<float> filterImag;
+            std::vector<float> sumReal;
+            std::vector<float> sumImag;
+        };
+    } // namespace audio
+} // namespace ouzel
+
+#endif // OUZEL_AUDIO_CONVOLVER_HPP
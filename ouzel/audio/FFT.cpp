@@ -0,0 +1,358 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#include <algorithm>
+#include <cmath>
+#if defined(__ARM_NEON__)
+#  include <arm_neon.h>
+#elif defined(__SSE__)
+#  include <xmmintrin.h>
+#endif
+#include "FFT.hpp"
+
+namespace ouzel
+{
+    namespace audio
+    {
+        static constexpr float PI = 3.14159265358979323846F;
+
+        FFT::FFT(uint32_t initSize):
+            size(std::max(initSize, 4U)),
+            half(size / 2)
+        {
+            uint32_t bits = 0;
+            while ((1U << bits) < half) ++bits;
+
+            bitReverse.resize(half);
+            for (uint32_t i = 0; i < half; ++i)
+            {
+                uint32_t reversed = 0;
+                for (uint32_t bit = 0; bit < bits; ++bit)
+                    if (i & (1U << bit)) reversed |= 1U << (bits - 1 - bit);
+                bitReverse[i] = reversed;
+            }
+
+            // the twiddle factors of every stage are stored contiguously, starting at halfLength - 1
+            cosines.resize(half);
+            sines.resize(half);
+            for (uint32_t halfLength = 1; halfLength < half; halfLength <<= 1)
+            {
+                for (uint32_t j = 0; j < halfLength; ++j)
+                {
+                    cosines[halfLength - 1 + j] = std::cos(PI * j / halfLength);
+                    sines[halfLength - 1 + j] = std::sin(PI * j / halfLength);
+                }
+            }
+
+            splitCosines.resize(half + 1);
+            splitSines.resize(half + 1);
+            for (uint32_t i = 0; i <= half; ++i)
+            {
+                splitCosines[i] = std::cos(PI * i / half);
+                splitSines[i] = std::sin(PI * i / half);
+            }
+
+            scratchReal.resize(half);
+            scratchImag.resize(half);
+        }
+
+#if defined(__SSE__)
+        static inline __m128 reverse(__m128 x)
+        {
+            return _mm_shuffle_ps(x, x, _MM_SHUFFLE(0, 1, 2, 3));
+        }
+#endif
+
+        void FFT::forward(const float* input, float* resultReal, float* resultImag)
+        {
+            uint32_t i = 0;
+#if defined(__SSE__)
+            for (; i + 4 <= half; i += 4)
+            {
+                __m128 first = _mm_loadu_ps(input + i * 2);
+                __m128 second = _mm_loadu_ps(input + i * 2 + 4);
+                _mm_storeu_ps(&scratchReal[i], _mm_shuffle_ps(first, second, _MM_SHUFFLE(2, 0, 2, 0)));
+                _mm_storeu_ps(&scratchImag[i], _mm_shuffle_ps(first, second, _MM_SHUFFLE(3, 1, 3, 1)));
+            }
+#endif
+            for (; i < half; ++i)
+            {
+                scratchReal[i] = input[i * 2];
+                scratchImag[i] = input[i * 2 + 1];
+            }
+
+            transform(false);
+
+            // the even and the odd samples are separated with the symmetry of the spectra of real signals,
+            // bin b mirrors bin k
+            resultReal[0] = scratchReal[0] + scratchImag[0];
+            resultImag[0] = 0.0F;
+            resultReal[half] = scratchReal[0] - scratchImag[0];
+            resultImag[half] = 0.0F;
+
+            uint32_t k = 1;
+#if defined(__SSE__)
+            const __m128 halves = _mm_set1_ps(0.5F);
+
+            for (; k + 3 < half; k += 4)
+            {
+                __m128 ar = _mm_loadu_ps(&scratchReal[k]);
+                __m128 ai = _mm_loadu_ps(&scratchImag[k]);
+                __m128 br = reverse(_mm_loadu_ps(&scratchReal[half - k - 3]));
+                __m128 bi = reverse(_mm_loadu_ps(&scratchImag[half - k - 3]));
+
+                __m128 evenReal = _mm_mul_ps(_mm_add_ps(ar, br), halves);
+                __m128 evenImag = _mm_mul_ps(_mm_sub_ps(ai, bi), halves);
+                __m128 oddReal = _mm_mul_ps(_mm_add_ps(ai, bi), halves);
+                __m128 oddImag = _mm_mul_ps(_mm_sub_ps(br, ar), halves);
+
+                __m128 c = _mm_loadu_ps(&splitCosines[k]);
+                __m128 s = _mm_loadu_ps(&splitSines[k]);
+
+                _mm_storeu_ps(resultReal + k, _mm_add_ps(evenReal, _mm_add_ps(_mm_mul_ps(c, oddReal), _mm_mul_ps(s, oddImag))));
+                _mm_storeu_ps(resultImag + k, _mm_add_ps(evenImag, _mm_sub_ps(_mm_mul_ps(c, oddImag), _mm_mul_ps(s, oddReal))));
+            }
+#endif
+            for (; k < half; ++k)
+            {
+                uint32_t b = half - k;
+
+                float evenReal = (scratchReal[k] + scratchReal[b]) * 0.5F;
+                float evenImag = (scratchImag[k] - scratchImag[b]) * 0.5F;
+                float oddReal = (scratchImag[k] + scratchImag[b]) * 0.5F;
+                float oddImag = -(scratchReal[k] - scratchReal[b]) * 0.5F;
+
+                float c = splitCosines[k];
+                float s = splitSines[k];
+
+                resultReal[k] = evenReal + c * oddReal + s * oddImag;
+                resultImag[k] = evenImag + c * oddImag - s * oddReal;
+            }
+        }
+
+        void FFT::inverse(const float* inputReal, const float* inputImag, float* result)
+        {
+            uint32_t k = 0;
+#if defined(__SSE__)
+            const __m128 halves = _mm_set1_ps(0.5F);
+
+            for (; k + 3 < half; k += 4)
+            {
+                __m128 ar = _mm_loadu_ps(inputReal + k);
+                __m128 ai = _mm_loadu_ps(inputImag + k);
+                __m128 br = reverse(_mm_loadu_ps(inputReal + half - k - 3));
+                __m128 bi = reverse(_mm_loadu_ps(inputImag + half - k - 3));
+
+                __m128 evenReal = _mm_mul_ps(_mm_add_ps(ar, br), halves);
+                __m128 evenImag = _mm_mul_ps(_mm_sub_ps(ai, bi), halves);
+                __m128 differenceReal = _mm_mul_ps(_mm_sub_ps(ar, br), halves);
+                __m128 differenceImag = _mm_mul_ps(_mm_add_ps(ai, bi), halves);
+
+                __m128 c = _mm_loadu_ps(&splitCosines[k]);
+                __m128 s = _mm_loadu_ps(&splitSines[k]);
+
+                __m128 oddReal = _mm_sub_ps(_mm_mul_ps(differenceReal, c), _mm_mul_ps(differenceImag, s));
+                __m128 oddImag = _mm_add_ps(_mm_mul_ps(differenceReal, s), _mm_mul_ps(differenceImag, c));
+
+                _mm_storeu_ps(&scratchReal[k], _mm_sub_ps(evenReal, oddImag));
+                _mm_storeu_ps(&scratchImag[k], _mm_add_ps(evenImag, oddReal));
+            }
+#endif
+            for (; k < half; ++k)
+            {
+                uint32_t b = half - k;
+
+                float evenReal = (inputReal[k] + inputReal[b]) * 0.5F;
+                float evenImag = (inputImag[k] - inputImag[b]) * 0.5F;
+                float differenceReal = (inputReal[k] - inputReal[b]) * 0.5F;
+                float differenceImag = (inputImag[k] + inputImag[b]) * 0.5F;
+
+                float c = splitCosines[k];
+                float s = splitSines[k];
+
+                float oddReal = differenceReal * c - differenceImag * s;
+                float oddImag = differenceReal * s + differenceImag * c;
+
+                scratchReal[k] = evenReal - oddImag;
+                scratchImag[k] = evenImag + oddReal;
+            }
+
+            transform(true);
+
+            uint32_t i = 0;
+#if defined(__SSE__)
+            for (; i + 4 <= half; i += 4)
+            {
+                __m128 real = _mm_loadu_ps(&scratchReal[i]);
+                __m128 imag = _mm_loadu_ps(&scratchImag[i]);
+                _mm_storeu_ps(result + i * 2, _mm_unpacklo_ps(real, imag));
+                _mm_storeu_ps(result + i * 2 + 4, _mm_unpackhi_ps(real, imag));
+            }
+#endif
+            for (; i < half; ++i)
+            {
+                result[i * 2] = scratchReal[i];
+                result[i * 2 + 1] = scratchImag[i];
+            }
+        }
+
+        void FFT::transform(bool inverseTransform)
+        {
+            float* real = scratchReal.data();
+            float* imag = scratchImag.data();
+
+            for (uint32_t i = 0; i < half; ++i)
+            {
+                uint32_t j = bitReverse[i];
+                if (i < j)
+                {
+                    std::swap(real[i], real[j]);
+                    std::swap(imag[i], imag[j]);
+                }
+            }
+
+            const float sign = inverseTransform ? 1.0F : -1.0F;
+
+            // the first two stages have the twiddle factors 1 and sign * i
+            for (uint32_t a = 0; a < half; a += 2)
+            {
+                float tr = real[a + 1];
+                float ti = imag[a + 1];
+                real[a + 1] = real[a] - tr;
+                imag[a + 1] = imag[a] - ti;
+                real[a] += tr;
+                imag[a] += ti;
+            }
+
+            if (half >= 4)
+            {
+                for (uint32_t start = 0; start < half; start += 4)
+                {
+                    float tr = real[start + 2];
+                    float ti = imag[start + 2];
+                    real[start + 2] = real[start] - tr;
+                    imag[start + 2] = imag[start] - ti;
+                    real[start] += tr;
+                    imag[start] += ti;
+
+                    tr = -sign * imag[start + 3];
+                    ti = sign * real[start + 3];
+                    real[start + 3] = real[start + 1] - tr;
+                    imag[start + 3] = imag[start + 1] - ti;
+                    real[start + 1] += tr;
+                    imag[start + 1] += ti;
+                }
+            }
+
+            for (uint32_t halfLength = 4; halfLength < half; halfLength <<= 1)
+            {
+                const float* stageCosines = &cosines[halfLength - 1];
+                const float* stageSines = &sines[halfLength - 1];
+
+                for (uint32_t start = 0; start < half; start += halfLength * 2)
+                {
+                    float* realA = real + start;
+                    float* imagA = imag + start;
+                    float* realB = realA + halfLength;
+                    float* imagB = imagA + halfLength;
+
+#if defined(__ARM_NEON__)
+                    const float32x4_t signs = vdupq_n_f32(sign);
+
+                    for (uint32_t j = 0; j < halfLength; j += 4)
+                    {
+                        float32x4_t wr = vld1q_f32(stageCosines + j);
+                        float32x4_t wi = vmulq_f32(vld1q_f32(stageSines + j), signs);
+                        float32x4_t br = vld1q_f32(realB + j);
+                        float32x4_t bi = vld1q_f32(imagB + j);
+                        float32x4_t ar = vld1q_f32(realA + j);
+                        float32x4_t ai = vld1q_f32(imagA + j);
+
+                        float32x4_t tr = vmlsq_f32(vmulq_f32(br, wr), bi, wi);
+                        float32x4_t ti = vmlaq_f32(vmulq_f32(br, wi), bi, wr);
+
+                        vst1q_f32(realB + j, vsubq_f32(ar, tr));
+                        vst1q_f32(imagB + j, vsubq_f32(ai, ti));
+                        vst1q_f32(realA + j, vaddq_f32(ar, tr));
+                        vst1q_f32(imagA + j, vaddq_f32(ai, ti));
+                    }
+#elif defined(__SSE__)
+                    const __m128 signs = _mm_set1_ps(sign);
+
+                    for (uint32_t j = 0; j < halfLength; j += 4)
+                    {
+                        __m128 wr = _mm_loadu_ps(stageCosines + j);
+                        __m128 wi = _mm_mul_ps(_mm_loadu_ps(stageSines + j), signs);
+                        __m128 br = _mm_loadu_ps(realB + j);
+                        __m128 bi = _mm_loadu_ps(imagB + j);
+                        __m128 ar = _mm_loadu_ps(realA + j);
+                        __m128 ai = _mm_loadu_ps(imagA + j);
+
+                        __m128 tr = _mm_sub_ps(_mm_mul_ps(br, wr), _mm_mul_ps(bi, wi));
+                        __m128 ti = _mm_add_ps(_mm_mul_ps(br, wi), _mm_mul_ps(bi, wr));
+
+                        _mm_storeu_ps(realB + j, _mm_sub_ps(ar, tr));
+                        _mm_storeu_ps(imagB + j, _mm_sub_ps(ai, ti));
+                        _mm_storeu_ps(realA + j, _mm_add_ps(ar, tr));
+                        _mm_storeu_ps(imagA + j, _mm_add_ps(ai, ti));
+                    }
+#else
+                    for (uint32_t j = 0; j < halfLength; ++j)
+                    {
+                        float wr = stageCosines[j];
+                        float wi = sign * stageSines[j];
+
+                        float tr = realB[j] * wr - imagB[j] * wi;
+                        float ti = realB[j] * wi + imagB[j] * wr;
+
+                        realB[j] = realA[j] - tr;
+                        imagB[j] = imagA[j] - ti;
+                        realA[j] += tr;
+                        imagA[j] += ti;
+                    }
+#endif
+                }
+            }
+        }
+
+        void FFT::multiplyAccumulate(const float* aReal, const float* aImag,
+                                     const float* bReal, const float* bImag,
+                                     float* sumReal, float* sumImag, uint32_t count)
+        {
+#if defined(__ARM_NEON__)
+            for (uint32_t i = 0; i < count; i += 4)
+            {
+                float32x4_t ar = vld1q_f32(aReal + i);
+                float32x4_t ai = vld1q_f32(aImag + i);
+                float32x4_t br = vld1q_f32(bReal + i);
+                float32x4_t bi = vld1q_f32(bImag + i);
+
+                float32x4_t sr = vld1q_f32(sumReal + i);
+                float32x4_t si = vld1q_f32(sumImag + i);
+                sr = vmlsq_f32(vmlaq_f32(sr, ar, br), ai, bi);
+                si = vmlaq_f32(vmlaq_f32(si, ar, bi), ai, br);
+                vst1q_f32(sumReal + i, sr);
+                vst1q_f32(sumImag + i, si);
+            }
+#elif defined(__SSE__)
+            for (uint32_t i = 0; i < count; i += 4)
+            {
+                __m128 ar = _mm_loadu_ps(aReal + i);
+                __m128 ai = _mm_loadu_ps(aImag + i);
+                __m128 br = _mm_loadu_ps(bReal + i);
+                __m128 bi = _mm_loadu_ps(bImag + i);
+
+                __m128 sr = _mm_add_ps(_mm_loadu_ps(sumReal + i), _mm_sub_ps(_mm_mul_ps(ar, br), _mm_mul_ps(ai, bi)));
+                __m128 si = _mm_add_ps(_mm_loadu_ps(sumImag + i), _mm_add_ps(_mm_mul_ps(ar, bi), _mm_mul_ps(ai, br)));
+                _mm_storeu_ps(sumReal + i, sr);
+                _mm_storeu_ps(sumImag + i, si);
+            }
+#else
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                sumReal[i] += aReal[i] * bReal[i] - aImag[i] * bImag[i];
+                sumImag[i] += aReal[i] * bImag[i] + aImag[i] * bReal[i];
+            }
+#endif
+        }
+    } // namespace audio
+} // namespace ouzel
@@ -0,0 +1,49 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_AUDIO_FFT_HPP
+#define OUZEL_AUDIO_FFT_HPP
+
+#include <cstdint>
+#include <vector>
+
+namespace ouzel
+{
+    namespace audio
+    {
+        // FFT of real signals of a power of two size, computed as a half size complex FFT of the even and
+        // odd samples. Spectra have size / 2 + 1 bins with the real and imaginary parts in separate arrays.
+        class FFT final
+        {
+        public:
+            FFT() = default;
+            explicit FFT(uint32_t initSize);
+
+            inline uint32_t getSize() const { return size; }
+
+            void forward(const float* input, float* resultReal, float* resultImag);
+            // the result is multiplied by size / 2
+            void inverse(const float* inputReal, const float* inputImag, float* result);
+
+            // sum += a * b for count bins, count must be a multiple of 4
+            static void multiplyAccumulate(const float* aReal, const float* aImag,
+                                           const float* bReal, const float* bImag,
+                                           float* sumReal, float* sumImag, uint32_t count);
+
+        private:
+            void transform(bool inverseTransform);
+
+            uint32_t size = 0;
+            uint32_t half = 0;
+
+            std::vector<uint32_t> bitReverse;
+            std::vector<float> cosines; // of the half size complex FFT, for every stage
+            std::vector<float> sines;
+            std::vector<float> splitCosines; // of the split into the real spectrum
+            std::vector<float> splitSines;
+            std::vector<float> scratchReal;
+            std::vector<float> scratchImag;
+        };
+    } // namespace audio
+} // namespace ouzel
+
+#endif // OUZEL_AUDIO_FFT_HPP
@@ -9,9 +9,10 @@ namespace ouzel
     namespace audio
     {
         Filter::Filter(Audio& initAudio,
-                       uintptr_t initProcessorId):
+                       std::unique_ptr<mixer::Processor>&& initProcessor):
             audio(initAudio),
-            processorId(initProcessorId)
+            processor(initProcessor.get()),
+            processorId(audio.initProcessor(std::move(initProcessor)))
         {
         }
 
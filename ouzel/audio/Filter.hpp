@@ -4,6 +4,8 @@
 #define OUZEL_AUDIO_FILTER_HPP
 
 #include <cstdint>
+#include <memory>
+#include "math/Vector3.hpp"
 
 namespace ouzel
 {
@@ -12,12 +14,17 @@ namespace ouzel
         class Audio;
         class Mix;
 
+        namespace mixer
+        {
+            class Processor;
+        }
+
         class Filter
         {
             friend Mix;
         public:
             Filter(Audio& initAudio,
-                   uintptr_t initProcessorId);
+                   std::unique_ptr<mixer::Processor>&& initProcessor);
             virtual ~Filter();
 
             Filter(const Filter&) = delete;
@@ -27,8 +34,13 @@ namespace ouzel
 
             uintptr_t getProcessorId() const { return processorId; }
 
+            // estimated factor the filter scales the volume by, used to find inaudible voices
+            virtual float getAttenuation(const Vector3<float>&) const { return 1.0F; }
+
         protected:
             Audio& audio;
+            // owned by the mixer, the game thread may only access its parameters
+            mixer::Processor* processor = nullptr;
             uintptr_t processorId = 0;
             Mix* mix = nullptr;
         };
@@ -1,11 +1,18 @@
 // Copyright 2015-2018 Elviss Strazdins. All rights reserved.
 
 #include <cmath>
+#include <memory>
+#include <random>
+#include <stdexcept>
 #include "Filters.hpp"
 #include "Audio.hpp"
+#include "AudioDevice.hpp"
+#include "Convolver.hpp"
+#include "Listener.hpp"
+#include "Mix.hpp"
+#include "mixer/Parameter.hpp"
 #include "scene/Actor.hpp"
 #include "math/MathUtils.hpp"
-#include "smbPitchShift.hpp"
 
 namespace ouzel
 {
@@ -14,19 +21,46 @@ namespace ouzel
         class DelayProcessor final: public mixer::Processor
         {
         public:
-            DelayProcessor()
+            DelayProcessor(uint16_t initChannels):
+                channels(initChannels)
             {
             }
 
-            void process(uint32_t frames, uint16_t channels, uint32_t sampleRate,
+            void process(uint32_t frames, uint16_t frameChannels, uint32_t,
                          std::vector<float>& samples) override
             {
+                if (buffer.empty() || frameChannels != channels) return;
+
+                // the buffer holds exactly the delayed frames, so the oldest frame is read before it is replaced
+                for (uint32_t frame = 0; frame < frames; ++frame)
+                {
+                    for (uint16_t channel = 0; channel < channels; ++channel)
+                    {
+                        float& delayed = buffer[position + channel];
+                        std::swap(delayed, samples[frame * channels + channel]);
+                    }
+
+                    position += channels;
+                    if (position == buffer.size()) position = 0;
+                }
+            }
+
+            // swaps the buffer, the old one stays in the update command and is freed with it on the game thread
+            void setBuffer(std::vector<float>& newBuffer)
+            {
+                buffer.swap(newBuffer);
+                position = 0;
             }
+
+        private:
+            uint16_t channels;
+            std::vector<float> buffer;
+            size_t position = 0;
         };
 
         Delay::Delay(Audio& initAudio):
             Filter(initAudio,
-            initAudio.initProcessor(std::unique_ptr<mixer::Processor>(new DelayProcessor())))
+                   std::unique_ptr<mixer::Processor>(new DelayProcessor(initAudio.getDevice()->getChannels())))
         {
         }
 
@@ -37,6 +71,15 @@ namespace ouzel
         void Delay::setDelay(float newDelay)
         {
             delay = newDelay;
+
+            const AudioDevice* device = audio.getDevice();
+            uint32_t frames = newDelay > 0.0F ? static_cast<uint32_t>(std::lround(newDelay * device->getSampleRate())) : 0;
+            std::shared_ptr<std::vector<float>> buffer = std::make_shared<std::vector<float>>(frames * device->getChannels());
+
+            audio.updateProcessor(processorId, [buffer](mixer::Object* node) {
+                DelayProcessor* delayProcessor = static_cast<DelayProcessor*>(node);
+                delayProcessor->setBuffer(*buffer);
+            });
         }
 
         class GainProcessor final: public mixer::Processor
@@ -46,27 +89,37 @@ namespace ouzel
             {
             }
 
-            void process(uint32_t, uint16_t, uint32_t,
+            void process(uint32_t frames, uint16_t channels, uint32_t,
                          std::vector<float>& samples) override
             {
-                for (float& sample : samples)
-                    sample *= gainFactor;
-            }
+                gainFactor.begin(frames);
 
-            void setGain(float newGain)
-            {
-                gain = newGain;
-                gainFactor = powf(10.0F, gain / 20.0F);
+                if (gainFactor.isSmoothing())
+                {
+                    for (uint32_t frame = 0; frame < frames; ++frame)
+                    {
+                        const float factor = gainFactor.next();
+                        for (uint16_t channel = 0; channel < channels; ++channel)
+                            samples[frame * channels + channel] *= factor;
+                    }
+                }
+                else
+                {
+                    const float factor = gainFactor.getValue();
+                    for (float& sample : samples)
+                        sample *= factor;
+                }
             }
 
+            inline mixer::Parameter& getGainFactor() { return gainFactor; }
+
         private:
-            float gain = 0.0F;
-            float gainFactor = 1.0F;
+            mixer::Parameter gainFactor{1.0F};
         };
 
         Gain::Gain(Audio& initAudio):
             Filter(initAudio,
-            initAudio.initProcessor(std::unique_ptr<mixer::Processor>(new GainProcessor())))
+                   std::unique_ptr<mixer::Processor>(new GainProcessor()))
         {
         }
 
@@ -78,54 +131,54 @@ namespace ouzel
         {
             gain = newGain;
 
-            audio.updateProcessor(processorId, [newGain](mixer::Object* node) {
-                GainProcessor* gainProcessor = static_cast<GainProcessor*>(node);
-                gainProcessor->setGain(newGain);
-            });
+            GainProcessor* gainProcessor = static_cast<GainProcessor*>(processor);
+            gainProcessor->getGainFactor().set(powf(10.0F, gain / 20.0F));
         }
 
-        class PannerProcessor final: public mixer::Processor
+        float Gain::getAttenuation(const Vector3<float>&) const
         {
-        public:
-            PannerProcessor()
-            {
-            }
+            return powf(10.0F, gain / 20.0F);
+        }
 
-            void process(uint32_t frames, uint16_t channels, uint32_t sampleRate,
-                         std::vector<float>& samples) override
-            {
-            }
+        // inverse distance model clamped to the min and max distance
+        static float getDistanceAttenuation(float distance, float rolloffFactor, float minDistance, float maxDistance)
+        {
+            if (minDistance <= 0.0F) return 1.0F;
 
-            void setPosition(const Vector3<float>& newPosition)
-            {
-                position = newPosition;
-            }
+            distance = clamp(distance, minDistance, maxDistance);
+            return minDistance / (minDistance + rolloffFactor * (distance - minDistance));
+        }
 
-            void setRolloffFactor(float newRolloffFactor)
-            {
-                rolloffFactor = newRolloffFactor;
-            }
+        struct PannerParameters
+        {
+            Vector3<float> position;
+            float rolloffFactor = 1.0F;
+            float minDistance = 1.0F;
+            float maxDistance = FLT_MAX;
+        };
 
-            void setMinDistance(float newMinDistance)
+        class PannerProcessor final: public mixer::Processor
+        {
+        public:
+            PannerProcessor()
             {
-                minDistance = newMinDistance;
             }
 
-            void setMaxDistance(float newMaxDistance)
+            void process(uint32_t, uint16_t, uint32_t,
+                         std::vector<float>&) override
             {
-                maxDistance = newMaxDistance;
+                parameters.update();
             }
 
+            inline mixer::ParameterBlock<PannerParameters>& getParameters() { return parameters; }
+
         private:
-            Vector3<float> position;
-            float rolloffFactor = 1.0F;
-            float minDistance = 1.0F;
-            float maxDistance = FLT_MAX;
+            mixer::ParameterBlock<PannerParameters> parameters;
         };
 
         Panner::Panner(Audio& initAudio):
             Filter(initAudio,
-                   initAudio.initProcessor(std::unique_ptr<mixer::Processor>(new PannerProcessor()))),
+                   std::unique_ptr<mixer::Processor>(new PannerProcessor())),
             scene::Component(scene::Component::SOUND)
         {
         }
@@ -137,41 +190,42 @@ namespace ouzel
         void Panner::setPosition(const Vector3<float>& newPosition)
         {
             position = newPosition;
-
-            audio.updateProcessor(processorId, [newPosition](mixer::Object* node) {
-                PannerProcessor* pannerProcessor = static_cast<PannerProcessor*>(node);
-                pannerProcessor->setPosition(newPosition);
-            });
+            updateParameters();
         }
 
         void Panner::setRolloffFactor(float newRolloffFactor)
         {
             rolloffFactor = newRolloffFactor;
-
-            audio.updateProcessor(processorId, [newRolloffFactor](mixer::Object* node) {
-                PannerProcessor* pannerProcessor = static_cast<PannerProcessor*>(node);
-                pannerProcessor->setRolloffFactor(newRolloffFactor);
-            });
+            updateParameters();
         }
 
         void Panner::setMinDistance(float newMinDistance)
         {
             minDistance = newMinDistance;
-
-            audio.updateProcessor(processorId, [newMinDistance](mixer::Object* node) {
-                PannerProcessor* pannerProcessor = static_cast<PannerProcessor*>(node);
-                pannerProcessor->setMinDistance(newMinDistance);
-            });
+            updateParameters();
         }
 
         void Panner::setMaxDistance(float newMaxDistance)
         {
             maxDistance = newMaxDistance;
+            updateParameters();
+        }
 
-            audio.updateProcessor(processorId, [newMaxDistance](mixer::Object* node) {
-                PannerProcessor* pannerProcessor = static_cast<PannerProcessor*>(node);
-                pannerProcessor->setMaxDistance(newMaxDistance);
-            });
+        void Panner::updateParameters()
+        {
+            PannerParameters parameters;
+            parameters.position = position;
+            parameters.rolloffFactor = rolloffFactor;
+            parameters.minDistance = minDistance;
+            parameters.maxDistance = maxDistance;
+
+            PannerProcessor* pannerProcessor = static_cast<PannerProcessor*>(processor);
+            pannerProcessor->getParameters().set(parameters);
+        }
+
+        float Panner::getAttenuation(const Vector3<float>& listenerPosition) const
+        {
+            return getDistanceAttenuation(position.distance(listenerPosition), rolloffFactor, minDistance, maxDistance);
         }
 
         void Panner::updateTransform()
@@ -190,40 +244,39 @@ namespace ouzel
             {
             }
 
-            void process(uint32_t frames, uint16_t channels, uint32_t sampleRate,
+            void process(uint32_t frames, uint16_t channels, uint32_t,
                          std::vector<float>& samples) override
             {
-                channelSamples.resize(frames);
-                pitchShift.resize(channels);
+                // the shifters take one pitch per call, so it changes once per buffer
+                pitch.begin(frames);
 
-                for (uint16_t channel = 0; channel < channels; ++channel)
-                {
-                    for (uint32_t sample = 0; sample < frames; ++sample)
-                        channelSamples[sample] = samples[sample * channels + channel];
-
-                    pitchShift[channel].process(pitch, frames, 1024, 4, static_cast<float>(sampleRate), channelSamples.data(), channelSamples.data());
+                if (pitchShifters.size() != channels) return;
 
-                    for (uint32_t sample = 0; sample < frames; ++sample)
-                        samples[sample * channels + channel] = channelSamples[sample];
-                }
+                for (uint16_t channel = 0; channel < channels; ++channel)
+                    pitchShifters[channel].process(pitch.getValue(), samples.data() + channel, frames, channels);
             }
 
-            void setPitch(float newPitch)
+            inline mixer::Parameter& getPitch() { return pitch; }
+
+            // swaps the shifters, the old ones stay in the update command and are freed with it on the game thread
+            void setPitchShifters(std::vector<PitchShifter>& newPitchShifters)
             {
-                pitch = clamp(newPitch, MIN_PITCH, MAX_PITCH);
+                pitchShifters.swap(newPitchShifters);
             }
 
         private:
-            float pitch = 1.0f;
-            std::vector<float> channelSamples;
-            std::vector<smb::PitchShift> pitchShift;
+            mixer::Parameter pitch;
+            std::vector<PitchShifter> pitchShifters;
         };
 
-        Pitch::Pitch(Audio& initAudio, float initPitch):
+        Pitch::Pitch(Audio& initAudio, float initPitch, PitchShifter::Mode initMode, uint32_t initFrameSize):
             Filter(initAudio,
-                   initAudio.initProcessor(std::unique_ptr<mixer::Processor>(new PitchProcessor(initPitch)))),
-            pitch(initPitch)
+                   std::unique_ptr<mixer::Processor>(new PitchProcessor(initPitch))),
+            pitch(initPitch),
+            mode(initMode),
+            frameSize(initFrameSize)
         {
+            updateShifters(mode, frameSize);
         }
 
         Pitch::~Pitch()
@@ -234,33 +287,340 @@ namespace ouzel
         {
             pitch = newPitch;
 
-            audio.updateProcessor(processorId, [newPitch](mixer::Object* node) {
+            PitchProcessor* pitchProcessor = static_cast<PitchProcessor*>(processor);
+            pitchProcessor->getPitch().set(clamp(newPitch, MIN_PITCH, MAX_PITCH));
+        }
+
+        void Pitch::setMode(PitchShifter::Mode newMode)
+        {
+            updateShifters(newMode, frameSize);
+            mode = newMode;
+        }
+
+        void Pitch::setFrameSize(uint32_t newFrameSize)
+        {
+            // throws for invalid sizes before anything is changed
+            updateShifters(mode, newFrameSize);
+            frameSize = newFrameSize;
+        }
+
+        void Pitch::updateShifters(PitchShifter::Mode newMode, uint32_t newFrameSize)
+        {
+            std::shared_ptr<std::vector<PitchShifter>> pitchShifters =
+                std::make_shared<std::vector<PitchShifter>>(audio.getDevice()->getChannels(), PitchShifter(newMode, newFrameSize));
+
+            audio.updateProcessor(processorId, [pitchShifters](mixer::Object* node) {
                 PitchProcessor* pitchProcessor = static_cast<PitchProcessor*>(node);
-                pitchProcessor->setPitch(newPitch);
+                pitchProcessor->setPitchShifters(*pitchShifters);
             });
         }
 
+        static constexpr uint32_t REVERB_BLOCK_SIZE = 256;
+        static constexpr float MAX_REVERB_DECAY = 10.0F;
+
+        // the reverberated signal is REVERB_BLOCK_SIZE frames late, the dry signal is not delayed
         class ReverbProcessor final: public mixer::Processor
         {
         public:
-            ReverbProcessor()
+            ReverbProcessor(uint16_t initChannels, float initMix):
+                channels(initChannels),
+                mix(initMix),
+                inputBlocks(initChannels * REVERB_BLOCK_SIZE),
+                outputBlocks(initChannels * REVERB_BLOCK_SIZE)
             {
             }
 
-            void process(uint32_t frames, uint16_t channels, uint32_t sampleRate,
+            void process(uint32_t frames, uint16_t frameChannels, uint32_t,
                          std::vector<float>& samples) override
             {
+                mix.begin(frames);
+
+                if (convolvers.size() != channels || frameChannels != channels) return;
+
+                for (uint32_t frame = 0; frame < frames; ++frame)
+                {
+                    const float currentMix = mix.next();
+
+                    for (uint16_t channel = 0; channel < channels; ++channel)
+                    {
+                        float& sample = samples[frame * channels + channel];
+                        inputBlocks[channel * REVERB_BLOCK_SIZE + position] = sample;
+                        sample = sample * (1.0F - currentMix) + outputBlocks[channel * REVERB_BLOCK_SIZE + position] * currentMix;
+                    }
+
+                    if (++position == REVERB_BLOCK_SIZE)
+                    {
+                        for (uint16_t channel = 0; channel < channels; ++channel)
+                            convolvers[channel].process(&inputBlocks[channel * REVERB_BLOCK_SIZE],
+                                                        &outputBlocks[channel * REVERB_BLOCK_SIZE]);
+                        position = 0;
+                    }
+                }
             }
+
+            // swaps the convolvers, the old ones stay in the update command and are freed with it on the game thread
+            void setConvolvers(std::vector<Convolver>& newConvolvers)
+            {
+                convolvers.swap(newConvolvers);
+            }
+
+            inline mixer::Parameter& getMix() { return mix; }
+
+        private:
+            uint16_t channels;
+            mixer::Parameter mix;
+            std::vector<Convolver> convolvers;
+            std::vector<float> inputBlocks;
+            std::vector<float> outputBlocks;
+            uint32_t position = 0;
         };
 
-        Reverb::Reverb(Audio& initAudio):
+        Reverb::Reverb(Audio& initAudio, float initDecay, float initMix):
             Filter(initAudio,
-            initAudio.initProcessor(std::unique_ptr<mixer::Processor>(new ReverbProcessor())))
+                   std::unique_ptr<mixer::Processor>(new ReverbProcessor(initAudio.getDevice()->getChannels(),
+                                                                         clamp(initMix, 0.0F, 1.0F)))),
+            mix(clamp(initMix, 0.0F, 1.0F))
         {
+            setDecay(initDecay);
         }
 
         Reverb::~Reverb()
         {
         }
+
+        void Reverb::setDecay(float newDecay)
+        {
+            decay = clamp(newDecay, 0.0F, MAX_REVERB_DECAY);
+
+            const uint32_t sampleRate = audio.getDevice()->getSampleRate();
+            const uint16_t channels = audio.getDevice()->getChannels();
+            const uint32_t frames = std::max(static_cast<uint32_t>(decay * sampleRate), 1U);
+
+            // independent noise for every channel makes the reverberation wide, -60 dB at the decay time
+            std::vector<float> samples(frames * channels);
+            std::minstd_rand generator;
+            std::uniform_real_distribution<float> distribution(-1.0F, 1.0F);
+            const float falloff = std::log(0.001F) / frames;
+
+            for (uint32_t frame = 0; frame < frames; ++frame)
+                for (uint16_t channel = 0; channel < channels; ++channel)
+                    samples[frame * channels + channel] = distribution(generator) * std::exp(falloff * frame);
+
+            setImpulseResponse(samples, channels, sampleRate);
+        }
+
+        void Reverb::setImpulseResponse(const std::vector<float>& samples, uint16_t channels, uint32_t sampleRate)
+        {
+            if (!channels || !sampleRate) return;
+
+            const uint32_t deviceSampleRate = audio.getDevice()->getSampleRate();
+            const uint16_t deviceChannels = audio.getDevice()->getChannels();
+            const uint32_t frames = static_cast<uint32_t>(samples.size() / channels);
+            const uint32_t deviceFrames = std::max(static_cast<uint32_t>(static_cast<uint64_t>(frames) * deviceSampleRate / sampleRate), 1U);
+
+            std::shared_ptr<std::vector<Convolver>> convolvers = std::make_shared<std::vector<Convolver>>();
+            std::vector<float> response(deviceFrames);
+
+            for (uint16_t deviceChannel = 0; deviceChannel < deviceChannels; ++deviceChannel)
+            {
+                uint16_t channel = deviceChannel % channels;
+
+                // linear resampling
+                for (uint32_t frame = 0; frame < deviceFrames; ++frame)
+                {
+                    float position = static_cast<float>(frame) * sampleRate / deviceSampleRate;
+                    uint32_t first = static_cast<uint32_t>(position);
+                    float fraction = position - first;
+
+                    float a = first < frames ? samples[first * channels + channel] : 0.0F;
+                    float b = first + 1 < frames ? samples[(first + 1) * channels + channel] : 0.0F;
+                    response[frame] = a + (b - a) * fraction;
+                }
+
+                // normalized to unit energy, so that the loudness does not depend on the response length
+                float energy = 0.0F;
+                for (float sample : response) energy += sample * sample;
+                if (energy > 0.0F)
+                {
+                    float scale = 1.0F / std::sqrt(energy);
+                    for (float& sample : response) sample *= scale;
+                }
+
+                convolvers->push_back(Convolver(response.data(), deviceFrames, REVERB_BLOCK_SIZE));
+            }
+
+            audio.updateProcessor(processorId, [convolvers](mixer::Object* node) {
+                ReverbProcessor* reverbProcessor = static_cast<ReverbProcessor*>(node);
+                reverbProcessor->setConvolvers(*convolvers);
+            });
+        }
+
+        void Reverb::setMix(float newMix)
+        {
+            mix = clamp(newMix, 0.0F, 1.0F);
+
+            ReverbProcessor* reverbProcessor = static_cast<ReverbProcessor*>(processor);
+            reverbProcessor->getMix().set(mix);
+        }
+
+        struct SpatializerParameters
+        {
+            Vector3<float> direction{0.0F, 0.0F, 1.0F};
+            float gain = 0.0F;
+        };
+
+        class SpatializerProcessor final: public mixer::Processor
+        {
+        public:
+            SpatializerProcessor()
+            {
+            }
+
+            void process(uint32_t frames, uint16_t channels, uint32_t,
+                         std::vector<float>& samples) override
+            {
+                if (parameters.update())
+                {
+                    direction = parameters.get().direction;
+                    gain = parameters.get().gain;
+                    convolver.setDirection(direction);
+                }
+
+                const uint32_t blockSize = static_cast<uint32_t>(blocks.size() / 3);
+                if (!blockSize || channels < 2) return;
+
+                float* inputBlock = &blocks[0];
+                float* leftBlock = &blocks[blockSize];
+                float* rightBlock = &blocks[blockSize * 2];
+                const float channelScale = 1.0F / channels;
+
+                for (uint32_t frame = 0; frame < frames; ++frame)
+                {
+                    float* frameSamples = &samples[frame * channels];
+
+                    float sum = 0.0F;
+                    for (uint16_t channel = 0; channel < channels; ++channel)
+                        sum += frameSamples[channel];
+
+                    currentGain += gainStep;
+                    inputBlock[position] = sum * channelScale * currentGain;
+
+                    frameSamples[0] = leftBlock[position];
+                    frameSamples[1] = rightBlock[position];
+                    for (uint16_t channel = 2; channel < channels; ++channel)
+                        frameSamples[channel] = 0.0F;
+
+                    if (++position == blockSize)
+                    {
+                        convolver.process(inputBlock, leftBlock, rightBlock);
+                        position = 0;
+                        gainStep = (gain - currentGain) / blockSize;
+                    }
+                }
+            }
+
+            // swaps the convolver and its blocks, the old ones (and the last reference to the old HRTF)
+            // stay in the update command and are freed with it on the game thread
+            void setConvolver(HrtfConvolver& newConvolver, std::vector<float>& newBlocks)
+            {
+                std::swap(convolver, newConvolver);
+                blocks.swap(newBlocks);
+                position = 0;
+                convolver.setDirection(direction);
+            }
+
+            inline mixer::ParameterBlock<SpatializerParameters>& getParameters() { return parameters; }
+
+        private:
+            mixer::ParameterBlock<SpatializerParameters> parameters;
+            HrtfConvolver convolver;
+            std::vector<float> blocks; // input, left and right
+            uint32_t position = 0;
+            Vector3<float> direction{0.0F, 0.0F, 1.0F};
+            float gain = 0.0F;
+            float currentGain = 0.0F;
+            float gainStep = 0.0F;
+        };
+
+        Spatializer::Spatializer(Audio& initAudio, const std::shared_ptr<const Hrtf>& initHrtf):
+            Filter(initAudio,
+                   std::unique_ptr<mixer::Processor>(new SpatializerProcessor())),
+            scene::Component(scene::Component::SOUND)
+        {
+            setHrtf(initHrtf);
+            audio.addSpatializer(this);
+        }
+
+        Spatializer::~Spatializer()
+        {
+            audio.removeSpatializer(this);
+        }
+
+        void Spatializer::setHrtf(const std::shared_ptr<const Hrtf>& newHrtf)
+        {
+            if (newHrtf && newHrtf->getSampleRate() != audio.getDevice()->getSampleRate())
+                throw std::runtime_error("HRTF sample rate does not match the audio device");
+
+            hrtf = newHrtf;
+
+            std::shared_ptr<HrtfConvolver> convolver = std::make_shared<HrtfConvolver>();
+            std::shared_ptr<std::vector<float>> blocks = std::make_shared<std::vector<float>>();
+
+            if (hrtf)
+            {
+                *convolver = HrtfConvolver(hrtf);
+                blocks->resize(hrtf->getBlockSize() * 3);
+            }
+
+            audio.updateProcessor(processorId, [convolver, blocks](mixer::Object* node) {
+                SpatializerProcessor* spatializerProcessor = static_cast<SpatializerProcessor*>(node);
+                spatializerProcessor->setConvolver(*convolver, *blocks);
+            });
+        }
+
+        float Spatializer::getAttenuation(const Vector3<float>& listenerPosition) const
+        {
+            return getDistanceAttenuation(position.distance(listenerPosition), rolloffFactor, minDistance, maxDistance);
+        }
+
+        void Spatializer::updateTransform()
+        {
+            position = actor->getWorldPosition();
+        }
+
+        void Spatializer::updateListener()
+        {
+            // the first listener on the way to the master mix
+            const Listener* listener = nullptr;
+            for (Mix* currentMix = mix; currentMix && !listener; currentMix = currentMix->getOutput())
+                if (!currentMix->getListeners().empty())
+                    listener = currentMix->getListeners().front();
+
+            Vector3<float> offset = listener ? position - listener->getPosition() : position;
+            if (listener)
+            {
+                Quaternion<float> inverseRotation = listener->getRotation();
+                inverseRotation.invert();
+                offset = inverseRotation.rotateVector(offset);
+            }
+
+            const float distance = offset.length();
+            Vector3<float> newDirection = distance > 0.0F ? offset / distance : Vector3<float>(0.0F, 0.0F, 1.0F);
+            float newGain = getDistanceAttenuation(distance, rolloffFactor, minDistance, maxDistance);
+
+            // every new direction costs a crossfade, so changes below about half a degree are skipped
+            if ((newDirection - direction).lengthSquared() < 0.0001F && std::fabs(newGain - gain) < 0.0001F)
+                return;
+
+            direction = newDirection;
+            gain = newGain;
+
+            SpatializerParameters parameters;
+            parameters.direction = direction;
+            parameters.gain = gain;
+
+            SpatializerProcessor* spatializerProcessor = static_cast<SpatializerProcessor*>(processor);
+            spatializerProcessor->getParameters().set(parameters);
+        }
     } // namespace audio
 } // namespace ouzel
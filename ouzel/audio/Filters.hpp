@@ -4,8 +4,13 @@
 #define OUZEL_AUDIO_FILTERS_HPP
 
 #include <cfloat>
+#include <memory>
 #include <utility>
+#include <vector>
 #include "audio/Filter.hpp"
+#include "audio/Hrtf.hpp"
+#include "audio/PitchShifter.hpp"
+#include "math/Quaternion.hpp"
 #include "math/Vector3.hpp"
 #include "scene/Component.hpp"
 
@@ -25,7 +30,8 @@ namespace ouzel
             Delay& operator=(Delay&&) = delete;
 
             inline float getDelay() const { return delay; }
-            inline void setDelay(float newDelay);
+            // the delayed samples are cleared
+            void setDelay(float newDelay);
 
             inline void setDelayRandom(const std::pair<float, float>& newDelayRandom) { delayRandom = newDelayRandom; }
             inline const std::pair<float, float>& getDelayRandom() const { return delayRandom; }
@@ -52,6 +58,8 @@ namespace ouzel
             inline void setGainRandom(const std::pair<float, float>& newGainRandom) { gainRandom = newGainRandom; }
             inline const std::pair<float, float>& getGainRandom() const { return gainRandom; }
 
+            float getAttenuation(const Vector3<float>& listenerPosition) const override;
+
         private:
             float gain = 0.0F; // dB
             std::pair<float, float> gainRandom{0.0F, 0.0F};
@@ -80,8 +88,11 @@ namespace ouzel
             inline float getMaxDistance() const { return maxDistance; }
             void setMaxDistance(float newMaxDistance);
 
+            float getAttenuation(const Vector3<float>& listenerPosition) const override;
+
         private:
             void updateTransform() override;
+            void updateParameters();
 
             Vector3<float> position;
             float rolloffFactor = 1.0F;
@@ -92,7 +103,9 @@ namespace ouzel
         class Pitch final: public Filter
         {
         public:
-            Pitch(Audio& initAudio, float initPitch = 1.0F);
+            Pitch(Audio& initAudio, float initPitch = 1.0F,
+                  PitchShifter::Mode initMode = PitchShifter::Mode::PHASE_VOCODER,
+                  uint32_t initFrameSize = 1024);
             ~Pitch();
 
             Pitch(const Pitch&) = delete;
@@ -106,21 +119,95 @@ namespace ouzel
             inline void setPitchRandom(const std::pair<float, float>& newPitchRandom) { pitchRandom = newPitchRandom; }
             inline const std::pair<float, float>& getPitchRandom() const { return pitchRandom; }
 
+            inline PitchShifter::Mode getMode() const { return mode; }
+            void setMode(PitchShifter::Mode newMode);
+
+            // the latency grows with the frame size, see PitchShifter
+            inline uint32_t getFrameSize() const { return frameSize; }
+            void setFrameSize(uint32_t newFrameSize);
+
         private:
+            void updateShifters(PitchShifter::Mode newMode, uint32_t newFrameSize);
+
             float pitch = 1.0f;
             std::pair<float, float> pitchRandom{0.0F, 0.0F};
+            PitchShifter::Mode mode = PitchShifter::Mode::PHASE_VOCODER;
+            uint32_t frameSize = 1024;
         };
 
         class Reverb final: public Filter
         {
         public:
-            Reverb(Audio& initAudio);
+            // uses a decaying noise impulse response that falls by 60 dB in initDecay seconds
+            Reverb(Audio& initAudio, float initDecay = 1.5F, float initMix = 0.3F);
             ~Reverb();
 
             Reverb(const Reverb&) = delete;
             Reverb& operator=(const Reverb&) = delete;
             Reverb(Reverb&&) = delete;
             Reverb& operator=(Reverb&&) = delete;
+
+            inline float getDecay() const { return decay; }
+            void setDecay(float newDecay);
+
+            // interleaved samples, resampled to the rate of the device, channels are repeated
+            // if the device has more of them
+            void setImpulseResponse(const std::vector<float>& samples, uint16_t channels, uint32_t sampleRate);
+
+            // 0 is only the dry signal, 1 is only the reverberated signal
+            inline float getMix() const { return mix; }
+            void setMix(float newMix);
+
+        private:
+            float decay = 1.5F;
+            float mix = 0.3F;
+        };
+
+        // Binaural rendering for headphones. The mix is downmixed to mono and placed at the position relative
+        // to the first listener on the way to the master mix, so every spatialized voice needs its own submix.
+        class Spatializer final: public Filter, public scene::Component
+        {
+            friend Audio;
+        public:
+            // the HRTF must have the sample rate of the device and can be shared by all spatializers
+            Spatializer(Audio& initAudio, const std::shared_ptr<const Hrtf>& initHrtf);
+            ~Spatializer();
+
+            Spatializer(const Spatializer&) = delete;
+            Spatializer& operator=(const Spatializer&) = delete;
+            Spatializer(Spatializer&&) = delete;
+            Spatializer& operator=(Spatializer&&) = delete;
+
+            inline const std::shared_ptr<const Hrtf>& getHrtf() const { return hrtf; }
+            void setHrtf(const std::shared_ptr<const Hrtf>& newHrtf);
+
+            inline const Vector3<float>& getPosition() const { return position; }
+            inline void setPosition(const Vector3<float>& newPosition) { position = newPosition; }
+
+            inline float getRolloffFactor() const { return rolloffFactor; }
+            inline void setRolloffFactor(float newRolloffFactor) { rolloffFactor = newRolloffFactor; }
+
+            inline float getMinDistance() const { return minDistance; }
+            inline void setMinDistance(float newMinDistance) { minDistance = newMinDistance; }
+
+            inline float getMaxDistance() const { return maxDistance; }
+            inline void setMaxDistance(float newMaxDistance) { maxDistance = newMaxDistance; }
+
+            float getAttenuation(const Vector3<float>& listenerPosition) const override;
+
+        private:
+            void updateTransform() override;
+            // sends the direction and the distance attenuation to the processor if they changed
+            void updateListener();
+
+            std::shared_ptr<const Hrtf> hrtf;
+            Vector3<float> position;
+            float rolloffFactor = 1.0F;
+            float minDistance = 1.0F;
+            float maxDistance = FLT_MAX;
+
+            Vector3<float> direction;
+            float gain = 0.0F;
         };
     } // namespace audio
 } // namespace ouzel
@@ -0,0 +1,448 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#if defined(__ARM_NEON__)
+#  include <arm_neon.h>
+#elif defined(__SSE__)
+#  include <xmmintrin.h>
+#endif
+#include "Hrtf.hpp"
+#include "math/MathUtils.hpp"
+#include "utils/Utils.hpp"
+
+namespace ouzel
+{
+    namespace audio
+    {
+        static constexpr float PI = 3.14159265358979323846F;
+        static constexpr float HEAD_RADIUS = 0.0875F; // meters
+        static constexpr float SPEED_OF_SOUND = 343.0F; // meters per second
+
+        // destination += source * weight, count must be a multiple of 4
+        static void addWeighted(const float* source, float weight, float* destination, uint32_t count)
+        {
+#if defined(__ARM_NEON__)
+            float32x4_t w = vdupq_n_f32(weight);
+            for (uint32_t i = 0; i < count; i += 4)
+                vst1q_f32(destination + i, vmlaq_f32(vld1q_f32(destination + i), vld1q_f32(source + i), w));
+#elif defined(__SSE__)
+            __m128 w = _mm_set1_ps(weight);
+            for (uint32_t i = 0; i < count; i += 4)
+                _mm_storeu_ps(destination + i, _mm_add_ps(_mm_loadu_ps(destination + i),
+                                                          _mm_mul_ps(_mm_loadu_ps(source + i), w)));
+#else
+            for (uint32_t i = 0; i < count; ++i)
+                destination[i] += source[i] * weight;
+#endif
+        }
+
+        static float decodeFloat(const uint8_t* buffer)
+        {
+            uint32_t bits = decodeLittleEndian<uint32_t>(buffer);
+            float result;
+            std::memcpy(&result, &bits, sizeof(result));
+            return result;
+        }
+
+        // resamples the response and removes the silence before its onset, returns the length of the removed part
+        static float align(const float* response, uint32_t length, uint32_t responseSampleRate,
+                           uint32_t sampleRate, std::vector<float>& result)
+        {
+            const uint32_t resampledLength = std::max(static_cast<uint32_t>(static_cast<uint64_t>(length) * sampleRate / responseSampleRate), 1U);
+            std::vector<float> resampled(resampledLength);
+
+            for (uint32_t i = 0; i < resampledLength; ++i)
+            {
+                float position = static_cast<float>(i) * responseSampleRate / sampleRate;
+                uint32_t first = static_cast<uint32_t>(position);
+                float fraction = position - first;
+
+                float a = first < length ? response[first] : 0.0F;
+                float b = first + 1 < length ? response[first + 1] : 0.0F;
+                resampled[i] = a + (b - a) * fraction;
+            }
+
+            float peak = 0.0F;
+            for (float sample : resampled) peak = std::max(peak, std::fabs(sample));
+
+            uint32_t onset = 0;
+            while (onset < resampledLength && std::fabs(resampled[onset]) < peak * 0.1F) ++onset;
+
+            // keep a couple of samples before the onset for the ringing of the measurement
+            uint32_t start = onset > 2 ? onset - 2 : 0;
+            if (start > Hrtf::MAX_DELAY) start = Hrtf::MAX_DELAY;
+
+            result.assign(resampled.begin() + start, resampled.end());
+            return static_cast<float>(start);
+        }
+
+        Hrtf::Hrtf(uint32_t initSampleRate, uint32_t initBlockSize):
+            sampleRate(initSampleRate),
+            blockSize(std::max(initBlockSize, 4U)),
+            partitionCount(1),
+            binStride((blockSize + 1 + 3) & ~3U)
+        {
+            std::vector<Vector3<float>> grid;
+            for (int32_t elevation = -45; elevation < 90; elevation += 15)
+                for (int32_t azimuth = 0; azimuth < 360; azimuth += 15)
+                {
+                    float a = azimuth * PI / 180.0F;
+                    float e = elevation * PI / 180.0F;
+                    grid.push_back(Vector3<float>(-std::sin(a) * std::cos(e), std::sin(e), std::cos(a) * std::cos(e)));
+                }
+            grid.push_back(Vector3<float>(0.0F, 1.0F, 0.0F));
+
+            directions.resize(grid.size());
+            delays.resize(grid.size() * 2);
+            spectraReal.resize(grid.size() * 2 * binStride);
+            spectraImag.resize(grid.size() * 2 * binStride);
+
+            // Brown and Duda head shadow, a one-pole one-zero filter that boosts the high frequencies
+            // towards the ear and cuts them on the other side of the head, discretized with the bilinear transform
+            const float beta = 2.0F * SPEED_OF_SOUND / HEAD_RADIUS;
+            const float k = 2.0F * sampleRate;
+            const Vector3<float> ears[2] = {Vector3<float>(-1.0F, 0.0F, 0.0F), Vector3<float>(1.0F, 0.0F, 0.0F)};
+
+            std::vector<float> responses[2];
+            for (uint32_t index = 0; index < grid.size(); ++index)
+            {
+                float earDelays[2];
+
+                for (uint32_t ear = 0; ear < 2; ++ear)
+                {
+                    float angle = std::acos(clamp(grid[index].dot(ears[ear]), -1.0F, 1.0F));
+                    float alpha = 1.05F + 0.95F * std::cos(angle * 180.0F / 150.0F);
+
+                    float b0 = (beta + alpha * k) / (beta + k);
+                    float b1 = (beta - alpha * k) / (beta + k);
+                    float a1 = (beta - k) / (beta + k);
+
+                    responses[ear].resize(blockSize);
+                    float previous = 0.0F;
+                    for (uint32_t i = 0; i < blockSize; ++i)
+                    {
+                        float output = (i == 0 ? b0 : 0.0F) + (i == 1 ? b1 : 0.0F) - a1 * previous;
+                        responses[ear][i] = output;
+                        previous = output;
+                    }
+
+                    // Woodworth's formula, offset so that the ear closer to the source has no delay when facing it
+                    float time = angle < PI / 2.0F ?
+                        -HEAD_RADIUS / SPEED_OF_SOUND * std::cos(angle) :
+                        HEAD_RADIUS / SPEED_OF_SOUND * (angle - PI / 2.0F);
+                    earDelays[ear] = (time + HEAD_RADIUS / SPEED_OF_SOUND) * sampleRate;
+                }
+
+                addResponse(index, grid[index], responses[0].data(), earDelays[0], responses[1].data(), earDelays[1]);
+            }
+        }
+
+        Hrtf::Hrtf(const std::vector<uint8_t>& data, uint32_t initSampleRate, uint32_t initBlockSize):
+            sampleRate(initSampleRate),
+            blockSize(std::max(initBlockSize, 4U)),
+            binStride((blockSize + 1 + 3) & ~3U)
+        {
+            if (data.size() < 16)
+                throw std::runtime_error("Failed to load HRTF, file too small");
+
+            if (data[0] != 'H' || data[1] != 'R' || data[2] != 'T' || data[3] != 'F')
+                throw std::runtime_error("Failed to load HRTF, invalid header");
+
+            const uint32_t responseSampleRate = decodeLittleEndian<uint32_t>(data.data() + 4);
+            const uint32_t count = decodeLittleEndian<uint32_t>(data.data() + 8);
+            const uint32_t length = decodeLittleEndian<uint32_t>(data.data() + 12);
+
+            if (!responseSampleRate || !count || !length)
+                throw std::runtime_error("Failed to load HRTF, no responses");
+
+            if ((data.size() - 16) / count < 8 + static_cast<uint64_t>(length) * 8)
+                throw std::runtime_error("Failed to load HRTF, not enough data");
+
+            std::vector<float> responses[2];
+            std::vector<Vector3<float>> grid(count);
+            std::vector<std::vector<float>> left(count);
+            std::vector<std::vector<float>> right(count);
+            std::vector<float> leftDelays(count);
+            std::vector<float> rightDelays(count);
+            uint32_t alignedLength = 1;
+
+            const uint8_t* position = data.data() + 16;
+            for (uint32_t index = 0; index < count; ++index)
+            {
+                float azimuth = decodeFloat(position) * PI / 180.0F;
+                float elevation = decodeFloat(position + 4) * PI / 180.0F;
+                position += 8;
+
+                grid[index] = Vector3<float>(-std::sin(azimuth) * std::cos(elevation),
+                                             std::sin(elevation),
+                                             std::cos(azimuth) * std::cos(elevation));
+
+                for (uint32_t ear = 0; ear < 2; ++ear)
+                {
+                    responses[ear].resize(length);
+                    for (uint32_t i = 0; i < length; ++i, position += 4)
+                        responses[ear][i] = decodeFloat(position);
+                }
+
+                leftDelays[index] = align(responses[0].data(), length, responseSampleRate, sampleRate, left[index]);
+                rightDelays[index] = align(responses[1].data(), length, responseSampleRate, sampleRate, right[index]);
+                alignedLength = std::max(alignedLength, static_cast<uint32_t>(std::max(left[index].size(), right[index].size())));
+            }
+
+            partitionCount = (alignedLength + blockSize - 1) / blockSize;
+            directions.resize(count);
+            delays.resize(count * 2);
+            spectraReal.resize(count * 2 * partitionCount * binStride);
+            spectraImag.resize(count * 2 * partitionCount * binStride);
+
+            for (uint32_t index = 0; index < count; ++index)
+            {
+                left[index].resize(partitionCount * blockSize);
+                right[index].resize(partitionCount * blockSize);
+                addResponse(index, grid[index], left[index].data(), leftDelays[index], right[index].data(), rightDelays[index]);
+            }
+        }
+
+        void Hrtf::interpolate(const Vector3<float>& direction,
+                               float* leftReal, float* leftImag, float* rightReal, float* rightImag,
+                               float& leftDelay, float& rightDelay) const
+        {
+            Vector3<float> normalized = direction;
+            if (normalized.lengthSquared() > 0.0F)
+                normalized.normalize();
+            else
+                normalized = Vector3<float>(0.0F, 0.0F, 1.0F);
+
+            // the four closest directions, the weight of the fourth one is subtracted from the others,
+            // so that a direction fades out before it is replaced and the blend stays continuous
+            uint32_t closest[4] = {0, 0, 0, 0};
+            float similarities[4] = {-2.0F, -2.0F, -2.0F, -2.0F};
+
+            for (uint32_t index = 0; index < directions.size(); ++index)
+            {
+                float similarity = directions[index].dot(normalized);
+
+                for (uint32_t i = 0; i < 4; ++i)
+                {
+                    if (similarity > similarities[i])
+                    {
+                        for (uint32_t j = 3; j > i; --j)
+                        {
+                            closest[j] = closest[j - 1];
+                            similarities[j] = similarities[j - 1];
+                        }
+                        closest[i] = index;
+                        similarities[i] = similarity;
+                        break;
+                    }
+                }
+            }
+
+            const uint32_t count = std::min(static_cast<uint32_t>(directions.size()), 3U);
+            const float threshold = directions.size() > 3 ? 1.0F / (1.0F - similarities[3] + 0.000001F) : 0.0F;
+
+            float weights[3] = {0.0F, 0.0F, 0.0F};
+            float sum = 0.0F;
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                weights[i] = std::max(1.0F / (1.0F - similarities[i] + 0.000001F) - threshold, 0.0F);
+                sum += weights[i];
+            }
+
+            // all of the closest directions are equally far
+            if (sum <= 0.0F)
+            {
+                weights[0] = 1.0F;
+                sum = 1.0F;
+            }
+
+            const uint32_t size = partitionCount * binStride;
+            std::fill(leftReal, leftReal + size, 0.0F);
+            std::fill(leftImag, leftImag + size, 0.0F);
+            std::fill(rightReal, rightReal + size, 0.0F);
+            std::fill(rightImag, rightImag + size, 0.0F);
+            leftDelay = 0.0F;
+            rightDelay = 0.0F;
+
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                if (weights[i] <= 0.0F) continue;
+
+                const float weight = weights[i] / sum;
+                const uint32_t left = closest[i] * 2 * size;
+                const uint32_t right = left + size;
+
+                addWeighted(&spectraReal[left], weight, leftReal, size);
+                addWeighted(&spectraImag[left], weight, leftImag, size);
+                addWeighted(&spectraReal[right], weight, rightReal, size);
+                addWeighted(&spectraImag[right], weight, rightImag, size);
+                leftDelay += delays[closest[i] * 2] * weight;
+                rightDelay += delays[closest[i] * 2 + 1] * weight;
+            }
+        }
+
+        void Hrtf::addResponse(uint32_t index, const Vector3<float>& direction,
+                               const float* left, float leftDelay, const float* right, float rightDelay)
+        {
+            directions[index] = direction;
+            delays[index * 2] = std::min(leftDelay, static_cast<float>(MAX_DELAY));
+            delays[index * 2 + 1] = std::min(rightDelay, static_cast<float>(MAX_DELAY));
+
+            FFT fft(blockSize * 2);
+            std::vector<float> timeBuffer(blockSize * 2);
+
+            // the 1 / blockSize scale of the inverse transform is applied to the responses
+            const float scale = 1.0F / blockSize;
+            const float* responses[2] = {left, right};
+
+            for (uint32_t ear = 0; ear < 2; ++ear)
+            {
+                for (uint32_t partition = 0; partition < partitionCount; ++partition)
+                {
+                    for (uint32_t i = 0; i < blockSize; ++i)
+                        timeBuffer[i] = responses[ear][partition * blockSize + i] * scale;
+
+                    const uint32_t offset = ((index * 2 + ear) * partitionCount + partition) * binStride;
+                    fft.forward(timeBuffer.data(), &spectraReal[offset], &spectraImag[offset]);
+                }
+            }
+        }
+
+        HrtfConvolver::HrtfConvolver(const std::shared_ptr<const Hrtf>& initHrtf):
+            hrtf(initHrtf),
+            blockSize(initHrtf->getBlockSize()),
+            partitionCount(initHrtf->getPartitionCount()),
+            binStride(initHrtf->getBinStride()),
+            fft(blockSize * 2),
+            direction(0.0F, 0.0F, 1.0F)
+        {
+            const uint32_t size = partitionCount * binStride;
+
+            timeBuffer.resize(blockSize * 2);
+            inputReal.resize(size);
+            inputImag.resize(size);
+            filterReal.resize(size * 4);
+            filterImag.resize(size * 4);
+            sumReal.resize(binStride);
+            sumImag.resize(binStride);
+            outputBuffer.resize(blockSize * 2);
+            currentBlock.resize(blockSize);
+            previousBlock.resize(blockSize);
+
+            uint32_t lineSize = 1;
+            while (lineSize < Hrtf::MAX_DELAY + 2) lineSize <<= 1;
+            leftLine.resize(lineSize);
+            rightLine.resize(lineSize);
+
+            hrtf->interpolate(direction,
+                              &filterReal[0], &filterImag[0], &filterReal[size], &filterImag[size],
+                              targetLeftDelay, targetRightDelay);
+            leftDelay = targetLeftDelay;
+            rightDelay = targetRightDelay;
+        }
+
+        void HrtfConvolver::setDirection(const Vector3<float>& newDirection)
+        {
+            direction = newDirection;
+            directionChanged = true;
+        }
+
+        void HrtfConvolver::process(const float* input, float* left, float* right)
+        {
+            if (!blockSize) return;
+
+            const uint32_t size = partitionCount * binStride;
+
+            std::copy(timeBuffer.begin() + blockSize, timeBuffer.end(), timeBuffer.begin());
+            std::copy(input, input + blockSize, timeBuffer.begin() + blockSize);
+
+            fft.forward(timeBuffer.data(), &inputReal[currentPartition * binStride], &inputImag[currentPartition * binStride]);
+
+            const uint32_t previousFilter = currentFilter;
+            if (directionChanged)
+            {
+                currentFilter ^= 1;
+                const uint32_t offset = currentFilter * 2 * size;
+                hrtf->interpolate(direction,
+                                  &filterReal[offset], &filterImag[offset],
+                                  &filterReal[offset + size], &filterImag[offset + size],
+                                  targetLeftDelay, targetRightDelay);
+            }
+
+            float* outputs[2] = {left, right};
+
+            for (uint32_t ear = 0; ear < 2; ++ear)
+            {
+                const uint32_t offset = (currentFilter * 2 + ear) * size;
+                convolve(&filterReal[offset], &filterImag[offset], currentBlock.data());
+
+                // the old and the new response are crossfaded, so that the movement does not click
+                if (previousFilter != currentFilter)
+                {
+                    const uint32_t previousOffset = (previousFilter * 2 + ear) * size;
+                    convolve(&filterReal[previousOffset], &filterImag[previousOffset], previousBlock.data());
+
+                    const float step = 1.0F / blockSize;
+                    for (uint32_t i = 0; i < blockSize; ++i)
+                        currentBlock[i] = previousBlock[i] + (currentBlock[i] - previousBlock[i]) * step * (i + 1);
+                }
+
+                if (ear == 0)
+                    delay(currentBlock.data(), outputs[ear], leftLine, leftDelay, targetLeftDelay);
+                else
+                    delay(currentBlock.data(), outputs[ear], rightLine, rightDelay, targetRightDelay);
+            }
+
+            linePosition = (linePosition + blockSize) & static_cast<uint32_t>(leftLine.size() - 1);
+            currentPartition = (currentPartition + 1) % partitionCount;
+            directionChanged = false;
+        }
+
+        void HrtfConvolver::convolve(const float* filterReal, const float* filterImag, float* output)
+        {
+            std::fill(sumReal.begin(), sumReal.end(), 0.0F);
+            std::fill(sumImag.begin(), sumImag.end(), 0.0F);
+
+            for (uint32_t partition = 0; partition < partitionCount; ++partition)
+            {
+                uint32_t inputPartition = (currentPartition + partitionCount - partition) % partitionCount;
+                FFT::multiplyAccumulate(&inputReal[inputPartition * binStride], &inputImag[inputPartition * binStride],
+                                        &filterReal[partition * binStride], &filterImag[partition * binStride],
+                                        sumReal.data(), sumImag.data(), binStride);
+            }
+
+            // overlap-save keeps only the second half
+            fft.inverse(sumReal.data(), sumImag.data(), outputBuffer.data());
+            std::copy(outputBuffer.begin() + blockSize, outputBuffer.end(), output);
+        }
+
+        // fractional delay with linear interpolation, the delay glides to the target over the block
+        void HrtfConvolver::delay(const float* input, float* output, std::vector<float>& line,
+                                  float& currentDelay, float targetDelay)
+        {
+            const uint32_t mask = static_cast<uint32_t>(line.size() - 1);
+            const float step = (targetDelay - currentDelay) / blockSize;
+            uint32_t position = linePosition;
+
+            for (uint32_t i = 0; i < blockSize; ++i)
+            {
+                line[position] = input[i];
+
+                float sampleDelay = currentDelay + step * (i + 1);
+                uint32_t whole = static_cast<uint32_t>(sampleDelay);
+                float fraction = sampleDelay - whole;
+
+                float a = line[(position - whole) & mask];
+                float b = line[(position - whole - 1) & mask];
+                output[i] = a + (b - a) * fraction;
+
+                position = (position + 1) & mask;
+            }
+
+            currentDelay = targetDelay;
+        }
+    } // namespace audio
+} // namespace ouzel
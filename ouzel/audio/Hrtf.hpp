@@ -0,0 +1,115 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_AUDIO_HRTF_HPP
+#define OUZEL_AUDIO_HRTF_HPP
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "audio/FFT.hpp"
+#include "math/Vector3.hpp"
+
+namespace ouzel
+{
+    namespace audio
+    {
+        // Set of head-related impulse responses measured from different directions, prepared for the
+        // partitioned convolution at one sample rate. The interaural time difference is removed from the
+        // responses and kept as a separate delay, so that the responses of neighbouring directions can be
+        // interpolated without comb filtering. It is immutable and can be shared by any number of voices.
+        class Hrtf final
+        {
+        public:
+            static constexpr uint32_t MAX_DELAY = 255;
+
+            // spherical head model without pinna cues, usable when no measured set is available
+            explicit Hrtf(uint32_t initSampleRate, uint32_t initBlockSize = 128);
+
+            // little endian binary file with the following layout:
+            // "HRTF", uint32 sample rate, uint32 direction count, uint32 response length,
+            // then for every direction float azimuth and elevation in degrees (the azimuth grows
+            // counterclockwise from the front, like in SOFA files), response length floats of the left
+            // ear and response length floats of the right ear
+            Hrtf(const std::vector<uint8_t>& data, uint32_t initSampleRate, uint32_t initBlockSize = 128);
+
+            inline uint32_t getSampleRate() const { return sampleRate; }
+            inline uint32_t getBlockSize() const { return blockSize; }
+            inline uint32_t getPartitionCount() const { return partitionCount; }
+            inline uint32_t getBinStride() const { return binStride; }
+            inline uint32_t getDirectionCount() const { return static_cast<uint32_t>(directions.size()); }
+
+            // blends the spectra and delays of the measured directions closest to the direction in the
+            // listener space (x is right, y is up and z is forward), spectra hold partitionCount * binStride bins
+            void interpolate(const Vector3<float>& direction,
+                             float* leftReal, float* leftImag, float* rightReal, float* rightImag,
+                             float& leftDelay, float& rightDelay) const;
+
+        private:
+            // responses must have partitionCount * blockSize samples
+            void addResponse(uint32_t index, const Vector3<float>& direction,
+                             const float* left, float leftDelay, const float* right, float rightDelay);
+
+            uint32_t sampleRate = 0;
+            uint32_t blockSize = 0;
+            uint32_t partitionCount = 0;
+            uint32_t binStride = 0; // blockSize + 1 bins rounded up to a multiple of 4
+
+            std::vector<Vector3<float>> directions;
+            std::vector<float> delays; // left and right for every direction
+            std::vector<float> spectraReal; // left and right partitions for every direction
+            std::vector<float> spectraImag;
+        };
+
+        // Binaural rendering of one mono voice with an HRTF set. All memory is allocated in the constructor.
+        class HrtfConvolver final
+        {
+        public:
+            HrtfConvolver() = default;
+            explicit HrtfConvolver(const std::shared_ptr<const Hrtf>& initHrtf);
+
+            inline const std::shared_ptr<const Hrtf>& getHrtf() const { return hrtf; }
+
+            // the change is crossfaded over the next block
+            void setDirection(const Vector3<float>& newDirection);
+
+            // renders blockSize input samples, the output is blockSize samples late
+            void process(const float* input, float* left, float* right);
+
+        private:
+            void convolve(const float* filterReal, const float* filterImag, float* output);
+            void delay(const float* input, float* output, std::vector<float>& line, float& currentDelay, float targetDelay);
+
+            std::shared_ptr<const Hrtf> hrtf;
+            uint32_t blockSize = 0;
+            uint32_t partitionCount = 0;
+            uint32_t binStride = 0;
+            uint32_t currentPartition = 0;
+            uint32_t currentFilter = 0;
+
+            FFT fft;
+
+            Vector3<float> direction;
+            bool directionChanged = false;
+            float leftDelay = 0.0F;
+            float rightDelay = 0.0F;
+            float targetLeftDelay = 0.0F;
+            float targetRightDelay = 0.0F;
+
+            std::vector<float> timeBuffer; // previous and current input block
+            std::vector<float> inputReal; // spectra of the last partitionCount input blocks
+            std::vector<float> inputImag;
+            std::vector<float> filterReal; // left and right, current and previous
+            std::vector<float> filterImag;
+            std::vector<float> sumReal;
+            std::vector<float> sumImag;
+            std::vector<float> outputBuffer;
+            std::vector<float> currentBlock;
+            std::vector<float> previousBlock;
+            std::vector<float> leftLine; // delay lines for the interaural time difference
+            std::vector<float> rightLine;
+            uint32_t linePosition = 0;
+        };
+    } // namespace audio
+} // namespace ouzel
+
+#endif // OUZEL_AUDIO_HRTF_HPP
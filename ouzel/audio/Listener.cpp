@@ -31,6 +31,8 @@ namespace ouzel
 
         void Listener::updateTransform()
         {
+            position = actor->getWorldPosition();
+            rotation = actor->getRotation();
             transformDirty = true;
         }
     } // namespace audio
@@ -30,6 +30,9 @@ namespace ouzel
 
             void setMix(Mix* newMix);
 
+            inline const Vector3<float>& getPosition() const { return position; }
+            inline const Quaternion<float>& getRotation() const { return rotation; }
+
         private:
             void updateTransform() override;
 
@@ -37,7 +40,7 @@ namespace ouzel
 
             Mix* mix = nullptr;
             Vector3<float> position;
-            Quaternion<float> rotation;
+            Quaternion<float> rotation = Quaternion<float>::identity();
             bool transformDirty = true;
         };
     } // namespace audio
@@ -35,6 +35,10 @@ namespace ouzel
             void addFilter(Filter* filter);
             void removeFilter(Filter* filter);
 
+            inline const std::vector<Filter*>& getFilters() const { return filters; }
+            inline const std::vector<Listener*>& getListeners() const { return listeners; }
+            virtual Mix* getOutput() const { return nullptr; }
+
         protected:
             void addInput(Submix* submix);
             void removeInput(Submix* submix);
@@ -23,6 +23,7 @@ namespace ouzel
             }
 
             void getData(uint32_t frames, std::vector<float>& samples) override;
+            void skip(uint32_t frames) override;
 
         private:
             uint32_t position = 0;
@@ -137,7 +138,7 @@ namespace ouzel
 
                 if ((frameCount - position) == 0)
                 {
-                    if (!isRepeating()) playing = false; // TODO: fire event
+                    if (!isRepeating()) finish();
                     reset();
                 }
 
@@ -153,6 +154,30 @@ namespace ouzel
             }
         }
 
+        void OscillatorSource::skip(uint32_t frames)
+        {
+            const float length = static_cast<OscillatorData&>(source).getLength();
+
+            if (length > 0.0F)
+            {
+                const uint32_t frameCount = static_cast<uint32_t>(length * source.getSampleRate());
+
+                if (isRepeating())
+                    position = frameCount ? static_cast<uint32_t>((static_cast<uint64_t>(position) + frames) % frameCount) : 0;
+                else if (frameCount - position > frames)
+                    position += frames;
+                else
+                {
+                    finish();
+                    reset();
+                }
+            }
+            else
+            {
+                position += frames;
+            }
+        }
+
         OscillatorSound::OscillatorSound(Audio& initAudio, float initFrequency,
                                          Type initType, float initAmplitude, float initLength):
             Sound(initAudio, initAudio.initSource([initFrequency, initType, initAmplitude, initLength](){
@@ -1,16 +1,187 @@
 // Copyright 2015-2018 Elviss Strazdins. All rights reserved.
 
+#include <algorithm>
+#include <cstring>
 #include <iterator>
+#include <limits>
 #include <stdexcept>
+#if defined(__ARM_NEON__)
+#  include <arm_neon.h>
+#elif defined(__SSE2__)
+#  include <emmintrin.h>
+#endif
 #include "PCMSound.hpp"
 #include "Audio.hpp"
 #include "mixer/Stream.hpp"
 #include "mixer/Source.hpp"
+#include "math/MathUtils.hpp"
 
 namespace ouzel
 {
     namespace audio
     {
+        static const int32_t IMA_ADPCM_STEPS[89] = {
+            7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+            50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+            253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+            1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+            3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487,
+            12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+        };
+
+        static const int32_t IMA_ADPCM_INDICES[16] = {
+            -1, -1, -1, -1, 2, 4, 6, 8,
+            -1, -1, -1, -1, 2, 4, 6, 8
+        };
+
+        static void convertUnsigned8(const uint8_t* data, float* result, uint32_t count)
+        {
+            uint32_t i = 0;
+
+#if defined(__ARM_NEON__)
+            if (isSimdAvailable)
+            {
+                float32x4_t scale = vdupq_n_f32(2.0F / 255.0F);
+                float32x4_t offset = vdupq_n_f32(-1.0F);
+
+                for (; i + 8 <= count; i += 8)
+                {
+                    uint16x8_t values = vmovl_u8(vld1_u8(data + i));
+                    vst1q_f32(result + i, vmlaq_f32(offset, vcvtq_f32_u32(vmovl_u16(vget_low_u16(values))), scale));
+                    vst1q_f32(result + i + 4, vmlaq_f32(offset, vcvtq_f32_u32(vmovl_u16(vget_high_u16(values))), scale));
+                }
+            }
+#elif defined(__SSE2__)
+            __m128i zero = _mm_setzero_si128();
+            __m128 scale = _mm_set1_ps(2.0F / 255.0F);
+            __m128 offset = _mm_set1_ps(-1.0F);
+
+            for (; i + 16 <= count; i += 16)
+            {
+                __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+                __m128i low = _mm_unpacklo_epi8(values, zero);
+                __m128i high = _mm_unpackhi_epi8(values, zero);
+
+                _mm_storeu_ps(result + i, _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(low, zero)), scale), offset));
+                _mm_storeu_ps(result + i + 4, _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(low, zero)), scale), offset));
+                _mm_storeu_ps(result + i + 8, _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(high, zero)), scale), offset));
+                _mm_storeu_ps(result + i + 12, _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(high, zero)), scale), offset));
+            }
+#endif
+
+            for (; i < count; ++i)
+                result[i] = data[i] * (2.0F / 255.0F) - 1.0F;
+        }
+
+        static void convertSigned16(const uint8_t* data, float* result, uint32_t count)
+        {
+            uint32_t i = 0;
+
+#if defined(__ARM_NEON__)
+            if (isSimdAvailable)
+            {
+                for (; i + 8 <= count; i += 8)
+                {
+                    int16x8_t values = vld1q_s16(reinterpret_cast<const int16_t*>(data + i * 2));
+                    vst1q_f32(result + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(values))), 1.0F / 32767.0F));
+                    vst1q_f32(result + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(values))), 1.0F / 32767.0F));
+                }
+            }
+#elif defined(__SSE2__)
+            __m128 scale = _mm_set1_ps(1.0F / 32767.0F);
+
+            for (; i + 8 <= count; i += 8)
+            {
+                __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 2));
+                // sign extend to 32 bits
+                __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(values, values), 16);
+                __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(values, values), 16);
+
+                _mm_storeu_ps(result + i, _mm_mul_ps(_mm_cvtepi32_ps(low), scale));
+                _mm_storeu_ps(result + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(high), scale));
+            }
+#endif
+
+            for (; i < count; ++i)
+                result[i] = static_cast<int16_t>(data[i * 2] | (data[i * 2 + 1] << 8)) * (1.0F / 32767.0F);
+        }
+
+        static void convertSigned24(const uint8_t* data, float* result, uint32_t count)
+        {
+            for (uint32_t i = 0; i < count; ++i)
+                result[i] = static_cast<int32_t>((static_cast<uint32_t>(data[i * 3]) << 8) |
+                                                 (static_cast<uint32_t>(data[i * 3 + 1]) << 16) |
+                                                 (static_cast<uint32_t>(data[i * 3 + 2]) << 24)) * (1.0F / 2147483648.0F);
+        }
+
+        static void convertSigned32(const uint8_t* data, float* result, uint32_t count)
+        {
+            uint32_t i = 0;
+
+#if defined(__ARM_NEON__)
+            if (isSimdAvailable)
+            {
+                for (; i + 4 <= count; i += 4)
+                    vst1q_f32(result + i, vmulq_n_f32(vcvtq_f32_s32(vld1q_s32(reinterpret_cast<const int32_t*>(data + i * 4))),
+                                                      1.0F / 2147483648.0F));
+            }
+#elif defined(__SSE2__)
+            __m128 scale = _mm_set1_ps(1.0F / 2147483648.0F);
+
+            for (; i + 4 <= count; i += 4)
+                _mm_storeu_ps(result + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 4))), scale));
+#endif
+
+            for (; i < count; ++i)
+                result[i] = static_cast<int32_t>(static_cast<uint32_t>(data[i * 4]) |
+                                                 (static_cast<uint32_t>(data[i * 4 + 1]) << 8) |
+                                                 (static_cast<uint32_t>(data[i * 4 + 2]) << 16) |
+                                                 (static_cast<uint32_t>(data[i * 4 + 3]) << 24)) * (1.0F / 2147483648.0F);
+        }
+
+        // decodes a WAVE IMA ADPCM block: a four byte header per channel followed by
+        // interleaved groups of four bytes (eight samples) per channel
+        static void decodeImaAdpcm(const uint8_t* block, uint32_t size, uint16_t channels,
+                                   uint32_t frames, float* result)
+        {
+            // truncated blocks are padded with silence
+            std::fill(result, result + frames * channels, 0.0F);
+
+            for (uint16_t channel = 0; channel < channels; ++channel)
+            {
+                const uint8_t* header = block + channel * 4;
+                int32_t predictor = static_cast<int16_t>(header[0] | (header[1] << 8));
+                int32_t index = std::min(static_cast<int32_t>(header[2]), 88);
+
+                result[channel] = predictor / 32767.0F;
+
+                for (uint32_t frame = 1; frame < frames; frame += 8)
+                {
+                    uint32_t offset = channels * 4 + ((frame - 1) / 8) * channels * 4 + channel * 4;
+
+                    for (uint32_t i = 0; i < 8 && frame + i < frames; ++i)
+                    {
+                        uint32_t byteOffset = offset + i / 2;
+                        if (byteOffset >= size) break;
+
+                        uint8_t nibble = (i % 2) ? (block[byteOffset] >> 4) : (block[byteOffset] & 0x0F);
+
+                        int32_t step = IMA_ADPCM_STEPS[index];
+                        int32_t diff = step >> 3;
+                        if (nibble & 1) diff += step >> 2;
+                        if (nibble & 2) diff += step >> 1;
+                        if (nibble & 4) diff += step;
+                        if (nibble & 8) diff = -diff;
+
+                        predictor = std::max(-32768, std::min(32767, predictor + diff));
+                        index = std::max(0, std::min(88, index + IMA_ADPCM_INDICES[nibble]));
+
+                        result[(frame + i) * channels + channel] = predictor / 32767.0F;
+                    }
+                }
+            }
+        }
+
         class PCMData;
 
         class PCMSource: public mixer::Stream
@@ -24,23 +195,61 @@ namespace ouzel
             }
 
             void getData(uint32_t frames, std::vector<float>& samples) override;
+            void skip(uint32_t frames) override;
 
         private:
+            void convert(uint32_t start, uint32_t count, float* result);
+
             uint32_t position = 0;
+
+            // the last decoded ADPCM block
+            std::vector<float> block;
+            uint32_t blockIndex = std::numeric_limits<uint32_t>::max();
         };
 
         class PCMData: public mixer::Source
         {
         public:
             PCMData(uint16_t initChannels, uint32_t initSampleRate,
-                    const std::vector<float>& initSamples):
-                samples(initSamples)
+                    PCMSound::Encoding initEncoding,
+                    const std::shared_ptr<const std::vector<uint8_t>>& initData,
+                    uint32_t initBlockAlign):
+                encoding(initEncoding),
+                data(initData),
+                blockAlign(initBlockAlign)
             {
                 channels = initChannels;
                 sampleRate = initSampleRate;
+
+                switch (encoding)
+                {
+                    case PCMSound::Encoding::UNSIGNED8: frameCount = static_cast<uint32_t>(data->size() / channels); break;
+                    case PCMSound::Encoding::SIGNED16: frameCount = static_cast<uint32_t>(data->size() / (channels * 2)); break;
+                    case PCMSound::Encoding::SIGNED24: frameCount = static_cast<uint32_t>(data->size() / (channels * 3)); break;
+                    case PCMSound::Encoding::SIGNED32:
+                    case PCMSound::Encoding::FLOAT32: frameCount = static_cast<uint32_t>(data->size() / (channels * 4)); break;
+                    case PCMSound::Encoding::IMA_ADPCM:
+                    {
+                        uint32_t headerSize = channels * 4;
+                        framesPerBlock = (blockAlign - headerSize) * 2 / channels + 1;
+
+                        frameCount = static_cast<uint32_t>(data->size() / blockAlign) * framesPerBlock;
+                        uint32_t remainder = static_cast<uint32_t>(data->size() % blockAlign);
+                        // the last block can be shorter, it holds whole groups of eight samples per channel
+                        if (remainder >= headerSize)
+                            frameCount += (remainder - headerSize) / headerSize * 8 + 1;
+                        break;
+                    }
+                    default:
+                        throw std::runtime_error("Unsupported encoding");
+                }
             }
 
-            const std::vector<float>& getSamples() const { return samples; }
+            PCMSound::Encoding getEncoding() const { return encoding; }
+            const std::vector<uint8_t>& getData() const { return *data; }
+            uint32_t getBlockAlign() const { return blockAlign; }
+            uint32_t getFramesPerBlock() const { return framesPerBlock; }
+            uint32_t getFrameCount() const { return frameCount; }
 
             std::unique_ptr<mixer::Stream> createStream() override
             {
@@ -48,7 +257,12 @@ namespace ouzel
             }
 
         private:
-            std::vector<float> samples;
+            PCMSound::Encoding encoding;
+            // shared by all the voices playing the sound
+            std::shared_ptr<const std::vector<uint8_t>> data;
+            uint32_t blockAlign = 0;
+            uint32_t framesPerBlock = 0;
+            uint32_t frameCount = 0;
         };
 
         PCMSource::PCMSource(PCMData& pcmData):
@@ -56,56 +270,145 @@ namespace ouzel
         {
         }
 
-        void PCMSource::getData(uint32_t frames, std::vector<float>& samples)
+        void PCMSource::convert(uint32_t start, uint32_t count, float* result)
         {
-            uint32_t neededSize = frames * source.getChannels();
-            samples.resize(neededSize);
+            PCMData& pcmData = static_cast<PCMData&>(source);
+            const uint8_t* data = pcmData.getData().data();
+            uint16_t channels = pcmData.getChannels();
 
+            switch (pcmData.getEncoding())
+            {
+                case PCMSound::Encoding::UNSIGNED8:
+                    convertUnsigned8(data + start * channels, result, count * channels);
+                    break;
+                case PCMSound::Encoding::SIGNED16:
+                    convertSigned16(data + start * channels * 2, result, count * channels);
+                    break;
+                case PCMSound::Encoding::SIGNED24:
+                    convertSigned24(data + start * channels * 3, result, count * channels);
+                    break;
+                case PCMSound::Encoding::SIGNED32:
+                    convertSigned32(data + start * channels * 4, result, count * channels);
+                    break;
+                case PCMSound::Encoding::FLOAT32:
+                    std::memcpy(result, data + start * channels * 4, count * channels * sizeof(float));
+                    break;
+                case PCMSound::Encoding::IMA_ADPCM:
+                {
+                    uint32_t framesPerBlock = pcmData.getFramesPerBlock();
+                    uint32_t blockAlign = pcmData.getBlockAlign();
+                    uint32_t dataSize = static_cast<uint32_t>(pcmData.getData().size());
+
+                    while (count > 0)
+                    {
+                        uint32_t currentBlock = start / framesPerBlock;
+                        uint32_t offset = start % framesPerBlock;
+
+                        if (currentBlock != blockIndex)
+                        {
+                            uint32_t blockStart = currentBlock * blockAlign;
+                            uint32_t blockFrames = std::min(framesPerBlock, pcmData.getFrameCount() - currentBlock * framesPerBlock);
+
+                            block.resize(framesPerBlock * channels);
+                            decodeImaAdpcm(data + blockStart, std::min(blockAlign, dataSize - blockStart),
+                                           channels, blockFrames, block.data());
+                            blockIndex = currentBlock;
+                        }
+
+                        uint32_t frames = std::min(count, framesPerBlock - offset);
+                        std::copy(block.begin() + offset * channels,
+                                  block.begin() + (offset + frames) * channels,
+                                  result);
+
+                        result += frames * channels;
+                        start += frames;
+                        count -= frames;
+                    }
+                    break;
+                }
+            }
+        }
+
+        void PCMSource::getData(uint32_t frames, std::vector<float>& samples)
+        {
             PCMData& pcmData = static_cast<PCMData&>(source);
-            const std::vector<float>& data = pcmData.getSamples();
+            uint16_t channels = pcmData.getChannels();
+            uint32_t frameCount = pcmData.getFrameCount();
 
-            uint32_t totalSize = 0;
+            samples.resize(frames * channels);
 
-            while (neededSize > 0)
+            uint32_t totalFrames = 0;
+
+            while (frames > 0 && frameCount > 0)
             {
-                if (isRepeating() && (data.size() - position) == 0) reset();
+                if (isRepeating() && position == frameCount) reset();
 
-                if (data.size() - position < neededSize)
-                {
-                    std::copy(data.begin() + position,
-                              data.end(),
-                              samples.begin() + totalSize);
-                    totalSize += static_cast<uint32_t>(data.size() - position);
-                    neededSize -= static_cast<uint32_t>(data.size() - position);
-                    position = static_cast<uint32_t>(data.size());
-                }
-                else
-                {
-                    std::copy(data.begin() + position,
-                              data.begin() + position + neededSize,
-                              samples.begin() + totalSize);
-                    totalSize += neededSize;
-                    position += neededSize;
-                    neededSize = 0;
-                }
+                uint32_t count = std::min(frames, frameCount - position);
+                convert(position, count, samples.data() + totalFrames * channels);
+
+                totalFrames += count;
+                frames -= count;
+                position += count;
 
                 if (!isRepeating()) break;
             }
 
-            if ((data.size() - position) == 0)
+            if (position == frameCount)
+            {
+                if (!isRepeating()) finish();
+                reset();
+            }
+
+            std::fill(samples.begin() + totalFrames * channels, samples.end(), 0.0F);
+        }
+
+        void PCMSource::skip(uint32_t frames)
+        {
+            uint32_t frameCount = static_cast<PCMData&>(source).getFrameCount();
+
+            if (isRepeating())
+                position = frameCount ? static_cast<uint32_t>((static_cast<uint64_t>(position) + frames) % frameCount) : 0;
+            else if (frameCount - position > frames)
+                position += frames;
+            else
             {
-                if (!isRepeating()) playing = false; // TODO: fire event
+                finish();
                 reset();
             }
+        }
 
-            std::fill(samples.begin() + totalSize, samples.end(), 0.0F);
+        static std::vector<uint8_t> encodeFloat(const std::vector<float>& samples)
+        {
+            std::vector<uint8_t> data(samples.size() * sizeof(float));
+            if (!samples.empty()) std::memcpy(data.data(), samples.data(), data.size());
+            return data;
         }
 
         PCMSound::PCMSound(Audio& initAudio, uint16_t channels, uint32_t sampleRate,
                            const std::vector<float>& samples):
-            Sound(initAudio, initAudio.initSource([channels, sampleRate, samples](){
-                return std::unique_ptr<mixer::Source>(new PCMData(channels, sampleRate, samples));
-            }))
+            PCMSound(initAudio, channels, sampleRate, Encoding::FLOAT32, encodeFloat(samples))
+        {
+        }
+
+        static uintptr_t initPCMSource(Audio& audio, uint16_t channels, uint32_t sampleRate,
+                                       PCMSound::Encoding encoding, std::vector<uint8_t>&& data, uint32_t blockAlign)
+        {
+            if (channels == 0)
+                throw std::runtime_error("Invalid channel count");
+
+            if (encoding == PCMSound::Encoding::IMA_ADPCM && blockAlign <= channels * 4U)
+                throw std::runtime_error("Invalid IMA ADPCM block size");
+
+            std::shared_ptr<const std::vector<uint8_t>> sharedData = std::make_shared<const std::vector<uint8_t>>(std::move(data));
+
+            return audio.initSource([channels, sampleRate, encoding, sharedData, blockAlign](){
+                return std::unique_ptr<mixer::Source>(new PCMData(channels, sampleRate, encoding, sharedData, blockAlign));
+            });
+        }
+
+        PCMSound::PCMSound(Audio& initAudio, uint16_t channels, uint32_t sampleRate,
+                           Encoding encoding, std::vector<uint8_t>&& data, uint32_t blockAlign):
+            Sound(initAudio, initPCMSource(initAudio, channels, sampleRate, encoding, std::move(data), blockAlign))
         {
         }
     } // namespace audio
@@ -14,8 +14,23 @@ namespace ouzel
         class PCMSound final: public Sound
         {
         public:
+            // samples are kept in memory in their encoding and converted to float while mixing,
+            // all integer encodings are little-endian and interleaved
+            enum class Encoding
+            {
+                UNSIGNED8,
+                SIGNED16,
+                SIGNED24,
+                SIGNED32,
+                FLOAT32,
+                IMA_ADPCM
+            };
+
             PCMSound(Audio& initAudio, uint16_t channels, uint32_t sampleRate,
                      const std::vector<float>& samples);
+            // blockAlign is the size of an IMA ADPCM block in bytes, it is ignored for other encodings
+            PCMSound(Audio& initAudio, uint16_t channels, uint32_t sampleRate,
+                     Encoding encoding, std::vector<uint8_t>&& data, uint32_t blockAlign = 0);
         };
     } // namespace audio
 } // namespace ouzel
@@ -0,0 +1,459 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#if defined(__SSE__)
+#  include <xmmintrin.h>
+#endif
+#include "PitchShifter.hpp"
+
+namespace ouzel
+{
+    namespace audio
+    {
+        static constexpr float PI = 3.14159265358979323846F;
+        static constexpr float TAU = 2.0F * PI;
+        static constexpr uint32_t OVERSAMPLING = 4;
+        static constexpr uint32_t MIN_FRAME_SIZE = 64;
+        static constexpr float ROUNDING_CONSTANT = 12582912.0F; // 1.5 * 2^23, adding it rounds to the nearest integer
+
+        // scalar versions of the approximations below, used without SSE
+        static inline float wrapPhase(float phase)
+        {
+            float turns = (phase * (1.0F / TAU) + ROUNDING_CONSTANT) - ROUNDING_CONSTANT;
+            return phase - turns * TAU;
+        }
+
+        // maximum error 1e-5 radians
+        static inline float fastAtan2(float y, float x)
+        {
+            float absX = std::fabs(x);
+            float absY = std::fabs(y);
+            float ratio = std::min(absX, absY) / (std::max(absX, absY) + 1e-30F);
+            float square = ratio * ratio;
+            float result = ((-0.0464964749F * square + 0.15931422F) * square - 0.327622764F) * square * ratio + ratio;
+            if (absY > absX) result = PI / 2.0F - result;
+            if (x < 0.0F) result = PI - result;
+            return y < 0.0F ? -result : result;
+        }
+
+        // for angles in [-pi, pi], maximum error 4e-6
+        static inline float fastSin(float angle)
+        {
+            if (angle > PI / 2.0F) angle = PI - angle;
+            else if (angle < -PI / 2.0F) angle = -PI - angle;
+            float square = angle * angle;
+            return angle * (1.0F + square * (-1.0F / 6.0F + square * (1.0F / 120.0F + square * (-1.0F / 5040.0F + square * (1.0F / 362880.0F)))));
+        }
+
+        // measures the true frequency of every bin in bins from the phase change since the last frame
+        static void analyze(const float* real, const float* imag, const float* bins,
+                            float* magnitudes, float* frequencies, float* lastPhases, uint32_t count)
+        {
+            const float expected = TAU / OVERSAMPLING;
+            const float scale = OVERSAMPLING / TAU;
+            uint32_t i = 0;
+
+#if defined(__SSE__)
+            const __m128 signMask = _mm_set1_ps(-0.0F);
+            const __m128 rounding = _mm_set1_ps(ROUNDING_CONSTANT);
+
+            for (; i + 4 <= count; i += 4)
+            {
+                __m128 x = _mm_loadu_ps(real + i);
+                __m128 y = _mm_loadu_ps(imag + i);
+
+                _mm_storeu_ps(magnitudes + i, _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y))));
+
+                __m128 absX = _mm_andnot_ps(signMask, x);
+                __m128 absY = _mm_andnot_ps(signMask, y);
+                __m128 ratio = _mm_div_ps(_mm_min_ps(absX, absY), _mm_add_ps(_mm_max_ps(absX, absY), _mm_set1_ps(1e-30F)));
+                __m128 square = _mm_mul_ps(ratio, ratio);
+                __m128 phase = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(_mm_sub_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(-0.0464964749F), square),
+                                                                                                    _mm_set1_ps(0.15931422F)), square),
+                                                                         _mm_set1_ps(0.327622764F)), square), ratio), ratio);
+                __m128 steep = _mm_cmpgt_ps(absY, absX);
+                phase = _mm_or_ps(_mm_and_ps(steep, _mm_sub_ps(_mm_set1_ps(PI / 2.0F), phase)), _mm_andnot_ps(steep, phase));
+                __m128 negativeX = _mm_cmplt_ps(x, _mm_setzero_ps());
+                phase = _mm_or_ps(_mm_and_ps(negativeX, _mm_sub_ps(_mm_set1_ps(PI), phase)), _mm_andnot_ps(negativeX, phase));
+                phase = _mm_or_ps(phase, _mm_and_ps(signMask, y));
+
+                __m128 bin = _mm_loadu_ps(bins + i);
+                __m128 difference = _mm_sub_ps(_mm_sub_ps(phase, _mm_loadu_ps(lastPhases + i)), _mm_mul_ps(bin, _mm_set1_ps(expected)));
+                _mm_storeu_ps(lastPhases + i, phase);
+
+                __m128 turns = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(difference, _mm_set1_ps(1.0F / TAU)), rounding), rounding);
+                difference = _mm_sub_ps(difference, _mm_mul_ps(turns, _mm_set1_ps(TAU)));
+
+                _mm_storeu_ps(frequencies + i, _mm_add_ps(bin, _mm_mul_ps(difference, _mm_set1_ps(scale))));
+            }
+#endif
+
+            for (; i < count; ++i)
+            {
+                magnitudes[i] = std::sqrt(real[i] * real[i] + imag[i] * imag[i]);
+
+                float phase = fastAtan2(imag[i], real[i]);
+                float difference = wrapPhase(phase - lastPhases[i] - bins[i] * expected);
+                lastPhases[i] = phase;
+
+                frequencies[i] = bins[i] + difference * scale;
+            }
+        }
+
+        // wraps the phases and converts the bins to complex numbers
+        static void toRectangular(const float* magnitudes, float* phases, float* real, float* imag, uint32_t count)
+        {
+            uint32_t i = 0;
+
+#if defined(__SSE__)
+            const __m128 signMask = _mm_set1_ps(-0.0F);
+            const __m128 rounding = _mm_set1_ps(ROUNDING_CONSTANT);
+            const __m128 halfPi = _mm_set1_ps(PI / 2.0F);
+
+            for (; i + 4 <= count; i += 4)
+            {
+                __m128 phase = _mm_loadu_ps(phases + i);
+                __m128 turns = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(phase, _mm_set1_ps(1.0F / TAU)), rounding), rounding);
+                phase = _mm_sub_ps(phase, _mm_mul_ps(turns, _mm_set1_ps(TAU)));
+                _mm_storeu_ps(phases + i, phase);
+
+                // cos(x) = sin(x + pi / 2), wrapped back into [-pi, pi]
+                __m128 cosineAngle = _mm_add_ps(phase, halfPi);
+                __m128 over = _mm_cmpgt_ps(cosineAngle, _mm_set1_ps(PI));
+                cosineAngle = _mm_sub_ps(cosineAngle, _mm_and_ps(over, _mm_set1_ps(TAU)));
+
+                __m128 angles[2] = {phase, cosineAngle};
+                __m128 results[2];
+
+                for (uint32_t a = 0; a < 2; ++a)
+                {
+                    // reflect into [-pi / 2, pi / 2]
+                    __m128 angle = angles[a];
+                    __m128 sign = _mm_and_ps(signMask, angle);
+                    __m128 reflect = _mm_cmpgt_ps(_mm_andnot_ps(signMask, angle), halfPi);
+                    angle = _mm_or_ps(_mm_and_ps(reflect, _mm_sub_ps(_mm_or_ps(_mm_set1_ps(PI), sign), angle)),
+                                      _mm_andnot_ps(reflect, angle));
+
+                    __m128 square = _mm_mul_ps(angle, angle);
+                    __m128 polynomial = _mm_add_ps(_mm_set1_ps(-1.0F / 5040.0F), _mm_mul_ps(square, _mm_set1_ps(1.0F / 362880.0F)));
+                    polynomial = _mm_add_ps(_mm_set1_ps(1.0F / 120.0F), _mm_mul_ps(square, polynomial));
+                    polynomial = _mm_add_ps(_mm_set1_ps(-1.0F / 6.0F), _mm_mul_ps(square, polynomial));
+                    polynomial = _mm_add_ps(_mm_set1_ps(1.0F), _mm_mul_ps(square, polynomial));
+                    results[a] = _mm_mul_ps(angle, polynomial);
+                }
+
+                __m128 magnitude = _mm_loadu_ps(magnitudes + i);
+                _mm_storeu_ps(real + i, _mm_mul_ps(magnitude, results[1]));
+                _mm_storeu_ps(imag + i, _mm_mul_ps(magnitude, results[0]));
+            }
+#endif
+
+            for (; i < count; ++i)
+            {
+                float phase = wrapPhase(phases[i]);
+                phases[i] = phase;
+
+                float cosineAngle = phase + PI / 2.0F;
+                if (cosineAngle > PI) cosineAngle -= TAU;
+
+                real[i] = magnitudes[i] * fastSin(cosineAngle);
+                imag[i] = magnitudes[i] * fastSin(phase);
+            }
+        }
+
+        static float dot(const float* a, const float* b, uint32_t count)
+        {
+            uint32_t i = 0;
+            float result = 0.0F;
+
+#if defined(__SSE__)
+            __m128 sum = _mm_setzero_ps();
+            for (; i + 4 <= count; i += 4)
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+
+            alignas(16) float sums[4];
+            _mm_store_ps(sums, sum);
+            result = (sums[0] + sums[1]) + (sums[2] + sums[3]);
+#endif
+
+            for (; i < count; ++i)
+                result += a[i] * b[i];
+
+            return result;
+        }
+
+        PitchShifter::PitchShifter(Mode initMode, uint32_t initFrameSize):
+            mode(initMode)
+        {
+            // rounding larger sizes up to a power of two would overflow
+            if (initFrameSize > MAX_FRAME_SIZE)
+                throw std::invalid_argument("Invalid pitch shifter frame size");
+
+            frameSize = MIN_FRAME_SIZE;
+            while (frameSize < initFrameSize) frameSize <<= 1;
+
+            if (mode == Mode::WSOLA)
+            {
+                ring.resize(frameSize * 4);
+                ringMask = frameSize * 4 - 1;
+                readDelay = static_cast<float>(frameSize / 2 + 4 + frameSize / 2);
+                reference.resize(frameSize / 2);
+                candidates.resize(frameSize / 2 * 2 + frameSize / 2);
+            }
+            else
+            {
+                const uint32_t binCount = frameSize / 2 + 1;
+                const uint32_t hop = frameSize / OVERSAMPLING;
+
+                fft = FFT(frameSize);
+                binStride = (binCount + 3) & ~3U;
+                fifoPosition = frameSize - hop;
+
+                window.resize(frameSize);
+                for (uint32_t i = 0; i < frameSize; ++i)
+                    window[i] = 0.5F - 0.5F * std::cos(TAU * i / frameSize);
+
+                bins.resize(binStride);
+                for (uint32_t i = 0; i < binStride; ++i)
+                    bins[i] = static_cast<float>(i);
+
+                inputFifo.resize(frameSize);
+                outputFifo.resize(hop);
+                outputAccumulator.resize(frameSize);
+                frame.resize(frameSize);
+                real.resize(binStride);
+                imag.resize(binStride);
+                magnitudes.resize(binStride);
+                frequencies.resize(binStride);
+                lastPhases.resize(binStride);
+                peaks.resize(binCount);
+                synthesisMagnitudes.resize(binStride);
+                synthesisPhases.resize(binStride);
+                lockedPhases.resize(binStride);
+            }
+        }
+
+        uint32_t PitchShifter::getLatency() const
+        {
+            if (mode == Mode::WSOLA)
+                return frameSize / 2 + 4 + frameSize / 2;
+            else
+                return frameSize - frameSize / OVERSAMPLING;
+        }
+
+        void PitchShifter::process(float pitch, float* samples, uint32_t count, uint32_t stride)
+        {
+            if (!frameSize) return;
+
+            if (mode == Mode::WSOLA)
+                processWsola(pitch, samples, count, stride);
+            else
+                processPhaseVocoder(pitch, samples, count, stride);
+        }
+
+        // The input is read back at the pitch rate from a delay line. When the delay drifts out of its range,
+        // the read position jumps by a frame and the two positions are crossfaded over half a frame. The jump
+        // target is adjusted by up to a quarter of a frame to where the waveform matches the current one best.
+        void PitchShifter::processWsola(float pitch, float* samples, uint32_t count, uint32_t stride)
+        {
+            const uint32_t overlap = frameSize / 2;
+            const float minDelay = static_cast<float>(overlap + 4);
+            const float maxDelay = static_cast<float>(overlap + 4 + frameSize + frameSize / 4);
+            const float drift = 1.0F - pitch;
+
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                float& sample = samples[i * stride];
+
+                ring[writeIndex] = sample;
+                writeIndex = (writeIndex + 1) & ringMask;
+
+                if (!fading)
+                {
+                    float targetDelay = 0.0F;
+                    if (pitch > 1.0F && readDelay < minDelay)
+                        targetDelay = readDelay + frameSize;
+                    else if (pitch < 1.0F && readDelay > maxDelay)
+                        targetDelay = readDelay - frameSize;
+
+                    if (targetDelay > 0.0F)
+                    {
+                        fadeDelay = targetDelay - static_cast<float>(findSplice(readDelay, targetDelay));
+                        fadePosition = 0;
+                        fading = true;
+                    }
+                }
+
+                float result = read(readDelay);
+                readDelay += drift;
+
+                if (fading)
+                {
+                    float factor = (fadePosition + 0.5F) / overlap;
+                    result += (read(fadeDelay) - result) * factor;
+                    fadeDelay += drift;
+
+                    if (++fadePosition == overlap)
+                    {
+                        readDelay = fadeDelay;
+                        fading = false;
+                    }
+                }
+
+                sample = result;
+            }
+        }
+
+        // returns the offset from the target position (towards the newer samples) with the highest
+        // normalized correlation to the samples that the current position would read next
+        int32_t PitchShifter::findSplice(float delay, float targetDelay)
+        {
+            const uint32_t overlap = frameSize / 2;
+            const int32_t range = static_cast<int32_t>(frameSize / 4);
+
+            uint32_t referenceStart = writeIndex - static_cast<uint32_t>(delay);
+            for (uint32_t i = 0; i < overlap; ++i)
+                reference[i] = ring[(referenceStart + i) & ringMask];
+
+            uint32_t candidateStart = writeIndex - static_cast<uint32_t>(targetDelay) - static_cast<uint32_t>(range);
+            for (uint32_t i = 0; i < candidates.size(); ++i)
+                candidates[i] = ring[(candidateStart + i) & ringMask];
+
+            int32_t bestOffset = 0;
+            float bestScore = -1.0F;
+
+            auto score = [this, overlap, range](int32_t offset) {
+                const float* candidate = &candidates[static_cast<uint32_t>(offset + range)];
+                float energy = dot(candidate, candidate, overlap);
+                return dot(reference.data(), candidate, overlap) / std::sqrt(energy + 1e-9F);
+            };
+
+            // coarse search followed by a search of the neighbours of the best match
+            for (int32_t offset = -range; offset <= range; offset += 4)
+            {
+                float currentScore = score(offset);
+                if (currentScore > bestScore)
+                {
+                    bestScore = currentScore;
+                    bestOffset = offset;
+                }
+            }
+
+            int32_t coarseOffset = bestOffset;
+            for (int32_t offset = std::max(coarseOffset - 3, -range); offset <= std::min(coarseOffset + 3, range); ++offset)
+            {
+                float currentScore = score(offset);
+                if (currentScore > bestScore)
+                {
+                    bestScore = currentScore;
+                    bestOffset = offset;
+                }
+            }
+
+            return bestOffset;
+        }
+
+        // Catmull-Rom interpolation of the sample delay samples before the newest one
+        float PitchShifter::read(float delay) const
+        {
+            uint32_t whole = static_cast<uint32_t>(delay);
+            float t = 1.0F - (delay - static_cast<float>(whole));
+            uint32_t index = writeIndex - whole - 1;
+
+            float p0 = ring[(index - 1) & ringMask];
+            float p1 = ring[index & ringMask];
+            float p2 = ring[(index + 1) & ringMask];
+            float p3 = ring[(index + 2) & ringMask];
+
+            return p1 + 0.5F * t * (p2 - p0 + t * (2.0F * p0 - 5.0F * p1 + 4.0F * p2 - p3 + t * (3.0F * (p1 - p2) + p3 - p0)));
+        }
+
+        void PitchShifter::processPhaseVocoder(float pitch, float* samples, uint32_t count, uint32_t stride)
+        {
+            const uint32_t latency = frameSize - frameSize / OVERSAMPLING;
+
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                float& sample = samples[i * stride];
+
+                inputFifo[fifoPosition] = sample;
+                sample = outputFifo[fifoPosition - latency];
+
+                if (++fifoPosition == frameSize)
+                {
+                    processFrame(pitch);
+                    fifoPosition = latency;
+                }
+            }
+        }
+
+        void PitchShifter::processFrame(float pitch)
+        {
+            const uint32_t hop = frameSize / OVERSAMPLING;
+            const uint32_t binCount = frameSize / 2 + 1;
+
+            for (uint32_t i = 0; i < frameSize; ++i)
+                frame[i] = inputFifo[i] * window[i];
+
+            fft.forward(frame.data(), real.data(), imag.data());
+
+            analyze(real.data(), imag.data(), bins.data(), magnitudes.data(), frequencies.data(), lastPhases.data(), binStride);
+
+            // every peak of the spectrum is moved with the bins around it, the phases of the moved bins keep
+            // their differences to the phase of the peak, which advances by the shifted frequency
+            uint32_t peakCount = 0;
+            for (uint32_t bin = 2; bin + 2 < binCount; ++bin)
+                if (magnitudes[bin] > magnitudes[bin - 1] && magnitudes[bin] >= magnitudes[bin + 1] &&
+                    magnitudes[bin] > magnitudes[bin - 2] && magnitudes[bin] >= magnitudes[bin + 2])
+                    peaks[peakCount++] = bin;
+
+            const float step = TAU / OVERSAMPLING;
+            std::fill(synthesisMagnitudes.begin(), synthesisMagnitudes.end(), 0.0F);
+            std::copy(synthesisPhases.begin(), synthesisPhases.end(), lockedPhases.begin());
+
+            for (uint32_t peak = 0; peak < peakCount; ++peak)
+            {
+                const uint32_t source = peaks[peak];
+                const uint32_t target = static_cast<uint32_t>(source * pitch + 0.5F);
+                if (target >= binCount) break;
+
+                // bins that would move below zero are dropped
+                const uint32_t first = std::max(peak > 0 ? (peaks[peak - 1] + source) / 2 + 1 : 0,
+                                                source > target ? source - target : 0);
+                const uint32_t last = peak + 1 < peakCount ? (source + peaks[peak + 1]) / 2 : binCount - 1;
+
+                const float rotation = synthesisPhases[target] + frequencies[source] * pitch * step - lastPhases[source];
+
+                for (uint32_t bin = first; bin <= last; ++bin)
+                {
+                    uint32_t shifted = bin + target - source;
+                    if (shifted >= binCount) break;
+
+                    synthesisMagnitudes[shifted] += magnitudes[bin];
+                    lockedPhases[shifted] = lastPhases[bin] + rotation;
+                }
+            }
+
+            synthesisPhases.swap(lockedPhases);
+
+            toRectangular(synthesisMagnitudes.data(), synthesisPhases.data(), real.data(), imag.data(), binStride);
+
+            fft.inverse(real.data(), imag.data(), frame.data());
+
+            // the inverse FFT is scaled by frameSize / 2 and the squared Hann windows of the overlapping
+            // frames add up to 3 / 8 of the oversampling
+            const float scale = 1.0F / (frameSize / 2 * 0.375F * OVERSAMPLING);
+
+            for (uint32_t i = 0; i < frameSize; ++i)
+                outputAccumulator[i] += window[i] * frame[i] * scale;
+
+            std::copy(outputAccumulator.begin(), outputAccumulator.begin() + hop, outputFifo.begin());
+            std::copy(outputAccumulator.begin() + hop, outputAccumulator.end(), outputAccumulator.begin());
+            std::fill(outputAccumulator.end() - hop, outputAccumulator.end(), 0.0F);
+
+            std::copy(inputFifo.begin() + hop, inputFifo.end(), inputFifo.begin());
+        }
+    } // namespace audio
+} // namespace ouzel
@@ -0,0 +1,87 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_AUDIO_PITCHSHIFTER_HPP
+#define OUZEL_AUDIO_PITCHSHIFTER_HPP
+
+#include <cstdint>
+#include <vector>
+#include "audio/FFT.hpp"
+
+namespace ouzel
+{
+    namespace audio
+    {
+        // Changes the pitch of one channel without changing its duration. All memory is allocated in the constructor.
+        class PitchShifter final
+        {
+        public:
+            enum class Mode
+            {
+                // resamples the input and splices it with overlap-add at the most similar waveform position,
+                // cheap and with low latency, best for engines and voices
+                WSOLA,
+                // shifts the bins of a short-time FFT with 4x overlap, fewer artifacts on music and chords
+                PHASE_VOCODER
+            };
+
+            static constexpr uint32_t MAX_FRAME_SIZE = 65536;
+
+            PitchShifter() = default;
+            // frameSize is rounded up to a power of two, larger frames add latency and improve low frequencies,
+            // throws std::invalid_argument if it is above MAX_FRAME_SIZE
+            PitchShifter(Mode initMode, uint32_t initFrameSize);
+
+            inline Mode getMode() const { return mode; }
+            inline uint32_t getFrameSize() const { return frameSize; }
+            // in samples
+            uint32_t getLatency() const;
+
+            // processes count samples in place, stride is the distance between the samples
+            void process(float pitch, float* samples, uint32_t count, uint32_t stride);
+
+        private:
+            void processWsola(float pitch, float* samples, uint32_t count, uint32_t stride);
+            int32_t findSplice(float delay, float targetDelay);
+            float read(float delay) const;
+
+            void processPhaseVocoder(float pitch, float* samples, uint32_t count, uint32_t stride);
+            void processFrame(float pitch);
+
+            Mode mode = Mode::WSOLA;
+            uint32_t frameSize = 0;
+
+            // WSOLA
+            std::vector<float> ring;
+            uint32_t ringMask = 0;
+            uint32_t writeIndex = 0;
+            float readDelay = 0.0F;
+            float fadeDelay = 0.0F;
+            uint32_t fadePosition = 0;
+            bool fading = false;
+            std::vector<float> reference;
+            std::vector<float> candidates;
+
+            // phase vocoder
+            FFT fft;
+            uint32_t binStride = 0;
+            uint32_t fifoPosition = 0;
+            std::vector<float> window;
+            std::vector<float> bins;
+            std::vector<float> inputFifo;
+            std::vector<float> outputFifo;
+            std::vector<float> outputAccumulator;
+            std::vector<float> frame;
+            std::vector<float> real;
+            std::vector<float> imag;
+            std::vector<float> magnitudes;
+            std::vector<float> frequencies;
+            std::vector<float> lastPhases;
+            std::vector<uint32_t> peaks;
+            std::vector<float> synthesisMagnitudes;
+            std::vector<float> synthesisPhases;
+            std::vector<float> lockedPhases;
+        };
+    } // namespace audio
+} // namespace ouzel
+
+#endif // OUZEL_AUDIO_PITCHSHIFTER_HPP
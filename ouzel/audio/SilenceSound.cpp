@@ -22,6 +22,7 @@ namespace ouzel
             }
 
             void getData(uint32_t frames, std::vector<float>& samples) override;
+            void skip(uint32_t frames) override;
 
         private:
             uint32_t position = 0;
@@ -88,7 +89,31 @@ namespace ouzel
 
                 if ((frameCount - position) == 0)
                 {
-                    if (!isRepeating()) playing = false; // TODO: fire event
+                    if (!isRepeating()) finish();
+                    reset();
+                }
+            }
+            else
+            {
+                position += frames;
+            }
+        }
+
+        void SilenceSource::skip(uint32_t frames)
+        {
+            const float length = static_cast<SilenceData&>(source).getLength();
+
+            if (length > 0.0F)
+            {
+                const uint32_t frameCount = static_cast<uint32_t>(length * source.getSampleRate());
+
+                if (isRepeating())
+                    position = frameCount ? static_cast<uint32_t>((static_cast<uint64_t>(position) + frames) % frameCount) : 0;
+                else if (frameCount - position > frames)
+                    position += frames;
+                else
+                {
+                    finish();
                     reset();
                 }
             }
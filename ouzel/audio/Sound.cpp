@@ -2,6 +2,7 @@
 
 #include "Sound.hpp"
 #include "Audio.hpp"
+#include "mixer/Stream.hpp"
 
 namespace ouzel
 {
@@ -15,7 +16,12 @@ namespace ouzel
 
         Sound::~Sound()
         {
-            if (sourceId) audio.deleteObject(sourceId);
+            if (sourceId) audio.deleteSource(sourceId);
+        }
+
+        std::function<std::unique_ptr<mixer::Stream>(mixer::Source&)> Sound::getStreamInitFunction() const
+        {
+            return nullptr;
         }
     } // namespace audio
 } // namespace ouzel
@@ -4,6 +4,7 @@
 #define OUZEL_AUDIO_SOUND_HPP
 
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
@@ -14,6 +15,12 @@ namespace ouzel
     {
         class Audio;
 
+        namespace mixer
+        {
+            class Source;
+            class Stream;
+        }
+
         class Sound
         {
             friend Audio;
@@ -29,6 +36,10 @@ namespace ouzel
 
             uintptr_t getSourceId() const { return sourceId; }
 
+            // called on the game thread for every new stream of the sound, the returned function creates the
+            // stream on the audio thread, an empty function makes the mixer call Source::createStream instead
+            virtual std::function<std::unique_ptr<mixer::Stream>(mixer::Source&)> getStreamInitFunction() const;
+
         protected:
             Audio& audio;
             uintptr_t sourceId = 0;
@@ -22,6 +22,7 @@ namespace ouzel
             Submix& operator=(Submix&&) = delete;
 
             void setOutput(Mix* newOutput);
+            Mix* getOutput() const override { return output; }
 
         private:
             Mix* output = nullptr;
@@ -3,6 +3,8 @@
 #include "Voice.hpp"
 #include "Audio.hpp"
 #include "AudioDevice.hpp"
+#include "Filter.hpp"
+#include "Listener.hpp"
 #include "Sound.hpp"
 #include "core/Engine.hpp"
 
@@ -12,18 +14,34 @@ namespace ouzel
     {
         Voice::Voice(Audio& initAudio, const std::shared_ptr<Sound>& initSound):
             audio(initAudio),
-            streamId(audio.initStream(initSound->getSourceId()))
+            streamId(audio.initStream(*initSound))
         {
             sound = initSound;
+            audio.addVoice(this);
         }
 
         Voice::~Voice()
         {
+            if (output) output->removeInput(this);
+
+            audio.removeVoice(this);
+            if (streamId) audio.releaseStream(sound->getSourceId(), streamId);
         }
 
         void Voice::play(bool repeat)
         {
-            audio.getMixer().addCommand(std::unique_ptr<mixer::Command>(new mixer::PlayStreamCommand(streamId, repeat)));
+            if (!streamId)
+            {
+                // the stream was released when the previous play finished
+                streamId = audio.initStream(*sound);
+
+                if (output)
+                    audio.getMixer().addCommand(std::unique_ptr<mixer::Command>(new mixer::SetStreamOutputCommand(streamId,
+                                                                                                                  output->getBusId())));
+            }
+
+            playId = ++audio.lastPlayId;
+            audio.getMixer().addCommand(std::unique_ptr<mixer::Command>(new mixer::PlayStreamCommand(streamId, repeat, playId)));
 
             playing = true;
             repeating = repeat;
@@ -36,46 +54,76 @@ namespace ouzel
 
         void Voice::pause()
         {
-            audio.getMixer().addCommand(std::unique_ptr<mixer::Command>(new mixer::StopStreamCommand(streamId, false)));
+            if (streamId)
+                audio.getMixer().addCommand(std::unique_ptr<mixer::Command>(new mixer::StopStreamCommand(streamId, false)));
 
             playing = false;
         }
 
         void Voice::stop()
         {
-            audio.getMixer().addCommand(std::unique_ptr<mixer::Command>(new mixer::StopStreamCommand(streamId, true)));
+            if (streamId)
+                audio.getMixer().addCommand(std::unique_ptr<mixer::Command>(new mixer::StopStreamCommand(streamId, true)));
 
             playing = false;
         }
 
-        // executed on audio thread
-        /*void Voice::onReset()
+        void Voice::finish()
         {
+            playing = false;
+            virtualized = false;
+
+            // the stream goes back to the pool until the voice is played again
+            audio.releaseStream(sound->getSourceId(), streamId);
+            streamId = 0;
+
             std::unique_ptr<SoundEvent> event(new SoundEvent());
-            event->type = Event::Type::SOUND_RESET;
+            event->type = Event::Type::SOUND_FINISH;
             event->voice = this;
             engine->getEventDispatcher().postEvent(std::move(event));
         }
 
         // executed on audio thread
-        void Voice::onStop()
+        /*void Voice::onReset()
         {
-            playing = false;
-
             std::unique_ptr<SoundEvent> event(new SoundEvent());
-            event->type = Event::Type::SOUND_FINISH;
+            event->type = Event::Type::SOUND_RESET;
             event->voice = this;
             engine->getEventDispatcher().postEvent(std::move(event));
         }*/
 
+        float Voice::getEstimatedLoudness() const
+        {
+            if (!output) return 0.0F;
+
+            // the first listener on the way to the master mix is used for the distance attenuation
+            Vector3<float> listenerPosition;
+            for (Mix* mix = output; mix; mix = mix->getOutput())
+            {
+                if (!mix->getListeners().empty())
+                {
+                    listenerPosition = mix->getListeners().front()->getPosition();
+                    break;
+                }
+            }
+
+            float loudness = 1.0F;
+            for (Mix* mix = output; mix; mix = mix->getOutput())
+                for (Filter* filter : mix->getFilters())
+                    loudness *= filter->getAttenuation(listenerPosition);
+
+            return loudness;
+        }
+
         void Voice::setOutput(Mix* newOutput)
         {
             if (output) output->removeInput(this);
             output = newOutput;
             if (output) output->addInput(this);
 
-            audio.getMixer().addCommand(std::unique_ptr<mixer::Command>(new mixer::SetStreamOutputCommand(streamId,
-                                                                                                          output ? output->getBusId() : 0)));
+            if (streamId)
+                audio.getMixer().addCommand(std::unique_ptr<mixer::Command>(new mixer::SetStreamOutputCommand(streamId,
+                                                                                                              output ? output->getBusId() : 0)));
         }
     } // namespace audio
 } // namespace ouzel
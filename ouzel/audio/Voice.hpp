@@ -3,6 +3,7 @@
 #ifndef OUZEL_AUDIO_VOICE_HPP
 #define OUZEL_AUDIO_VOICE_HPP
 
+#include <cstdint>
 #include <memory>
 #include "math/Vector3.hpp"
 
@@ -16,6 +17,7 @@ namespace ouzel
 
         class Voice final
         {
+            friend Audio;
             friend Mix;
         public:
             Voice(Audio& initAudio, const std::shared_ptr<Sound>& initSound);
@@ -36,15 +38,32 @@ namespace ouzel
             bool isRepeating() const { return repeating; }
 
             void setOutput(Mix* newOutput);
+            inline Mix* getOutput() const { return output; }
+
+            // voices with higher priority are kept real when there are more audible voices than the limit
+            inline int32_t getPriority() const { return priority; }
+            inline void setPriority(int32_t newPriority) { priority = newPriority; }
+
+            // a virtual voice keeps its play position but is not mixed, see Audio::setMaxRealVoices
+            inline bool isVirtual() const { return virtualized; }
+
+            // product of the attenuation of all the filters between the voice and the master mix
+            float getEstimatedLoudness() const;
 
         private:
+            // called by Audio when the stream reached its end
+            void finish();
+
             Audio& audio;
-            uintptr_t streamId;
+            uintptr_t streamId; // zero after the voice finished playing
+            uint32_t playId = 0;
 
             std::shared_ptr<Sound> sound;
 
             bool playing = false;
             bool repeating = false;
+            bool virtualized = false;
+            int32_t priority = 0;
 
             Mix* output = nullptr;
         };
@@ -1,10 +1,19 @@
 // Copyright 2015-2018 Elviss Strazdins. All rights reserved.
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
+#include <thread>
 #include "VorbisSound.hpp"
 #include "Audio.hpp"
 #include "mixer/Stream.hpp"
 #include "mixer/Source.hpp"
+#include "core/Engine.hpp"
+#include "utils/Log.hpp"
 #include "utils/Utils.hpp"
 
 #include "stb_vorbis.c"
@@ -13,101 +22,409 @@ namespace ouzel
 {
     namespace audio
     {
-        class VorbisData;
-
-        class VorbisSource: public mixer::Stream
+        // decoded samples of a single stream, filled by the decoder thread and read by the audio thread,
+        // the positions only grow and are wrapped when the buffer is accessed
+        class VorbisBuffer final
         {
         public:
-            VorbisSource(VorbisData& vorbisData);
+            static constexpr size_t MAX_END_MARKERS = 16;
 
-            ~VorbisSource()
+            VorbisBuffer(const std::shared_ptr<const std::vector<uint8_t>>& initData,
+                         uint16_t initChannels, uint32_t sampleRate, float lookahead):
+                data(initData),
+                channels(initChannels),
+                refillPeriod(std::max(static_cast<long>(lookahead * 250.0F), 1L))
+            {
+                uint32_t frames = std::max(static_cast<uint32_t>(lookahead * sampleRate), 1U);
+                samples.resize(frames * channels);
+
+                vorbisStream = stb_vorbis_open_memory(data->data(), static_cast<int>(data->size()), nullptr, nullptr);
+                if (!vorbisStream)
+                    throw std::runtime_error("Failed to load Vorbis stream");
+            }
+
+            ~VorbisBuffer()
             {
                 if (vorbisStream)
                     stb_vorbis_close(vorbisStream);
             }
 
-            void reset() override
+            VorbisBuffer(const VorbisBuffer&) = delete;
+            VorbisBuffer& operator=(const VorbisBuffer&) = delete;
+
+            // called from the decoder thread only, decodes until the buffer is full
+            void decode()
             {
-                stb_vorbis_seek_start(vorbisStream);
+                uint32_t request = seekRequest.load(std::memory_order_acquire);
+                bool seeking = request != seekDone.load(std::memory_order_relaxed);
+                if (seeking)
+                {
+                    // the reader does not touch its positions until the seek is done,
+                    // so everything decoded before the seek can be dropped here
+                    stb_vorbis_seek_start(vorbisStream);
+                    lastEndPosition = SIZE_MAX;
+                    readPosition.store(writePosition.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                    endRead.store(endCount.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                }
+
+                size_t write = writePosition.load(std::memory_order_relaxed);
+                size_t free = samples.size() - (write - readPosition.load(std::memory_order_acquire));
+
+                while (free >= channels)
+                {
+                    size_t offset = write % samples.size();
+                    size_t count = std::min(free, samples.size() - offset);
+
+                    size_t decoded = static_cast<size_t>(stb_vorbis_get_samples_float_interleaved(vorbisStream, channels,
+                                                                                                  samples.data() + offset,
+                                                                                                  static_cast<int>(count))) * channels;
+                    if (decoded)
+                    {
+                        write += decoded;
+                        free -= decoded;
+                        writePosition.store(write, std::memory_order_release);
+
+                        // let the reader start with the first decoded chunk
+                        if (seeking)
+                        {
+                            seekDone.store(request, std::memory_order_release);
+                            seeking = false;
+                        }
+                    }
+
+                    if (decoded < count)
+                    {
+                        // an empty stream would produce end markers forever
+                        if (write == lastEndPosition) break;
+
+                        // the stream continues from the start after the marker, so the reader can either
+                        // loop or stop with the buffer already holding the beginning of the stream
+                        size_t end = endCount.load(std::memory_order_relaxed);
+                        if (end - endRead.load(std::memory_order_acquire) == MAX_END_MARKERS) break;
+
+                        endPositions[end % MAX_END_MARKERS] = write;
+                        endCount.store(end + 1, std::memory_order_release);
+                        lastEndPosition = write;
+
+                        stb_vorbis_seek_start(vorbisStream);
+                    }
+                }
+
+                if (seeking) seekDone.store(request, std::memory_order_release);
             }
 
-            void getData(uint32_t frames, std::vector<float>& samples) override;
+            std::shared_ptr<const std::vector<uint8_t>> data;
+            uint16_t channels;
+            std::chrono::milliseconds refillPeriod;
+            std::atomic<bool> closed{false};
+
+            std::vector<float> samples;
+            std::atomic<size_t> writePosition{0};
+            std::atomic<size_t> readPosition{0};
+
+            size_t endPositions[MAX_END_MARKERS];
+            std::atomic<size_t> endCount{0};
+            std::atomic<size_t> endRead{0};
+
+            std::atomic<uint32_t> seekRequest{0};
+            std::atomic<uint32_t> seekDone{0};
 
         private:
             stb_vorbis* vorbisStream = nullptr;
+            size_t lastEndPosition = SIZE_MAX;
         };
 
-        class VorbisData: public mixer::Source
+        // low priority thread shared by all the Vorbis streams, runs while any Vorbis sound exists
+        class VorbisDecoder final
         {
         public:
-            VorbisData(const std::vector<uint8_t>& initData):
-                data(initData)
+            // kept by the streams to wake the decoder up, it can outlive the decoder
+            class Signal final
             {
-                stb_vorbis* vorbisStream = stb_vorbis_open_memory(data.data(), static_cast<int>(data.size()), nullptr, nullptr);
+            public:
+                // does not lock the mutex, so that the audio thread never waits for the decoder thread,
+                // a signal that arrives right before the decoder starts waiting is handled after the refill period
+                void notify()
+                {
+                    pending.store(true, std::memory_order_release);
+                    condition.notify_all();
+                }
 
-                if (!vorbisStream)
-                    throw std::runtime_error("Failed to load Vorbis stream");
+                std::mutex mutex;
+                std::condition_variable condition;
+                std::atomic<bool> pending{false};
+            };
 
-                stb_vorbis_info info = stb_vorbis_get_info(vorbisStream);
+            static std::shared_ptr<VorbisDecoder> getInstance()
+            {
+                static std::mutex instanceMutex;
+                static std::weak_ptr<VorbisDecoder> instance;
 
-                channels = static_cast<uint16_t>(info.channels);
-                sampleRate = info.sample_rate;
+                std::lock_guard<std::mutex> lock(instanceMutex);
+                std::shared_ptr<VorbisDecoder> result = instance.lock();
+                if (!result)
+                {
+                    result = std::make_shared<VorbisDecoder>();
+                    instance = result;
+                }
 
-                stb_vorbis_close(vorbisStream);
+                return result;
             }
 
-            const std::vector<uint8_t>& getData() const { return data; }
+            VorbisDecoder():
+                signal(std::make_shared<Signal>()),
+                thread(&VorbisDecoder::main, this)
+            {
+            }
 
-            std::unique_ptr<mixer::Stream> createStream() override
+            ~VorbisDecoder()
+            {
+                std::unique_lock<std::mutex> lock(signal->mutex);
+                running = false;
+                lock.unlock();
+                signal->condition.notify_all();
+
+                if (thread.joinable()) thread.join();
+            }
+
+            VorbisDecoder(const VorbisDecoder&) = delete;
+            VorbisDecoder& operator=(const VorbisDecoder&) = delete;
+
+            const std::shared_ptr<Signal>& getSignal() const { return signal; }
+
+            void addBuffer(const std::shared_ptr<VorbisBuffer>& buffer)
             {
-                return std::unique_ptr<mixer::Stream>(new VorbisSource(*this));
+                std::unique_lock<std::mutex> lock(signal->mutex);
+                buffers.push_back(buffer);
+                lock.unlock();
+                signal->notify();
             }
 
         private:
-            std::vector<uint8_t> data;
+            void main()
+            {
+                setCurrentThreadName("Vorbis");
+
+                try
+                {
+                    setCurrentThreadLowPriority();
+                }
+                catch (const std::exception& e)
+                {
+                    engine->log(Log::Level::WARN) << e.what();
+                }
+
+                std::vector<std::shared_ptr<VorbisBuffer>> currentBuffers;
+
+                std::unique_lock<std::mutex> lock(signal->mutex);
+                while (running)
+                {
+                    signal->pending.store(false, std::memory_order_relaxed);
+
+                    buffers.erase(std::remove_if(buffers.begin(), buffers.end(),
+                                                 [](const std::shared_ptr<VorbisBuffer>& buffer) {
+                                                     return buffer->closed.load(std::memory_order_acquire);
+                                                 }), buffers.end());
+
+                    std::chrono::milliseconds period(100);
+                    for (const std::shared_ptr<VorbisBuffer>& buffer : buffers)
+                        period = std::min(period, buffer->refillPeriod);
+
+                    currentBuffers = buffers;
+                    lock.unlock();
+
+                    for (const std::shared_ptr<VorbisBuffer>& buffer : currentBuffers)
+                        buffer->decode();
+
+                    currentBuffers.clear();
+
+                    lock.lock();
+                    if (running && !signal->pending.load(std::memory_order_acquire))
+                        signal->condition.wait_for(lock, period);
+                }
+            }
+
+            std::shared_ptr<Signal> signal;
+            std::vector<std::shared_ptr<VorbisBuffer>> buffers;
+            bool running = true;
+            std::thread thread;
         };
 
-        VorbisSource::VorbisSource(VorbisData& vorbisData):
-            Stream(vorbisData)
+        class VorbisSource: public mixer::Stream
         {
-            const std::vector<uint8_t>& data = vorbisData.getData();
-            vorbisStream = stb_vorbis_open_memory(data.data(), static_cast<int>(data.size()), nullptr, nullptr);
-        }
+        public:
+            VorbisSource(mixer::Source& initSource,
+                         const std::shared_ptr<VorbisBuffer>& initBuffer,
+                         const std::shared_ptr<VorbisDecoder::Signal>& initSignal):
+                Stream(initSource),
+                buffer(initBuffer),
+                signal(initSignal)
+            {
+            }
 
-        void VorbisSource::getData(uint32_t frames, std::vector<float>& samples)
+            ~VorbisSource()
+            {
+                buffer->closed.store(true, std::memory_order_release);
+            }
+
+            void reset() override
+            {
+                buffer->seekRequest.store(++seekRequest, std::memory_order_release);
+                seekPending = true;
+                signal->notify();
+            }
+
+            void getData(uint32_t frames, std::vector<float>& samples) override;
+            void skip(uint32_t frames) override;
+
+        private:
+            // copies up to size decoded samples to the result (or drops them if result is null)
+            size_t read(size_t size, float* result);
+
+            std::shared_ptr<VorbisBuffer> buffer;
+            std::shared_ptr<VorbisDecoder::Signal> signal;
+            uint32_t seekRequest = 0;
+            bool seekPending = false;
+            bool starving = false;
+        };
+
+        class VorbisData: public mixer::Source
         {
-            uint32_t neededSize = frames * source.getChannels();
-            samples.resize(neededSize);
+        public:
+            VorbisData(uint16_t initChannels, uint32_t initSampleRate)
+            {
+                channels = initChannels;
+                sampleRate = initSampleRate;
+            }
+
+            std::unique_ptr<mixer::Stream> createStream() override
+            {
+                // the decoding state is allocated on the game thread, see VorbisSound::getStreamInitFunction
+                throw std::runtime_error("Vorbis streams must be created with an init function");
+            }
+        };
+
+        size_t VorbisSource::read(size_t size, float* result)
+        {
+            if (seekPending)
+            {
+                // the decoder drops everything decoded before the seek
+                if (buffer->seekDone.load(std::memory_order_acquire) != seekRequest)
+                    return 0;
+
+                seekPending = false;
+            }
 
-            uint32_t totalSize = 0;
+            const std::vector<float>& bufferSamples = buffer->samples;
+            size_t read = buffer->readPosition.load(std::memory_order_relaxed);
+            size_t write = buffer->writePosition.load(std::memory_order_acquire);
+            size_t totalSize = 0;
 
-            while (neededSize > 0)
+            while (totalSize < size)
             {
-                if (vorbisStream->eof)
-                    reset();
+                size_t endRead = buffer->endRead.load(std::memory_order_relaxed);
+                bool hasEnd = endRead != buffer->endCount.load(std::memory_order_acquire);
+                size_t end = hasEnd ? buffer->endPositions[endRead % VorbisBuffer::MAX_END_MARKERS] : write;
+
+                if (read == end && hasEnd)
+                {
+                    buffer->endRead.store(endRead + 1, std::memory_order_release);
+
+                    if (!isRepeating())
+                    {
+                        // the buffer continues with the start of the stream
+                        finish();
+                        break;
+                    }
+
+                    continue;
+                }
+
+                size_t count = std::min(size - totalSize, std::min(end, write) - read);
+                if (!count) break;
 
-                int resultFrames = stb_vorbis_get_samples_float_interleaved(vorbisStream, source.getChannels(),
-                                                                            samples.data() + totalSize, static_cast<int>(neededSize));
-                totalSize += static_cast<uint32_t>(resultFrames) * source.getChannels();
-                neededSize -= static_cast<uint32_t>(resultFrames) * source.getChannels();
+                if (result)
+                {
+                    size_t offset = read % bufferSamples.size();
+                    size_t firstPart = std::min(count, bufferSamples.size() - offset);
+                    std::copy(bufferSamples.begin() + static_cast<std::ptrdiff_t>(offset),
+                              bufferSamples.begin() + static_cast<std::ptrdiff_t>(offset + firstPart),
+                              result + totalSize);
+                    std::copy(bufferSamples.begin(),
+                              bufferSamples.begin() + static_cast<std::ptrdiff_t>(count - firstPart),
+                              result + totalSize + firstPart);
+                }
 
-                if (!isRepeating()) break;
+                read += count;
+                totalSize += count;
             }
 
-            if (vorbisStream->eof)
+            buffer->readPosition.store(read, std::memory_order_release);
+
+            return totalSize;
+        }
+
+        void VorbisSource::getData(uint32_t frames, std::vector<float>& samples)
+        {
+            const size_t neededSize = frames * source.getChannels();
+            samples.resize(neededSize);
+
+            size_t totalSize = read(neededSize, samples.data());
+
+            // the silence while the decoder seeks to the start is expected
+            if (totalSize < neededSize && playing && !seekPending)
             {
-                if (!isRepeating()) playing = false; // TODO: fire event
-                reset();
+                // report only once until the decoder catches up
+                if (!starving) reportStarvation();
+                starving = true;
             }
+            else
+                starving = false;
+
+            std::fill(samples.begin() + static_cast<std::ptrdiff_t>(totalSize), samples.end(), 0.0F);
+        }
 
-            std::fill(samples.begin() + totalSize, samples.end(), 0.0F);
+        void VorbisSource::skip(uint32_t frames)
+        {
+            // the decoder keeps running, only the mixing is skipped
+            read(frames * source.getChannels(), nullptr);
         }
 
-        VorbisSound::VorbisSound(Audio& initAudio, const std::vector<uint8_t>& initData):
-            Sound(initAudio, initAudio.initSource([initData](){
-                return std::unique_ptr<mixer::Source>(new VorbisData(initData));
-            }))
+        VorbisSound::VorbisSound(Audio& initAudio, const std::vector<uint8_t>& initData, float initLookahead):
+            Sound(initAudio, 0),
+            data(std::make_shared<const std::vector<uint8_t>>(initData)),
+            lookahead(initLookahead),
+            decoder(VorbisDecoder::getInstance())
         {
+            stb_vorbis* vorbisStream = stb_vorbis_open_memory(data->data(), static_cast<int>(data->size()), nullptr, nullptr);
+
+            if (!vorbisStream)
+                throw std::runtime_error("Failed to load Vorbis stream");
+
+            stb_vorbis_info info = stb_vorbis_get_info(vorbisStream);
+
+            channels = static_cast<uint16_t>(info.channels);
+            sampleRate = info.sample_rate;
+
+            stb_vorbis_close(vorbisStream);
+
+            uint16_t sourceChannels = channels;
+            uint32_t sourceSampleRate = sampleRate;
+            sourceId = audio.initSource([sourceChannels, sourceSampleRate]() {
+                return std::unique_ptr<mixer::Source>(new VorbisData(sourceChannels, sourceSampleRate));
+            });
+        }
+
+        std::function<std::unique_ptr<mixer::Stream>(mixer::Source&)> VorbisSound::getStreamInitFunction() const
+        {
+            // opening the stream allocates, so it is done here instead of on the audio thread
+            std::shared_ptr<VorbisBuffer> buffer = std::make_shared<VorbisBuffer>(data, channels, sampleRate, lookahead);
+            decoder->addBuffer(buffer);
+
+            std::shared_ptr<VorbisDecoder::Signal> signal = decoder->getSignal();
+            return [buffer, signal](mixer::Source& source) {
+                return std::unique_ptr<mixer::Stream>(new VorbisSource(source, buffer, signal));
+            };
         }
     } // namespace audio
 } // namespace ouzel
@@ -4,6 +4,7 @@
 #define OUZEL_AUDIO_VORBISSOUND_HPP
 
 #include <cstdint>
+#include <memory>
 #include <vector>
 #include "audio/Sound.hpp"
 
@@ -11,13 +12,22 @@ namespace ouzel
 {
     namespace audio
     {
+        class VorbisDecoder;
+
         class VorbisSound final: public Sound
         {
         public:
-            VorbisSound(Audio& initAudio, const std::vector<uint8_t>& initData);
+            // lookahead is the length of audio in seconds that is decoded in advance for each stream
+            VorbisSound(Audio& initAudio, const std::vector<uint8_t>& initData, float initLookahead = 0.25F);
+
+            std::function<std::unique_ptr<mixer::Stream>(mixer::Source&)> getStreamInitFunction() const override;
 
         private:
-            std::vector<uint8_t> data;
+            std::shared_ptr<const std::vector<uint8_t>> data;
+            uint16_t channels = 0;
+            uint32_t sampleRate = 0;
+            float lookahead;
+            std::shared_ptr<VorbisDecoder> decoder;
         };
     } // namespace audio
 } // namespace ouzel
@@ -239,9 +239,6 @@ namespace ouzel
                 {
                     bus->getData(frames, channels, sampleRate, listenerPosition, listenerRotation, buffer);
 
-                    for (Processor* processor : processors)
-                        processor->process(frames, channels, sampleRate, buffer);
-
                     for (size_t s = 0; s < samples.size(); ++s)
                         samples[s] += buffer[s];
                 }
@@ -253,6 +250,14 @@ namespace ouzel
                         const uint32_t sourceSampleRate = stream->getSource().getSampleRate();
                         const uint16_t sourceChannels = stream->getSource().getChannels();
 
+                        if (stream->isVirtual())
+                        {
+                            // advance by the same number of frames as a mixed stream would
+                            stream->skip(sourceSampleRate != sampleRate ?
+                                         (frames * sourceSampleRate + sampleRate - 1) / sampleRate : frames);
+                            continue;
+                        }
+
                         if (sourceSampleRate != sampleRate)
                         {
                             uint32_t sourceFrames = (frames * sourceSampleRate + sampleRate - 1) / sampleRate; // round up
@@ -3,6 +3,7 @@
 #ifndef OUZEL_AUDIO_MIXER_COMMANDS_HPP
 #define OUZEL_AUDIO_MIXER_COMMANDS_HPP
 
+#include <atomic>
 #include <cstdint>
 #include <functional>
 #include <memory>
@@ -32,14 +33,17 @@ namespace ouzel
                     PLAY_STREAM,
                     STOP_STREAM,
                     SET_STREAM_OUTPUT,
+                    SET_STREAM_VIRTUAL,
                     INIT_SOURCE,
                     INIT_PROCESSOR,
                     UPDATE_PROCESSOR
                 };
 
                 explicit Command(Type initType): type(initType) {}
+                virtual ~Command() {}
 
                 Type type;
+                Command* next = nullptr; // used by the mixer to return processed commands to the game thread
             };
 
             class DeleteObjectCommand: public Command
@@ -121,28 +125,37 @@ namespace ouzel
             {
             public:
                 InitStreamCommand(uintptr_t initStreamId,
-                                  uintptr_t initSourceId):
+                                  uintptr_t initSourceId,
+                                  const std::function<std::unique_ptr<Stream>(Source&)>& initInitFunction,
+                                  std::unique_ptr<std::atomic<uint32_t>>&& initFinishedPlayId):
                     Command(Command::Type::INIT_STREAM),
                     streamId(initStreamId),
-                    sourceId(initSourceId)
+                    sourceId(initSourceId),
+                    initFunction(initInitFunction),
+                    finishedPlayId(std::move(initFinishedPlayId))
                 {}
 
                 uintptr_t streamId;
                 uintptr_t sourceId;
+                std::function<std::unique_ptr<Stream>(Source&)> initFunction;
+                std::unique_ptr<std::atomic<uint32_t>> finishedPlayId;
             };
 
             class PlayStreamCommand: public Command
             {
             public:
                 PlayStreamCommand(uintptr_t initStreamId,
-                                  bool initRepeat):
+                                  bool initRepeat,
+                                  uint32_t initPlayId):
                     Command(Command::Type::PLAY_STREAM),
                     streamId(initStreamId),
-                    repeat(initRepeat)
+                    repeat(initRepeat),
+                    playId(initPlayId)
                 {}
 
                 uintptr_t streamId;
                 bool repeat;
+                uint32_t playId;
             };
 
             class StopStreamCommand: public Command
@@ -173,6 +186,20 @@ namespace ouzel
                 uintptr_t busId;
             };
 
+            class SetStreamVirtualCommand: public Command
+            {
+            public:
+                SetStreamVirtualCommand(uintptr_t initStreamId,
+                                        bool initVirtualized):
+                    Command(Command::Type::SET_STREAM_VIRTUAL),
+                    streamId(initStreamId),
+                    virtualized(initVirtualized)
+                {}
+
+                uintptr_t streamId;
+                bool virtualized;
+            };
+
             class InitSourceCommand: public Command
             {
             public:
@@ -12,9 +12,9 @@ namespace ouzel
     {
         namespace mixer
         {
-            Mixer::Mixer(const std::function<void(const Event&)>& initCallback):
-                callback(initCallback)
+            Mixer::~Mixer()
             {
+                deleteProcessedCommands();
             }
 
             void Mixer::addCommand(std::unique_ptr<Command>&& command)
@@ -89,13 +89,18 @@ namespace ouzel
                         }
                         case Command::Type::INIT_STREAM:
                         {
-                            auto initStreamCommand = static_cast<const InitStreamCommand*>(command.get());
+                            auto initStreamCommand = static_cast<InitStreamCommand*>(command.get());
 
                             if (initStreamCommand->streamId > objects.size())
                                 objects.resize(initStreamCommand->streamId);
 
                             Source* source = static_cast<Source*>(objects[initStreamCommand->sourceId - 1].get());
-                            objects[initStreamCommand->streamId - 1] = source->createStream();
+                            std::unique_ptr<Stream> stream = initStreamCommand->initFunction ?
+                                initStreamCommand->initFunction(*source) : source->createStream();
+                            stream->mixer = this;
+                            stream->objectId = initStreamCommand->streamId;
+                            stream->finishedPlayId = std::move(initStreamCommand->finishedPlayId);
+                            objects[initStreamCommand->streamId - 1] = std::move(stream);
                             break;
                         }
                         case Command::Type::PLAY_STREAM:
@@ -103,7 +108,7 @@ namespace ouzel
                             auto playStreamCommand = static_cast<const PlayStreamCommand*>(command.get());
 
                             Stream* stream = static_cast<Stream*>(objects[playStreamCommand->streamId - 1].get());
-                            stream->play(playStreamCommand->repeat);
+                            stream->play(playStreamCommand->repeat, playStreamCommand->playId);
                             break;
                         }
                         case Command::Type::STOP_STREAM:
@@ -122,6 +127,14 @@ namespace ouzel
                             stream->setOutput(setStreamOutputCommand->busId ? static_cast<Bus*>(objects[setStreamOutputCommand->busId - 1].get()) : nullptr);
                             break;
                         }
+                        case Command::Type::SET_STREAM_VIRTUAL:
+                        {
+                            auto setStreamVirtualCommand = static_cast<const SetStreamVirtualCommand*>(command.get());
+
+                            Stream* stream = static_cast<Stream*>(objects[setStreamVirtualCommand->streamId - 1].get());
+                            stream->setVirtual(setStreamVirtualCommand->virtualized);
+                            break;
+                        }
                         case Command::Type::INIT_SOURCE:
                         {
                             auto initSourceCommand = static_cast<const InitSourceCommand*>(command.get());
@@ -148,6 +161,9 @@ namespace ouzel
 
                             Processor* processor = static_cast<Processor*>(objects[updateProcessorCommand->processorId - 1].get());
                             updateProcessorCommand->updateFunction(processor);
+
+                            // the function may hold the state that was swapped out of the processor
+                            releaseCommand(std::move(command));
                             break;
                         }
                         default:
@@ -171,6 +187,49 @@ namespace ouzel
                 for (float& f : samples)
                     f = clamp(f, -1.0F, 1.0F);
             }
+
+            void Mixer::releaseCommand(std::unique_ptr<Command>&& command)
+            {
+                // only the game thread takes the list and it takes it whole, so the push can not suffer from ABA
+                Command* releasedCommand = command.release();
+                releasedCommand->next = processedCommands.load(std::memory_order_relaxed);
+                while (!processedCommands.compare_exchange_weak(releasedCommand->next, releasedCommand,
+                                                                std::memory_order_release,
+                                                                std::memory_order_relaxed));
+            }
+
+            void Mixer::deleteProcessedCommands()
+            {
+                Command* command = processedCommands.exchange(nullptr, std::memory_order_acquire);
+
+                while (command)
+                {
+                    Command* next = command->next;
+                    delete command;
+                    command = next;
+                }
+            }
+
+            void Mixer::addEvent(const Event& event)
+            {
+                size_t writePosition = eventWritePosition.load(std::memory_order_relaxed);
+                if (writePosition - eventReadPosition.load(std::memory_order_acquire) == MAX_EVENTS)
+                    return;
+
+                events[writePosition % MAX_EVENTS] = event;
+                eventWritePosition.store(writePosition + 1, std::memory_order_release);
+            }
+
+            bool Mixer::getEvent(Event& event)
+            {
+                size_t readPosition = eventReadPosition.load(std::memory_order_relaxed);
+                if (readPosition == eventWritePosition.load(std::memory_order_acquire))
+                    return false;
+
+                event = events[readPosition % MAX_EVENTS];
+                eventReadPosition.store(readPosition + 1, std::memory_order_release);
+                return true;
+            }
         }
     } // namespace audio
 } // namespace ouzel
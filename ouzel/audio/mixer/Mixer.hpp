@@ -3,9 +3,9 @@
 #ifndef OUZEL_AUDIO_MIXER_MIXER_HPP
 #define OUZEL_AUDIO_MIXER_MIXER_HPP
 
+#include <atomic>
 #include <condition_variable>
 #include <cstdint>
-#include <functional>
 #include <mutex>
 #include <queue>
 #include <set>
@@ -41,7 +41,8 @@ namespace ouzel
                     uintptr_t objectId;
                 };
 
-                Mixer(const std::function<void(const Event&)>& initCallback);
+                Mixer() {}
+                ~Mixer();
 
                 Mixer(const Mixer&) = delete;
                 Mixer& operator=(const Mixer&) = delete;
@@ -54,6 +55,10 @@ namespace ouzel
                 void process();
                 void getData(uint32_t frames, uint16_t channels, uint32_t sampleRate, std::vector<float>& samples);
 
+                // called on the game thread, deletes the processor update commands that the audio thread has run,
+                // together with everything their functions captured (e.g. the buffers swapped out of the processors)
+                void deleteProcessedCommands();
+
                 uintptr_t getObjectId()
                 {
                     auto i = deletedObjectIds.begin();
@@ -73,8 +78,21 @@ namespace ouzel
                     deletedObjectIds.insert(objectId);
                 }
 
+                // called on the audio thread, the event is dropped if the game thread has not read
+                // the previous MAX_EVENTS events yet, so it must only be used for reports that can be lost
+                // (finished streams are reported through their finished play id instead)
+                void addEvent(const Event& event);
+                // called on the game thread, returns false if there are no events left
+                bool getEvent(Event& event);
+
             private:
-                std::function<void(const Event&)> callback;
+                void releaseCommand(std::unique_ptr<Command>&& command);
+
+                static constexpr size_t MAX_EVENTS = 256;
+
+                Event events[MAX_EVENTS];
+                std::atomic<size_t> eventWritePosition{0};
+                std::atomic<size_t> eventReadPosition{0};
 
                 uintptr_t lastObjectId = 0;
                 std::set<uintptr_t> deletedObjectIds;
@@ -85,6 +103,7 @@ namespace ouzel
                 std::mutex commandMutex;
                 std::condition_variable commandConditionVariable;
                 std::queue<std::unique_ptr<Command>> commandQueue;
+                std::atomic<Command*> processedCommands{nullptr};
             };
         }
     } // namespace audio
@@ -0,0 +1,104 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_AUDIO_MIXER_PARAMETER_HPP
+#define OUZEL_AUDIO_MIXER_PARAMETER_HPP
+
+#include <atomic>
+#include <cstdint>
+
+namespace ouzel
+{
+    namespace audio
+    {
+        namespace mixer
+        {
+            // Numeric processor parameter that the game thread sets without locking or allocating. The audio
+            // thread picks up the latest value once per buffer and glides to it over the samples of the buffer.
+            class Parameter final
+            {
+            public:
+                explicit Parameter(float initValue = 0.0F):
+                    target(initValue), current(initValue), end(initValue)
+                {
+                }
+
+                Parameter(const Parameter&) = delete;
+                Parameter& operator=(const Parameter&) = delete;
+
+                Parameter(Parameter&&) = delete;
+                Parameter& operator=(Parameter&&) = delete;
+
+                // game thread
+                inline float get() const { return target.load(std::memory_order_relaxed); }
+                inline void set(float newValue) { target.store(newValue, std::memory_order_relaxed); }
+
+                // audio thread, starts a linear ramp from the previous value to the latest one
+                void begin(uint32_t frames)
+                {
+                    current = end;
+                    end = target.load(std::memory_order_relaxed);
+                    step = frames ? (end - current) / frames : 0.0F;
+                }
+
+                inline bool isSmoothing() const { return step != 0.0F; }
+                // value of the next sample of the ramp
+                inline float next() { return current += step; }
+                // value at the end of the ramp
+                inline float getValue() const { return end; }
+
+            private:
+                std::atomic<float> target;
+                float current;
+                float end;
+                float step = 0.0F;
+            };
+
+            // Parameters that must change together, triple buffered so that neither thread ever waits for the other.
+            // Only one thread may set them and only the audio thread may read them.
+            template<class T>
+            class ParameterBlock final
+            {
+            public:
+                explicit ParameterBlock(const T& initValue = T()):
+                    buffers{initValue, initValue, initValue}
+                {
+                }
+
+                ParameterBlock(const ParameterBlock&) = delete;
+                ParameterBlock& operator=(const ParameterBlock&) = delete;
+
+                ParameterBlock(ParameterBlock&&) = delete;
+                ParameterBlock& operator=(ParameterBlock&&) = delete;
+
+                // game thread, the written buffer is exchanged with the middle one
+                void set(const T& newValue)
+                {
+                    buffers[back] = newValue;
+                    back = middle.exchange(back | DIRTY, std::memory_order_acq_rel) & INDEX;
+                }
+
+                // audio thread, takes the middle buffer if it was written since the last call, returns true if it did
+                bool update()
+                {
+                    if (!(middle.load(std::memory_order_relaxed) & DIRTY)) return false;
+
+                    front = middle.exchange(front, std::memory_order_acq_rel) & INDEX;
+                    return true;
+                }
+
+                inline const T& get() const { return buffers[front]; }
+
+            private:
+                static constexpr uint32_t INDEX = 0x03;
+                static constexpr uint32_t DIRTY = 0x04;
+
+                T buffers[3];
+                uint32_t back = 0;
+                std::atomic<uint32_t> middle{1};
+                uint32_t front = 2;
+            };
+        }
+    } // namespace audio
+} // namespace ouzel
+
+#endif // OUZEL_AUDIO_MIXER_PARAMETER_HPP
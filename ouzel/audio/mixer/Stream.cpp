@@ -2,6 +2,7 @@
 
 #include "Stream.hpp"
 #include "Bus.hpp"
+#include "Mixer.hpp"
 #include "Source.hpp"
 
 namespace ouzel
@@ -27,10 +28,11 @@ namespace ouzel
                 if (output) output->addInput(this);
             }
 
-            void Stream::play(bool repeat)
+            void Stream::play(bool repeat, uint32_t newPlayId)
             {
                 playing = true;
                 repeating = repeat;
+                playId = newPlayId;
             }
 
             void Stream::stop(bool shouldReset)
@@ -38,6 +40,23 @@ namespace ouzel
                 playing = false;
                 if (shouldReset) reset();
             }
+
+            void Stream::reportStarvation()
+            {
+                if (mixer)
+                {
+                    Mixer::Event event(Mixer::Event::Type::STARVATION);
+                    event.objectId = objectId;
+                    mixer->addEvent(event);
+                }
+            }
+
+            void Stream::finish()
+            {
+                playing = false;
+
+                if (finishedPlayId) finishedPlayId->store(playId, std::memory_order_release);
+            }
         }
     } // namespace audio
 } // namespace ouzel
@@ -3,6 +3,9 @@
 #ifndef OUZEL_AUDIO_MIXER_STREAM_HPP
 #define OUZEL_AUDIO_MIXER_STREAM_HPP
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include "audio/mixer/Object.hpp"
 
 namespace ouzel
@@ -12,11 +15,13 @@ namespace ouzel
         namespace mixer
         {
             class Bus;
+            class Mixer;
             class Source;
 
             class Stream: public Object
             {
                 friend Bus;
+                friend Mixer;
             public:
                 Stream(Source& initSource);
                 ~Stream();
@@ -24,21 +29,40 @@ namespace ouzel
                 const Source& getSource() const { return source; }
 
                 virtual void getData(uint32_t frames, std::vector<float>& samples) = 0;
+                // advances the stream without producing samples, used for virtual streams
+                virtual void skip(uint32_t frames) = 0;
 
                 void setOutput(Bus* newOutput);
 
                 bool isPlaying() const { return playing; }
-                void play(bool repeat);
+                void play(bool repeat, uint32_t newPlayId);
 
                 bool isRepeating() const { return repeating; }
                 void stop(bool shouldReset);
                 virtual void reset() = 0;
 
+                // virtual streams keep playing but are not mixed
+                bool isVirtual() const { return virtualized; }
+                void setVirtual(bool newVirtualized) { virtualized = newVirtualized; }
+
             protected:
+                // sends a starvation event to the mixer, must be called from the audio thread
+                void reportStarvation();
+                // stops a stream that reached its end and stores its play id for the game thread,
+                // must be called from the audio thread
+                void finish();
+
                 Source& source;
+                Mixer* mixer = nullptr;
+                uintptr_t objectId = 0;
                 Bus* output = nullptr;
                 bool playing = false;
                 bool repeating = false;
+                uint32_t playId = 0;
+                bool virtualized = false;
+                // allocated by the game thread, which polls it until it deletes the stream, unlike the
+                // events this can't be dropped and only the last finished play matters
+                std::unique_ptr<std::atomic<uint32_t>> finishedPlayId;
             };
         }
     } // namespace audio
@@ -19,23 +19,33 @@
 #    include "opengl/ColorVSGLES2.h"
 #    include "opengl/TexturePSGLES2.h"
 #    include "opengl/TextureVSGLES2.h"
+#    include "opengl/ParticleVSGLES2.h"
+#    include "opengl/DistanceFieldPSGLES2.h"
 #    include "opengl/ColorPSGLES3.h"
 #    include "opengl/ColorVSGLES3.h"
 #    include "opengl/TexturePSGLES3.h"
 #    include "opengl/TextureVSGLES3.h"
+#    include "opengl/ParticleVSGLES3.h"
+#    include "opengl/DistanceFieldPSGLES3.h"
 #  else
 #    include "opengl/ColorPSGL2.h"
 #    include "opengl/ColorVSGL2.h"
 #    include "opengl/TexturePSGL2.h"
 #    include "opengl/TextureVSGL2.h"
+#    include "opengl/ParticleVSGL2.h"
+#    include "opengl/DistanceFieldPSGL2.h"
 #    include "opengl/ColorPSGL3.h"
 #    include "opengl/ColorVSGL3.h"
 #    include "opengl/TexturePSGL3.h"
 #    include "opengl/TextureVSGL3.h"
+#    include "opengl/ParticleVSGL3.h"
+#    include "opengl/DistanceFieldPSGL3.h"
 #    include "opengl/ColorPSGL4.h"
 #    include "opengl/ColorVSGL4.h"
 #    include "opengl/TexturePSGL4.h"
 #    include "opengl/TextureVSGL4.h"
+#    include "opengl/ParticleVSGL4.h"
+#    include "opengl/DistanceFieldPSGL4.h"
 #  endif
 #endif
 
@@ -375,6 +385,176 @@ namespace ouzel
                 }
 
                 assetBundle.setShader(SHADER_COLOR, colorShader);
+
+                std::shared_ptr<graphics::Shader> distanceFieldShader;
+
+                switch (renderer->getDevice()->getAPIMajorVersion())
+                {
+#  if OUZEL_SUPPORTS_OPENGLES
+                    case 2:
+                        distanceFieldShader = std::make_shared<graphics::Shader>(*renderer,
+                                                                                 std::vector<uint8_t>(std::begin(DistanceFieldPSGLES2_glsl), std::end(DistanceFieldPSGLES2_glsl)),
+                                                                                 std::vector<uint8_t>(std::begin(TextureVSGLES2_glsl), std::end(TextureVSGLES2_glsl)),
+                                                                                 std::set<graphics::Vertex::Attribute::Usage>{
+                                                                                     graphics::Vertex::Attribute::Usage::POSITION,
+                                                                                     graphics::Vertex::Attribute::Usage::COLOR,
+                                                                                     graphics::Vertex::Attribute::Usage::TEXTURE_COORDINATES0
+                                                                                 },
+                                                                                 std::vector<graphics::Shader::ConstantInfo>{{"color", graphics::DataType::FLOAT_VECTOR4},
+                                                                                                                             {"outlineColor", graphics::DataType::FLOAT_VECTOR4},
+                                                                                                                             {"outlineWidth", graphics::DataType::FLOAT}},
+                                                                                 std::vector<graphics::Shader::ConstantInfo>{{"modelViewProj", graphics::DataType::FLOAT_MATRIX4}});
+                        break;
+                    case 3:
+                        distanceFieldShader = std::make_shared<graphics::Shader>(*renderer,
+                                                                                 std::vector<uint8_t>(std::begin(DistanceFieldPSGLES3_glsl), std::end(DistanceFieldPSGLES3_glsl)),
+                                                                                 std::vector<uint8_t>(std::begin(TextureVSGLES3_glsl), std::end(TextureVSGLES3_glsl)),
+                                                                                 std::set<graphics::Vertex::Attribute::Usage>{
+                                                                                     graphics::Vertex::Attribute::Usage::POSITION,
+                                                                                     graphics::Vertex::Attribute::Usage::COLOR,
+                                                                                     graphics::Vertex::Attribute::Usage::TEXTURE_COORDINATES0
+                                                                                 },
+                                                                                 std::vector<graphics::Shader::ConstantInfo>{{"color", graphics::DataType::FLOAT_VECTOR4},
+                                                                                                                             {"outlineColor", graphics::DataType::FLOAT_VECTOR4},
+                                                                                                                             {"outlineWidth", graphics::DataType::FLOAT}},
+                                                                                 std::vector<graphics::Shader::ConstantInfo>{{"modelViewProj", graphics::DataType::FLOAT_MATRIX4}});
+                        break;
+#  else
+                    case 2:
+                        distanceFieldShader = std::make_shared<graphics::Shader>(*renderer,
+                                                                                 std::vector<uint8_t>(std::begin(DistanceFieldPSGL2_glsl), std::end(DistanceFieldPSGL2_glsl)),
+                                                                                 std::vector<uint8_t>(std::begin(TextureVSGL2_glsl), std::end(TextureVSGL2_glsl)),
+                                                                                 std::set<graphics::Vertex::Attribute::Usage>{
+                                                                                     graphics::Vertex::Attribute::Usage::POSITION,
+                                                                                     graphics::Vertex::Attribute::Usage::COLOR,
+                                                                                     graphics::Vertex::Attribute::Usage::TEXTURE_COORDINATES0
+                                                                                 },
+                                                                                 std::vector<graphics::Shader::ConstantInfo>{{"color", graphics::DataType::FLOAT_VECTOR4},
+                                                                                                                             {"outlineColor", graphics::DataType::FLOAT_VECTOR4},
+                                                                                                                             {"outlineWidth", graphics::DataType::FLOAT}},
+                                                                                 std::vector<graphics::Shader::ConstantInfo>{{"modelViewProj", graphics::DataType::FLOAT_MATRIX4}});
+                        break;
+                    case 3:
+                        distanceFieldShader = std::make_shared<graphics::Shader>(*renderer,
+                                                                                 std::vector<uint8_t>(std::begin(DistanceFieldPSGL3_glsl), std::end(DistanceFieldPSGL3_glsl)),
+                                                                                 std::vector<uint8_t>(std::begin(TextureVSGL3_glsl), std::end(TextureVSGL3_glsl)),
+                                                                                 std::set<graphics::Vertex::Attribute::Usage>{
+                                                                                     graphics::Vertex::Attribute::Usage::POSITION,
+                                                                                     graphics::Vertex::Attribute::Usage::COLOR,
+                                                                                     graphics::Vertex::Attribute::Usage::TEXTURE_COORDINATES0
+                                                                                 },
+                                                                                 std::vector<graphics::Shader::ConstantInfo>{{"color", graphics::DataType::FLOAT_VECTOR4},
+                                                                                                                             {"outlineColor", graphics::DataType::FLOAT_VECTOR4},
+                                                                                                                             {"outlineWidth", graphics::DataType::FLOAT}},
+                                                                                 std::vector<graphics::Shader::ConstantInfo>{{"modelViewProj", graphics::DataType::FLOAT_MATRIX4}});
+                        break;
+                    case 4:
+                        distanceFieldShader = std::make_shared<graphics::Shader>(*renderer,
+                                                                                 std::vector<uint8_t>(std::begin(DistanceFieldPSGL4_glsl), std::end(DistanceFieldPSGL4_glsl)),
+                                                                                 std::vector<uint8_t>(std::begin(TextureVSGL4_glsl), std::end(TextureVSGL4_glsl)),
+                                                                                 std::set<graphics::Vertex::Attribute::Usage>{
+                                                                                     graphics::Vertex::Attribute::Usage::POSITION,
+                                                                                     graphics::Vertex::Attribute::Usage::COLOR,
+                                                                                     graphics::Vertex::Attribute::Usage::TEXTURE_COORDINATES0
+                                                                                 },
+                                                                                 std::vector<graphics::Shader::ConstantInfo>{{"color", graphics::DataType::FLOAT_VECTOR4},
+                                                                                                                             {"outlineColor", graphics::DataType::FLOAT_VECTOR4},
+                                                                                                                             {"outlineWidth", graphics::DataType::FLOAT}},
+                                                                                 std::vector<graphics::Shader::ConstantInfo>{{"modelViewProj", graphics::DataType::FLOAT_MATRIX4}});
+                        break;
+#  endif
+                    default:
+                        throw std::runtime_error("Unsupported OpenGL version");
+                }
+
+                assetBundle.setShader(SHADER_DISTANCE_FIELD, distanceFieldShader);
+
+                // quads expanded from per-instance data, the color attribute keeps the vertex attribute locations in sync
+                if (renderer->getDevice()->isInstancingSupported())
+                {
+                    std::shared_ptr<graphics::Shader> particleShader;
+
+                    switch (renderer->getDevice()->getAPIMajorVersion())
+                    {
+#  if OUZEL_SUPPORTS_OPENGLES
+                        case 2:
+                            particleShader = std::make_shared<graphics::Shader>(*renderer,
+                                                                                std::vector<uint8_t>(std::begin(TexturePSGLES2_glsl), std::end(TexturePSGLES2_glsl)),
+                                                                                std::vector<uint8_t>(std::begin(ParticleVSGLES2_glsl), std::end(ParticleVSGLES2_glsl)),
+                                                                                std::set<graphics::Vertex::Attribute::Usage>{
+                                                                                    graphics::Vertex::Attribute::Usage::POSITION,
+                                                                                    graphics::Vertex::Attribute::Usage::COLOR,
+                                                                                    graphics::Vertex::Attribute::Usage::TEXTURE_COORDINATES0,
+                                                                                    graphics::Vertex::Attribute::Usage::INSTANCE_TRANSFORM,
+                                                                                    graphics::Vertex::Attribute::Usage::INSTANCE_COLOR
+                                                                                },
+                                                                                std::vector<graphics::Shader::ConstantInfo>{{"color", graphics::DataType::FLOAT_VECTOR4}},
+                                                                                std::vector<graphics::Shader::ConstantInfo>{{"modelViewProj", graphics::DataType::FLOAT_MATRIX4}});
+                            break;
+                        case 3:
+                            particleShader = std::make_shared<graphics::Shader>(*renderer,
+                                                                                std::vector<uint8_t>(std::begin(TexturePSGLES3_glsl), std::end(TexturePSGLES3_glsl)),
+                                                                                std::vector<uint8_t>(std::begin(ParticleVSGLES3_glsl), std::end(ParticleVSGLES3_glsl)),
+                                                                                std::set<graphics::Vertex::Attribute::Usage>{
+                                                                                    graphics::Vertex::Attribute::Usage::POSITION,
+                                                                                    graphics::Vertex::Attribute::Usage::COLOR,
+                                                                                    graphics::Vertex::Attribute::Usage::TEXTURE_COORDINATES0,
+                                                                                    graphics::Vertex::Attribute::Usage::INSTANCE_TRANSFORM,
+                                                                                    graphics::Vertex::Attribute::Usage::INSTANCE_COLOR
+                                                                                },
+                                                                                std::vector<graphics::Shader::ConstantInfo>{{"color", graphics::DataType::FLOAT_VECTOR4}},
+                                                                                std::vector<graphics::Shader::ConstantInfo>{{"modelViewProj", graphics::DataType::FLOAT_MATRIX4}});
+                            break;
+#  else
+                        case 2:
+                            particleShader = std::make_shared<graphics::Shader>(*renderer,
+                                                                                std::vector<uint8_t>(std::begin(TexturePSGL2_glsl), std::end(TexturePSGL2_glsl)),
+                                                                                std::vector<uint8_t>(std::begin(ParticleVSGL2_glsl), std::end(ParticleVSGL2_glsl)),
+                                                                                std::set<graphics::Vertex::Attribute::Usage>{
+                                                                                    graphics::Vertex::Attribute::Usage::POSITION,
+                                                                                    graphics::Vertex::Attribute::Usage::COLOR,
+                                                                                    graphics::Vertex::Attribute::Usage::TEXTURE_COORDINATES0,
+                                                                                    graphics::Vertex::Attribute::Usage::INSTANCE_TRANSFORM,
+                                                                                    graphics::Vertex::Attribute::Usage::INSTANCE_COLOR
+                                                                                },
+                                                                                std::vector<graphics::Shader::ConstantInfo>{{"color", graphics::DataType::FLOAT_VECTOR4}},
+                                                                                std::vector<graphics::Shader::ConstantInfo>{{"modelViewProj", graphics::DataType::FLOAT_MATRIX4}});
+                            break;
+                        case 3:
+                            particleShader = std::make_shared<graphics::Shader>(*renderer,
+                                                                                std::vector<uint8_t>(std::begin(TexturePSGL3_glsl), std::end(TexturePSGL3_glsl)),
+                                                                                std::vector<uint8_t>(std::begin(ParticleVSGL3_glsl), std::end(ParticleVSGL3_glsl)),
+                                                                                std::set<graphics::Vertex::Attribute::Usage>{
+                                                                                    graphics::Vertex::Attribute::Usage::POSITION,
+                                                                                    graphics::Vertex::Attribute::Usage::COLOR,
+                                                                                    graphics::Vertex::Attribute::Usage::TEXTURE_COORDINATES0,
+                                                                                    graphics::Vertex::Attribute::Usage::INSTANCE_TRANSFORM,
+                                                                                    graphics::Vertex::Attribute::Usage::INSTANCE_COLOR
+                                                                                },
+                                                                                std::vector<graphics::Shader::ConstantInfo>{{"color", graphics::DataType::FLOAT_VECTOR4}},
+                                                                                std::vector<graphics::Shader::ConstantInfo>{{"modelViewProj", graphics::DataType::FLOAT_MATRIX4}});
+                            break;
+                        case 4:
+                            particleShader = std::make_shared<graphics::Shader>(*renderer,
+                                                                                std::vector<uint8_t>(std::begin(TexturePSGL4_glsl), std::end(TexturePSGL4_glsl)),
+                                                                                std::vector<uint8_t>(std::begin(ParticleVSGL4_glsl), std::end(ParticleVSGL4_glsl)),
+                                                                                std::set<graphics::Vertex::Attribute::Usage>{
+                                                                                    graphics::Vertex::Attribute::Usage::POSITION,
+                                                                                    graphics::Vertex::Attribute::Usage::COLOR,
+                                                                                    graphics::Vertex::Attribute::Usage::TEXTURE_COORDINATES0,
+                                                                                    graphics::Vertex::Attribute::Usage::INSTANCE_TRANSFORM,
+                                                                                    graphics::Vertex::Attribute::Usage::INSTANCE_COLOR
+                                                                                },
+                                                                                std::vector<graphics::Shader::ConstantInfo>{{"color", graphics::DataType::FLOAT_VECTOR4}},
+                                                                                std::vector<graphics::Shader::ConstantInfo>{{"modelViewProj", graphics::DataType::FLOAT_MATRIX4}});
+                            break;
+#  endif
+                        default:
+                            throw std::runtime_error("Unsupported OpenGL version");
+                    }
+
+                    assetBundle.setShader(SHADER_PARTICLE, particleShader);
+                }
                 break;
             }
 #endif
@@ -606,13 +786,52 @@ namespace ouzel
         std::chrono::steady_clock::time_point currentTime = std::chrono::steady_clock::now();
         auto diff = currentTime - previousUpdateTime;
 
-        if (diff > std::chrono::milliseconds(1)) // at least one millisecond has passed
+        float timestep = fixedTimestep;
+
+        if (timestep > 0.0F)
         {
-            if (diff > std::chrono::seconds(1000 / 20)) diff = std::chrono::milliseconds(1000 / 20); // limit the update rate to a minimum 20 FPS
+            previousUpdateTime = currentTime;
+            updateAccumulator += diff;
+
+            // the real time follows the clock, also when updates are skipped
+            timer.update(Timer::Time::REAL, std::chrono::duration<float>(diff).count());
+
+            auto step = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(timestep));
+            if (step <= std::chrono::steady_clock::duration::zero()) step = std::chrono::steady_clock::duration(1);
+
+            for (uint32_t updates = 0; updateAccumulator >= step; ++updates)
+            {
+                if (updates == maxUpdatesPerFrame)
+                {
+                    updateAccumulator %= step;
+                    break;
+                }
+
+                updateAccumulator -= step;
+
+                timer.update(Timer::Time::GAME, timestep);
+
+                std::unique_ptr<UpdateEvent> updateEvent(new UpdateEvent());
+                updateEvent->type = Event::Type::UPDATE;
+                updateEvent->delta = timestep;
+                eventDispatcher.dispatchEvent(std::move(updateEvent));
+            }
+
+            interpolation = static_cast<float>(updateAccumulator.count()) / static_cast<float>(step.count());
+        }
+        else if (diff > std::chrono::milliseconds(1)) // at least one millisecond has passed
+        {
+            timer.update(Timer::Time::REAL, std::chrono::duration<float>(diff).count());
+
+            if (diff > std::chrono::milliseconds(1000 / 20)) diff = std::chrono::milliseconds(1000 / 20); // limit the update rate to a minimum 20 FPS
 
             previousUpdateTime = currentTime;
+            updateAccumulator = std::chrono::steady_clock::duration::zero();
+            interpolation = 0.0F;
             float delta = std::chrono::duration_cast<std::chrono::microseconds>(diff).count() / 1000000.0F;
 
+            timer.update(Timer::Time::GAME, delta);
+
             std::unique_ptr<UpdateEvent> updateEvent(new UpdateEvent());
             updateEvent->type = Event::Type::UPDATE;
             updateEvent->delta = delta;
@@ -622,6 +841,7 @@ namespace ouzel
         inputManager->update();
         window->update();
         audio->update();
+        network.update();
 
         if (renderer->getRefillQueue())
             sceneManager.draw();
@@ -641,6 +861,7 @@ namespace ouzel
         try
         {
             std::unique_ptr<Application> application = ouzel::main(args);
+            previousUpdateTime = std::chrono::steady_clock::now();
 
 #if !defined(__EMSCRIPTEN__)
             while (active)
@@ -652,6 +873,9 @@ namespace ouzel
                     std::unique_lock<std::mutex> lock(updateMutex);
                     while (active && paused)
                         updateCondition.wait(lock);
+
+                    // the time spent paused must not be simulated
+                    previousUpdateTime = std::chrono::steady_clock::now();
                 }
             }
 
@@ -673,4 +897,12 @@ namespace ouzel
     {
         screenSaverEnabled = newScreenSaverEnabled;
     }
+
+    void Engine::setMaxUpdatesPerFrame(uint32_t newMaxUpdatesPerFrame)
+    {
+        if (!newMaxUpdatesPerFrame)
+            throw std::invalid_argument("Maximum number of updates per frame must be positive");
+
+        maxUpdatesPerFrame = newMaxUpdatesPerFrame;
+    }
 }
@@ -25,6 +25,7 @@
 #include "network/Network.hpp"
 #include "utils/INI.hpp"
 #include "utils/Log.hpp"
+#include "utils/ThreadPool.hpp"
 
 namespace ouzel
 {
@@ -32,6 +33,8 @@ namespace ouzel
 
     const std::string SHADER_TEXTURE = "shaderTexture";
     const std::string SHADER_COLOR = "shaderColor";
+    const std::string SHADER_PARTICLE = "shaderParticle";
+    const std::string SHADER_DISTANCE_FIELD = "shaderDistanceField";
 
     const std::string BLEND_NO_BLEND = "blendNoBlend";
     const std::string BLEND_ADD = "blendAdd";
@@ -62,6 +65,7 @@ namespace ouzel
 
         inline FileSystem& getFileSystem() { return fileSystem; }
         inline EventDispatcher& getEventDispatcher() { return eventDispatcher; }
+        inline ThreadPool& getThreadPool() { return threadPool; }
         inline assets::Cache& getCache() { return cache; }
         inline Window* getWindow() { return window.get(); }
         inline graphics::Renderer* getRenderer() const { return renderer.get(); }
@@ -70,6 +74,7 @@ namespace ouzel
         inline input::InputManager* getInputManager() const { return inputManager.get(); }
         inline Localization& getLocalization() { return localization; }
         inline network::Network& getNetwork() { return network; }
+        inline Timer& getTimer() { return timer; }
 
         inline const ini::Data& getDefaultSettings() const { return defaultSettings; }
         inline const ini::Data& getUserSettings() const { return userSettings; }
@@ -94,6 +99,19 @@ namespace ouzel
         bool isOneUpdatePerFrame() const { return oneUpdatePerFrame; }
         void setOneUpdatePerFrame(bool value) { oneUpdatePerFrame = value; }
 
+        // 0 means one update with a variable delta per frame, otherwise the UPDATE event is dispatched
+        // with a constant delta as many times as the elapsed time allows
+        float getFixedTimestep() const { return fixedTimestep; }
+        void setFixedTimestep(float newFixedTimestep) { fixedTimestep = newFixedTimestep; }
+
+        // fixed updates beyond this limit are skipped, so that a slow frame does not cause more slow frames,
+        // throws std::invalid_argument for zero, because then the simulation would never update
+        uint32_t getMaxUpdatesPerFrame() const { return maxUpdatesPerFrame; }
+        void setMaxUpdatesPerFrame(uint32_t newMaxUpdatesPerFrame);
+
+        // fraction of the fixed timestep that has elapsed since the last update, for interpolating the drawn state
+        float getInterpolation() const { return interpolation; }
+
     protected:
         class Command
         {
@@ -116,6 +134,7 @@ namespace ouzel
         Logger logger;
         FileSystem fileSystem;
         EventDispatcher eventDispatcher;
+        ThreadPool threadPool;
         std::unique_ptr<Window> window;
         std::unique_ptr<graphics::Renderer> renderer;
         std::unique_ptr<audio::Audio> audio;
@@ -125,6 +144,7 @@ namespace ouzel
         assets::Bundle assetBundle;
         scene::SceneManager sceneManager;
         network::Network network;
+        Timer timer;
 
         ini::Data defaultSettings;
         ini::Data userSettings;
@@ -135,10 +155,14 @@ namespace ouzel
         std::condition_variable updateCondition;
 #endif
         std::chrono::steady_clock::time_point previousUpdateTime;
+        std::chrono::steady_clock::duration updateAccumulator = std::chrono::steady_clock::duration::zero();
+        float interpolation = 0.0F;
 
         std::atomic_bool active{false};
         std::atomic_bool paused{false};
         std::atomic_bool oneUpdatePerFrame{false};
+        std::atomic<float> fixedTimestep{0.0F};
+        std::atomic<uint32_t> maxUpdatesPerFrame{5};
 
         std::atomic_bool screenSaverEnabled{true};
         std::vector<std::string> args;
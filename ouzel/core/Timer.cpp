@@ -1,14 +1,277 @@
 // Copyright 2015-2018 Elviss Strazdins. All rights reserved.
 
+#include <algorithm>
+#include <cmath>
 #include "Timer.hpp"
 
 namespace ouzel
 {
+    static constexpr double TICKS_PER_SECOND = 1000.0;
+    static constexpr uint64_t MAX_DELTA = (uint64_t(1) << (Timer::SLOT_BITS * Timer::LEVEL_COUNT)) - 1;
+
+    static inline uint32_t countTrailingZeros(uint64_t value)
+    {
+        uint32_t result = 0;
+        while (!(value & 1))
+        {
+            value >>= 1;
+            ++result;
+        }
+        return result;
+    }
+
     Timer::Timer()
     {
+        for (Wheel& wheel : wheels)
+            for (uint32_t& head : wheel.heads)
+                head = NONE;
+    }
+
+    uint64_t Timer::schedule(float delay, const std::function<void()>& callback, float interval, Time time)
+    {
+        uint32_t index;
+        if (firstFree != NONE)
+        {
+            index = firstFree;
+            firstFree = entries[index].next;
+        }
+        else
+        {
+            index = static_cast<uint32_t>(entries.size());
+            entries.push_back(Entry());
+        }
+
+        Entry& entry = entries[index];
+        Wheel& wheel = wheels[static_cast<uint32_t>(time)];
+
+        uint64_t delayTicks = delay > 0.0F ? static_cast<uint64_t>(std::llround(delay * TICKS_PER_SECOND)) : 0;
+
+        entry.callback = callback;
+        entry.expireTick = wheel.tick + std::max(delayTicks, uint64_t(1));
+        entry.interval = interval > 0.0F ? std::max(static_cast<uint64_t>(std::llround(interval * TICKS_PER_SECOND)), uint64_t(1)) : 0;
+        entry.wheel = static_cast<uint8_t>(time);
+        entry.state = State::SCHEDULED;
+        ++count;
+        ++wheel.count;
+
+        insert(index);
+
+        return (static_cast<uint64_t>(entry.generation) << 32) | index;
+    }
+
+    bool Timer::cancel(uint64_t handle)
+    {
+        Entry* entry = getEntry(handle);
+        if (!entry) return false;
+
+        uint32_t index = static_cast<uint32_t>(handle & 0xFFFFFFFF);
+
+        if (entry->state == State::FIRING)
+        {
+            // released after its callback returns
+            entry->state = State::CANCELED;
+            return true;
+        }
+
+        unlink(index);
+        release(index);
+        return true;
+    }
+
+    bool Timer::isScheduled(uint64_t handle) const
+    {
+        return getEntry(handle) != nullptr;
+    }
+
+    Timer::Entry* Timer::getEntry(uint64_t handle)
+    {
+        uint32_t index = static_cast<uint32_t>(handle & 0xFFFFFFFF);
+        if (index >= entries.size()) return nullptr;
+
+        Entry& entry = entries[index];
+        if (entry.generation != static_cast<uint32_t>(handle >> 32)) return nullptr;
+        if (entry.state != State::SCHEDULED && entry.state != State::FIRING) return nullptr;
+
+        return &entry;
+    }
+
+    const Timer::Entry* Timer::getEntry(uint64_t handle) const
+    {
+        return const_cast<Timer*>(this)->getEntry(handle);
     }
 
-    void Timer::update(float)
+    void Timer::update(Time time, float delta)
     {
+        Wheel& wheel = wheels[static_cast<uint32_t>(time)];
+
+        if (time == Time::GAME)
+        {
+            if (paused) return;
+            wheel.time += static_cast<double>(delta) * timeScale;
+        }
+        else
+            wheel.time += delta;
+
+        advance(wheel, static_cast<uint64_t>(wheel.time * TICKS_PER_SECOND));
+    }
+
+    // entries are placed on the level where the slot index changes within the remaining time
+    void Timer::insert(uint32_t index)
+    {
+        Entry& entry = entries[index];
+        const Wheel& wheel = wheels[entry.wheel];
+
+        uint64_t delta = entry.expireTick > wheel.tick ? entry.expireTick - wheel.tick : 0;
+        uint64_t expireTick = wheel.tick + std::min(delta, MAX_DELTA);
+
+        uint32_t level = 0;
+        while (level < LEVEL_COUNT - 1 && delta >= (uint64_t(1) << (SLOT_BITS * (level + 1))))
+            ++level;
+
+        uint32_t slot = static_cast<uint32_t>((expireTick >> (SLOT_BITS * level)) & (SLOT_COUNT - 1));
+        link(index, level * SLOT_COUNT + slot);
+    }
+
+    void Timer::link(uint32_t index, uint32_t list)
+    {
+        Entry& entry = entries[index];
+        Wheel& wheel = wheels[entry.wheel];
+
+        entry.list = list;
+        entry.previous = NONE;
+        entry.next = wheel.heads[list];
+        if (entry.next != NONE) entries[entry.next].previous = index;
+        wheel.heads[list] = index;
+
+        if (list < SLOT_COUNT) wheel.occupied[list / 64] |= uint64_t(1) << (list % 64);
+    }
+
+    void Timer::unlink(uint32_t index)
+    {
+        Entry& entry = entries[index];
+        if (entry.list == NONE) return;
+
+        Wheel& wheel = wheels[entry.wheel];
+
+        if (entry.previous != NONE)
+            entries[entry.previous].next = entry.next;
+        else
+            wheel.heads[entry.list] = entry.next;
+
+        if (entry.next != NONE) entries[entry.next].previous = entry.previous;
+
+        if (entry.list < SLOT_COUNT && wheel.heads[entry.list] == NONE)
+            wheel.occupied[entry.list / 64] &= ~(uint64_t(1) << (entry.list % 64));
+
+        entry.list = NONE;
+        entry.previous = NONE;
+        entry.next = NONE;
+    }
+
+    void Timer::release(uint32_t index)
+    {
+        Entry& entry = entries[index];
+        --count;
+        --wheels[entry.wheel].count;
+
+        entry.callback = nullptr;
+        entry.state = State::FREE;
+        ++entry.generation;
+        entry.next = firstFree;
+        firstFree = index;
+    }
+
+    void Timer::advance(Wheel& wheel, uint64_t targetTick)
+    {
+        while (wheel.tick < targetTick)
+        {
+            if (!wheel.count)
+            {
+                wheel.tick = targetTick;
+                return;
+            }
+
+            // skip to the next occupied slot of the first level, but not past the end of the level
+            uint32_t slot = static_cast<uint32_t>(wheel.tick & (SLOT_COUNT - 1)) + 1;
+            uint64_t levelEnd = (wheel.tick | (SLOT_COUNT - 1)) + 1;
+            uint64_t nextTick = levelEnd;
+
+            for (uint32_t word = slot / 64; word < SLOT_COUNT / 64; ++word)
+            {
+                uint64_t bits = wheel.occupied[word];
+                if (word == slot / 64) bits &= ~uint64_t(0) << (slot % 64);
+                if (bits)
+                {
+                    nextTick = (wheel.tick & ~uint64_t(SLOT_COUNT - 1)) + word * 64 + countTrailingZeros(bits);
+                    break;
+                }
+            }
+
+            if (nextTick > targetTick)
+            {
+                wheel.tick = targetTick;
+                return;
+            }
+
+            wheel.tick = nextTick;
+
+            if (wheel.tick == levelEnd)
+            {
+                // the first level wrapped around, move the timers of the next slots of the upper levels down
+                uint32_t level = 1;
+                while (level < LEVEL_COUNT - 1 &&
+                       ((wheel.tick >> (SLOT_BITS * level)) & (SLOT_COUNT - 1)) == 0)
+                    ++level;
+
+                for (;; --level)
+                {
+                    cascade(wheel, level);
+                    if (level == 1) break;
+                }
+            }
+
+            fire(wheel, static_cast<uint32_t>(wheel.tick & (SLOT_COUNT - 1)));
+        }
+    }
+
+    void Timer::cascade(Wheel& wheel, uint32_t level)
+    {
+        uint32_t slot = static_cast<uint32_t>((wheel.tick >> (SLOT_BITS * level)) & (SLOT_COUNT - 1));
+        uint32_t list = level * SLOT_COUNT + slot;
+
+        uint32_t index = wheel.heads[list];
+        wheel.heads[list] = NONE;
+
+        while (index != NONE)
+        {
+            uint32_t next = entries[index].next;
+            entries[index].list = NONE;
+            insert(index);
+            index = next;
+        }
+    }
+
+    void Timer::fire(Wheel& wheel, uint32_t slot)
+    {
+        while (wheel.heads[slot] != NONE)
+        {
+            uint32_t index = wheel.heads[slot];
+            unlink(index);
+
+            entries[index].state = State::FIRING;
+            entries[index].callback();
+
+            // the callback could have scheduled timers, but entries of a deque are not moved
+            Entry& entry = entries[index];
+
+            if (entry.state == State::FIRING && entry.interval)
+            {
+                entry.state = State::SCHEDULED;
+                entry.expireTick = std::max(entry.expireTick + entry.interval, wheel.tick + 1);
+                insert(index);
+            }
+            else
+                release(index);
+        }
     }
 }
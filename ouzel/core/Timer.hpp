@@ -3,11 +3,27 @@
 #ifndef OUZEL_CORE_TIMER_HPP
 #define OUZEL_CORE_TIMER_HPP
 
+#include <cstdint>
+#include <deque>
+#include <functional>
+
 namespace ouzel
 {
+    // Schedules callbacks on hierarchical timing wheels with millisecond resolution. Scheduling and
+    // canceling take constant time and update only visits the slots of the elapsed ticks that hold timers.
     class Timer final
     {
     public:
+        enum class Time
+        {
+            GAME, // stops while the timer is paused and is scaled by the time scale
+            REAL
+        };
+
+        static constexpr uint32_t LEVEL_COUNT = 4;
+        static constexpr uint32_t SLOT_BITS = 8;
+        static constexpr uint32_t SLOT_COUNT = 1 << SLOT_BITS;
+
         Timer();
         ~Timer() = default;
 
@@ -17,7 +33,79 @@ namespace ouzel
         Timer(Timer&&) = delete;
         Timer& operator=(Timer&&) = delete;
 
-        void update(float delta);
+        // calls the callback after delay seconds and then every interval seconds if interval is positive,
+        // returns a handle for cancel
+        uint64_t schedule(float delay, const std::function<void()>& callback,
+                          float interval = 0.0F, Time time = Time::GAME);
+        // returns false if the timer has already fired or was canceled
+        bool cancel(uint64_t handle);
+        bool isScheduled(uint64_t handle) const;
+
+        inline bool isPaused() const { return paused; }
+        inline void setPaused(bool newPaused) { paused = newPaused; }
+
+        inline float getTimeScale() const { return timeScale; }
+        inline void setTimeScale(float newTimeScale) { timeScale = newTimeScale; }
+
+        inline double getGameTime() const { return wheels[static_cast<uint32_t>(Time::GAME)].time; }
+        inline double getRealTime() const { return wheels[static_cast<uint32_t>(Time::REAL)].time; }
+
+        inline uint32_t getCount() const { return count; }
+
+        // advances one of the times and fires its due timers, the game time does not advance while paused
+        // and delta is multiplied by the time scale for it
+        void update(Time time, float delta);
+
+    private:
+        static constexpr uint32_t NONE = 0xFFFFFFFF;
+
+        enum class State: uint8_t
+        {
+            FREE,
+            SCHEDULED,
+            FIRING,
+            CANCELED
+        };
+
+        struct Entry
+        {
+            std::function<void()> callback;
+            uint64_t expireTick = 0;
+            uint64_t interval = 0; // in ticks
+            uint32_t generation = 1;
+            uint32_t list = NONE;
+            uint32_t previous = NONE;
+            uint32_t next = NONE;
+            uint8_t wheel = 0;
+            State state = State::FREE;
+        };
+
+        struct Wheel
+        {
+            double time = 0.0;
+            uint64_t tick = 0;
+            uint32_t count = 0;
+            uint64_t occupied[SLOT_COUNT / 64] = {}; // non-empty slots of the first level
+            uint32_t heads[LEVEL_COUNT * SLOT_COUNT];
+        };
+
+        Entry* getEntry(uint64_t handle);
+        const Entry* getEntry(uint64_t handle) const;
+        void insert(uint32_t index);
+        void link(uint32_t index, uint32_t list);
+        void unlink(uint32_t index);
+        void release(uint32_t index);
+        void advance(Wheel& wheel, uint64_t targetTick);
+        void cascade(Wheel& wheel, uint32_t level);
+        void fire(Wheel& wheel, uint32_t slot);
+
+        // a deque, so that the callback of a firing entry stays in place while new timers are scheduled
+        std::deque<Entry> entries;
+        uint32_t firstFree = NONE;
+        uint32_t count = 0;
+        Wheel wheels[2];
+        bool paused = false;
+        float timeScale = 1.0F;
     };
 }
 
@@ -295,8 +295,6 @@ namespace ouzel
         init();
         start();
 
-        input::InputSystemLinux* inputLinux = static_cast<input::InputSystemLinux*>(inputManager->getInputSystem());
-
 #if OUZEL_SUPPORTS_X11
         NativeWindowLinux* windowLinux = static_cast<NativeWindowLinux*>(window->getNativeWindow());
 
@@ -454,15 +452,15 @@ namespace ouzel
                     }
                 }
             }
-
-            inputLinux->update();
         }
 #else
         while (active)
         {
             executeAll();
 
-            inputLinux->update();
+            // input is read on its own thread, so there is nothing to do until a function is queued
+            std::unique_lock<std::mutex> lock(executeMutex);
+            executeCondition.wait_for(lock, std::chrono::milliseconds(10), [this]() { return !executeQueue.empty(); });
         }
 #endif
 
@@ -496,6 +494,8 @@ namespace ouzel
 #else
         std::unique_lock<std::mutex> lock(executeMutex);
         executeQueue.push(func);
+        lock.unlock();
+        executeCondition.notify_one();
 #endif
     }
 
@@ -37,6 +37,7 @@ namespace ouzel
 
         std::queue<std::function<void()>> executeQueue;
         std::mutex executeMutex;
+        std::condition_variable executeCondition;
         Atom executeAtom = None;
 
 #if OUZEL_SUPPORTS_X11
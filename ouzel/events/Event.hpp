@@ -84,6 +84,11 @@ namespace ouzel
             SOUND_RESET,
             SOUND_FINISH,
 
+            // network events
+            NETWORK_CONNECT, // connection accepted or established
+            NETWORK_DISCONNECT, // connection closed by the peer or failed
+            NETWORK_RECEIVE, // data received on a connection or UDP endpoint
+
             UPDATE,
 
             USER // user defined event
@@ -179,6 +184,16 @@ namespace ouzel
         audio::Voice* voice;
     };
 
+    struct NetworkEvent final: Event
+    {
+        uintptr_t endpointId = 0;
+        uintptr_t listenerId = 0; // listener that accepted the connection
+        uint32_t address = 0; // peer address in host byte order
+        uint16_t port = 0;
+        const uint8_t* data = nullptr; // valid only during the dispatch
+        uint32_t size = 0;
+    };
+
     struct UpdateEvent final: Event
     {
         float delta;
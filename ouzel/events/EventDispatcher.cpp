@@ -71,6 +71,11 @@ namespace ouzel
     {
         if (!event) return false;
 
+        return dispatchEvent(*event);
+    }
+
+    bool EventDispatcher::dispatchEvent(const Event& event)
+    {
         bool handled = false;
 
         for (const EventHandler* eventHandler : eventHandlers)
@@ -79,14 +84,14 @@ namespace ouzel
 
             if (i == eventHandlerDeleteSet.end())
             {
-                switch (event->type)
+                switch (event.type)
                 {
                     case Event::Type::KEYBOARD_CONNECT:
                     case Event::Type::KEYBOARD_DISCONNECT:
                     case Event::Type::KEY_PRESS:
                     case Event::Type::KEY_RELEASE:
                         if (eventHandler->keyboardHandler)
-                            handled = eventHandler->keyboardHandler(*static_cast<KeyboardEvent*>(event.get()));
+                            handled = eventHandler->keyboardHandler(static_cast<const KeyboardEvent&>(event));
                         break;
                     case Event::Type::MOUSE_CONNECT:
                     case Event::Type::MOUSE_DISCONNECT:
@@ -96,7 +101,7 @@ namespace ouzel
                     case Event::Type::MOUSE_MOVE:
                     case Event::Type::MOUSE_CURSOR_LOCK_CHANGE:
                         if (eventHandler->mouseHandler)
-                            handled = eventHandler->mouseHandler(*static_cast<MouseEvent*>(event.get()));
+                            handled = eventHandler->mouseHandler(static_cast<const MouseEvent&>(event));
                         break;
                     case Event::Type::TOUCHPAD_CONNECT:
                     case Event::Type::TOUCHPAD_DISCONNECT:
@@ -105,13 +110,13 @@ namespace ouzel
                     case Event::Type::TOUCH_END:
                     case Event::Type::TOUCH_CANCEL:
                         if (eventHandler->touchHandler)
-                            handled = eventHandler->touchHandler(*static_cast<TouchEvent*>(event.get()));
+                            handled = eventHandler->touchHandler(static_cast<const TouchEvent&>(event));
                         break;
                     case Event::Type::GAMEPAD_CONNECT:
                     case Event::Type::GAMEPAD_DISCONNECT:
                     case Event::Type::GAMEPAD_BUTTON_CHANGE:
                         if (eventHandler->gamepadHandler)
-                            handled = eventHandler->gamepadHandler(*static_cast<GamepadEvent*>(event.get()));
+                            handled = eventHandler->gamepadHandler(static_cast<const GamepadEvent&>(event));
                         break;
                     case Event::Type::WINDOW_SIZE_CHANGE:
                     case Event::Type::WINDOW_TITLE_CHANGE:
@@ -119,7 +124,7 @@ namespace ouzel
                     case Event::Type::SCREEN_CHANGE:
                     case Event::Type::RESOLUTION_CHANGE:
                         if (eventHandler->windowHandler)
-                            handled = eventHandler->windowHandler(*static_cast<WindowEvent*>(event.get()));
+                            handled = eventHandler->windowHandler(static_cast<const WindowEvent&>(event));
                         break;
                     case Event::Type::ENGINE_START:
                     case Event::Type::ENGINE_STOP:
@@ -129,7 +134,7 @@ namespace ouzel
                     case Event::Type::LOW_MEMORY:
                     case Event::Type::OPEN_FILE:
                         if (eventHandler->systemHandler)
-                            handled = eventHandler->systemHandler(*static_cast<SystemEvent*>(event.get()));
+                            handled = eventHandler->systemHandler(static_cast<const SystemEvent&>(event));
                         break;
                     case Event::Type::ACTOR_ENTER:
                     case Event::Type::ACTOR_LEAVE:
@@ -139,27 +144,33 @@ namespace ouzel
                     case Event::Type::ACTOR_DRAG:
                     case Event::Type::WIDGET_CHANGE:
                         if (eventHandler->uiHandler)
-                            handled = eventHandler->uiHandler(*static_cast<UIEvent*>(event.get()));
+                            handled = eventHandler->uiHandler(static_cast<const UIEvent&>(event));
                         break;
                     case Event::Type::ANIMATION_START:
                     case Event::Type::ANIMATION_RESET:
                     case Event::Type::ANIMATION_FINISH:
                         if (eventHandler->animationHandler)
-                            handled = eventHandler->animationHandler(*static_cast<AnimationEvent*>(event.get()));
+                            handled = eventHandler->animationHandler(static_cast<const AnimationEvent&>(event));
                         break;
                     case Event::Type::SOUND_START:
                     case Event::Type::SOUND_RESET:
                     case Event::Type::SOUND_FINISH:
                         if (eventHandler->soundHandler)
-                            handled = eventHandler->soundHandler(*static_cast<SoundEvent*>(event.get()));
+                            handled = eventHandler->soundHandler(static_cast<const SoundEvent&>(event));
+                        break;
+                    case Event::Type::NETWORK_CONNECT:
+                    case Event::Type::NETWORK_DISCONNECT:
+                    case Event::Type::NETWORK_RECEIVE:
+                        if (eventHandler->networkHandler)
+                            handled = eventHandler->networkHandler(static_cast<const NetworkEvent&>(event));
                         break;
                     case Event::Type::UPDATE:
                         if (eventHandler->updateHandler)
-                            handled = eventHandler->updateHandler(*static_cast<UpdateEvent*>(event.get()));
+                            handled = eventHandler->updateHandler(static_cast<const UpdateEvent&>(event));
                         break;
                     case Event::Type::USER:
                         if (eventHandler->userHandler)
-                            handled = eventHandler->userHandler(*static_cast<UserEvent*>(event.get()));
+                            handled = eventHandler->userHandler(static_cast<const UserEvent&>(event));
                         break;
                     default:
                         return false; // custom event should not be sent
@@ -31,6 +31,7 @@ namespace ouzel
 
         // dispatches the event immediately
         bool dispatchEvent(std::unique_ptr<Event>&& event);
+        bool dispatchEvent(const Event& event);
 
         // posts the event for dispatching on the game thread
         std::future<bool> postEvent(std::unique_ptr<Event>&& event);
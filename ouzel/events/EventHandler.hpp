@@ -31,6 +31,7 @@ namespace ouzel
         std::function<bool(const UIEvent&)> uiHandler;
         std::function<bool(const AnimationEvent&)> animationHandler;
         std::function<bool(const SoundEvent&)> soundHandler;
+        std::function<bool(const NetworkEvent&)> networkHandler;
         std::function<bool(const UpdateEvent&)> updateHandler;
         std::function<bool(const UserEvent&)> userHandler;
 
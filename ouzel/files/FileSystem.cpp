@@ -380,6 +380,17 @@ namespace ouzel
         }
     }
 
+    bool FileSystem::archiveFileExists(const std::string& filename) const
+    {
+        for (const auto& archive : archives)
+        {
+            if (archive->fileExists(filename))
+                return true;
+        }
+
+        return false;
+    }
+
     bool FileSystem::resourceFileExists(const std::string& filename) const
     {
         if (!pathIsRelative(filename))
@@ -31,6 +31,8 @@ namespace ouzel
         void writeFile(const std::string& filename, const std::vector<uint8_t>& data) const;
 
         bool resourceFileExists(const std::string& filename) const;
+        // readFile checks the archives before the resource paths
+        bool archiveFileExists(const std::string& filename) const;
         std::string getPath(const std::string& filename, bool searchResources = true) const;
         void addResourcePath(const std::string& path);
         void addArchive(Archive* archive);
@@ -0,0 +1,163 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#include <stdexcept>
+#include <system_error>
+#if !defined(_WIN32)
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+#include <vector>
+#include "MappedFile.hpp"
+
+namespace ouzel
+{
+    MappedFile::MappedFile()
+    {
+    }
+
+    MappedFile::MappedFile(const std::string& filename)
+    {
+#if defined(_WIN32)
+        int bufferSize = MultiByteToWideChar(CP_UTF8, 0, filename.c_str(), -1, nullptr, 0);
+        if (bufferSize == 0)
+            throw std::system_error(GetLastError(), std::system_category(), "Failed to convert UTF-8 to wide char");
+
+        std::vector<WCHAR> buffer(bufferSize);
+        if (MultiByteToWideChar(CP_UTF8, 0, filename.c_str(), -1, buffer.data(), bufferSize) == 0)
+            throw std::system_error(GetLastError(), std::system_category(), "Failed to convert the filename to wide char");
+
+        // relative paths longer than MAX_PATH are not supported
+        if (buffer.size() > MAX_PATH)
+            buffer.insert(buffer.begin(), {L'\\', L'\\', L'?', L'\\'});
+
+        file = CreateFileW(buffer.data(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            throw std::system_error(GetLastError(), std::system_category(), "Failed to open file");
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize))
+        {
+            DWORD error = GetLastError();
+            close();
+            throw std::system_error(error, std::system_category(), "Failed to get file size");
+        }
+
+        if (fileSize.QuadPart == 0 || fileSize.QuadPart > UINT32_MAX)
+        {
+            close();
+            throw std::runtime_error("Unsupported file size");
+        }
+
+        mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping)
+        {
+            DWORD error = GetLastError();
+            close();
+            throw std::system_error(error, std::system_category(), "Failed to create file mapping");
+        }
+
+        void* address = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!address)
+        {
+            DWORD error = GetLastError();
+            close();
+            throw std::system_error(error, std::system_category(), "Failed to map file");
+        }
+
+        data = static_cast<const uint8_t*>(address);
+        size = static_cast<uint32_t>(fileSize.QuadPart);
+#else
+        int file = open(filename.c_str(), O_RDONLY);
+        if (file == -1)
+            throw std::system_error(errno, std::system_category(), "Failed to open file");
+
+        struct stat fileStat;
+        if (fstat(file, &fileStat) == -1)
+        {
+            int error = errno;
+            ::close(file);
+            throw std::system_error(error, std::system_category(), "Failed to get file size");
+        }
+
+        if (fileStat.st_size == 0 || static_cast<uint64_t>(fileStat.st_size) > UINT32_MAX)
+        {
+            ::close(file);
+            throw std::runtime_error("Unsupported file size");
+        }
+
+        void* address = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+
+        // the mapping stays valid after the descriptor is closed
+        ::close(file);
+
+        if (address == MAP_FAILED)
+            throw std::system_error(errno, std::system_category(), "Failed to map file");
+
+        data = static_cast<const uint8_t*>(address);
+        size = static_cast<uint32_t>(fileStat.st_size);
+#endif
+    }
+
+    MappedFile::~MappedFile()
+    {
+#if defined(_WIN32)
+        if (data) UnmapViewOfFile(data);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+#else
+        if (data) munmap(const_cast<uint8_t*>(data), size);
+#endif
+    }
+
+    MappedFile::MappedFile(MappedFile&& other)
+    {
+#if defined(_WIN32)
+        file = other.file;
+        mapping = other.mapping;
+        other.file = INVALID_HANDLE_VALUE;
+        other.mapping = nullptr;
+#endif
+        data = other.data;
+        size = other.size;
+        other.data = nullptr;
+        other.size = 0;
+    }
+
+    MappedFile& MappedFile::operator=(MappedFile&& other)
+    {
+        if (&other != this)
+        {
+            close();
+
+#if defined(_WIN32)
+            file = other.file;
+            mapping = other.mapping;
+            other.file = INVALID_HANDLE_VALUE;
+            other.mapping = nullptr;
+#endif
+            data = other.data;
+            size = other.size;
+            other.data = nullptr;
+            other.size = 0;
+        }
+
+        return *this;
+    }
+
+    void MappedFile::close()
+    {
+#if defined(_WIN32)
+        if (data) UnmapViewOfFile(data);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        mapping = nullptr;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (data) munmap(const_cast<uint8_t*>(data), size);
+#endif
+        data = nullptr;
+        size = 0;
+    }
+}
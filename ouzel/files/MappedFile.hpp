@@ -0,0 +1,50 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_FILES_MAPPEDFILE_HPP
+#define OUZEL_FILES_MAPPEDFILE_HPP
+
+#include <cstdint>
+#include <string>
+
+#if defined(_WIN32)
+#  define WIN32_LEAN_AND_MEAN
+#  define NOMINMAX
+#  include <Windows.h>
+#  undef WIN32_LEAN_AND_MEAN
+#  undef NOMINMAX
+#endif
+
+namespace ouzel
+{
+    // read-only memory mapping of a whole file
+    class MappedFile final
+    {
+    public:
+        MappedFile();
+        explicit MappedFile(const std::string& filename);
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        MappedFile(MappedFile&& other);
+        MappedFile& operator=(MappedFile&& other);
+
+        inline bool isOpen() const { return data != nullptr; }
+
+        void close();
+
+        inline const uint8_t* getData() const { return data; }
+        inline uint32_t getSize() const { return size; }
+
+    private:
+#if defined(_WIN32)
+        HANDLE file = INVALID_HANDLE_VALUE;
+        HANDLE mapping = nullptr;
+#endif
+        const uint8_t* data = nullptr;
+        uint32_t size = 0;
+    };
+}
+
+#endif // OUZEL_FILES_MAPPEDFILE_HPP
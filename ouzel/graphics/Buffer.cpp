@@ -1,5 +1,6 @@
 // Copyright 2015-2018 Elviss Strazdins. All rights reserved.
 
+#include <algorithm>
 #include <stdexcept>
 #include "Buffer.hpp"
 #include "Renderer.hpp"
@@ -9,6 +10,34 @@ namespace ouzel
 {
     namespace graphics
     {
+        BufferStaging::BufferStaging()
+        {
+            blocks.reserve(MAX_BLOCKS);
+        }
+
+        std::vector<uint8_t> BufferStaging::getBlock(uint32_t blockSize)
+        {
+            std::vector<uint8_t> block;
+
+            std::unique_lock<std::mutex> lock(mutex);
+            if (!blocks.empty())
+            {
+                block = std::move(blocks.back());
+                blocks.pop_back();
+            }
+            lock.unlock();
+
+            block.resize(blockSize);
+            return block;
+        }
+
+        void BufferStaging::returnBlock(std::vector<uint8_t>&& block)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (blocks.size() < MAX_BLOCKS)
+                blocks.push_back(std::move(block));
+        }
+
         Buffer::Buffer(Renderer& initRenderer):
             resource(initRenderer)
         {
@@ -18,34 +47,39 @@ namespace ouzel
             resource(initRenderer),
             usage(initUsage),
             flags(initFlags),
-            size(initSize)
+            size(initSize),
+            layout(initUsage == Usage::VERTEX ? VertexLayout::STANDARD : VertexLayout())
         {
             initRenderer.addCommand(std::unique_ptr<Command>(new InitBufferCommand(resource.getId(),
                                                                                    initUsage,
                                                                                    initFlags,
                                                                                    std::vector<uint8_t>(),
-                                                                                   initSize)));
+                                                                                   initSize,
+                                                                                   layout)));
         }
 
         Buffer::Buffer(Renderer& initRenderer, Usage initUsage, uint32_t initFlags, const void* initData, uint32_t initSize):
             resource(initRenderer),
             usage(initUsage),
             flags(initFlags),
-            size(initSize)
+            size(initSize),
+            layout(initUsage == Usage::VERTEX ? VertexLayout::STANDARD : VertexLayout())
         {
             initRenderer.addCommand(std::unique_ptr<Command>(new InitBufferCommand(resource.getId(),
                                                                                    initUsage,
                                                                                    initFlags,
                                                                                    std::vector<uint8_t>(static_cast<const uint8_t*>(initData),
                                                                                                         static_cast<const uint8_t*>(initData) + initSize),
-                                                                                   initSize)));
+                                                                                   initSize,
+                                                                                   layout)));
         }
 
         Buffer::Buffer(Renderer& initRenderer, Usage initUsage, uint32_t initFlags, const std::vector<uint8_t>& initData, uint32_t initSize):
             resource(initRenderer),
             usage(initUsage),
             flags(initFlags),
-            size(initSize)
+            size(initSize),
+            layout(initUsage == Usage::VERTEX ? VertexLayout::STANDARD : VertexLayout())
         {
             if (!initData.empty() && initSize != initData.size())
                 throw std::runtime_error("Invalid buffer data");
@@ -54,15 +88,55 @@ namespace ouzel
                                                                                    initUsage,
                                                                                    initFlags,
                                                                                    initData,
-                                                                                   initSize)));
+                                                                                   initSize,
+                                                                                   layout)));
+        }
+
+        Buffer::Buffer(Renderer& initRenderer, const VertexLayout& initLayout, uint32_t initFlags, uint32_t initSize):
+            resource(initRenderer),
+            usage(Usage::VERTEX),
+            flags(initFlags),
+            size(initSize),
+            layout(initLayout)
+        {
+            initRenderer.addCommand(std::unique_ptr<Command>(new InitBufferCommand(resource.getId(),
+                                                                                   usage,
+                                                                                   initFlags,
+                                                                                   std::vector<uint8_t>(),
+                                                                                   initSize,
+                                                                                   layout)));
+        }
+
+        Buffer::Buffer(Renderer& initRenderer, const VertexLayout& initLayout, uint32_t initFlags, const std::vector<uint8_t>& initData, uint32_t initSize):
+            resource(initRenderer),
+            usage(Usage::VERTEX),
+            flags(initFlags),
+            size(initSize),
+            layout(initLayout)
+        {
+            if (!initData.empty() && initSize != initData.size())
+                throw std::runtime_error("Invalid buffer data");
+
+            initRenderer.addCommand(std::unique_ptr<Command>(new InitBufferCommand(resource.getId(),
+                                                                                   usage,
+                                                                                   initFlags,
+                                                                                   initData,
+                                                                                   initSize,
+                                                                                   layout)));
         }
 
         void Buffer::setData(const void* newData, uint32_t newSize)
         {
             if (resource.getId())
-                resource.getRenderer()->addCommand(std::unique_ptr<Command>(new SetBufferDataCommand(resource.getId(),
-                                                                                                     std::vector<uint8_t>(static_cast<const uint8_t*>(newData),
-                                                                                                                          static_cast<const uint8_t*>(newData) + newSize))));
+            {
+                if (!staging) staging = std::make_shared<BufferStaging>();
+
+                std::vector<uint8_t> block = staging->getBlock(newSize);
+                std::copy(static_cast<const uint8_t*>(newData),
+                          static_cast<const uint8_t*>(newData) + newSize,
+                          block.begin());
+                sendData(std::move(block));
+            }
         }
 
         void Buffer::setData(const std::vector<uint8_t>& newData)
@@ -76,8 +150,66 @@ namespace ouzel
             if (newData.size() > size) size = static_cast<uint32_t>(newData.size());
 
             if (resource.getId())
-                resource.getRenderer()->addCommand(std::unique_ptr<Command>(new SetBufferDataCommand(resource.getId(),
-                                                                                                     newData)));
+            {
+                if (!staging) staging = std::make_shared<BufferStaging>();
+
+                std::vector<uint8_t> block = staging->getBlock(static_cast<uint32_t>(newData.size()));
+                std::copy(newData.begin(), newData.end(), block.begin());
+                sendData(std::move(block));
+            }
+        }
+
+        void Buffer::setData(std::vector<uint8_t>&& newData)
+        {
+            if (!(flags & Buffer::DYNAMIC))
+                throw std::runtime_error("Buffer is not dynamic");
+
+            if (newData.empty())
+                throw std::runtime_error("Invalid buffer data");
+
+            if (newData.size() > size) size = static_cast<uint32_t>(newData.size());
+
+            if (resource.getId())
+            {
+                if (!staging) staging = std::make_shared<BufferStaging>();
+                sendData(std::move(newData));
+            }
+        }
+
+        void* Buffer::map(uint32_t mapSize)
+        {
+            if (!(flags & Buffer::DYNAMIC))
+                throw std::runtime_error("Buffer is not dynamic");
+
+            if (mapped)
+                throw std::runtime_error("Buffer is already mapped");
+
+            if (mapSize == 0)
+                throw std::runtime_error("Invalid buffer data");
+
+            if (!staging) staging = std::make_shared<BufferStaging>();
+
+            mappedData = staging->getBlock(mapSize);
+            mapped = true;
+
+            return mappedData.data();
+        }
+
+        void Buffer::unmap()
+        {
+            if (!mapped)
+                throw std::runtime_error("Buffer is not mapped");
+
+            mapped = false;
+            setData(std::move(mappedData));
+        }
+
+        void Buffer::sendData(std::vector<uint8_t>&& newData)
+        {
+            // the command returns the block to the staging pool when the render thread is done with it
+            resource.getRenderer()->addCommand(std::unique_ptr<Command>(new SetBufferDataCommand(resource.getId(),
+                                                                                                 std::move(newData),
+                                                                                                 staging)));
         }
     } // namespace graphics
 } // namespace ouzel
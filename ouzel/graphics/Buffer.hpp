@@ -3,8 +3,11 @@
 #ifndef OUZEL_GRAPHICS_BUFFER_HPP
 #define OUZEL_GRAPHICS_BUFFER_HPP
 
+#include <memory>
+#include <mutex>
 #include <vector>
 #include "graphics/GraphicsResource.hpp"
+#include "graphics/VertexLayout.hpp"
 
 namespace ouzel
 {
@@ -12,6 +15,22 @@ namespace ouzel
     {
         class Renderer;
 
+        // recycles the blocks that carry the data of a buffer to the render thread
+        class BufferStaging final
+        {
+        public:
+            BufferStaging();
+
+            std::vector<uint8_t> getBlock(uint32_t blockSize);
+            void returnBlock(std::vector<uint8_t>&& block);
+
+        private:
+            static constexpr size_t MAX_BLOCKS = 4;
+
+            std::mutex mutex;
+            std::vector<std::vector<uint8_t>> blocks;
+        };
+
         class Buffer final
         {
         public:
@@ -35,25 +54,41 @@ namespace ouzel
             Buffer(Renderer& initRenderer, Usage newUsage, uint32_t newFlags, uint32_t newSize = 0);
             Buffer(Renderer& initRenderer, Usage newUsage, uint32_t newFlags, const void* newData, uint32_t newSize);
             Buffer(Renderer& initRenderer, Usage newUsage, uint32_t newFlags, const std::vector<uint8_t>& newData, uint32_t newSize);
+            // vertex buffers that store the vertices in a layout other than VertexLayout::STANDARD
+            Buffer(Renderer& initRenderer, const VertexLayout& newLayout, uint32_t newFlags, uint32_t newSize = 0);
+            Buffer(Renderer& initRenderer, const VertexLayout& newLayout, uint32_t newFlags, const std::vector<uint8_t>& newData, uint32_t newSize);
 
             Buffer(const Buffer&) = delete;
             Buffer& operator=(const Buffer&) = delete;
 
             void setData(const void* newData, uint32_t newSize);
             void setData(const std::vector<uint8_t>& newData);
+            void setData(std::vector<uint8_t>&& newData);
+
+            // returns a recycled staging block that the caller fills in place of building a separate vector,
+            // the block is handed over to the render thread without a copy when unmap is called
+            void* map(uint32_t mapSize);
+            void unmap();
 
             inline uintptr_t getResource() const { return resource.getId(); }
 
             inline Usage getUsage() const { return usage; }
             inline uint32_t getFlags() const { return flags; }
             inline uint32_t getSize() const { return size; }
+            inline const VertexLayout& getLayout() const { return layout; }
 
         private:
+            void sendData(std::vector<uint8_t>&& newData);
+
             Resource resource;
 
             Buffer::Usage usage;
             uint32_t flags = 0;
             uint32_t size = 0;
+            VertexLayout layout;
+            std::shared_ptr<BufferStaging> staging;
+            std::vector<uint8_t> mappedData;
+            bool mapped = false;
         };
     } // namespace graphics
 } // namespace ouzel
@@ -52,6 +52,7 @@ namespace ouzel
                 SET_SHADER_CONSTANTS,
                 INIT_TEXTURE,
                 SET_TEXTURE_DATA,
+                SET_TEXTURE_REGION_DATA,
                 SET_TEXTURE_PARAMETERS,
                 SET_TEXTURES
             };
@@ -367,6 +368,8 @@ namespace ouzel
                         uint32_t initIndexCount,
                         uint32_t initIndexSize,
                         uintptr_t initVertexBuffer,
+                        uintptr_t initInstanceBuffer,
+                        uint32_t initInstanceCount,
                         DrawMode initDrawMode,
                         uint32_t initStartIndex):
                 Command(Command::Type::DRAW),
@@ -374,6 +377,8 @@ namespace ouzel
                 indexCount(initIndexCount),
                 indexSize(initIndexSize),
                 vertexBuffer(initVertexBuffer),
+                instanceBuffer(initInstanceBuffer),
+                instanceCount(initInstanceCount),
                 drawMode(initDrawMode),
                 startIndex(initStartIndex)
             {
@@ -383,6 +388,8 @@ namespace ouzel
             uint32_t indexCount;
             uint32_t indexSize;
             uintptr_t vertexBuffer;
+            uintptr_t instanceBuffer; // 0 for non-instanced draws
+            uint32_t instanceCount;
             DrawMode drawMode;
             uint32_t startIndex;
         };
@@ -449,13 +456,15 @@ namespace ouzel
                               Buffer::Usage initUsage,
                               uint32_t initFlags,
                               const std::vector<uint8_t>& initData,
-                              uint32_t initSize):
+                              uint32_t initSize,
+                              const VertexLayout& initLayout):
                 Command(Command::Type::INIT_BUFFER),
                 buffer(initBuffer),
                 usage(initUsage),
                 flags(initFlags),
                 data(initData),
-                size(initSize)
+                size(initSize),
+                layout(initLayout)
             {
             }
 
@@ -464,6 +473,7 @@ namespace ouzel
             uint32_t flags;
             std::vector<uint8_t> data;
             uint32_t size;
+            VertexLayout layout;
         };
 
         class SetBufferDataCommand: public Command
@@ -477,8 +487,32 @@ namespace ouzel
             {
             }
 
+            SetBufferDataCommand(uintptr_t initBuffer,
+                                 std::vector<uint8_t>&& initData):
+                Command(Command::Type::SET_BUFFER_DATA),
+                buffer(initBuffer),
+                data(std::move(initData))
+            {
+            }
+
+            SetBufferDataCommand(uintptr_t initBuffer,
+                                 std::vector<uint8_t>&& initData,
+                                 const std::shared_ptr<BufferStaging>& initStaging):
+                Command(Command::Type::SET_BUFFER_DATA),
+                buffer(initBuffer),
+                data(std::move(initData)),
+                staging(initStaging)
+            {
+            }
+
+            ~SetBufferDataCommand()
+            {
+                if (staging) staging->returnBlock(std::move(data));
+            }
+
             uintptr_t buffer;
             std::vector<uint8_t> data;
+            std::shared_ptr<BufferStaging> staging;
         };
 
         class InitShaderCommand: public Command
@@ -577,6 +611,28 @@ namespace ouzel
             std::vector<Texture::Level> levels;
         };
 
+        // updates a rectangle of the first mip level, data is tightly packed
+        class SetTextureRegionDataCommand: public Command
+        {
+        public:
+            SetTextureRegionDataCommand(uintptr_t initTexture,
+                                        const Vector2<uint32_t>& initOffset,
+                                        const Size2<uint32_t>& initSize,
+                                        std::vector<uint8_t>&& initData):
+                Command(Command::Type::SET_TEXTURE_REGION_DATA),
+                texture(initTexture),
+                offset(initOffset),
+                size(initSize),
+                data(std::move(initData))
+            {
+            }
+
+            uintptr_t texture;
+            Vector2<uint32_t> offset;
+            Size2<uint32_t> size;
+            std::vector<uint8_t> data;
+        };
+
         class SetTextureParametersCommand: public Command
         {
         public:
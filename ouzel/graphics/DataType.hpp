@@ -65,6 +65,10 @@ namespace ouzel
             INTEGER_VECTOR4,
             UNSIGNED_INTEGER_VECTOR4,
 
+            HALF_FLOAT,
+            HALF_FLOAT_VECTOR2,
+            HALF_FLOAT_VECTOR4,
+
             FLOAT,
             FLOAT_VECTOR2,
             FLOAT_VECTOR3,
@@ -135,6 +139,13 @@ namespace ouzel
                 case DataType::UNSIGNED_INTEGER_VECTOR4:
                     return 4 * sizeof(uint32_t);
 
+                case DataType::HALF_FLOAT:
+                    return sizeof(uint16_t);
+                case DataType::HALF_FLOAT_VECTOR2:
+                    return 2 * sizeof(uint16_t);
+                case DataType::HALF_FLOAT_VECTOR4:
+                    return 4 * sizeof(uint16_t);
+
                 case DataType::FLOAT:
                     return sizeof(float);
                 case DataType::FLOAT_VECTOR2:
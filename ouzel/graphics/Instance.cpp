@@ -0,0 +1,14 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#include "Instance.hpp"
+
+namespace ouzel
+{
+    namespace graphics
+    {
+        const std::vector<Vertex::Attribute> Instance::ATTRIBUTES = {
+            Vertex::Attribute(Vertex::Attribute::Usage::INSTANCE_TRANSFORM, DataType::FLOAT_VECTOR4),
+            Vertex::Attribute(Vertex::Attribute::Usage::INSTANCE_COLOR, DataType::UNSIGNED_BYTE_VECTOR4_NORM)
+        };
+    } // namespace graphics
+} // namespace ouzel
@@ -0,0 +1,35 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_GRAPHICS_INSTANCE_HPP
+#define OUZEL_GRAPHICS_INSTANCE_HPP
+
+#include <vector>
+#include "graphics/Vertex.hpp"
+#include "math/Vector2.hpp"
+#include "math/Color.hpp"
+
+namespace ouzel
+{
+    namespace graphics
+    {
+        // per-instance data of an instanced quad, the quad corners come from the vertex buffer
+        class Instance final
+        {
+        public:
+            static const std::vector<Vertex::Attribute> ATTRIBUTES;
+
+            Instance() {}
+            Instance(const Vector2<float>& initPosition, float initSize, float initRotation, Color initColor):
+                position(initPosition), size(initSize), rotation(initRotation), color(initColor)
+            {
+            }
+
+            Vector2<float> position;
+            float size = 0.0F; // scale of the quad corners
+            float rotation = 0.0F; // in radians
+            Color color;
+        };
+    } // namespace graphics
+} // namespace ouzel
+
+#endif // OUZEL_GRAPHICS_INSTANCE_HPP
@@ -1,7 +1,13 @@
 // Copyright 2015-2018 Elviss Strazdins. All rights reserved.
 
 #include <algorithm>
+#include <iomanip>
+#include <sstream>
 #include "RenderDevice.hpp"
+#include "core/Engine.hpp"
+#include "files/FileSystem.hpp"
+#include "utils/Log.hpp"
+#include "stb_image_write.h"
 
 namespace ouzel
 {
@@ -16,8 +22,13 @@ namespace ouzel
         {
         }
 
+        // continuous capture skips frames while this many are still being encoded
+        static constexpr size_t MAX_CAPTURE_TASKS = 4;
+
         RenderDevice::~RenderDevice()
         {
+            for (std::future<void>& task : captureTasks)
+                task.wait();
         }
 
         void RenderDevice::init(Window* newWindow,
@@ -40,6 +51,9 @@ namespace ouzel
             debugRenderer = newDebugRenderer;
 
             previousFrameTime = std::chrono::steady_clock::now();
+
+            // raw frame captures are written as uncompressed TGA
+            stbi_write_tga_with_rle = 0;
         }
 
         void RenderDevice::process()
@@ -73,8 +87,114 @@ namespace ouzel
             return std::vector<Size2<uint32_t>>();
         }
 
-        void RenderDevice::generateScreenshot(const std::string&)
+        void RenderDevice::generateScreenshot(const std::string& filename)
+        {
+            pendingCaptures.push_back({filename, CaptureFormat::PNG});
+        }
+
+        void RenderDevice::startFrameCapture(const std::string& directory, float interval, CaptureFormat format)
+        {
+            frameCapture = true;
+            frameCaptureDirectory = directory;
+            frameCaptureInterval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(interval));
+            frameCaptureFormat = format;
+            lastFrameCaptureTime = std::chrono::steady_clock::time_point();
+            frameCaptureIndex = 0;
+        }
+
+        void RenderDevice::stopFrameCapture()
+        {
+            frameCapture = false;
+        }
+
+        std::vector<RenderDevice::Capture> RenderDevice::getFrameCaptures()
+        {
+            for (auto i = captureTasks.begin(); i != captureTasks.end();)
+            {
+                if (i->wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+                {
+                    try
+                    {
+                        i->get();
+                    }
+                    catch (const std::exception& e)
+                    {
+                        engine->log(Log::Level::ERR) << e.what();
+                    }
+
+                    i = captureTasks.erase(i);
+                }
+                else
+                    ++i;
+            }
+
+            std::vector<Capture> result = std::move(pendingCaptures);
+            pendingCaptures.clear();
+
+            if (frameCapture && captureTasks.size() < MAX_CAPTURE_TASKS)
+            {
+                std::chrono::steady_clock::time_point currentTime = std::chrono::steady_clock::now();
+
+                if (currentTime - lastFrameCaptureTime >= frameCaptureInterval)
+                {
+                    lastFrameCaptureTime = currentTime;
+
+                    std::ostringstream filename;
+                    filename << frameCaptureDirectory << FileSystem::DIRECTORY_SEPARATOR <<
+                        "frame" << std::setw(6) << std::setfill('0') << frameCaptureIndex++ <<
+                        ((frameCaptureFormat == CaptureFormat::PNG) ? ".png" : ".tga");
+
+                    result.push_back({filename.str(), frameCaptureFormat});
+                }
+            }
+
+            return result;
+        }
+
+        void RenderDevice::saveCaptures(std::vector<Capture>&& captures,
+                                        std::vector<uint8_t>&& data,
+                                        uint32_t width, uint32_t height,
+                                        bool flip, bool bgra)
         {
+            auto captureData = std::make_shared<std::vector<uint8_t>>(std::move(data));
+            auto captureFiles = std::make_shared<std::vector<Capture>>(std::move(captures));
+
+            captureTasks.push_back(engine->getThreadPool().run([captureData, captureFiles, width, height, flip, bgra]() {
+                std::vector<uint8_t>& pixels = *captureData;
+                const size_t pitch = width * 4;
+
+                if (flip)
+                {
+                    for (uint32_t row = 0; row < height / 2; ++row)
+                        std::swap_ranges(pixels.begin() + static_cast<std::ptrdiff_t>(row * pitch),
+                                         pixels.begin() + static_cast<std::ptrdiff_t>((row + 1) * pitch),
+                                         pixels.begin() + static_cast<std::ptrdiff_t>((height - row - 1) * pitch));
+                }
+
+                if (bgra)
+                {
+                    for (size_t i = 0; i < pixels.size(); i += 4)
+                    {
+                        std::swap(pixels[i], pixels[i + 2]);
+                        pixels[i + 3] = 255;
+                    }
+                }
+
+                for (const Capture& capture : *captureFiles)
+                {
+                    int result;
+
+                    if (capture.format == CaptureFormat::PNG)
+                        result = stbi_write_png(capture.filename.c_str(), static_cast<int>(width), static_cast<int>(height),
+                                                4, pixels.data(), static_cast<int>(pitch));
+                    else
+                        result = stbi_write_tga(capture.filename.c_str(), static_cast<int>(width), static_cast<int>(height),
+                                                4, pixels.data());
+
+                    if (!result)
+                        throw std::runtime_error("Failed to save image to file " + capture.filename);
+                }
+            }));
         }
 
         void RenderDevice::executeOnRenderThread(const std::function<void()>& func)
@@ -4,10 +4,14 @@
 #define OUZEL_GRAPHICS_RENDERDEVICE_HPP
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <future>
 #include <mutex>
 #include <queue>
 #include <set>
+#include <string>
+#include <vector>
 #include "graphics/Commands.hpp"
 #include "graphics/Driver.hpp"
 #include "graphics/Texture.hpp"
@@ -44,6 +48,12 @@ namespace ouzel
                 Type type;
             };
 
+            enum class CaptureFormat
+            {
+                PNG,
+                RAW // uncompressed TGA
+            };
+
             RenderDevice(Driver initDriver, const std::function<void(const Event&)>& initCallback);
             virtual ~RenderDevice();
 
@@ -79,6 +89,7 @@ namespace ouzel
             inline bool isNPOTTexturesSupported() const { return npotTexturesSupported; }
             inline bool isAnisotropicFilteringSupported() const { return anisotropicFilteringSupported; }
             inline bool isRenderTargetsSupported() const { return renderTargetsSupported; }
+            inline bool isInstancingSupported() const { return instancingSupported; }
 
             const Matrix4<float>& getProjectionTransform(bool renderTarget) const
             {
@@ -109,7 +120,20 @@ namespace ouzel
                 deletedResourceIds.insert(resourceId);
             }
 
+            // must be called on the render thread, the frame is read back without waiting for the GPU
+            // and encoded on a worker thread
+            void generateScreenshot(const std::string& filename);
+            // captures a frame every interval seconds (every frame if interval is zero) to the directory
+            void startFrameCapture(const std::string& directory, float interval, CaptureFormat format);
+            void stopFrameCapture();
+
         protected:
+            struct Capture final
+            {
+                std::string filename;
+                CaptureFormat format;
+            };
+
             virtual void init(Window* newWindow,
                               const Size2<uint32_t>& newSize,
                               uint32_t newSampleCount,
@@ -122,7 +146,13 @@ namespace ouzel
 
             void executeAll();
 
-            virtual void generateScreenshot(const std::string& filename);
+            // returns the captures that were requested for the frame that is about to be presented
+            std::vector<Capture> getFrameCaptures();
+            // flips and encodes the pixels on a worker thread, the data must be tightly packed RGBA or BGRA
+            void saveCaptures(std::vector<Capture>&& captures,
+                              std::vector<uint8_t>&& data,
+                              uint32_t width, uint32_t height,
+                              bool flip, bool bgra);
 
             Driver driver;
             std::function<void(const Event&)> callback;
@@ -144,6 +174,7 @@ namespace ouzel
             bool npotTexturesSupported = true;
             bool anisotropicFilteringSupported = true;
             bool renderTargetsSupported = true;
+            bool instancingSupported = true;
 
             Matrix4<float> projectionTransform;
             Matrix4<float> renderTargetProjectionTransform;
@@ -166,6 +197,18 @@ namespace ouzel
 
             uintptr_t lastResourceId = 0;
             std::set<uintptr_t> deletedResourceIds;
+
+        private:
+            std::vector<Capture> pendingCaptures;
+
+            bool frameCapture = false;
+            std::string frameCaptureDirectory;
+            std::chrono::steady_clock::duration frameCaptureInterval;
+            CaptureFormat frameCaptureFormat = CaptureFormat::PNG;
+            std::chrono::steady_clock::time_point lastFrameCaptureTime;
+            uint32_t frameCaptureIndex = 0;
+
+            std::vector<std::future<void>> captureTasks;
         };
     } // namespace graphics
 } // namespace ouzel
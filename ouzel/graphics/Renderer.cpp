@@ -200,6 +200,16 @@ namespace ouzel
             device->executeOnRenderThread(std::bind(&RenderDevice::generateScreenshot, device.get(), filename));
         }
 
+        void Renderer::startFrameCapture(const std::string& directory, float interval, RenderDevice::CaptureFormat format)
+        {
+            device->executeOnRenderThread(std::bind(&RenderDevice::startFrameCapture, device.get(), directory, interval, format));
+        }
+
+        void Renderer::stopFrameCapture()
+        {
+            device->executeOnRenderThread(std::bind(&RenderDevice::stopFrameCapture, device.get()));
+        }
+
         void Renderer::setRenderTarget(uintptr_t renderTarget)
         {
             addCommand(std::unique_ptr<Command>(new SetRenderTargetCommand(renderTarget)));
@@ -267,6 +277,33 @@ namespace ouzel
                                                                 indexCount,
                                                                 indexSize,
                                                                 vertexBuffer,
+                                                                0,
+                                                                0,
+                                                                drawMode,
+                                                                startIndex)));
+        }
+
+        void Renderer::draw(uintptr_t indexBuffer,
+                            uint32_t indexCount,
+                            uint32_t indexSize,
+                            uintptr_t vertexBuffer,
+                            uintptr_t instanceBuffer,
+                            uint32_t instanceCount,
+                            DrawMode drawMode,
+                            uint32_t startIndex)
+        {
+            if (!indexBuffer || !vertexBuffer || !instanceBuffer)
+                throw std::runtime_error("Invalid mesh buffer passed to render queue");
+
+            if (!device->isInstancingSupported())
+                throw std::runtime_error("Instancing is not supported");
+
+            addCommand(std::unique_ptr<Command>(new DrawCommand(indexBuffer,
+                                                                indexCount,
+                                                                indexSize,
+                                                                vertexBuffer,
+                                                                instanceBuffer,
+                                                                instanceCount,
                                                                 drawMode,
                                                                 startIndex)));
         }
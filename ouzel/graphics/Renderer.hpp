@@ -52,6 +52,9 @@ namespace ouzel
             inline const Size2<uint32_t>& getSize() const { return size; }
 
             void saveScreenshot(const std::string& filename);
+            void startFrameCapture(const std::string& directory, float interval,
+                                   RenderDevice::CaptureFormat format = RenderDevice::CaptureFormat::PNG);
+            void stopFrameCapture();
 
             void setRenderTarget(uintptr_t renderTarget);
             void clearRenderTarget(bool clearColorBuffer,
@@ -74,6 +77,15 @@ namespace ouzel
                       uintptr_t vertexBuffer,
                       DrawMode drawMode,
                       uint32_t startIndex);
+            // draws the mesh instanceCount times with graphics::Instance data from the instance buffer
+            void draw(uintptr_t indexBuffer,
+                      uint32_t indexCount,
+                      uint32_t indexSize,
+                      uintptr_t vertexBuffer,
+                      uintptr_t instanceBuffer,
+                      uint32_t instanceCount,
+                      DrawMode drawMode,
+                      uint32_t startIndex);
             void pushDebugMarker(const std::string& name);
             void popDebugMarker();
             void setShaderConstants(std::vector<std::vector<float>> fragmentShaderConstants,
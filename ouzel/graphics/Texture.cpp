@@ -579,6 +579,30 @@ namespace ouzel
                                                                                                       levels)));
         }
 
+        void Texture::setData(const std::vector<uint8_t>& newData,
+                              const Vector2<uint32_t>& offset,
+                              const Size2<uint32_t>& regionSize)
+        {
+            if (!(flags & Texture::DYNAMIC) || flags & Texture::BIND_RENDER_TARGET)
+                throw std::runtime_error("Texture is not dynamic");
+
+            if (offset.v[0] + regionSize.v[0] > size.v[0] ||
+                offset.v[1] + regionSize.v[1] > size.v[1])
+                throw std::runtime_error("Invalid texture region");
+
+            if (newData.size() != regionSize.v[0] * regionSize.v[1] * getPixelSize(pixelFormat))
+                throw std::runtime_error("Invalid texture region data size");
+
+            if (resource.getId())
+            {
+                std::vector<uint8_t> data = newData;
+                resource.getRenderer()->addCommand(std::unique_ptr<Command>(new SetTextureRegionDataCommand(resource.getId(),
+                                                                                                            offset,
+                                                                                                            regionSize,
+                                                                                                            std::move(data))));
+            }
+        }
+
         void Texture::setFilter(Filter newFilter)
         {
             filter = newFilter;
@@ -8,6 +8,7 @@
 #include "graphics/PixelFormat.hpp"
 #include "math/Color.hpp"
 #include "math/Size2.hpp"
+#include "math/Vector2.hpp"
 
 namespace ouzel
 {
@@ -90,6 +91,10 @@ namespace ouzel
             inline const Size2<uint32_t>& getSize() const { return size; }
 
             void setData(const std::vector<uint8_t>& newData);
+            // updates only a rectangle of the first mip level, newData holds regionSize pixels without padding
+            void setData(const std::vector<uint8_t>& newData,
+                         const Vector2<uint32_t>& offset,
+                         const Size2<uint32_t>& regionSize);
 
             inline uint32_t getFlags() const { return flags; }
             inline uint32_t getMipmaps() const { return mipmaps; }
@@ -32,7 +32,9 @@ namespace ouzel
                     POINT_SIZE,
                     TANGENT,
                     TEXTURE_COORDINATES0,
-                    TEXTURE_COORDINATES1
+                    TEXTURE_COORDINATES1,
+                    INSTANCE_TRANSFORM,
+                    INSTANCE_COLOR
                 };
 
                 Attribute(Usage initUsage, DataType initDataType):
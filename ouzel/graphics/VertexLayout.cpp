@@ -0,0 +1,334 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include "VertexLayout.hpp"
+
+namespace ouzel
+{
+    namespace graphics
+    {
+        // the layouts are built from their own attribute lists, Vertex::ATTRIBUTES might not be initialized yet
+        const VertexLayout VertexLayout::STANDARD({
+            Vertex::Attribute(Vertex::Attribute::Usage::POSITION, DataType::FLOAT_VECTOR3),
+            Vertex::Attribute(Vertex::Attribute::Usage::COLOR, DataType::UNSIGNED_BYTE_VECTOR4_NORM),
+            Vertex::Attribute(Vertex::Attribute::Usage::TEXTURE_COORDINATES0, DataType::FLOAT_VECTOR2),
+            Vertex::Attribute(Vertex::Attribute::Usage::TEXTURE_COORDINATES1, DataType::FLOAT_VECTOR2),
+            Vertex::Attribute(Vertex::Attribute::Usage::NORMAL, DataType::FLOAT_VECTOR3)
+        });
+
+        const VertexLayout VertexLayout::POSITION({
+            Vertex::Attribute(Vertex::Attribute::Usage::POSITION, DataType::FLOAT_VECTOR3)
+        });
+
+        const VertexLayout VertexLayout::COMPACT_2D({
+            Vertex::Attribute(Vertex::Attribute::Usage::POSITION, DataType::FLOAT_VECTOR3),
+            Vertex::Attribute(Vertex::Attribute::Usage::COLOR, DataType::UNSIGNED_BYTE_VECTOR4_NORM),
+            Vertex::Attribute(Vertex::Attribute::Usage::TEXTURE_COORDINATES0, DataType::UNSIGNED_SHORT_VECTOR2_NORM)
+        });
+
+        const VertexLayout VertexLayout::COMPACT_3D({
+            Vertex::Attribute(Vertex::Attribute::Usage::POSITION, DataType::FLOAT_VECTOR3),
+            Vertex::Attribute(Vertex::Attribute::Usage::COLOR, DataType::UNSIGNED_BYTE_VECTOR4_NORM),
+            Vertex::Attribute(Vertex::Attribute::Usage::TEXTURE_COORDINATES0, DataType::HALF_FLOAT_VECTOR2),
+            Vertex::Attribute(Vertex::Attribute::Usage::NORMAL, DataType::BYTE_VECTOR4_NORM)
+        });
+
+        enum class Scalar
+        {
+            BYTE,
+            BYTE_NORM,
+            UNSIGNED_BYTE,
+            UNSIGNED_BYTE_NORM,
+            SHORT,
+            SHORT_NORM,
+            UNSIGNED_SHORT,
+            UNSIGNED_SHORT_NORM,
+            INTEGER,
+            UNSIGNED_INTEGER,
+            HALF_FLOAT,
+            FLOAT
+        };
+
+        static uint32_t getComponents(DataType dataType, Scalar& scalar)
+        {
+            switch (dataType)
+            {
+                case DataType::BYTE: scalar = Scalar::BYTE; return 1;
+                case DataType::BYTE_NORM: scalar = Scalar::BYTE_NORM; return 1;
+                case DataType::UNSIGNED_BYTE: scalar = Scalar::UNSIGNED_BYTE; return 1;
+                case DataType::UNSIGNED_BYTE_NORM: scalar = Scalar::UNSIGNED_BYTE_NORM; return 1;
+                case DataType::BYTE_VECTOR2: scalar = Scalar::BYTE; return 2;
+                case DataType::BYTE_VECTOR2_NORM: scalar = Scalar::BYTE_NORM; return 2;
+                case DataType::UNSIGNED_BYTE_VECTOR2: scalar = Scalar::UNSIGNED_BYTE; return 2;
+                case DataType::UNSIGNED_BYTE_VECTOR2_NORM: scalar = Scalar::UNSIGNED_BYTE_NORM; return 2;
+                case DataType::BYTE_VECTOR3: scalar = Scalar::BYTE; return 3;
+                case DataType::BYTE_VECTOR3_NORM: scalar = Scalar::BYTE_NORM; return 3;
+                case DataType::UNSIGNED_BYTE_VECTOR3: scalar = Scalar::UNSIGNED_BYTE; return 3;
+                case DataType::UNSIGNED_BYTE_VECTOR3_NORM: scalar = Scalar::UNSIGNED_BYTE_NORM; return 3;
+                case DataType::BYTE_VECTOR4: scalar = Scalar::BYTE; return 4;
+                case DataType::BYTE_VECTOR4_NORM: scalar = Scalar::BYTE_NORM; return 4;
+                case DataType::UNSIGNED_BYTE_VECTOR4: scalar = Scalar::UNSIGNED_BYTE; return 4;
+                case DataType::UNSIGNED_BYTE_VECTOR4_NORM: scalar = Scalar::UNSIGNED_BYTE_NORM; return 4;
+
+                case DataType::SHORT: scalar = Scalar::SHORT; return 1;
+                case DataType::SHORT_NORM: scalar = Scalar::SHORT_NORM; return 1;
+                case DataType::UNSIGNED_SHORT: scalar = Scalar::UNSIGNED_SHORT; return 1;
+                case DataType::UNSIGNED_SHORT_NORM: scalar = Scalar::UNSIGNED_SHORT_NORM; return 1;
+                case DataType::SHORT_VECTOR2: scalar = Scalar::SHORT; return 2;
+                case DataType::SHORT_VECTOR2_NORM: scalar = Scalar::SHORT_NORM; return 2;
+                case DataType::UNSIGNED_SHORT_VECTOR2: scalar = Scalar::UNSIGNED_SHORT; return 2;
+                case DataType::UNSIGNED_SHORT_VECTOR2_NORM: scalar = Scalar::UNSIGNED_SHORT_NORM; return 2;
+                case DataType::SHORT_VECTOR3: scalar = Scalar::SHORT; return 3;
+                case DataType::SHORT_VECTOR3_NORM: scalar = Scalar::SHORT_NORM; return 3;
+                case DataType::UNSIGNED_SHORT_VECTOR3: scalar = Scalar::UNSIGNED_SHORT; return 3;
+                case DataType::UNSIGNED_SHORT_VECTOR3_NORM: scalar = Scalar::UNSIGNED_SHORT_NORM; return 3;
+                case DataType::SHORT_VECTOR4: scalar = Scalar::SHORT; return 4;
+                case DataType::SHORT_VECTOR4_NORM: scalar = Scalar::SHORT_NORM; return 4;
+                case DataType::UNSIGNED_SHORT_VECTOR4: scalar = Scalar::UNSIGNED_SHORT; return 4;
+                case DataType::UNSIGNED_SHORT_VECTOR4_NORM: scalar = Scalar::UNSIGNED_SHORT_NORM; return 4;
+
+                case DataType::INTEGER: scalar = Scalar::INTEGER; return 1;
+                case DataType::UNSIGNED_INTEGER: scalar = Scalar::UNSIGNED_INTEGER; return 1;
+                case DataType::INTEGER_VECTOR2: scalar = Scalar::INTEGER; return 2;
+                case DataType::UNSIGNED_INTEGER_VECTOR2: scalar = Scalar::UNSIGNED_INTEGER; return 2;
+                case DataType::INTEGER_VECTOR3: scalar = Scalar::INTEGER; return 3;
+                case DataType::UNSIGNED_INTEGER_VECTOR3: scalar = Scalar::UNSIGNED_INTEGER; return 3;
+                case DataType::INTEGER_VECTOR4: scalar = Scalar::INTEGER; return 4;
+                case DataType::UNSIGNED_INTEGER_VECTOR4: scalar = Scalar::UNSIGNED_INTEGER; return 4;
+
+                case DataType::HALF_FLOAT: scalar = Scalar::HALF_FLOAT; return 1;
+                case DataType::HALF_FLOAT_VECTOR2: scalar = Scalar::HALF_FLOAT; return 2;
+                case DataType::HALF_FLOAT_VECTOR4: scalar = Scalar::HALF_FLOAT; return 4;
+
+                case DataType::FLOAT: scalar = Scalar::FLOAT; return 1;
+                case DataType::FLOAT_VECTOR2: scalar = Scalar::FLOAT; return 2;
+                case DataType::FLOAT_VECTOR3: scalar = Scalar::FLOAT; return 3;
+                case DataType::FLOAT_VECTOR4: scalar = Scalar::FLOAT; return 4;
+
+                default:
+                    throw std::runtime_error("Invalid vertex attribute data type");
+            }
+        }
+
+        static uint16_t floatToHalf(float value)
+        {
+            uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+
+            uint32_t sign = (bits >> 16) & 0x8000;
+            uint32_t mantissa = bits & 0x007FFFFF;
+            int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xFF) - 127 + 15;
+
+            if (((bits >> 23) & 0xFF) == 0xFF) // infinity or NaN
+                return static_cast<uint16_t>(sign | 0x7C00 | (mantissa ? 0x0200 : 0));
+
+            if (exponent >= 0x1F) // too large, clamp to infinity
+                return static_cast<uint16_t>(sign | 0x7C00);
+
+            if (exponent <= 0) // denormalized half
+            {
+                if (exponent < -10) return static_cast<uint16_t>(sign);
+
+                mantissa |= 0x00800000;
+                uint32_t shift = static_cast<uint32_t>(14 - exponent);
+                uint32_t result = mantissa >> shift;
+                if ((mantissa >> (shift - 1)) & 0x01) ++result;
+
+                return static_cast<uint16_t>(sign | result);
+            }
+
+            // rounding may carry into the exponent, which is still the correct result
+            uint32_t result = sign | (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+            if (mantissa & 0x1000) ++result;
+
+            return static_cast<uint16_t>(result);
+        }
+
+        template<class T>
+        static void store(uint8_t* destination, T value)
+        {
+            std::memcpy(destination, &value, sizeof(value));
+        }
+
+        static uint32_t storeComponent(uint8_t* destination, Scalar scalar, float value)
+        {
+            switch (scalar)
+            {
+                case Scalar::BYTE:
+                    store(destination, static_cast<int8_t>(value));
+                    return sizeof(int8_t);
+                case Scalar::BYTE_NORM:
+                    store(destination, static_cast<int8_t>(std::round(std::max(-1.0F, std::min(1.0F, value)) * 127.0F)));
+                    return sizeof(int8_t);
+                case Scalar::UNSIGNED_BYTE:
+                    store(destination, static_cast<uint8_t>(value));
+                    return sizeof(uint8_t);
+                case Scalar::UNSIGNED_BYTE_NORM:
+                    store(destination, static_cast<uint8_t>(std::round(std::max(0.0F, std::min(1.0F, value)) * 255.0F)));
+                    return sizeof(uint8_t);
+                case Scalar::SHORT:
+                    store(destination, static_cast<int16_t>(value));
+                    return sizeof(int16_t);
+                case Scalar::SHORT_NORM:
+                    store(destination, static_cast<int16_t>(std::round(std::max(-1.0F, std::min(1.0F, value)) * 32767.0F)));
+                    return sizeof(int16_t);
+                case Scalar::UNSIGNED_SHORT:
+                    store(destination, static_cast<uint16_t>(value));
+                    return sizeof(uint16_t);
+                case Scalar::UNSIGNED_SHORT_NORM:
+                    store(destination, static_cast<uint16_t>(std::round(std::max(0.0F, std::min(1.0F, value)) * 65535.0F)));
+                    return sizeof(uint16_t);
+                case Scalar::INTEGER:
+                    store(destination, static_cast<int32_t>(value));
+                    return sizeof(int32_t);
+                case Scalar::UNSIGNED_INTEGER:
+                    store(destination, static_cast<uint32_t>(value));
+                    return sizeof(uint32_t);
+                case Scalar::HALF_FLOAT:
+                    store(destination, floatToHalf(value));
+                    return sizeof(uint16_t);
+                case Scalar::FLOAT:
+                    store(destination, value);
+                    return sizeof(float);
+            }
+
+            return 0;
+        }
+
+        // unsigned normalized formats can only hold texture coordinates in the [0, 1] range
+        static bool canStoreTexCoord(Scalar scalar, const Vector2<float>& texCoord)
+        {
+            if (scalar != Scalar::UNSIGNED_BYTE_NORM && scalar != Scalar::UNSIGNED_SHORT_NORM) return true;
+
+            return texCoord.v[0] >= 0.0F && texCoord.v[0] <= 1.0F &&
+                texCoord.v[1] >= 0.0F && texCoord.v[1] <= 1.0F;
+        }
+
+        VertexLayout::VertexLayout(const std::vector<Vertex::Attribute>& attributes)
+        {
+            for (const Vertex::Attribute& attribute : attributes)
+            {
+                uint32_t size = getDataTypeSize(attribute.dataType);
+                if (!size) throw std::runtime_error("Invalid vertex attribute data type");
+
+                elements.push_back({attribute.usage, attribute.dataType, stride});
+                stride += (size + 3) & ~3U;
+            }
+        }
+
+        const VertexLayout::Element* VertexLayout::getElement(Vertex::Attribute::Usage usage) const
+        {
+            for (const Element& element : elements)
+                if (element.usage == usage) return &element;
+
+            return nullptr;
+        }
+
+        bool VertexLayout::canPack(const Vertex* vertices, size_t count) const
+        {
+            for (const Element& element : elements)
+            {
+                if (element.usage != Vertex::Attribute::Usage::TEXTURE_COORDINATES0 &&
+                    element.usage != Vertex::Attribute::Usage::TEXTURE_COORDINATES1)
+                    continue;
+
+                Scalar scalar;
+                getComponents(element.dataType, scalar);
+                size_t index = element.usage == Vertex::Attribute::Usage::TEXTURE_COORDINATES0 ? 0 : 1;
+
+                for (size_t i = 0; i < count; ++i)
+                    if (!canStoreTexCoord(scalar, vertices[i].texCoords[index])) return false;
+            }
+
+            return true;
+        }
+
+        void VertexLayout::pack(const Vertex* vertices, size_t count, std::vector<uint8_t>& result) const
+        {
+            // reuses the storage of result if it is big enough
+            result.resize(count * stride);
+
+            for (const Element& element : elements)
+            {
+                Scalar scalar;
+                uint32_t components = getComponents(element.dataType, scalar);
+
+                for (size_t i = 0; i < count; ++i)
+                {
+                    const Vertex& vertex = vertices[i];
+                    float values[4];
+
+                    switch (element.usage)
+                    {
+                        case Vertex::Attribute::Usage::POSITION:
+                            values[0] = vertex.position.v[0];
+                            values[1] = vertex.position.v[1];
+                            values[2] = vertex.position.v[2];
+                            values[3] = 1.0F;
+                            break;
+                        case Vertex::Attribute::Usage::COLOR:
+                            values[0] = vertex.color.normR();
+                            values[1] = vertex.color.normG();
+                            values[2] = vertex.color.normB();
+                            values[3] = vertex.color.normA();
+                            break;
+                        case Vertex::Attribute::Usage::TEXTURE_COORDINATES0:
+                        case Vertex::Attribute::Usage::TEXTURE_COORDINATES1:
+                        {
+                            const Vector2<float>& texCoord = vertex.texCoords[element.usage == Vertex::Attribute::Usage::TEXTURE_COORDINATES0 ? 0 : 1];
+                            values[0] = texCoord.v[0];
+                            values[1] = texCoord.v[1];
+                            values[2] = 0.0F;
+                            values[3] = 0.0F;
+
+                            if (!canStoreTexCoord(scalar, texCoord))
+                                throw std::out_of_range("Texture coordinates outside of the normalized range");
+                            break;
+                        }
+                        case Vertex::Attribute::Usage::NORMAL:
+                            values[0] = vertex.normal.v[0];
+                            values[1] = vertex.normal.v[1];
+                            values[2] = vertex.normal.v[2];
+                            values[3] = 0.0F;
+                            break;
+                        default:
+                            throw std::runtime_error("Vertex has no data for the attribute");
+                    }
+
+                    uint8_t* destination = result.data() + i * stride + element.offset;
+
+                    for (uint32_t component = 0; component < components; ++component)
+                        destination += storeComponent(destination, scalar, values[component]);
+                }
+            }
+        }
+
+        bool VertexLayout::operator==(const VertexLayout& other) const
+        {
+            if (stride != other.stride || elements.size() != other.elements.size()) return false;
+
+            for (size_t i = 0; i < elements.size(); ++i)
+                if (elements[i].usage != other.elements[i].usage ||
+                    elements[i].dataType != other.elements[i].dataType)
+                    return false;
+
+            return true;
+        }
+
+        bool VertexLayout::operator<(const VertexLayout& other) const
+        {
+            if (elements.size() != other.elements.size()) return elements.size() < other.elements.size();
+
+            for (size_t i = 0; i < elements.size(); ++i)
+            {
+                if (elements[i].usage != other.elements[i].usage) return elements[i].usage < other.elements[i].usage;
+                if (elements[i].dataType != other.elements[i].dataType) return elements[i].dataType < other.elements[i].dataType;
+            }
+
+            return false;
+        }
+    } // namespace graphics
+} // namespace ouzel
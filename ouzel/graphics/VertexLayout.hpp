@@ -0,0 +1,80 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_GRAPHICS_VERTEXLAYOUT_HPP
+#define OUZEL_GRAPHICS_VERTEXLAYOUT_HPP
+
+#include <cstdint>
+#include <vector>
+#include "graphics/Vertex.hpp"
+
+namespace ouzel
+{
+    namespace graphics
+    {
+        // describes how the vertices are stored in a vertex buffer, attributes are laid out in
+        // the given order and each of them starts at a 4-byte boundary
+        class VertexLayout final
+        {
+        public:
+            struct Element final
+            {
+                Vertex::Attribute::Usage usage;
+                DataType dataType;
+                uint32_t offset;
+            };
+
+            // position, color, two float texture coordinates and normal (the Vertex class itself)
+            static const VertexLayout STANDARD;
+            // float position only, e.g. for depth-only passes
+            static const VertexLayout POSITION;
+            // float position, color and unsigned short normalized texture coordinates, texture coordinates
+            // outside the [0, 1] range (e.g. of repeated textures) can't be stored, use canPack to check them
+            static const VertexLayout COMPACT_2D;
+            // float position, color, half float texture coordinates and byte normalized normal
+            static const VertexLayout COMPACT_3D;
+
+            VertexLayout() {}
+            explicit VertexLayout(const std::vector<Vertex::Attribute>& attributes);
+
+            const Element* getElement(Vertex::Attribute::Usage usage) const;
+
+            inline const std::vector<Element>& getElements() const { return elements; }
+            inline uint32_t getStride() const { return stride; }
+
+            // whether the vertices can be stored in this layout without losing their values, pack throws for
+            // the ones that can't
+            bool canPack(const Vertex* vertices, size_t count) const;
+            inline bool canPack(const std::vector<Vertex>& vertices) const
+            {
+                return canPack(vertices.data(), vertices.size());
+            }
+
+            // converts the vertices to this layout
+            void pack(const Vertex* vertices, size_t count, std::vector<uint8_t>& result) const;
+            inline void pack(const std::vector<Vertex>& vertices, std::vector<uint8_t>& result) const
+            {
+                pack(vertices.data(), vertices.size(), result);
+            }
+            inline std::vector<uint8_t> pack(const Vertex* vertices, size_t count) const
+            {
+                std::vector<uint8_t> result;
+                pack(vertices, count, result);
+                return result;
+            }
+            inline std::vector<uint8_t> pack(const std::vector<Vertex>& vertices) const
+            {
+                return pack(vertices.data(), vertices.size());
+            }
+
+            bool operator==(const VertexLayout& other) const;
+            inline bool operator!=(const VertexLayout& other) const { return !(*this == other); }
+            bool operator<(const VertexLayout& other) const;
+
+        private:
+            std::vector<Element> elements;
+            uint32_t stride = 0;
+        };
+    } // namespace graphics
+} // namespace ouzel
+
+#endif // OUZEL_GRAPHICS_VERTEXLAYOUT_HPP
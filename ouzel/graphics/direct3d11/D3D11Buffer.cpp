@@ -11,16 +11,29 @@ namespace ouzel
 {
     namespace graphics
     {
+        // dynamic buffers can hold this many uploads of their size before they have to be discarded
+        static constexpr UINT STORAGE_COUNT = 4;
+        static constexpr UINT ALIGNMENT = 16;
+
         D3D11Buffer::D3D11Buffer(D3D11RenderDevice& renderDeviceD3D11,
                                  Buffer::Usage newUsage, uint32_t newFlags,
                                  const std::vector<uint8_t>& data,
-                                 uint32_t newSize):
+                                 uint32_t newSize,
+                                 const VertexLayout& newLayout):
             D3D11RenderResource(renderDeviceD3D11),
             usage(newUsage),
             flags(newFlags),
+            layout(newLayout),
             size(static_cast<UINT>(newSize))
         {
-            createBuffer(newSize, data);
+            if ((flags & Buffer::DYNAMIC) && newSize > 0)
+            {
+                // leave room for the uploads that follow, like setData does when it grows the buffer
+                createBuffer(static_cast<UINT>(newSize) * STORAGE_COUNT, std::vector<uint8_t>());
+                if (!data.empty()) uploadData(data, D3D11_MAP_WRITE_DISCARD);
+            }
+            else
+                createBuffer(newSize, data);
         }
 
         D3D11Buffer::~D3D11Buffer()
@@ -36,26 +49,40 @@ namespace ouzel
             if (data.empty())
                 throw std::runtime_error("Data is empty");
 
-            if (!buffer || data.size() > size)
-                createBuffer(static_cast<UINT>(data.size()), data);
-            else
+            UINT dataSize = static_cast<UINT>(data.size());
+
+            if (!buffer || dataSize > size)
             {
-                if (!data.empty())
-                {
-                    D3D11_MAPPED_SUBRESOURCE mappedSubresource;
-                    mappedSubresource.pData = nullptr;
-                    mappedSubresource.RowPitch = 0;
-                    mappedSubresource.DepthPitch = 0;
+                createBuffer(dataSize * STORAGE_COUNT, std::vector<uint8_t>());
+                uploadData(data, D3D11_MAP_WRITE_DISCARD);
+            }
+            else if (writeOffset + dataSize <= size)
+                uploadData(data, D3D11_MAP_WRITE_NO_OVERWRITE);
+            else
+                uploadData(data, D3D11_MAP_WRITE_DISCARD);
+        }
 
-                    HRESULT hr;
-                    if (FAILED(hr = renderDevice.getContext()->Map(buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedSubresource)))
-                        throw std::system_error(hr, direct3D11ErrorCategory, "Failed to lock Direct3D 11 buffer");
+        void D3D11Buffer::uploadData(const std::vector<uint8_t>& data, D3D11_MAP mapType)
+        {
+            // the GPU may still read the data before writeOffset, so append after it
+            // and discard the whole buffer only when it is full
+            if (mapType == D3D11_MAP_WRITE_DISCARD) writeOffset = 0;
 
-                    std::copy(data.begin(), data.end(), static_cast<uint8_t*>(mappedSubresource.pData));
+            D3D11_MAPPED_SUBRESOURCE mappedSubresource;
+            mappedSubresource.pData = nullptr;
+            mappedSubresource.RowPitch = 0;
+            mappedSubresource.DepthPitch = 0;
 
-                    renderDevice.getContext()->Unmap(buffer, 0);
-                }
-            }
+            HRESULT hr;
+            if (FAILED(hr = renderDevice.getContext()->Map(buffer, 0, mapType, 0, &mappedSubresource)))
+                throw std::system_error(hr, direct3D11ErrorCategory, "Failed to lock Direct3D 11 buffer");
+
+            offset = writeOffset;
+            std::copy(data.begin(), data.end(), static_cast<uint8_t*>(mappedSubresource.pData) + offset);
+
+            renderDevice.getContext()->Unmap(buffer, 0);
+
+            writeOffset = (offset + static_cast<UINT>(data.size()) + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
         }
 
         void D3D11Buffer::createBuffer(UINT newSize, const std::vector<uint8_t>& data)
@@ -66,6 +93,9 @@ namespace ouzel
                 buffer = nullptr;
             }
 
+            offset = 0;
+            writeOffset = 0;
+
             if (newSize)
             {
                 size = newSize;
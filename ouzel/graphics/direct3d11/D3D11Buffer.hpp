@@ -23,25 +23,33 @@ namespace ouzel
             D3D11Buffer(D3D11RenderDevice& renderDeviceD3D11,
                         Buffer::Usage newUsage, uint32_t newFlags,
                         const std::vector<uint8_t>& data,
-                        uint32_t newSize);
+                        uint32_t newSize,
+                        const VertexLayout& newLayout);
             ~D3D11Buffer();
 
             void setData(const std::vector<uint8_t>& data);
 
             inline uint32_t getFlags() const { return flags; }
             inline Buffer::Usage getUsage() const { return usage; }
+            inline const VertexLayout& getLayout() const { return layout; }
             inline UINT getSize() const { return size; }
+            // offset of the current data inside the buffer, dynamic buffers append to it until it is full
+            inline UINT getOffset() const { return offset; }
 
             ID3D11Buffer* getBuffer() const { return buffer; }
 
         private:
             void createBuffer(UINT newSize, const std::vector<uint8_t>& data);
+            void uploadData(const std::vector<uint8_t>& data, D3D11_MAP mapType);
 
             Buffer::Usage usage;
             uint32_t flags = 0;
+            VertexLayout layout;
 
             ID3D11Buffer* buffer = nullptr;
             UINT size = 0;
+            UINT offset = 0;
+            UINT writeOffset = 0;
         };
     } // namespace graphics
 } // namespace ouzel
@@ -4,6 +4,7 @@
 
 #if OUZEL_COMPILE_DIRECT3D11
 
+#include <algorithm>
 #include <cassert>
 #include "D3D11RenderDevice.hpp"
 #include "D3D11BlendState.hpp"
@@ -12,12 +13,12 @@
 #include "D3D11RenderTarget.hpp"
 #include "D3D11Shader.hpp"
 #include "D3D11Texture.hpp"
+#include "graphics/Instance.hpp"
 #include "core/Engine.hpp"
 #include "core/Window.hpp"
 #include "core/windows/NativeWindowWin.hpp"
 #include "utils/Log.hpp"
 #include "utils/Utils.hpp"
-#include "stb_image_write.h"
 
 namespace ouzel
 {
@@ -81,6 +82,12 @@ namespace ouzel
 
             resources.clear();
 
+            for (Readback& readback : readbacks)
+                if (readback.texture) readback.texture->Release();
+
+            if (resolveTexture)
+                resolveTexture->Release();
+
             if (defaultDepthStencilState)
                 defaultDepthStencilState->Release();
 
@@ -160,6 +167,9 @@ namespace ouzel
             if (featureLevel < D3D_FEATURE_LEVEL_10_0)
                 npotTexturesSupported = false;
 
+            if (featureLevel < D3D_FEATURE_LEVEL_9_3)
+                instancingSupported = false;
+
             IDXGIDevice* dxgiDevice;
             IDXGIFactory* factory;
 
@@ -369,6 +379,7 @@ namespace ouzel
                             if (currentRenderTarget)
                                 currentRenderTarget->resolve();
 
+                            captureFrame();
                             swapChain->Present(swapInterval, 0);
                             break;
                         }
@@ -629,11 +640,10 @@ namespace ouzel
                             {
                                 assert(shader->getFragmentShader());
                                 assert(shader->getVertexShader());
-                                assert(shader->getInputLayout());
 
+                                // the input layout depends on the buffers too, it is set at draw time
                                 context->PSSetShader(shader->getFragmentShader(), nullptr, 0);
                                 context->VSSetShader(shader->getVertexShader(), nullptr, 0);
-                                context->IASetInputLayout(shader->getInputLayout());
                             }
                             else
                             {
@@ -658,19 +668,46 @@ namespace ouzel
                             assert(vertexBuffer);
                             assert(vertexBuffer->getBuffer());
 
-                            ID3D11Buffer* buffers[] = {vertexBuffer->getBuffer()};
-                            UINT strides[] = {sizeof(Vertex)};
-                            UINT offsets[] = {0};
-                            context->IASetVertexBuffers(0, 1, buffers, strides, offsets);
                             context->IASetIndexBuffer(indexBuffer->getBuffer(),
-                                                      getIndexFormat(drawCommand->indexSize), 0);
+                                                      getIndexFormat(drawCommand->indexSize), indexBuffer->getOffset());
                             context->IASetPrimitiveTopology(getPrimitiveTopology(drawCommand->drawMode));
 
                             assert(drawCommand->indexCount);
                             assert(indexBuffer->getSize());
                             assert(vertexBuffer->getSize());
 
-                            context->DrawIndexed(drawCommand->indexCount, drawCommand->startIndex, 0);
+                            if (drawCommand->instanceBuffer)
+                            {
+                                D3D11Buffer* instanceBuffer = static_cast<D3D11Buffer*>(resources[drawCommand->instanceBuffer - 1].get());
+
+                                assert(instanceBuffer);
+                                assert(instanceBuffer->getBuffer());
+
+                                if (currentShader)
+                                    context->IASetInputLayout(currentShader->getInputLayout(vertexBuffer->getLayout(),
+                                                                                            instanceBuffer->getLayout()));
+
+                                ID3D11Buffer* buffers[] = {vertexBuffer->getBuffer(), instanceBuffer->getBuffer()};
+                                UINT strides[] = {vertexBuffer->getLayout().getStride(), instanceBuffer->getLayout().getStride()};
+                                UINT offsets[] = {vertexBuffer->getOffset(), instanceBuffer->getOffset()};
+                                context->IASetVertexBuffers(0, 2, buffers, strides, offsets);
+
+                                context->DrawIndexedInstanced(drawCommand->indexCount, drawCommand->instanceCount,
+                                                              drawCommand->startIndex, 0, 0);
+                            }
+                            else
+                            {
+                                if (currentShader)
+                                    context->IASetInputLayout(currentShader->getInputLayout(vertexBuffer->getLayout(),
+                                                                                            VertexLayout()));
+
+                                ID3D11Buffer* buffers[] = {vertexBuffer->getBuffer()};
+                                UINT strides[] = {vertexBuffer->getLayout().getStride()};
+                                UINT offsets[] = {vertexBuffer->getOffset()};
+                                context->IASetVertexBuffers(0, 1, buffers, strides, offsets);
+
+                                context->DrawIndexed(drawCommand->indexCount, drawCommand->startIndex, 0);
+                            }
 
                             break;
                         }
@@ -715,7 +752,8 @@ namespace ouzel
                                                                                 initBufferCommand->usage,
                                                                                 initBufferCommand->flags,
                                                                                 initBufferCommand->data,
-                                                                                initBufferCommand->size));
+                                                                                initBufferCommand->size,
+                                                                                initBufferCommand->layout));
 
                             if (initBufferCommand->buffer > resources.size())
                                 resources.resize(initBufferCommand->buffer);
@@ -842,6 +880,18 @@ namespace ouzel
                             break;
                         }
 
+                        case Command::Type::SET_TEXTURE_REGION_DATA:
+                        {
+                            auto setTextureRegionDataCommand = static_cast<const SetTextureRegionDataCommand*>(command.get());
+
+                            D3D11Texture* texture = static_cast<D3D11Texture*>(resources[setTextureRegionDataCommand->texture - 1].get());
+                            texture->setData(setTextureRegionDataCommand->data,
+                                             setTextureRegionDataCommand->offset,
+                                             setTextureRegionDataCommand->size);
+
+                            break;
+                        }
+
                         case Command::Type::SET_TEXTURE_PARAMETERS:
                         {
                             auto setTextureParametersCommand = static_cast<const SetTextureParametersCommand*>(command.get());
@@ -956,78 +1006,129 @@ namespace ouzel
             return result;
         }
 
-        void D3D11RenderDevice::generateScreenshot(const std::string& filename)
+        void D3D11RenderDevice::captureFrame()
         {
-            ID3D11Texture2D* backBufferTexture;
-            HRESULT hr;
-            if (FAILED(hr = backBuffer->QueryInterface(IID_ID3D11Texture2D, reinterpret_cast<void**>(&backBufferTexture))))
-                throw std::system_error(hr, direct3D11ErrorCategory, "Failed to get Direct3D 11 back buffer texture");
+            for (size_t i = 0; i < READBACK_COUNT; ++i)
+                if (!readbacks[i].captures.empty()) finishReadback(i, false);
+
+            std::vector<Capture> captures = getFrameCaptures();
+            if (captures.empty()) return;
+
+            // all the readbacks are in flight only if the GPU is several frames behind
+            if (!readbacks[nextReadback].captures.empty()) finishReadback(nextReadback, true);
+
+            Readback& readback = readbacks[nextReadback];
+            nextReadback = (nextReadback + 1) % READBACK_COUNT;
 
             D3D11_TEXTURE2D_DESC backBufferDesc;
-            backBufferTexture->GetDesc(&backBufferDesc);
-
-            D3D11_TEXTURE2D_DESC textureDesc;
-            textureDesc.Width = backBufferDesc.Width;
-            textureDesc.Height = backBufferDesc.Height;
-            textureDesc.MipLevels = 1;
-            textureDesc.ArraySize = 1;
-            textureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-            textureDesc.SampleDesc.Count = 1;
-            textureDesc.SampleDesc.Quality = 0;
-            textureDesc.Usage = D3D11_USAGE_STAGING;
-            textureDesc.BindFlags = 0;
-            textureDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
-            textureDesc.MiscFlags = 0;
-
-            ID3D11Texture2D* texture;
-            if (FAILED(hr = device->CreateTexture2D(&textureDesc, nullptr, &texture)))
-                throw std::system_error(hr, direct3D11ErrorCategory, "Failed to create Direct3D 11 texture");
+            backBuffer->GetDesc(&backBufferDesc);
+
+            HRESULT hr;
+
+            if (!readback.texture ||
+                readback.width != backBufferDesc.Width ||
+                readback.height != backBufferDesc.Height)
+            {
+                if (readback.texture)
+                {
+                    readback.texture->Release();
+                    readback.texture = nullptr;
+                }
+
+                D3D11_TEXTURE2D_DESC textureDesc;
+                textureDesc.Width = backBufferDesc.Width;
+                textureDesc.Height = backBufferDesc.Height;
+                textureDesc.MipLevels = 1;
+                textureDesc.ArraySize = 1;
+                textureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+                textureDesc.SampleDesc.Count = 1;
+                textureDesc.SampleDesc.Quality = 0;
+                textureDesc.Usage = D3D11_USAGE_STAGING;
+                textureDesc.BindFlags = 0;
+                textureDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+                textureDesc.MiscFlags = 0;
+
+                if (FAILED(hr = device->CreateTexture2D(&textureDesc, nullptr, &readback.texture)))
+                    throw std::system_error(hr, direct3D11ErrorCategory, "Failed to create Direct3D 11 texture");
+
+                readback.width = backBufferDesc.Width;
+                readback.height = backBufferDesc.Height;
+            }
 
             if (backBufferDesc.SampleDesc.Count > 1)
             {
                 D3D11_TEXTURE2D_DESC resolveTextureDesc;
-                resolveTextureDesc.Width = backBufferDesc.Width;
-                resolveTextureDesc.Height = backBufferDesc.Height;
-                resolveTextureDesc.MipLevels = 1;
-                resolveTextureDesc.ArraySize = 1;
-                resolveTextureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-                resolveTextureDesc.SampleDesc.Count = 1;
-                resolveTextureDesc.SampleDesc.Quality = 0;
-                resolveTextureDesc.Usage = D3D11_USAGE_DEFAULT;
-                resolveTextureDesc.BindFlags = 0;
-                resolveTextureDesc.CPUAccessFlags = 0;
-                resolveTextureDesc.MiscFlags = 0;
-
-                ID3D11Texture2D* resolveTexture;
-                if (FAILED(hr = device->CreateTexture2D(&resolveTextureDesc, nullptr, &resolveTexture)))
+
+                if (resolveTexture)
                 {
-                    texture->Release();
-                    throw std::system_error(hr, direct3D11ErrorCategory, "Failed to create Direct3D 11 texture");
+                    resolveTexture->GetDesc(&resolveTextureDesc);
+
+                    if (resolveTextureDesc.Width != backBufferDesc.Width ||
+                        resolveTextureDesc.Height != backBufferDesc.Height)
+                    {
+                        resolveTexture->Release();
+                        resolveTexture = nullptr;
+                    }
+                }
+
+                if (!resolveTexture)
+                {
+                    resolveTextureDesc.Width = backBufferDesc.Width;
+                    resolveTextureDesc.Height = backBufferDesc.Height;
+                    resolveTextureDesc.MipLevels = 1;
+                    resolveTextureDesc.ArraySize = 1;
+                    resolveTextureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+                    resolveTextureDesc.SampleDesc.Count = 1;
+                    resolveTextureDesc.SampleDesc.Quality = 0;
+                    resolveTextureDesc.Usage = D3D11_USAGE_DEFAULT;
+                    resolveTextureDesc.BindFlags = 0;
+                    resolveTextureDesc.CPUAccessFlags = 0;
+                    resolveTextureDesc.MiscFlags = 0;
+
+                    if (FAILED(hr = device->CreateTexture2D(&resolveTextureDesc, nullptr, &resolveTexture)))
+                        throw std::system_error(hr, direct3D11ErrorCategory, "Failed to create Direct3D 11 texture");
                 }
 
                 context->ResolveSubresource(resolveTexture, 0, backBuffer, 0, DXGI_FORMAT_R8G8B8A8_UNORM);
-                context->CopyResource(texture, resolveTexture);
-                resolveTexture->Release();
+                context->CopyResource(readback.texture, resolveTexture);
             }
             else
-                context->CopyResource(texture, backBuffer);
+                context->CopyResource(readback.texture, backBuffer);
+
+            readback.captures = std::move(captures);
+        }
+
+        void D3D11RenderDevice::finishReadback(size_t index, bool wait)
+        {
+            Readback& readback = readbacks[index];
 
             D3D11_MAPPED_SUBRESOURCE mappedSubresource;
-            if (FAILED(hr = context->Map(texture, 0, D3D11_MAP_READ, 0, &mappedSubresource)))
+            HRESULT hr = context->Map(readback.texture, 0, D3D11_MAP_READ,
+                                      wait ? 0 : D3D11_MAP_FLAG_DO_NOT_WAIT, &mappedSubresource);
+
+            if (hr == DXGI_ERROR_WAS_STILL_DRAWING) return;
+
+            if (FAILED(hr))
             {
-                texture->Release();
+                readback.captures.clear();
                 throw std::system_error(hr, direct3D11ErrorCategory, "Failed to map Direct3D 11 resource");
             }
 
-            if (!stbi_write_png(filename.c_str(), textureDesc.Width, textureDesc.Height, 4, mappedSubresource.pData, static_cast<int>(mappedSubresource.RowPitch)))
+            const UINT pitch = readback.width * 4;
+            std::vector<uint8_t> data(pitch * readback.height);
+
+            for (UINT row = 0; row < readback.height; ++row)
             {
-                context->Unmap(texture, 0);
-                texture->Release();
-                throw std::runtime_error("Failed to save screenshot to file");
+                const uint8_t* source = static_cast<const uint8_t*>(mappedSubresource.pData) + row * mappedSubresource.RowPitch;
+                std::copy(source, source + pitch, data.begin() + row * pitch);
             }
 
-            context->Unmap(texture, 0);
-            texture->Release();
+            context->Unmap(readback.texture, 0);
+
+            saveCaptures(std::move(readback.captures), std::move(data),
+                         readback.width, readback.height,
+                         false, false);
+            readback.captures.clear();
         }
 
         void D3D11RenderDevice::resizeBackBuffer(UINT newWidth, UINT newHeight)
@@ -81,7 +81,8 @@ namespace ouzel
             void process() override;
             void resizeBackBuffer(UINT newWidth, UINT newHeight);
             void uploadBuffer(ID3D11Buffer* buffer, const void* data, uint32_t dataSize);
-            void generateScreenshot(const std::string& filename) override;
+            void captureFrame();
+            void finishReadback(size_t index, bool wait);
             void main();
 
             IDXGIOutput* getOutput() const;
@@ -103,6 +104,20 @@ namespace ouzel
 
             UINT swapInterval = 0;
 
+            // frames are copied to staging textures and mapped once the copy has finished
+            struct Readback final
+            {
+                ID3D11Texture2D* texture = nullptr;
+                UINT width = 0;
+                UINT height = 0;
+                std::vector<Capture> captures;
+            };
+
+            static constexpr size_t READBACK_COUNT = 3;
+            Readback readbacks[READBACK_COUNT];
+            size_t nextReadback = 0;
+            ID3D11Texture2D* resolveTexture = nullptr;
+
             std::atomic_bool running{false};
             std::thread renderThread;
 
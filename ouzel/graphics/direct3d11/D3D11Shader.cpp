@@ -6,6 +6,7 @@
 
 #include "D3D11Shader.hpp"
 #include "D3D11RenderDevice.hpp"
+#include "graphics/Instance.hpp"
 
 namespace ouzel
 {
@@ -67,6 +68,10 @@ namespace ouzel
                 case DataType::INTEGER_VECTOR4: return DXGI_FORMAT_R32G32B32A32_SINT;
                 case DataType::UNSIGNED_INTEGER_VECTOR4: return DXGI_FORMAT_R32G32B32A32_UINT;
 
+                case DataType::HALF_FLOAT: return DXGI_FORMAT_R16_FLOAT;
+                case DataType::HALF_FLOAT_VECTOR2: return DXGI_FORMAT_R16G16_FLOAT;
+                case DataType::HALF_FLOAT_VECTOR4: return DXGI_FORMAT_R16G16B16A16_FLOAT;
+
                 case DataType::FLOAT: return DXGI_FORMAT_R32_FLOAT;
                 case DataType::FLOAT_VECTOR2: return DXGI_FORMAT_R32G32_FLOAT;
                 case DataType::FLOAT_VECTOR3: return DXGI_FORMAT_R32G32B32_FLOAT;
@@ -80,6 +85,29 @@ namespace ouzel
             return DXGI_FORMAT_UNKNOWN;
         }
 
+        static const char* getSemantic(Vertex::Attribute::Usage usage, UINT& index)
+        {
+            index = 0;
+
+            switch (usage)
+            {
+                case Vertex::Attribute::Usage::BINORMAL: return "BINORMAL";
+                case Vertex::Attribute::Usage::BLEND_INDICES: return "BLENDINDICES";
+                case Vertex::Attribute::Usage::BLEND_WEIGHT: return "BLENDWEIGHT";
+                case Vertex::Attribute::Usage::COLOR: return "COLOR";
+                case Vertex::Attribute::Usage::NORMAL: return "NORMAL";
+                case Vertex::Attribute::Usage::POSITION: return "POSITION";
+                case Vertex::Attribute::Usage::POSITION_TRANSFORMED: return "POSITIONT";
+                case Vertex::Attribute::Usage::POINT_SIZE: return "PSIZE";
+                case Vertex::Attribute::Usage::TANGENT: return "TANGENT";
+                case Vertex::Attribute::Usage::TEXTURE_COORDINATES0: return "TEXCOORD";
+                case Vertex::Attribute::Usage::TEXTURE_COORDINATES1: index = 1; return "TEXCOORD";
+                case Vertex::Attribute::Usage::INSTANCE_TRANSFORM: return "INSTANCETRANSFORM";
+                case Vertex::Attribute::Usage::INSTANCE_COLOR: return "INSTANCECOLOR";
+                default: throw std::runtime_error("Invalid vertex attribute usage");
+            }
+        }
+
         D3D11Shader::D3D11Shader(D3D11RenderDevice& renderDeviceD3D11,
                                  const std::vector<uint8_t>& fragmentShaderData,
                                  const std::vector<uint8_t>& vertexShaderData,
@@ -92,6 +120,7 @@ namespace ouzel
                                  const std::string&):
             D3D11RenderResource(renderDeviceD3D11),
             vertexAttributes(newVertexAttributes),
+            vertexShaderByteCode(vertexShaderData),
             fragmentShaderConstantInfo(newFragmentShaderConstantInfo),
             vertexShaderConstantInfo(newVertexShaderConstantInfo)
         {
@@ -104,81 +133,6 @@ namespace ouzel
             if (FAILED(hr = renderDeviceD3D11.getDevice()->CreateVertexShader(vertexShaderData.data(), vertexShaderData.size(), nullptr, &vertexShader)))
                 throw std::system_error(hr, direct3D11ErrorCategory, "Failed to create a Direct3D 11 vertex shader");
 
-            std::vector<D3D11_INPUT_ELEMENT_DESC> vertexInputElements;
-
-            UINT offset = 0;
-
-            for (const Vertex::Attribute& vertexAttribute : Vertex::ATTRIBUTES)
-            {
-                if (vertexAttributes.find(vertexAttribute.usage) != vertexAttributes.end())
-                {
-                    DXGI_FORMAT vertexFormat = getVertexFormat(vertexAttribute.dataType);
-
-                    if (vertexFormat == DXGI_FORMAT_UNKNOWN)
-                        throw std::runtime_error("Invalid vertex format");
-
-                    const char* semantic;
-                    UINT index = 0;
-
-                    switch (vertexAttribute.usage)
-                    {
-                        case Vertex::Attribute::Usage::BINORMAL:
-                            semantic = "BINORMAL";
-                            break;
-                        case Vertex::Attribute::Usage::BLEND_INDICES:
-                            semantic = "BLENDINDICES";
-                            break;
-                        case Vertex::Attribute::Usage::BLEND_WEIGHT:
-                            semantic = "BLENDWEIGHT";
-                            break;
-                        case Vertex::Attribute::Usage::COLOR:
-                            semantic = "COLOR";
-                            break;
-                        case Vertex::Attribute::Usage::NORMAL:
-                            semantic = "NORMAL";
-                            break;
-                        case Vertex::Attribute::Usage::POSITION:
-                            semantic = "POSITION";
-                            break;
-                        case Vertex::Attribute::Usage::POSITION_TRANSFORMED:
-                            semantic = "POSITIONT";
-                            break;
-                        case Vertex::Attribute::Usage::POINT_SIZE:
-                            semantic = "PSIZE";
-                            break;
-                        case Vertex::Attribute::Usage::TANGENT:
-                            semantic = "TANGENT";
-                            break;
-                        case Vertex::Attribute::Usage::TEXTURE_COORDINATES0:
-                            semantic = "TEXCOORD";
-                            break;
-                        case Vertex::Attribute::Usage::TEXTURE_COORDINATES1:
-                            semantic = "TEXCOORD";
-                            index = 1;
-                            break;
-                        default:
-                            throw std::runtime_error("Invalid vertex attribute usage");
-                    }
-
-                    vertexInputElements.push_back({
-                        semantic, index,
-                        vertexFormat,
-                        0, offset, D3D11_INPUT_PER_VERTEX_DATA, 0
-                    });
-                }
-
-                offset += getDataTypeSize(vertexAttribute.dataType);
-            }
-
-            if (inputLayout) inputLayout->Release();
-
-            if (FAILED(hr = renderDeviceD3D11.getDevice()->CreateInputLayout(vertexInputElements.data(),
-                                                                             static_cast<UINT>(vertexInputElements.size()),
-                                                                             vertexShaderData.data(),
-                                                                             vertexShaderData.size(),
-                                                                             &inputLayout)))
-                throw std::system_error(hr, direct3D11ErrorCategory, "Failed to create Direct3D 11 input layout for vertex shader");
-
             if (!fragmentShaderConstantInfo.empty())
             {
                 fragmentShaderConstantLocations.clear();
@@ -242,8 +196,8 @@ namespace ouzel
             if (vertexShader)
                 vertexShader->Release();
 
-            if (inputLayout)
-                inputLayout->Release();
+            for (const auto& inputLayout : inputLayouts)
+                inputLayout.second->Release();
 
             if (fragmentShaderConstantBuffer)
                 fragmentShaderConstantBuffer->Release();
@@ -251,6 +205,79 @@ namespace ouzel
             if (vertexShaderConstantBuffer)
                 vertexShaderConstantBuffer->Release();
         }
+
+        ID3D11InputLayout* D3D11Shader::getInputLayout(const VertexLayout& vertexLayout,
+                                                       const VertexLayout& instanceLayout)
+        {
+            auto key = std::make_pair(vertexLayout, instanceLayout);
+            auto inputLayoutIterator = inputLayouts.find(key);
+            if (inputLayoutIterator != inputLayouts.end()) return inputLayoutIterator->second;
+
+            std::vector<D3D11_INPUT_ELEMENT_DESC> vertexInputElements;
+
+            for (const Vertex::Attribute& vertexAttribute : Vertex::ATTRIBUTES)
+            {
+                if (vertexAttributes.find(vertexAttribute.usage) != vertexAttributes.end())
+                {
+                    const VertexLayout::Element* element = vertexLayout.getElement(vertexAttribute.usage);
+                    if (!element)
+                        throw std::runtime_error("Vertex layout does not provide an attribute used by the shader");
+
+                    DXGI_FORMAT vertexFormat = getVertexFormat(element->dataType);
+
+                    if (vertexFormat == DXGI_FORMAT_UNKNOWN)
+                        throw std::runtime_error("Invalid vertex format");
+
+                    UINT index;
+                    const char* semantic = getSemantic(vertexAttribute.usage, index);
+
+                    vertexInputElements.push_back({
+                        semantic, index,
+                        vertexFormat,
+                        0, element->offset, D3D11_INPUT_PER_VERTEX_DATA, 0
+                    });
+                }
+            }
+
+            // instance data comes from the second vertex buffer slot
+            for (const Vertex::Attribute& instanceAttribute : Instance::ATTRIBUTES)
+            {
+                if (vertexAttributes.find(instanceAttribute.usage) != vertexAttributes.end())
+                {
+                    const VertexLayout::Element* element = instanceLayout.getElement(instanceAttribute.usage);
+                    if (!element)
+                        throw std::runtime_error("Instance layout does not provide an attribute used by the shader");
+
+                    DXGI_FORMAT instanceFormat = getVertexFormat(element->dataType);
+
+                    if (instanceFormat == DXGI_FORMAT_UNKNOWN)
+                        throw std::runtime_error("Invalid instance format");
+
+                    UINT index;
+                    const char* semantic = getSemantic(instanceAttribute.usage, index);
+
+                    vertexInputElements.push_back({
+                        semantic, index,
+                        instanceFormat,
+                        1, element->offset, D3D11_INPUT_PER_INSTANCE_DATA, 1
+                    });
+                }
+            }
+
+            ID3D11InputLayout* inputLayout;
+
+            HRESULT hr;
+            if (FAILED(hr = renderDevice.getDevice()->CreateInputLayout(vertexInputElements.data(),
+                                                                        static_cast<UINT>(vertexInputElements.size()),
+                                                                        vertexShaderByteCode.data(),
+                                                                        vertexShaderByteCode.size(),
+                                                                        &inputLayout)))
+                throw std::system_error(hr, direct3D11ErrorCategory, "Failed to create Direct3D 11 input layout for vertex shader");
+
+            inputLayouts[key] = inputLayout;
+
+            return inputLayout;
+        }
     } // namespace graphics
 } // namespace ouzel
 
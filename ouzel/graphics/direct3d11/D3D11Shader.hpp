@@ -7,10 +7,13 @@
 
 #if OUZEL_COMPILE_DIRECT3D11
 
+#include <map>
+#include <utility>
 #include <vector>
 #include <d3d11.h>
 #include "graphics/direct3d11/D3D11RenderResource.hpp"
 #include "graphics/Shader.hpp"
+#include "graphics/VertexLayout.hpp"
 
 namespace ouzel
 {
@@ -49,17 +52,21 @@ namespace ouzel
 
             ID3D11Buffer* getFragmentShaderConstantBuffer() const { return fragmentShaderConstantBuffer; }
             ID3D11Buffer* getVertexShaderConstantBuffer() const { return vertexShaderConstantBuffer; }
-            ID3D11InputLayout* getInputLayout() const { return inputLayout; }
+
+            // input layouts are created on the first draw with the given vertex and instance buffer layouts
+            ID3D11InputLayout* getInputLayout(const VertexLayout& vertexLayout,
+                                              const VertexLayout& instanceLayout);
 
         private:
             std::set<Vertex::Attribute::Usage> vertexAttributes;
+            std::vector<uint8_t> vertexShaderByteCode;
 
             std::vector<Shader::ConstantInfo> fragmentShaderConstantInfo;
             std::vector<Shader::ConstantInfo> vertexShaderConstantInfo;
 
             ID3D11PixelShader* fragmentShader = nullptr;
             ID3D11VertexShader* vertexShader = nullptr;
-            ID3D11InputLayout* inputLayout = nullptr;
+            std::map<std::pair<VertexLayout, VertexLayout>, ID3D11InputLayout*> inputLayouts;
 
             ID3D11Buffer* fragmentShaderConstantBuffer = nullptr;
             ID3D11Buffer* vertexShaderConstantBuffer = nullptr;
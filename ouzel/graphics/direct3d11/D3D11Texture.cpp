@@ -167,6 +167,19 @@ namespace ouzel
                     throw std::system_error(hr, direct3D11ErrorCategory, "Failed to create Direct3D 11 texture");
             }
 
+            if (flags & Texture::DYNAMIC && !(flags & Texture::BIND_RENDER_TARGET))
+            {
+                levelData.resize(width * height * pixelSize);
+
+                if (!levels.front().data.empty())
+                {
+                    for (UINT row = 0; row < height; ++row)
+                        std::copy(levels.front().data.begin() + row * levels.front().pitch,
+                                  levels.front().data.begin() + row * levels.front().pitch + width * pixelSize,
+                                  levelData.begin() + row * width * pixelSize);
+                }
+            }
+
             if (flags & Texture::BIND_RENDER_TARGET)
             {
                 if (sampleCount > 1)
@@ -305,6 +318,14 @@ namespace ouzel
             {
                 if (!levels[level].data.empty())
                 {
+                    if (level == 0)
+                    {
+                        for (UINT row = 0; row < height; ++row)
+                            std::copy(levels[level].data.begin() + row * levels[level].pitch,
+                                      levels[level].data.begin() + row * levels[level].pitch + width * pixelSize,
+                                      levelData.begin() + row * width * pixelSize);
+                    }
+
                     D3D11_MAPPED_SUBRESOURCE mappedSubresource;
                     mappedSubresource.pData = nullptr;
                     mappedSubresource.RowPitch = 0;
@@ -346,6 +367,44 @@ namespace ouzel
             }
         }
 
+        void D3D11Texture::setData(const std::vector<uint8_t>& data,
+                                   const Vector2<uint32_t>& offset,
+                                   const Size2<uint32_t>& size)
+        {
+            if (!(flags & Texture::DYNAMIC) || flags & Texture::BIND_RENDER_TARGET)
+                throw std::runtime_error("Texture is not dynamic");
+
+            uint32_t rowSize = size.v[0] * pixelSize;
+            uint32_t levelPitch = width * pixelSize;
+
+            for (uint32_t row = 0; row < size.v[1]; ++row)
+                std::copy(data.begin() + row * rowSize,
+                          data.begin() + (row + 1) * rowSize,
+                          levelData.begin() + (offset.v[1] + row) * levelPitch + offset.v[0] * pixelSize);
+
+            D3D11_MAPPED_SUBRESOURCE mappedSubresource;
+            mappedSubresource.pData = nullptr;
+            mappedSubresource.RowPitch = 0;
+            mappedSubresource.DepthPitch = 0;
+
+            HRESULT hr;
+            if (FAILED(hr = renderDevice.getContext()->Map(texture, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedSubresource)))
+                throw std::system_error(hr, direct3D11ErrorCategory, "Failed to map Direct3D 11 texture");
+
+            uint8_t* destination = static_cast<uint8_t*>(mappedSubresource.pData);
+
+            for (UINT row = 0; row < height; ++row)
+            {
+                std::copy(levelData.begin() + row * levelPitch,
+                          levelData.begin() + (row + 1) * levelPitch,
+                          destination);
+
+                destination += mappedSubresource.RowPitch;
+            }
+
+            renderDevice.getContext()->Unmap(texture, 0);
+        }
+
         void D3D11Texture::setFilter(Texture::Filter filter)
         {
             samplerDescriptor.filter = (filter == Texture::Filter::DEFAULT) ? renderDevice.getTextureFilter() : filter;
@@ -43,6 +43,9 @@ namespace ouzel
             ~D3D11Texture();
 
             void setData(const std::vector<Texture::Level>& levels);
+            void setData(const std::vector<uint8_t>& data,
+                         const Vector2<uint32_t>& offset,
+                         const Size2<uint32_t>& size);
             void setFilter(Texture::Filter filter);
             void setAddressX(Texture::Address addressX);
             void setAddressY(Texture::Address addressY);
@@ -75,6 +78,9 @@ namespace ouzel
             uint32_t pixelSize = 0;
             SamplerStateDesc samplerDescriptor;
 
+            // copy of the first level of dynamic textures, dynamic resources can only be mapped with discard
+            std::vector<uint8_t> levelData;
+
             ID3D11Texture2D* texture = nullptr;
             ID3D11Texture2D* msaaTexture = nullptr;
             ID3D11ShaderResourceView* resourceView = nullptr;
@@ -30,14 +30,19 @@ namespace ouzel
             MetalBuffer(MetalRenderDevice& renderDeviceMetal,
                         Buffer::Usage newUsage, uint32_t newFlags,
                         const std::vector<uint8_t>& newData,
-                        uint32_t newSize);
+                        uint32_t newSize,
+                        const VertexLayout& newLayout);
             ~MetalBuffer();
 
             void setData(const std::vector<uint8_t>& data);
 
             inline uint32_t getFlags() const { return flags; }
             inline Buffer::Usage getUsage() const { return usage; }
+            inline const VertexLayout& getLayout() const { return layout; }
             inline NSUInteger getSize() const { return size; }
+            // offset of the current data inside the buffer, dynamic buffers have a region per frame in flight
+            // and append the updates of a frame to its region
+            inline NSUInteger getOffset() const { return offset; }
 
             inline MTLBufferPtr getBuffer() const { return buffer; }
 
@@ -46,9 +51,13 @@ namespace ouzel
 
             Buffer::Usage usage;
             uint32_t flags = 0;
+            VertexLayout layout;
 
             MTLBufferPtr buffer = nil;
             NSUInteger size = 0;
+            uint64_t frame = 0;
+            NSUInteger writeOffset = 0;
+            NSUInteger offset = 0;
         };
     } // namespace graphics
 } // namespace ouzel
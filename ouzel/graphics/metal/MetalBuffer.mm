@@ -13,18 +13,31 @@ namespace ouzel
 {
     namespace graphics
     {
+        static constexpr NSUInteger ALIGNMENT = 16;
+
         MetalBuffer::MetalBuffer(MetalRenderDevice& renderDeviceMetal,
                                  Buffer::Usage newUsage, uint32_t newFlags,
                                  const std::vector<uint8_t>& data,
-                                 uint32_t newSize):
+                                 uint32_t newSize,
+                                 const VertexLayout& newLayout):
             MetalRenderResource(renderDeviceMetal),
             usage(newUsage),
-            flags(newFlags)
+            flags(newFlags),
+            layout(newLayout)
         {
             createBuffer(newSize);
 
+            if (buffer && (flags & Buffer::DYNAMIC))
+            {
+                frame = renderDevice.getFrameIndex();
+                offset = (frame % MetalRenderDevice::BUFFER_COUNT) * size;
+            }
+
             if (!data.empty())
-                std::copy(data.begin(), data.end(), static_cast<uint8_t*>([buffer contents]));
+            {
+                std::copy(data.begin(), data.end(), static_cast<uint8_t*>([buffer contents]) + offset);
+                writeOffset = (static_cast<NSUInteger>(data.size()) + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+            }
         }
 
         MetalBuffer::~MetalBuffer()
@@ -40,10 +53,24 @@ namespace ouzel
             if (data.empty())
                 throw std::runtime_error("Data is empty");
 
-            if (!buffer || data.size() > size)
-                createBuffer(static_cast<uint32_t>(data.size()));
+            NSUInteger dataSize = static_cast<NSUInteger>(data.size());
 
-            std::copy(data.begin(), data.end(), static_cast<uint8_t*>([buffer contents]));
+            if (!buffer || dataSize > size)
+                createBuffer(dataSize);
+            else if (frame != renderDevice.getFrameIndex())
+                writeOffset = 0; // the frame that used this region before has completed
+            else if (writeOffset + dataSize > size)
+            {
+                // the draws encoded earlier in this frame still read from the current buffer,
+                // the command buffer retains it, so replace it with a bigger one
+                createBuffer(std::max(size * 2, dataSize));
+            }
+
+            frame = renderDevice.getFrameIndex();
+            offset = (frame % MetalRenderDevice::BUFFER_COUNT) * size + writeOffset;
+            std::copy(data.begin(), data.end(), static_cast<uint8_t*>([buffer contents]) + offset);
+
+            writeOffset = (writeOffset + dataSize + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
         }
 
         void MetalBuffer::createBuffer(NSUInteger newSize)
@@ -54,11 +81,17 @@ namespace ouzel
                 buffer = nil;
             }
 
+            writeOffset = 0;
+            offset = 0;
+
             if (newSize > 0)
             {
-                size = newSize;
+                // keep the regions of dynamic buffers aligned
+                size = (flags & Buffer::DYNAMIC) ? (newSize + ALIGNMENT - 1) & ~(ALIGNMENT - 1) : newSize;
+
+                NSUInteger length = (flags & Buffer::DYNAMIC) ? size * MetalRenderDevice::BUFFER_COUNT : size;
 
-                buffer = [renderDevice.getDevice() newBufferWithLength:size
+                buffer = [renderDevice.getDevice() newBufferWithLength:length
                                                                options:MTLResourceCPUCacheModeWriteCombined];
 
                 if (!buffer)
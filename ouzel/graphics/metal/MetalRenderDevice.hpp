@@ -66,6 +66,8 @@ namespace ouzel
             ~MetalRenderDevice();
 
             inline MTLDevicePtr getDevice() const { return device; }
+            // number of the frame being encoded, at most BUFFER_COUNT frames are in flight
+            inline uint64_t getFrameIndex() const { return frameIndex; }
 
             MTLSamplerStatePtr getSamplerState(const SamplerStateDescriptor& descriptor);
 
@@ -83,13 +85,15 @@ namespace ouzel
                       bool newDebugRenderer) override;
 
             void process() override;
-            void generateScreenshot(const std::string& filename) override;
+            void captureFrame();
 
             class PipelineStateDesc
             {
             public:
                 MetalBlendState* blendState = nullptr;
                 MetalShader* shader = nullptr;
+                VertexLayout vertexLayout;
+                VertexLayout instanceLayout;
                 NSUInteger sampleCount = 0;
                 std::vector<MTLPixelFormat> colorFormats;
                 MTLPixelFormat depthFormat;
@@ -97,8 +101,8 @@ namespace ouzel
 
                 bool operator<(const PipelineStateDesc& other) const
                 {
-                    return std::tie(blendState, shader, sampleCount, colorFormats, depthFormat) <
-                        std::tie(other.blendState, other.shader, other.sampleCount, colorFormats, other.depthFormat);
+                    return std::tie(blendState, shader, vertexLayout, instanceLayout, sampleCount, colorFormats, depthFormat) <
+                        std::tie(other.blendState, other.shader, other.vertexLayout, other.instanceLayout, other.sampleCount, colorFormats, other.depthFormat);
                 }
             };
 
@@ -131,6 +135,7 @@ namespace ouzel
             MTLPixelFormat stencilFormat;
 
             dispatch_semaphore_t inflightSemaphore;
+            uint64_t frameIndex = 0;
 
             std::map<PipelineStateDesc, MTLRenderPipelineStatePtr> pipelineStates;
 
@@ -18,7 +18,6 @@
 #include "events/EventDispatcher.hpp"
 #include "utils/Log.hpp"
 #include "utils/Utils.hpp"
-#include "stb_image_write.h"
 
 namespace ouzel
 {
@@ -207,6 +206,7 @@ namespace ouzel
         {
             RenderDevice::process();
             executeAll();
+            captureFrame();
 
             id<CAMetalDrawable> currentMetalDrawable = [metalLayer nextDrawable];
 
@@ -280,6 +280,7 @@ namespace ouzel
                 renderPassDescriptor.depthAttachment.texture = nil;
 
             dispatch_semaphore_wait(inflightSemaphore, DISPATCH_TIME_FOREVER);
+            ++frameIndex;
 
             id<MTLCommandBuffer> currentCommandBuffer = [metalCommandQueue commandBuffer];
 
@@ -596,12 +597,10 @@ namespace ouzel
                             MetalShader* shader = static_cast<MetalShader*>(resources[setPipelineStateCommand->shader - 1].get());
                             currentShader = shader;
 
+                            // the pipeline state also depends on the vertex layouts, it is set at draw time
                             currentPipelineStateDesc.blendState = blendState;
                             currentPipelineStateDesc.shader = shader;
 
-                            MTLRenderPipelineStatePtr pipelineState = getPipelineState(currentPipelineStateDesc);
-                            if (pipelineState) [currentRenderCommandEncoder setRenderPipelineState:pipelineState];
-
                             break;
                         }
 
@@ -621,18 +620,44 @@ namespace ouzel
                             assert(vertexBuffer);
                             assert(vertexBuffer->getBuffer());
 
-                            [currentRenderCommandEncoder setVertexBuffer:vertexBuffer->getBuffer() offset:0 atIndex:0];
+                            MetalBuffer* instanceBuffer = drawCommand->instanceBuffer ?
+                                static_cast<MetalBuffer*>(resources[drawCommand->instanceBuffer - 1].get()) : nullptr;
+
+                            currentPipelineStateDesc.vertexLayout = vertexBuffer->getLayout();
+                            currentPipelineStateDesc.instanceLayout = instanceBuffer ? instanceBuffer->getLayout() : VertexLayout();
+
+                            MTLRenderPipelineStatePtr pipelineState = getPipelineState(currentPipelineStateDesc);
+                            if (pipelineState) [currentRenderCommandEncoder setRenderPipelineState:pipelineState];
+
+                            [currentRenderCommandEncoder setVertexBuffer:vertexBuffer->getBuffer() offset:vertexBuffer->getOffset() atIndex:0];
 
                             // draw
                             assert(drawCommand->indexCount);
                             assert(indexBuffer->getSize());
                             assert(vertexBuffer->getSize());
 
-                            [currentRenderCommandEncoder drawIndexedPrimitives:getPrimitiveType(drawCommand->drawMode)
-                                                                    indexCount:drawCommand->indexCount
-                                                                     indexType:getIndexType(drawCommand->indexSize)
-                                                                   indexBuffer:indexBuffer->getBuffer()
-                                                             indexBufferOffset:drawCommand->startIndex * drawCommand->indexSize];
+                            if (instanceBuffer)
+                            {
+                                assert(instanceBuffer->getBuffer());
+
+                                // buffer 1 is used for the shader constants
+                                [currentRenderCommandEncoder setVertexBuffer:instanceBuffer->getBuffer() offset:instanceBuffer->getOffset() atIndex:2];
+
+                                [currentRenderCommandEncoder drawIndexedPrimitives:getPrimitiveType(drawCommand->drawMode)
+                                                                        indexCount:drawCommand->indexCount
+                                                                         indexType:getIndexType(drawCommand->indexSize)
+                                                                       indexBuffer:indexBuffer->getBuffer()
+                                                                 indexBufferOffset:indexBuffer->getOffset() + drawCommand->startIndex * drawCommand->indexSize
+                                                                     instanceCount:drawCommand->instanceCount];
+                            }
+                            else
+                            {
+                                [currentRenderCommandEncoder drawIndexedPrimitives:getPrimitiveType(drawCommand->drawMode)
+                                                                        indexCount:drawCommand->indexCount
+                                                                         indexType:getIndexType(drawCommand->indexSize)
+                                                                       indexBuffer:indexBuffer->getBuffer()
+                                                                 indexBufferOffset:indexBuffer->getOffset() + drawCommand->startIndex * drawCommand->indexSize];
+                            }
 
                             break;
                         }
@@ -687,7 +712,8 @@ namespace ouzel
                                                                                 initBufferCommand->usage,
                                                                                 initBufferCommand->flags,
                                                                                 initBufferCommand->data,
-                                                                                initBufferCommand->size));
+                                                                                initBufferCommand->size,
+                                                                                initBufferCommand->layout));
 
                             if (initBufferCommand->buffer > resources.size())
                                 resources.resize(initBufferCommand->buffer);
@@ -867,6 +893,18 @@ namespace ouzel
                             break;
                         }
 
+                        case Command::Type::SET_TEXTURE_REGION_DATA:
+                        {
+                            auto setTextureRegionDataCommand = static_cast<const SetTextureRegionDataCommand*>(command.get());
+
+                            MetalTexture* texture = static_cast<MetalTexture*>(resources[setTextureRegionDataCommand->texture - 1].get());
+                            texture->setData(setTextureRegionDataCommand->data,
+                                             setTextureRegionDataCommand->offset,
+                                             setTextureRegionDataCommand->size);
+
+                            break;
+                        }
+
                         case Command::Type::SET_TEXTURE_PARAMETERS:
                         {
                             auto setTextureParametersCommand = static_cast<const SetTextureParametersCommand*>(command.get());
@@ -913,8 +951,12 @@ namespace ouzel
             }
         }
 
-        void MetalRenderDevice::generateScreenshot(const std::string& filename)
+        void MetalRenderDevice::captureFrame()
         {
+            // reads the previous frame, the channels are swapped on a worker thread
+            std::vector<Capture> captures = getFrameCaptures();
+            if (captures.empty()) return;
+
             if (!currentMetalTexture)
                 throw std::runtime_error("No back buffer");
 
@@ -924,21 +966,9 @@ namespace ouzel
             std::vector<uint8_t> data(width * height * 4);
             [currentMetalTexture getBytes:data.data() bytesPerRow:width * 4 fromRegion:MTLRegionMake2D(0, 0, width, height) mipmapLevel:0];
 
-            uint8_t temp;
-            for (uint32_t y = 0; y < height; ++y)
-            {
-                for (uint32_t x = 0; x < width; ++x)
-                {
-                    // reverse the order of channels
-                    temp = data[((y * width + x) * 4)];
-                    data[((y * width + x) * 4)] = data[((y * width + x) * 4) + 2];
-                    data[((y * width + x) * 4) + 2] = temp;
-                    data[((y * width + x) * 4) + 3] = 255;
-                }
-            }
-
-            if (!stbi_write_png(filename.c_str(), static_cast<int>(width), static_cast<int>(height), 4, data.data(), static_cast<int>(width * 4)))
-                throw std::runtime_error("Failed to save image to file");
+            saveCaptures(std::move(captures), std::move(data),
+                         static_cast<uint32_t>(width), static_cast<uint32_t>(height),
+                         false, true);
         }
 
         MTLRenderPipelineStatePtr MetalRenderDevice::getPipelineState(const PipelineStateDesc& desc)
@@ -958,11 +988,10 @@ namespace ouzel
                 {
                     assert(desc.shader->getFragmentShader());
                     assert(desc.shader->getVertexShader());
-                    assert(desc.shader->getVertexDescriptor());
 
                     pipelineStateDescriptor.vertexFunction = desc.shader->getVertexShader();
                     pipelineStateDescriptor.fragmentFunction = desc.shader->getFragmentShader();
-                    pipelineStateDescriptor.vertexDescriptor = desc.shader->getVertexDescriptor();
+                    pipelineStateDescriptor.vertexDescriptor = desc.shader->getVertexDescriptor(desc.vertexLayout, desc.instanceLayout);
                 }
 
                 for (size_t i = 0; i < desc.colorFormats.size(); ++i)
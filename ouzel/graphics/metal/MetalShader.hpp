@@ -17,8 +17,11 @@ typedef id MTLFunctionPtr;
 typedef id MTLVertexDescriptorPtr;
 #endif
 
+#include <map>
+#include <utility>
 #include "graphics/metal/MetalRenderResource.hpp"
 #include "graphics/Shader.hpp"
+#include "graphics/VertexLayout.hpp"
 
 namespace ouzel
 {
@@ -58,7 +61,9 @@ namespace ouzel
             inline MTLFunctionPtr getFragmentShader() const { return fragmentShader; }
             inline MTLFunctionPtr getVertexShader() const { return vertexShader; }
 
-            inline MTLVertexDescriptorPtr getVertexDescriptor() const { return vertexDescriptor; }
+            // vertex descriptors are created for every combination of vertex and instance buffer layouts
+            MTLVertexDescriptorPtr getVertexDescriptor(const VertexLayout& vertexLayout,
+                                                       const VertexLayout& instanceLayout);
 
             inline uint32_t getFragmentShaderConstantBufferSize() const { return fragmentShaderConstantSize; }
             inline uint32_t getVertexShaderConstantBufferSize() const { return vertexShaderConstantSize; }
@@ -74,7 +79,7 @@ namespace ouzel
             MTLFunctionPtr fragmentShader = nil;
             MTLFunctionPtr vertexShader = nil;
 
-            MTLVertexDescriptorPtr vertexDescriptor = nil;
+            std::map<std::pair<VertexLayout, VertexLayout>, MTLVertexDescriptorPtr> vertexDescriptors;
 
             std::vector<Location> fragmentShaderConstantLocations;
             uint32_t fragmentShaderConstantSize = 0;
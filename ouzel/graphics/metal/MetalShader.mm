@@ -8,6 +8,7 @@
 #include <stdexcept>
 #include "MetalShader.hpp"
 #include "MetalRenderDevice.hpp"
+#include "graphics/Instance.hpp"
 
 namespace ouzel
 {
@@ -69,6 +70,10 @@ namespace ouzel
                 case DataType::INTEGER_VECTOR4: return MTLVertexFormatInt4;
                 case DataType::UNSIGNED_INTEGER_VECTOR4: return MTLVertexFormatUInt4;
 
+                case DataType::HALF_FLOAT: return MTLVertexFormatInvalid;
+                case DataType::HALF_FLOAT_VECTOR2: return MTLVertexFormatHalf2;
+                case DataType::HALF_FLOAT_VECTOR4: return MTLVertexFormatHalf4;
+
                 case DataType::FLOAT: return MTLVertexFormatFloat;
                 case DataType::FLOAT_VECTOR2: return MTLVertexFormatFloat2;
                 case DataType::FLOAT_VECTOR3: return MTLVertexFormatFloat3;
@@ -117,33 +122,6 @@ namespace ouzel
                     vertexShaderAlignment += info.size;
             }
 
-            uint32_t index = 0;
-            NSUInteger offset = 0;
-
-            vertexDescriptor = [MTLVertexDescriptor new];
-
-            for (const Vertex::Attribute& vertexAttribute : Vertex::ATTRIBUTES)
-            {
-                if (vertexAttributes.find(vertexAttribute.usage) != vertexAttributes.end())
-                {
-                    MTLVertexFormat vertexFormat = getVertexFormat(vertexAttribute.dataType);
-
-                    if (vertexFormat == MTLVertexFormatInvalid)
-                        throw std::runtime_error("Invalid vertex format");
-
-                    vertexDescriptor.attributes[index].format = vertexFormat;
-                    vertexDescriptor.attributes[index].offset = offset;
-                    vertexDescriptor.attributes[index].bufferIndex = 0;
-                    ++index;
-                }
-
-                offset += getDataTypeSize(vertexAttribute.dataType);
-            }
-
-            vertexDescriptor.layouts[0].stride = offset;
-            vertexDescriptor.layouts[0].stepRate = 1;
-            vertexDescriptor.layouts[0].stepFunction = MTLVertexStepFunctionPerVertex;
-
             NSError* err;
 
             dispatch_data_t fragmentShaderDispatchData = dispatch_data_create(fragmentShaderData.data(), fragmentShaderData.size(), nullptr, DISPATCH_DATA_DESTRUCTOR_DEFAULT);
@@ -219,7 +197,79 @@ namespace ouzel
         {
             if (vertexShader) [vertexShader release];
             if (fragmentShader) [fragmentShader release];
-            if (vertexDescriptor) [vertexDescriptor release];
+            for (const auto& vertexDescriptor : vertexDescriptors)
+                [vertexDescriptor.second release];
+        }
+
+        MTLVertexDescriptorPtr MetalShader::getVertexDescriptor(const VertexLayout& vertexLayout,
+                                                                const VertexLayout& instanceLayout)
+        {
+            auto key = std::make_pair(vertexLayout, instanceLayout);
+            auto vertexDescriptorIterator = vertexDescriptors.find(key);
+            if (vertexDescriptorIterator != vertexDescriptors.end()) return vertexDescriptorIterator->second;
+
+            // attribute indices are assigned in the order of the attributes that the shader uses
+            uint32_t index = 0;
+
+            MTLVertexDescriptor* vertexDescriptor = [MTLVertexDescriptor new];
+
+            for (const Vertex::Attribute& vertexAttribute : Vertex::ATTRIBUTES)
+            {
+                if (vertexAttributes.find(vertexAttribute.usage) != vertexAttributes.end())
+                {
+                    const VertexLayout::Element* element = vertexLayout.getElement(vertexAttribute.usage);
+                    MTLVertexFormat vertexFormat = element ? getVertexFormat(element->dataType) : MTLVertexFormatInvalid;
+
+                    if (vertexFormat == MTLVertexFormatInvalid)
+                    {
+                        [vertexDescriptor release];
+                        throw std::runtime_error("Invalid vertex format");
+                    }
+
+                    vertexDescriptor.attributes[index].format = vertexFormat;
+                    vertexDescriptor.attributes[index].offset = element->offset;
+                    vertexDescriptor.attributes[index].bufferIndex = 0;
+                    ++index;
+                }
+            }
+
+            vertexDescriptor.layouts[0].stride = vertexLayout.getStride();
+            vertexDescriptor.layouts[0].stepRate = 1;
+            vertexDescriptor.layouts[0].stepFunction = MTLVertexStepFunctionPerVertex;
+
+            bool instanced = false;
+
+            for (const Vertex::Attribute& instanceAttribute : Instance::ATTRIBUTES)
+            {
+                if (vertexAttributes.find(instanceAttribute.usage) != vertexAttributes.end())
+                {
+                    const VertexLayout::Element* element = instanceLayout.getElement(instanceAttribute.usage);
+                    MTLVertexFormat instanceFormat = element ? getVertexFormat(element->dataType) : MTLVertexFormatInvalid;
+
+                    if (instanceFormat == MTLVertexFormatInvalid)
+                    {
+                        [vertexDescriptor release];
+                        throw std::runtime_error("Invalid instance format");
+                    }
+
+                    vertexDescriptor.attributes[index].format = instanceFormat;
+                    vertexDescriptor.attributes[index].offset = element->offset;
+                    vertexDescriptor.attributes[index].bufferIndex = 2;
+                    ++index;
+                    instanced = true;
+                }
+            }
+
+            if (instanced)
+            {
+                vertexDescriptor.layouts[2].stride = instanceLayout.getStride();
+                vertexDescriptor.layouts[2].stepRate = 1;
+                vertexDescriptor.layouts[2].stepFunction = MTLVertexStepFunctionPerInstance;
+            }
+
+            vertexDescriptors[key] = vertexDescriptor;
+
+            return vertexDescriptor;
         }
     } // namespace graphics
 } // namespace ouzel
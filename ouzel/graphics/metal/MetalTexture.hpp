@@ -57,6 +57,9 @@ namespace ouzel
             ~MetalTexture();
 
             void setData(const std::vector<Texture::Level>& levels);
+            void setData(const std::vector<uint8_t>& data,
+                         const Vector2<uint32_t>& offset,
+                         const Size2<uint32_t>& size);
             void setFilter(Texture::Filter filter);
             void setAddressX(Texture::Address addressX);
             void setAddressY(Texture::Address addressY);
@@ -93,6 +96,7 @@ namespace ouzel
             MTLTexturePtr msaaTexture = nil;
 
             MTLPixelFormat pixelFormat;
+            uint32_t pixelSize = 0;
             bool stencilBuffer = false;
         };
     } // namespace graphics
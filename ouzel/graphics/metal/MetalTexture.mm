@@ -86,6 +86,7 @@ namespace ouzel
             mipmaps(static_cast<uint32_t>(levels.size())),
             sampleCount(initSampleCount),
             pixelFormat(getMetalPixelFormat(initPixelFormat)),
+            pixelSize(getPixelSize(initPixelFormat)),
             stencilBuffer(initPixelFormat == PixelFormat::DEPTH_STENCIL)
         {
             if ((flags & Texture::BIND_RENDER_TARGET) && (mipmaps == 0 || mipmaps > 1))
@@ -202,6 +203,21 @@ namespace ouzel
             }
         }
 
+        void MetalTexture::setData(const std::vector<uint8_t>& data,
+                                   const Vector2<uint32_t>& offset,
+                                   const Size2<uint32_t>& size)
+        {
+            if (!(flags & Texture::DYNAMIC) || flags & Texture::BIND_RENDER_TARGET)
+                throw std::runtime_error("Texture is not dynamic");
+
+            [texture replaceRegion:MTLRegionMake2D(static_cast<NSUInteger>(offset.v[0]),
+                                                   static_cast<NSUInteger>(offset.v[1]),
+                                                   static_cast<NSUInteger>(size.v[0]),
+                                                   static_cast<NSUInteger>(size.v[1]))
+                       mipmapLevel:0 withBytes:data.data()
+                       bytesPerRow:static_cast<NSUInteger>(size.v[0] * pixelSize)];
+        }
+
         void MetalTexture::setFilter(Texture::Filter filter)
         {
             samplerDescriptor.filter = (filter == Texture::Filter::DEFAULT) ? renderDevice.getTextureFilter() : filter;
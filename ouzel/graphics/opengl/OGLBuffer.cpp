@@ -4,6 +4,7 @@
 
 #if OUZEL_COMPILE_OPENGL
 
+#include <algorithm>
 #include "OGLBuffer.hpp"
 #include "OGLRenderDevice.hpp"
 
@@ -11,13 +12,21 @@ namespace ouzel
 {
     namespace graphics
     {
+#if OUZEL_SUPPORTS_OPENGLES
+        static constexpr GLbitfield STORAGE_FLAGS = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT_EXT | GL_MAP_COHERENT_BIT_EXT;
+#else
+        static constexpr GLbitfield STORAGE_FLAGS = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+#endif
+
         OGLBuffer::OGLBuffer(OGLRenderDevice& renderDeviceOGL,
                              Buffer::Usage newUsage, uint32_t newFlags,
                              const std::vector<uint8_t>& newData,
-                             uint32_t newSize):
+                             uint32_t newSize,
+                             const VertexLayout& newLayout):
             OGLRenderResource(renderDeviceOGL),
             usage(newUsage),
             flags(newFlags),
+            layout(newLayout),
             data(newData)
         {
             createBuffer();
@@ -25,25 +34,14 @@ namespace ouzel
             size = static_cast<GLsizeiptr>(newSize);
 
             if (size > 0)
-            {
-                renderDeviceOGL.bindBuffer(bufferType, bufferId);
-
-                if (data.empty())
-                    renderDevice.glBufferDataProc(bufferType, size, nullptr,
-                                                  (flags & Texture::DYNAMIC) ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);
-                else
-                    renderDevice.glBufferDataProc(bufferType, size, data.data(),
-                                                  (flags & Texture::DYNAMIC) ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);
-
-                GLenum error;
-
-                if ((error = renderDevice.glGetErrorProc()) != GL_NO_ERROR)
-                    throw std::system_error(makeErrorCode(error), "Failed to create buffer");
-            }
+                uploadData();
         }
 
         OGLBuffer::~OGLBuffer()
         {
+            for (GLsync& fence : fences)
+                if (fence) renderDevice.glDeleteSyncProc(fence);
+
             if (bufferId)
                 renderDevice.deleteBuffer(bufferId);
         }
@@ -51,28 +49,18 @@ namespace ouzel
         void OGLBuffer::reload()
         {
             bufferId = 0;
+            storage = nullptr;
+            region = 0;
+            offset = 0;
+            for (GLsync& fence : fences) fence = nullptr;
 
             createBuffer();
 
             if (size > 0)
-            {
-                renderDevice.bindBuffer(bufferType, bufferId);
-
-                if (data.empty())
-                    renderDevice.glBufferDataProc(bufferType, size, nullptr,
-                                                  (flags & Texture::DYNAMIC) ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);
-                else
-                    renderDevice.glBufferDataProc(bufferType, size, data.data(),
-                                                  (flags & Texture::DYNAMIC) ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);
-
-                GLenum error;
-
-                if ((error = renderDevice.glGetErrorProc()) != GL_NO_ERROR)
-                    throw std::system_error(makeErrorCode(error), "Failed to create buffer");
-            }
+                uploadData();
         }
 
-        void OGLBuffer::setData(const std::vector<uint8_t>& newData)
+        void OGLBuffer::setData(std::vector<uint8_t>& newData)
         {
             if (!(flags & Buffer::DYNAMIC))
                 throw std::runtime_error("Buffer is not dynamic");
@@ -80,27 +68,43 @@ namespace ouzel
             if (newData.empty())
                 throw std::invalid_argument("Data is empty");
 
-            data = newData;
+            data.swap(newData);
 
             if (!bufferId)
                 throw std::runtime_error("Buffer not initialized");
 
-            renderDevice.bindBuffer(bufferType, bufferId);
-
             if (static_cast<GLsizeiptr>(data.size()) > size)
             {
                 size = static_cast<GLsizeiptr>(data.size());
+                uploadData();
+            }
+            else if (storage)
+            {
+                // fence the region the previous draws read from and move to the next one
+                fences[region] = renderDevice.glFenceSyncProc(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+                region = (region + 1) % STORAGE_COUNT;
 
-                renderDevice.glBufferDataProc(bufferType, size, data.data(),
-                                              (flags & Texture::DYNAMIC) ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);
+                if (GLsync fence = fences[region])
+                {
+                    GLenum result;
+                    while ((result = renderDevice.glClientWaitSyncProc(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000)) == GL_TIMEOUT_EXPIRED);
 
-                GLenum error;
+                    renderDevice.glDeleteSyncProc(fence);
+                    fences[region] = nullptr;
 
-                if ((error = renderDevice.glGetErrorProc()) != GL_NO_ERROR)
-                    throw std::system_error(makeErrorCode(error), "Failed to create buffer");
+                    if (result == GL_WAIT_FAILED)
+                        throw std::system_error(makeErrorCode(renderDevice.glGetErrorProc()), "Failed to wait for buffer fence");
+                }
+
+                offset = static_cast<GLintptr>(region) * size;
+                std::copy(data.begin(), data.end(), storage + offset);
             }
             else
             {
+                renderDevice.bindBuffer(bufferType, bufferId);
+
+                // orphan the old storage so that the driver does not have to wait for the draws that use it
+                renderDevice.glBufferDataProc(bufferType, size, nullptr, GL_DYNAMIC_DRAW);
                 renderDevice.glBufferSubDataProc(bufferType, 0, static_cast<GLsizeiptr>(data.size()), data.data());
 
                 GLenum error;
@@ -110,6 +114,67 @@ namespace ouzel
             }
         }
 
+        void OGLBuffer::uploadData()
+        {
+            if ((flags & Buffer::DYNAMIC) && renderDevice.isBufferStorageSupported())
+                createStorage();
+            else
+            {
+                renderDevice.bindBuffer(bufferType, bufferId);
+
+                if (data.empty())
+                    renderDevice.glBufferDataProc(bufferType, size, nullptr,
+                                                  (flags & Buffer::DYNAMIC) ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);
+                else
+                    renderDevice.glBufferDataProc(bufferType, size, data.data(),
+                                                  (flags & Buffer::DYNAMIC) ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);
+
+                GLenum error;
+
+                if ((error = renderDevice.glGetErrorProc()) != GL_NO_ERROR)
+                    throw std::system_error(makeErrorCode(error), "Failed to create buffer");
+            }
+        }
+
+        void OGLBuffer::createStorage()
+        {
+            // immutable storage can not be resized, so a new buffer is needed
+            if (storage)
+            {
+                for (GLsync& fence : fences)
+                {
+                    if (fence) renderDevice.glDeleteSyncProc(fence);
+                    fence = nullptr;
+                }
+
+                renderDevice.deleteBuffer(bufferId);
+                bufferId = 0;
+                storage = nullptr;
+                createBuffer();
+            }
+
+            region = 0;
+            offset = 0;
+
+            renderDevice.bindBuffer(bufferType, bufferId);
+
+            GLsizeiptr storageSize = size * STORAGE_COUNT;
+            renderDevice.glBufferStorageProc(bufferType, storageSize, nullptr, STORAGE_FLAGS);
+
+            GLenum error;
+
+            if ((error = renderDevice.glGetErrorProc()) != GL_NO_ERROR)
+                throw std::system_error(makeErrorCode(error), "Failed to create buffer storage");
+
+            storage = static_cast<uint8_t*>(renderDevice.glMapBufferRangeProc(bufferType, 0, storageSize, STORAGE_FLAGS));
+
+            if (!storage)
+                throw std::system_error(makeErrorCode(renderDevice.glGetErrorProc()), "Failed to map buffer");
+
+            if (!data.empty())
+                std::copy(data.begin(), data.end(), storage);
+        }
+
         void OGLBuffer::createBuffer()
         {
             renderDevice.glGenBuffersProc(1, &bufferId);
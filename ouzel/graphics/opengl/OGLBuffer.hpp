@@ -32,31 +32,46 @@ namespace ouzel
             OGLBuffer(OGLRenderDevice& renderDeviceOGL,
                       Buffer::Usage newUsage, uint32_t newFlags,
                       const std::vector<uint8_t>& newData,
-                      uint32_t newSize);
+                      uint32_t newSize,
+                      const VertexLayout& newLayout);
             ~OGLBuffer();
 
             void reload() override;
 
-            void setData(const std::vector<uint8_t>& newData);
+            // takes the contents of newData and gives back the previous data so that its storage can be reused
+            void setData(std::vector<uint8_t>& newData);
 
             inline uint32_t getFlags() const { return flags; }
             inline Buffer::Usage getUsage() const { return usage; }
+            inline const VertexLayout& getLayout() const { return layout; }
             inline GLsizeiptr getSize() const { return size; }
 
             inline GLuint getBufferId() const { return bufferId; }
             inline GLuint getBufferType() const { return bufferType; }
+            // offset of the current data inside the buffer, used by dynamic buffers that stream through a ring
+            inline GLintptr getOffset() const { return offset; }
 
         private:
             void createBuffer();
+            void createStorage();
+            void uploadData();
 
             Buffer::Usage usage;
             uint32_t flags = 0;
+            VertexLayout layout;
             std::vector<uint8_t> data;
 
             GLuint bufferId = 0;
             GLsizeiptr size = 0;
 
             GLuint bufferType = 0;
+
+            // dynamic buffers have STORAGE_COUNT regions of size bytes if persistent mapping is supported
+            static constexpr uint32_t STORAGE_COUNT = 3;
+            uint8_t* storage = nullptr;
+            uint32_t region = 0;
+            GLsync fences[STORAGE_COUNT] = {};
+            GLintptr offset = 0;
         };
     } // namespace graphics
 } // namespace ouzel
@@ -8,6 +8,7 @@
 #  include <dlfcn.h>
 #endif
 
+#include <algorithm>
 #include <cassert>
 #include <sstream>
 
@@ -37,11 +38,11 @@
 #include "OGLRenderTarget.hpp"
 #include "OGLShader.hpp"
 #include "OGLTexture.hpp"
+#include "graphics/Instance.hpp"
 #include "core/Engine.hpp"
 #include "core/Window.hpp"
 #include "utils/Log.hpp"
 #include "utils/Utils.hpp"
-#include "stb_image_write.h"
 
 template<typename T>
 static inline T getCoreProcAddress(const char* name)
@@ -149,6 +150,11 @@ namespace ouzel
                 case DataType::UNSIGNED_INTEGER_VECTOR4:
                     return GL_UNSIGNED_INT;
 
+                case DataType::HALF_FLOAT:
+                case DataType::HALF_FLOAT_VECTOR2:
+                case DataType::HALF_FLOAT_VECTOR4:
+                    return GL_HALF_FLOAT;
+
                 case DataType::FLOAT:
                 case DataType::FLOAT_VECTOR2:
                 case DataType::FLOAT_VECTOR3:
@@ -176,6 +182,7 @@ namespace ouzel
                 case DataType::UNSIGNED_SHORT_NORM:
                 case DataType::INTEGER:
                 case DataType::UNSIGNED_INTEGER:
+                case DataType::HALF_FLOAT:
                 case DataType::FLOAT:
                     return 1;
 
@@ -189,6 +196,7 @@ namespace ouzel
                 case DataType::UNSIGNED_SHORT_VECTOR2_NORM:
                 case DataType::INTEGER_VECTOR2:
                 case DataType::UNSIGNED_INTEGER_VECTOR2:
+                case DataType::HALF_FLOAT_VECTOR2:
                 case DataType::FLOAT_VECTOR2:
                     return 2;
 
@@ -215,6 +223,7 @@ namespace ouzel
                 case DataType::UNSIGNED_SHORT_VECTOR4_NORM:
                 case DataType::INTEGER_VECTOR4:
                 case DataType::UNSIGNED_INTEGER_VECTOR4:
+                case DataType::HALF_FLOAT_VECTOR4:
                 case DataType::FLOAT_VECTOR4:
                     return 4;
 
@@ -307,6 +316,12 @@ namespace ouzel
 
         OGLRenderDevice::~OGLRenderDevice()
         {
+            for (Readback& readback : readbacks)
+            {
+                if (readback.fence) glDeleteSyncProc(readback.fence);
+                if (readback.pixelBuffer) glDeleteBuffersProc(1, &readback.pixelBuffer);
+            }
+
             if (vertexArrayId) glDeleteVertexArraysProc(1, &vertexArrayId);
 
             resources.clear();
@@ -515,6 +530,7 @@ namespace ouzel
 
             anisotropicFilteringSupported = false;
             npotTexturesSupported = false;
+            instancingSupported = false;
             bool multisamplingSupported = false;
             textureBaseLevelSupported = false;
             textureMaxLevelSupported = false;
@@ -533,7 +549,37 @@ namespace ouzel
                     glCopyImageSubDataProc = getExtProcAddress<PFNGLCOPYIMAGESUBDATAPROC>("glCopyImageSubData");
                     glTexStorage2DMultisampleProc = getExtProcAddress<PFNGLTEXSTORAGE2DMULTISAMPLEPROC>("glTexStorage2DMultisample");
                 }
+
+                if ((apiMajorVersion == 4 && apiMinorVersion >= 4) || // at least OpenGL 4.4
+                    apiMajorVersion > 4)
+                    glBufferStorageProc = getExtProcAddress<PFNGLBUFFERSTORAGEPROC>("glBufferStorage");
+#endif
+            }
+
+#if !OUZEL_OPENGL_INTERFACE_EAGL
+#  if OUZEL_SUPPORTS_OPENGLES
+            if (apiMajorVersion >= 3)
+#  else
+            if ((apiMajorVersion == 3 && apiMinorVersion >= 2) || // at least OpenGL 3.2
+                apiMajorVersion > 3)
+#  endif
+            {
+                glFenceSyncProc = getExtProcAddress<PFNGLFENCESYNCPROC>("glFenceSync");
+                glDeleteSyncProc = getExtProcAddress<PFNGLDELETESYNCPROC>("glDeleteSync");
+                glClientWaitSyncProc = getExtProcAddress<PFNGLCLIENTWAITSYNCPROC>("glClientWaitSync");
+            }
 #endif
+
+#if OUZEL_SUPPORTS_OPENGLES
+            if (apiMajorVersion >= 3)
+#else
+            if ((apiMajorVersion == 4 && apiMinorVersion >= 1) || // at least OpenGL 4.1
+                apiMajorVersion > 4)
+#endif
+            {
+                glGetProgramBinaryProc = getExtProcAddress<PFNGLGETPROGRAMBINARYPROC>("glGetProgramBinary");
+                glProgramBinaryProc = getExtProcAddress<PFNGLPROGRAMBINARYPROC>("glProgramBinary");
+                glProgramParameteriProc = getExtProcAddress<PFNGLPROGRAMPARAMETERIPROC>("glProgramParameteri");
             }
 
             if (apiMajorVersion >= 3)
@@ -549,6 +595,9 @@ namespace ouzel
                 textureMaxLevelSupported = true;
                 renderTargetsSupported = true;
 
+                glDrawElementsInstancedProc = getExtProcAddress<PFNGLDRAWELEMENTSINSTANCEDPROC>("glDrawElementsInstanced");
+                glVertexAttribDivisorProc = getExtProcAddress<PFNGLVERTEXATTRIBDIVISORPROC>("glVertexAttribDivisor");
+
                 glUniform1uivProc = getExtProcAddress<PFNGLUNIFORM1UIVPROC>("glUniform1uiv");
                 glUniform2uivProc = getExtProcAddress<PFNGLUNIFORM2UIVPROC>("glUniform2uiv");
                 glUniform3uivProc = getExtProcAddress<PFNGLUNIFORM3UIVPROC>("glUniform3uiv");
@@ -627,6 +676,16 @@ namespace ouzel
 #endif
                 }
 #if OUZEL_SUPPORTS_OPENGLES // OpenGL ES
+                else if (extension == "GL_EXT_instanced_arrays")
+                {
+                    if (!glDrawElementsInstancedProc) glDrawElementsInstancedProc = getExtProcAddress<PFNGLDRAWELEMENTSINSTANCEDEXTPROC>("glDrawElementsInstancedEXT");
+                    if (!glVertexAttribDivisorProc) glVertexAttribDivisorProc = getExtProcAddress<PFNGLVERTEXATTRIBDIVISOREXTPROC>("glVertexAttribDivisorEXT");
+                }
+                else if (extension == "GL_ANGLE_instanced_arrays")
+                {
+                    if (!glDrawElementsInstancedProc) glDrawElementsInstancedProc = getExtProcAddress<PFNGLDRAWELEMENTSINSTANCEDANGLEPROC>("glDrawElementsInstancedANGLE");
+                    if (!glVertexAttribDivisorProc) glVertexAttribDivisorProc = getExtProcAddress<PFNGLVERTEXATTRIBDIVISORANGLEPROC>("glVertexAttribDivisorANGLE");
+                }
                 else if (extension == "GL_APPLE_framebuffer_multisample")
                 {
                     multisamplingSupported = true;
@@ -648,6 +707,13 @@ namespace ouzel
 #  if !OUZEL_OPENGL_INTERFACE_EAGL
                 else if (extension == "GL_EXT_copy_image")
                     glCopyImageSubDataProc = getExtProcAddress<PFNGLCOPYIMAGESUBDATAEXTPROC>("glCopyImageSubDataEXT");
+                else if (extension == "GL_EXT_buffer_storage")
+                    glBufferStorageProc = getExtProcAddress<PFNGLBUFFERSTORAGEEXTPROC>("glBufferStorageEXT");
+                else if (extension == "GL_OES_get_program_binary")
+                {
+                    if (!glGetProgramBinaryProc) glGetProgramBinaryProc = getExtProcAddress<PFNGLGETPROGRAMBINARYPROC>("glGetProgramBinaryOES");
+                    if (!glProgramBinaryProc) glProgramBinaryProc = getExtProcAddress<PFNGLPROGRAMBINARYPROC>("glProgramBinaryOES");
+                }
                 else if (extension == "GL_EXT_multisampled_render_to_texture")
                 {
                     multisamplingSupported = true;
@@ -661,8 +727,30 @@ namespace ouzel
                 }
 #  endif
 #else // OpenGL
+                else if (extension == "GL_ARB_instanced_arrays")
+                {
+                    if (!glVertexAttribDivisorProc) glVertexAttribDivisorProc = getExtProcAddress<PFNGLVERTEXATTRIBDIVISORARBPROC>("glVertexAttribDivisorARB");
+                }
+                else if (extension == "GL_ARB_draw_instanced")
+                {
+                    if (!glDrawElementsInstancedProc) glDrawElementsInstancedProc = getExtProcAddress<PFNGLDRAWELEMENTSINSTANCEDARBPROC>("glDrawElementsInstancedARB");
+                }
                 else if (extension == "GL_ARB_copy_image")
                     glCopyImageSubDataProc = getExtProcAddress<PFNGLCOPYIMAGESUBDATAPROC>("glCopyImageSubData");
+                else if (extension == "GL_ARB_buffer_storage")
+                    glBufferStorageProc = getExtProcAddress<PFNGLBUFFERSTORAGEPROC>("glBufferStorage");
+                else if (extension == "GL_ARB_get_program_binary")
+                {
+                    glGetProgramBinaryProc = getExtProcAddress<PFNGLGETPROGRAMBINARYPROC>("glGetProgramBinary");
+                    glProgramBinaryProc = getExtProcAddress<PFNGLPROGRAMBINARYPROC>("glProgramBinary");
+                    glProgramParameteriProc = getExtProcAddress<PFNGLPROGRAMPARAMETERIPROC>("glProgramParameteri");
+                }
+                else if (extension == "GL_ARB_sync")
+                {
+                    glFenceSyncProc = getExtProcAddress<PFNGLFENCESYNCPROC>("glFenceSync");
+                    glDeleteSyncProc = getExtProcAddress<PFNGLDELETESYNCPROC>("glDeleteSync");
+                    glClientWaitSyncProc = getExtProcAddress<PFNGLCLIENTWAITSYNCPROC>("glClientWaitSync");
+                }
                 else if (extension == "GL_ARB_vertex_array_object")
                 {
                     glGenVertexArraysProc = getExtProcAddress<PFNGLGENVERTEXARRAYSPROC>("glGenVertexArrays");
@@ -702,6 +790,35 @@ namespace ouzel
 
             if (!multisamplingSupported) sampleCount = 1;
 
+            instancingSupported = glDrawElementsInstancedProc && glVertexAttribDivisorProc;
+
+            if (glGetProgramBinaryProc && glProgramBinaryProc)
+            {
+                GLint binaryFormatCount = 0;
+                glGetIntegervProc(GL_NUM_PROGRAM_BINARY_FORMATS, &binaryFormatCount);
+
+                if ((error = glGetErrorProc()) == GL_NO_ERROR && binaryFormatCount > 0)
+                {
+                    try
+                    {
+                        programCacheDirectory = engine->getFileSystem().getStorageDirectory();
+
+                        // binaries are only valid for the driver that created them
+                        for (GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION})
+                        {
+                            const GLubyte* value = glGetStringProc(name);
+                            if (value) driverString += reinterpret_cast<const char*>(value);
+                            driverString += '\n';
+                        }
+                    }
+                    catch (const std::exception& e)
+                    {
+                        engine->log(Log::Level::WARN) << "Shader cache disabled, " << e.what();
+                        programCacheDirectory.clear();
+                    }
+                }
+            }
+
             glDisableProc(GL_DITHER);
 
             if ((error = glGetErrorProc()) != GL_NO_ERROR)
@@ -826,6 +943,7 @@ namespace ouzel
 
                         case Command::Type::PRESENT:
                         {
+                            captureFrame();
                             present();
                             break;
                         }
@@ -1152,21 +1270,28 @@ namespace ouzel
                             bindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer->getBufferId());
                             bindBuffer(GL_ARRAY_BUFFER, vertexBuffer->getBufferId());
 
-                            GLuint vertexOffset = 0;
+                            const VertexLayout& vertexLayout = vertexBuffer->getLayout();
 
+                            // attributes have fixed locations (see OGLShader), the ones that the shader does not
+                            // read or that are missing from the buffer's layout are disabled
                             for (GLuint index = 0; index < Vertex::ATTRIBUTES.size(); ++index)
                             {
-                                const Vertex::Attribute& vertexAttribute = Vertex::ATTRIBUTES[index];
-
-                                glEnableVertexAttribArrayProc(index);
-                                glVertexAttribPointerProc(index,
-                                                          getArraySize(vertexAttribute.dataType),
-                                                          getVertexType(vertexAttribute.dataType),
-                                                          isNormalized(vertexAttribute.dataType),
-                                                          static_cast<GLsizei>(sizeof(Vertex)),
-                                                          reinterpret_cast<void*>(static_cast<uintptr_t>(vertexOffset)));
+                                Vertex::Attribute::Usage usage = Vertex::ATTRIBUTES[index].usage;
+                                const VertexLayout::Element* element = vertexLayout.getElement(usage);
 
-                                vertexOffset += getDataTypeSize(vertexAttribute.dataType);
+                                if (element && currentShader &&
+                                    currentShader->getVertexAttributes().find(usage) != currentShader->getVertexAttributes().end())
+                                {
+                                    glEnableVertexAttribArrayProc(index);
+                                    glVertexAttribPointerProc(index,
+                                                              getArraySize(element->dataType),
+                                                              getVertexType(element->dataType),
+                                                              isNormalized(element->dataType),
+                                                              static_cast<GLsizei>(vertexLayout.getStride()),
+                                                              reinterpret_cast<void*>(static_cast<uintptr_t>(vertexBuffer->getOffset() + element->offset)));
+                                }
+                                else
+                                    glDisableVertexAttribArrayProc(index);
                             }
 
                             GLenum error;
@@ -1177,13 +1302,65 @@ namespace ouzel
                             assert(indexBuffer->getSize());
                             assert(vertexBuffer->getSize());
 
-                            glDrawElementsProc(getDrawMode(drawCommand->drawMode),
-                                               static_cast<GLsizei>(drawCommand->indexCount),
-                                               getIndexType(drawCommand->indexSize),
-                                               reinterpret_cast<void*>(static_cast<uintptr_t>(drawCommand->startIndex * drawCommand->indexSize)));
+                            if (drawCommand->instanceBuffer)
+                            {
+                                OGLBuffer* instanceBuffer = static_cast<OGLBuffer*>(resources[drawCommand->instanceBuffer - 1].get());
 
-                            if ((error = glGetErrorProc()) != GL_NO_ERROR)
-                                throw std::system_error(makeErrorCode(error), "Failed to draw elements");
+                                assert(instanceBuffer);
+                                assert(instanceBuffer->getBufferId());
+
+                                bindBuffer(GL_ARRAY_BUFFER, instanceBuffer->getBufferId());
+
+                                // instance attributes are bound after the vertex attributes (see OGLShader)
+                                const VertexLayout& instanceLayout = instanceBuffer->getLayout();
+
+                                for (GLuint index = 0; index < Instance::ATTRIBUTES.size(); ++index)
+                                {
+                                    const VertexLayout::Element* element = instanceLayout.getElement(Instance::ATTRIBUTES[index].usage);
+                                    if (!element) continue;
+
+                                    GLuint location = static_cast<GLuint>(Vertex::ATTRIBUTES.size()) + index;
+
+                                    glEnableVertexAttribArrayProc(location);
+                                    glVertexAttribPointerProc(location,
+                                                              getArraySize(element->dataType),
+                                                              getVertexType(element->dataType),
+                                                              isNormalized(element->dataType),
+                                                              static_cast<GLsizei>(instanceLayout.getStride()),
+                                                              reinterpret_cast<void*>(static_cast<uintptr_t>(instanceBuffer->getOffset() + element->offset)));
+                                    glVertexAttribDivisorProc(location, 1);
+                                }
+
+                                if ((error = glGetErrorProc()) != GL_NO_ERROR)
+                                    throw std::system_error(makeErrorCode(error), "Failed to update instance attributes");
+
+                                glDrawElementsInstancedProc(getDrawMode(drawCommand->drawMode),
+                                                            static_cast<GLsizei>(drawCommand->indexCount),
+                                                            getIndexType(drawCommand->indexSize),
+                                                            reinterpret_cast<void*>(static_cast<uintptr_t>(indexBuffer->getOffset() + drawCommand->startIndex * drawCommand->indexSize)),
+                                                            static_cast<GLsizei>(drawCommand->instanceCount));
+
+                                if ((error = glGetErrorProc()) != GL_NO_ERROR)
+                                    throw std::system_error(makeErrorCode(error), "Failed to draw instanced elements");
+
+                                // non-instanced draws must not read the instance attributes
+                                for (GLuint index = 0; index < Instance::ATTRIBUTES.size(); ++index)
+                                {
+                                    GLuint location = static_cast<GLuint>(Vertex::ATTRIBUTES.size()) + index;
+                                    glVertexAttribDivisorProc(location, 0);
+                                    glDisableVertexAttribArrayProc(location);
+                                }
+                            }
+                            else
+                            {
+                                glDrawElementsProc(getDrawMode(drawCommand->drawMode),
+                                                   static_cast<GLsizei>(drawCommand->indexCount),
+                                                   getIndexType(drawCommand->indexSize),
+                                                   reinterpret_cast<void*>(static_cast<uintptr_t>(indexBuffer->getOffset() + drawCommand->startIndex * drawCommand->indexSize)));
+
+                                if ((error = glGetErrorProc()) != GL_NO_ERROR)
+                                    throw std::system_error(makeErrorCode(error), "Failed to draw elements");
+                            }
 
                             break;
                         }
@@ -1229,7 +1406,8 @@ namespace ouzel
                                                                             initBufferCommand->usage,
                                                                             initBufferCommand->flags,
                                                                             initBufferCommand->data,
-                                                                            initBufferCommand->size));
+                                                                            initBufferCommand->size,
+                                                                            initBufferCommand->layout));
 
                             if (initBufferCommand->buffer > resources.size())
                                 resources.resize(initBufferCommand->buffer);
@@ -1239,7 +1417,7 @@ namespace ouzel
 
                         case Command::Type::SET_BUFFER_DATA:
                         {
-                            auto setBufferDataCommand = static_cast<const SetBufferDataCommand*>(command.get());
+                            auto setBufferDataCommand = static_cast<SetBufferDataCommand*>(command.get());
 
                             OGLBuffer* buffer = static_cast<OGLBuffer*>(resources[setBufferDataCommand->buffer - 1].get());
                             buffer->setData(setBufferDataCommand->data);
@@ -1336,6 +1514,18 @@ namespace ouzel
                             break;
                         }
 
+                        case Command::Type::SET_TEXTURE_REGION_DATA:
+                        {
+                            auto setTextureRegionDataCommand = static_cast<const SetTextureRegionDataCommand*>(command.get());
+
+                            OGLTexture* texture = static_cast<OGLTexture*>(resources[setTextureRegionDataCommand->texture - 1].get());
+                            texture->setData(setTextureRegionDataCommand->data,
+                                             setTextureRegionDataCommand->offset,
+                                             setTextureRegionDataCommand->size);
+
+                            break;
+                        }
+
                         case Command::Type::SET_TEXTURE_PARAMETERS:
                         {
                             auto setTextureParametersCommand = static_cast<const SetTextureParametersCommand*>(command.get());
@@ -1379,36 +1569,112 @@ namespace ouzel
         {
         }
 
-        void OGLRenderDevice::generateScreenshot(const std::string& filename)
+        void OGLRenderDevice::captureFrame()
         {
+            for (size_t i = 0; i < READBACK_COUNT; ++i)
+                if (readbacks[i].fence) finishReadback(i, false);
+
+            std::vector<Capture> captures = getFrameCaptures();
+            if (captures.empty()) return;
+
             bindFrameBuffer(frameBufferId);
 
             const GLsizei pixelSize = 4;
+            const GLsizeiptr dataSize = frameBufferWidth * frameBufferHeight * pixelSize;
 
-            std::vector<uint8_t> data(static_cast<size_t>(frameBufferWidth * frameBufferHeight * pixelSize));
+            if (apiMajorVersion >= 3 && glMapBufferRangeProc && glUnmapBufferProc &&
+                glFenceSyncProc && glDeleteSyncProc && glClientWaitSyncProc)
+            {
+                // all the readbacks are in flight only if the GPU is several frames behind
+                if (readbacks[nextReadback].fence) finishReadback(nextReadback, true);
 
-            glReadPixelsProc(0, 0, frameBufferWidth, frameBufferHeight,
-                             GL_RGBA, GL_UNSIGNED_BYTE, data.data());
+                Readback& readback = readbacks[nextReadback];
+                nextReadback = (nextReadback + 1) % READBACK_COUNT;
 
-            GLenum error;
+                if (!readback.pixelBuffer)
+                {
+                    glGenBuffersProc(1, &readback.pixelBuffer);
 
-            if ((error = glGetErrorProc()) != GL_NO_ERROR)
-                throw std::system_error(makeErrorCode(error), "Failed to read pixels from frame buffer");
+                    GLenum error;
 
-            uint32_t temp;
-            uint32_t* rgba = reinterpret_cast<uint32_t*>(data.data());
-            for (GLsizei row = 0; row < frameBufferHeight / 2; ++row)
-            {
-                for (GLsizei col = 0; col < frameBufferWidth; ++col)
-                {
-                    temp = rgba[static_cast<size_t>((frameBufferHeight - row - 1) * frameBufferWidth + col)];
-                    rgba[static_cast<size_t>((frameBufferHeight - row - 1) * frameBufferWidth + col)] = rgba[static_cast<size_t>(row * frameBufferWidth + col)];
-                    rgba[static_cast<size_t>(row * frameBufferWidth + col)] = temp;
+                    if ((error = glGetErrorProc()) != GL_NO_ERROR)
+                        throw std::system_error(makeErrorCode(error), "Failed to create pixel buffer");
                 }
+
+                bindBuffer(GL_PIXEL_PACK_BUFFER, readback.pixelBuffer);
+                glBufferDataProc(GL_PIXEL_PACK_BUFFER, dataSize, nullptr, GL_STREAM_READ);
+                glReadPixelsProc(0, 0, frameBufferWidth, frameBufferHeight,
+                                 GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+                bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+                GLenum error;
+
+                if ((error = glGetErrorProc()) != GL_NO_ERROR)
+                    throw std::system_error(makeErrorCode(error), "Failed to read pixels from frame buffer");
+
+                readback.fence = glFenceSyncProc(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+                readback.width = frameBufferWidth;
+                readback.height = frameBufferHeight;
+                readback.captures = std::move(captures);
+            }
+            else
+            {
+                std::vector<uint8_t> data(static_cast<size_t>(dataSize));
+
+                glReadPixelsProc(0, 0, frameBufferWidth, frameBufferHeight,
+                                 GL_RGBA, GL_UNSIGNED_BYTE, data.data());
+
+                GLenum error;
+
+                if ((error = glGetErrorProc()) != GL_NO_ERROR)
+                    throw std::system_error(makeErrorCode(error), "Failed to read pixels from frame buffer");
+
+                saveCaptures(std::move(captures), std::move(data),
+                             static_cast<uint32_t>(frameBufferWidth),
+                             static_cast<uint32_t>(frameBufferHeight),
+                             true, false);
             }
+        }
+
+        void OGLRenderDevice::finishReadback(size_t index, bool wait)
+        {
+            Readback& readback = readbacks[index];
+
+            GLenum result = glClientWaitSyncProc(readback.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+
+            if (wait)
+                while (result == GL_TIMEOUT_EXPIRED)
+                    result = glClientWaitSyncProc(readback.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+
+            if (result == GL_TIMEOUT_EXPIRED) return;
+
+            glDeleteSyncProc(readback.fence);
+            readback.fence = nullptr;
+
+            if (result == GL_WAIT_FAILED)
+                throw std::system_error(makeErrorCode(glGetErrorProc()), "Failed to wait for pixel buffer fence");
+
+            const GLsizeiptr dataSize = readback.width * readback.height * 4;
+            std::vector<uint8_t> data(static_cast<size_t>(dataSize));
+
+            bindBuffer(GL_PIXEL_PACK_BUFFER, readback.pixelBuffer);
+            const uint8_t* pixels = static_cast<const uint8_t*>(glMapBufferRangeProc(GL_PIXEL_PACK_BUFFER, 0, dataSize, GL_MAP_READ_BIT));
+
+            if (!pixels)
+            {
+                bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+                throw std::system_error(makeErrorCode(glGetErrorProc()), "Failed to map pixel buffer");
+            }
+
+            std::copy(pixels, pixels + dataSize, data.begin());
+            glUnmapBufferProc(GL_PIXEL_PACK_BUFFER);
+            bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
 
-            if (!stbi_write_png(filename.c_str(), frameBufferWidth, frameBufferHeight, pixelSize, data.data(), frameBufferWidth * pixelSize))
-                throw std::runtime_error("Failed to save image to file");
+            saveCaptures(std::move(readback.captures), std::move(data),
+                         static_cast<uint32_t>(readback.width),
+                         static_cast<uint32_t>(readback.height),
+                         true, false);
+            readback.captures.clear();
         }
     } // namespace graphics
 } // namespace ouzel
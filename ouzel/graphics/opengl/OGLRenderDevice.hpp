@@ -13,6 +13,7 @@
 #include <map>
 #include <memory>
 #include <queue>
+#include <string>
 #include <system_error>
 #include <utility>
 #include <vector>
@@ -94,6 +95,7 @@ namespace ouzel
             PFNGLCULLFACEPROC glCullFaceProc = nullptr;
             PFNGLSCISSORPROC glScissorProc = nullptr;
             PFNGLDRAWELEMENTSPROC glDrawElementsProc = nullptr;
+            PFNGLDRAWELEMENTSINSTANCEDPROC glDrawElementsInstancedProc = nullptr;
             PFNGLREADPIXELSPROC glReadPixelsProc = nullptr;
 
             PFNGLBLENDFUNCSEPARATEPROC glBlendFuncSeparateProc = nullptr;
@@ -138,6 +140,7 @@ namespace ouzel
             PFNGLMAPBUFFERRANGEEXTPROC glMapBufferRangeProc = nullptr;
             PFNGLFRAMEBUFFERTEXTURE2DMULTISAMPLEEXTPROC glFramebufferTexture2DMultisampleProc = nullptr;
             PFNGLCOPYIMAGESUBDATAEXTPROC glCopyImageSubDataProc = nullptr;
+            PFNGLBUFFERSTORAGEEXTPROC glBufferStorageProc = nullptr;
 #  if OUZEL_OPENGL_INTERFACE_EAGL
             PFNGLDISCARDFRAMEBUFFEREXTPROC glDiscardFramebufferEXTProc = nullptr;
             PFNGLRENDERBUFFERSTORAGEMULTISAMPLEAPPLEPROC glRenderbufferStorageMultisampleAPPLEProc = nullptr;
@@ -150,6 +153,7 @@ namespace ouzel
             PFNGLUNMAPBUFFERPROC glUnmapBufferProc = nullptr;
             PFNGLMAPBUFFERRANGEPROC glMapBufferRangeProc = nullptr;
             PFNGLCOPYIMAGESUBDATAPROC glCopyImageSubDataProc = nullptr;
+            PFNGLBUFFERSTORAGEPROC glBufferStorageProc = nullptr;
 #endif
 
             PFNGLCREATESHADERPROC glCreateShaderProc = nullptr;
@@ -176,12 +180,21 @@ namespace ouzel
             PFNGLBUFFERDATAPROC glBufferDataProc = nullptr;
             PFNGLBUFFERSUBDATAPROC glBufferSubDataProc = nullptr;
 
+            PFNGLGETPROGRAMBINARYPROC glGetProgramBinaryProc = nullptr;
+            PFNGLPROGRAMBINARYPROC glProgramBinaryProc = nullptr;
+            PFNGLPROGRAMPARAMETERIPROC glProgramParameteriProc = nullptr;
+
+            PFNGLFENCESYNCPROC glFenceSyncProc = nullptr;
+            PFNGLDELETESYNCPROC glDeleteSyncProc = nullptr;
+            PFNGLCLIENTWAITSYNCPROC glClientWaitSyncProc = nullptr;
+
             PFNGLGENVERTEXARRAYSPROC glGenVertexArraysProc = nullptr;
             PFNGLBINDVERTEXARRAYPROC glBindVertexArrayProc = nullptr;
             PFNGLDELETEVERTEXARRAYSPROC glDeleteVertexArraysProc = nullptr;
             PFNGLENABLEVERTEXATTRIBARRAYPROC glEnableVertexAttribArrayProc = nullptr;
             PFNGLDISABLEVERTEXATTRIBARRAYPROC glDisableVertexAttribArrayProc = nullptr;
             PFNGLVERTEXATTRIBPOINTERPROC glVertexAttribPointerProc = nullptr;
+            PFNGLVERTEXATTRIBDIVISORPROC glVertexAttribDivisorProc = nullptr;
 
             PFNGLGETSTRINGIPROC glGetStringiProc = nullptr;
             PFNGLPUSHGROUPMARKEREXTPROC glPushGroupMarkerEXTProc = nullptr;
@@ -191,6 +204,15 @@ namespace ouzel
 
             bool isTextureBaseLevelSupported() const { return textureBaseLevelSupported; }
             bool isTextureMaxLevelSupported() const { return textureMaxLevelSupported; }
+            // program binaries are cached in this directory, empty if they are not supported
+            inline const std::string& getProgramCacheDirectory() const { return programCacheDirectory; }
+            inline const std::string& getDriverString() const { return driverString; }
+            // persistently mapped buffers with fences for reusing their storage
+            bool isBufferStorageSupported() const
+            {
+                return glBufferStorageProc && glMapBufferRangeProc &&
+                    glFenceSyncProc && glDeleteSyncProc && glClientWaitSyncProc;
+            }
 
             inline void setFrontFace(GLenum mode)
             {
@@ -627,7 +649,8 @@ namespace ouzel
 
             void process() override;
             virtual void present();
-            void generateScreenshot(const std::string& filename) override;
+            void captureFrame();
+            void finishReadback(size_t index, bool wait);
             void setUniform(GLint location, DataType dataType, const void* data);
 
             GLuint frameBufferId = 0;
@@ -638,6 +661,23 @@ namespace ouzel
             bool textureBaseLevelSupported = false;
             bool textureMaxLevelSupported = false;
 
+            std::string programCacheDirectory;
+            std::string driverString;
+
+            // frames are read into pixel pack buffers and mapped once their fence is signaled
+            struct Readback final
+            {
+                GLuint pixelBuffer = 0;
+                GLsync fence = nullptr;
+                GLsizei width = 0;
+                GLsizei height = 0;
+                std::vector<Capture> captures;
+            };
+
+            static constexpr size_t READBACK_COUNT = 3;
+            Readback readbacks[READBACK_COUNT];
+            size_t nextReadback = 0;
+
             struct StateCache
             {
                 GLenum frontFace = GL_CCW;
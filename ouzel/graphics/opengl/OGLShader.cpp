@@ -4,13 +4,48 @@
 
 #if OUZEL_COMPILE_OPENGL
 
+#include <iomanip>
+#include <sstream>
 #include "OGLShader.hpp"
 #include "OGLRenderDevice.hpp"
+#include "core/Engine.hpp"
+#include "files/FileSystem.hpp"
+#include "graphics/Instance.hpp"
+#include "utils/Log.hpp"
 
 namespace ouzel
 {
     namespace graphics
     {
+        static constexpr uint32_t PROGRAM_BINARY_MAGIC = 0x4250474F; // "OGPB"
+        static constexpr size_t PROGRAM_BINARY_HEADER_SIZE = 16;
+
+        // 64-bit FNV-1a
+        static uint64_t hashData(uint64_t hash, const uint8_t* data, size_t size)
+        {
+            for (size_t i = 0; i < size; ++i)
+            {
+                hash ^= data[i];
+                hash *= 1099511628211U;
+            }
+
+            return hash;
+        }
+
+        static void encodeUInt32(std::vector<uint8_t>& buffer, uint32_t value)
+        {
+            for (uint32_t i = 0; i < 4; ++i)
+                buffer.push_back(static_cast<uint8_t>(value >> (i * 8)));
+        }
+
+        static uint32_t decodeUInt32(const uint8_t* buffer)
+        {
+            return static_cast<uint32_t>(buffer[0]) |
+                static_cast<uint32_t>(buffer[1]) << 8 |
+                static_cast<uint32_t>(buffer[2]) << 16 |
+                static_cast<uint32_t>(buffer[3]) << 24;
+        }
+
         OGLShader::OGLShader(OGLRenderDevice& renderDeviceOGL,
                              const std::vector<uint8_t>& newFragmentShader,
                              const std::vector<uint8_t>& newVertexShader,
@@ -79,7 +114,7 @@ namespace ouzel
             return std::string();
         }
 
-        void OGLShader::compileShader()
+        void OGLShader::linkProgram()
         {
             fragmentShaderId = renderDevice.glCreateShaderProc(GL_FRAGMENT_SHADER);
 
@@ -116,10 +151,11 @@ namespace ouzel
             renderDevice.glAttachShaderProc(programId, vertexShaderId);
             renderDevice.glAttachShaderProc(programId, fragmentShaderId);
 
-            GLuint index = 0;
-
-            for (const Vertex::Attribute& vertexAttribute : Vertex::ATTRIBUTES)
+            // every attribute has a fixed location, so that any vertex layout can feed any shader (see OGLRenderDevice)
+            for (GLuint index = 0; index < Vertex::ATTRIBUTES.size(); ++index)
             {
+                const Vertex::Attribute& vertexAttribute = Vertex::ATTRIBUTES[index];
+
                 if (vertexAttributes.find(vertexAttribute.usage) != vertexAttributes.end())
                 {
                     const GLchar* name;
@@ -164,10 +200,40 @@ namespace ouzel
                     }
 
                     renderDevice.glBindAttribLocationProc(programId, index, name);
-                    ++index;
                 }
             }
 
+            // instance attributes have fixed locations after all of the vertex attributes
+            for (GLuint instanceIndex = 0; instanceIndex < Instance::ATTRIBUTES.size(); ++instanceIndex)
+            {
+                const Vertex::Attribute& instanceAttribute = Instance::ATTRIBUTES[instanceIndex];
+
+                if (vertexAttributes.find(instanceAttribute.usage) != vertexAttributes.end())
+                {
+                    const GLchar* name;
+
+                    switch (instanceAttribute.usage)
+                    {
+                        case Vertex::Attribute::Usage::INSTANCE_TRANSFORM:
+                            name = "instanceTransform0";
+                            break;
+                        case Vertex::Attribute::Usage::INSTANCE_COLOR:
+                            name = "instanceColor0";
+                            break;
+                        default:
+                            throw std::runtime_error("Invalid instance attribute usage");
+                    }
+
+                    renderDevice.glBindAttribLocationProc(programId,
+                                                          static_cast<GLuint>(Vertex::ATTRIBUTES.size()) + instanceIndex,
+                                                          name);
+                }
+            }
+
+            // the binary can only be retrieved with this hint on some drivers
+            if (renderDevice.glProgramParameteriProc && !renderDevice.getProgramCacheDirectory().empty())
+                renderDevice.glProgramParameteriProc(programId, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
             renderDevice.glLinkProgramProc(programId);
 
             renderDevice.glGetProgramivProc(programId, GL_LINK_STATUS, &status);
@@ -187,6 +253,54 @@ namespace ouzel
 
             if ((error = renderDevice.glGetErrorProc()) != GL_NO_ERROR)
                 throw std::system_error(makeErrorCode(error), "Failed to detach shader");
+        }
+
+        void OGLShader::compileShader()
+        {
+            std::string cacheFilename;
+
+            const std::string& cacheDirectory = renderDevice.getProgramCacheDirectory();
+
+            if (!cacheDirectory.empty())
+            {
+                // the key changes with the sources, the attribute bindings and the driver
+                const std::string& driverString = renderDevice.getDriverString();
+                uint64_t hash = 14695981039346656037U;
+                hash = hashData(hash, fragmentShaderData.data(), fragmentShaderData.size());
+                hash = hashData(hash, vertexShaderData.data(), vertexShaderData.size());
+                for (GLuint index = 0; index < Vertex::ATTRIBUTES.size(); ++index)
+                {
+                    if (vertexAttributes.find(Vertex::ATTRIBUTES[index].usage) != vertexAttributes.end())
+                    {
+                        uint8_t value[] = {static_cast<uint8_t>(Vertex::ATTRIBUTES[index].usage), static_cast<uint8_t>(index)};
+                        hash = hashData(hash, value, sizeof(value));
+                    }
+                }
+                for (GLuint index = 0; index < Instance::ATTRIBUTES.size(); ++index)
+                {
+                    if (vertexAttributes.find(Instance::ATTRIBUTES[index].usage) != vertexAttributes.end())
+                    {
+                        uint8_t value[] = {static_cast<uint8_t>(Instance::ATTRIBUTES[index].usage), static_cast<uint8_t>(Vertex::ATTRIBUTES.size() + index)};
+                        hash = hashData(hash, value, sizeof(value));
+                    }
+                }
+                hash = hashData(hash, reinterpret_cast<const uint8_t*>(driverString.data()), driverString.size());
+
+                std::ostringstream filename;
+                filename << cacheDirectory << FileSystem::DIRECTORY_SEPARATOR <<
+                    "shader-" << std::hex << std::setw(16) << std::setfill('0') << hash << ".bin";
+                cacheFilename = filename.str();
+            }
+
+            if (cacheFilename.empty() || !loadProgramBinary(cacheFilename))
+            {
+                linkProgram();
+
+                if (!cacheFilename.empty())
+                    saveProgramBinary(cacheFilename);
+            }
+
+            GLenum error;
 
             renderDevice.useProgram(programId);
 
@@ -237,6 +351,89 @@ namespace ouzel
                 }
             }
         }
+
+        bool OGLShader::loadProgramBinary(const std::string& filename)
+        {
+            FileSystem& fileSystem = engine->getFileSystem();
+
+            if (!fileSystem.fileExists(filename)) return false;
+
+            std::vector<uint8_t> data;
+
+            try
+            {
+                data = fileSystem.readFile(filename, false);
+            }
+            catch (const std::exception& e)
+            {
+                engine->log(Log::Level::WARN) << "Failed to read shader cache " << filename << ", " << e.what();
+                return false;
+            }
+
+            if (data.size() <= PROGRAM_BINARY_HEADER_SIZE ||
+                decodeUInt32(data.data()) != PROGRAM_BINARY_MAGIC ||
+                decodeUInt32(data.data() + 12) != data.size() - PROGRAM_BINARY_HEADER_SIZE)
+                return false;
+
+            GLenum binaryFormat = static_cast<GLenum>(decodeUInt32(data.data() + 8));
+
+            programId = renderDevice.glCreateProgramProc();
+            renderDevice.glProgramBinaryProc(programId, binaryFormat,
+                                             data.data() + PROGRAM_BINARY_HEADER_SIZE,
+                                             static_cast<GLsizei>(data.size() - PROGRAM_BINARY_HEADER_SIZE));
+
+            // drivers reject binaries after an update, an unknown format also sets an error
+            GLint status = GL_FALSE;
+            if (renderDevice.glGetErrorProc() == GL_NO_ERROR)
+                renderDevice.glGetProgramivProc(programId, GL_LINK_STATUS, &status);
+
+            if (status == GL_FALSE)
+            {
+                engine->log(Log::Level::INFO) << "Shader cache " << filename << " was rejected by the driver";
+
+                renderDevice.deleteProgram(programId);
+                programId = 0;
+                return false;
+            }
+
+            return true;
+        }
+
+        void OGLShader::saveProgramBinary(const std::string& filename)
+        {
+            GLint length = 0;
+            renderDevice.glGetProgramivProc(programId, GL_PROGRAM_BINARY_LENGTH, &length);
+
+            if (renderDevice.glGetErrorProc() != GL_NO_ERROR || length <= 0)
+                return;
+
+            std::vector<uint8_t> data;
+            encodeUInt32(data, PROGRAM_BINARY_MAGIC);
+            encodeUInt32(data, 0);
+            encodeUInt32(data, 0);
+            encodeUInt32(data, static_cast<uint32_t>(length));
+            data.resize(PROGRAM_BINARY_HEADER_SIZE + static_cast<size_t>(length));
+
+            GLenum binaryFormat = 0;
+            GLsizei binaryLength = 0;
+            renderDevice.glGetProgramBinaryProc(programId, length, &binaryLength, &binaryFormat,
+                                                data.data() + PROGRAM_BINARY_HEADER_SIZE);
+
+            if (renderDevice.glGetErrorProc() != GL_NO_ERROR || binaryLength != length)
+                return;
+
+            for (uint32_t i = 0; i < 4; ++i)
+                data[8 + i] = static_cast<uint8_t>(binaryFormat >> (i * 8));
+
+            try
+            {
+                engine->getFileSystem().writeFile(filename, data);
+            }
+            catch (const std::exception& e)
+            {
+                engine->log(Log::Level::WARN) << "Failed to write shader cache " << filename << ", " << e.what();
+            }
+        }
     } // namespace graphics
 } // namespace ouzel
 
@@ -58,6 +58,9 @@ namespace ouzel
 
         private:
             void compileShader();
+            void linkProgram();
+            bool loadProgramBinary(const std::string& filename);
+            void saveProgramBinary(const std::string& filename);
             std::string getShaderMessage(GLuint shaderId);
             std::string getProgramMessage();
 
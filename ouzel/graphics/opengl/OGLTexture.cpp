@@ -390,6 +390,44 @@ namespace ouzel
                 throw std::system_error(makeErrorCode(error), "Failed to upload texture data");
         }
 
+        void OGLTexture::setData(const std::vector<uint8_t>& data,
+                                 const Vector2<uint32_t>& offset,
+                                 const Size2<uint32_t>& size)
+        {
+            if (!(flags & Texture::DYNAMIC) || flags & Texture::BIND_RENDER_TARGET)
+                throw std::runtime_error("Texture is not dynamic");
+
+            if (!textureId)
+                throw std::runtime_error("Texture not initialized");
+
+            // keep the copy used for reloading the texture up to date
+            if (!levels.empty() && !levels[0].data.empty())
+            {
+                uint32_t pixelSize = levels[0].pitch / levels[0].size.v[0];
+                uint32_t rowSize = size.v[0] * pixelSize;
+
+                for (uint32_t row = 0; row < size.v[1]; ++row)
+                    std::copy(data.begin() + row * rowSize,
+                              data.begin() + (row + 1) * rowSize,
+                              levels[0].data.begin() + (offset.v[1] + row) * levels[0].pitch + offset.v[0] * pixelSize);
+            }
+
+            renderDevice.bindTexture(textureTarget, 0, textureId);
+
+            renderDevice.glTexSubImage2DProc(GL_TEXTURE_2D, 0,
+                                             static_cast<GLint>(offset.v[0]),
+                                             static_cast<GLint>(offset.v[1]),
+                                             static_cast<GLsizei>(size.v[0]),
+                                             static_cast<GLsizei>(size.v[1]),
+                                             pixelFormat, pixelType,
+                                             data.data());
+
+            GLenum error;
+
+            if ((error = renderDevice.glGetErrorProc()) != GL_NO_ERROR)
+                throw std::system_error(makeErrorCode(error), "Failed to upload texture data");
+        }
+
         void OGLTexture::setFilter(Texture::Filter newFilter)
         {
             filter = newFilter;
@@ -42,6 +42,9 @@ namespace ouzel
             void reload() override;
 
             void setData(const std::vector<Texture::Level>& newLevels);
+            void setData(const std::vector<uint8_t>& data,
+                         const Vector2<uint32_t>& offset,
+                         const Size2<uint32_t>& size);
             void setFilter(Texture::Filter newFilter);
             void setAddressX(Texture::Address newAddressX);
             void setAddressY(Texture::Address newAddressY);
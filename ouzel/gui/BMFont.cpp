@@ -222,6 +222,11 @@ namespace ouzel
                             value = parseInt(data, iterator);
                             outline = static_cast<uint16_t>(std::stoi(value));
                         }
+                        else if (key == "distanceField")
+                        {
+                            value = parseInt(data, iterator);
+                            distanceField = std::stoi(value) != 0;
+                        }
                         else
                             value = parseString(data, iterator);
                     }
@@ -34,6 +34,12 @@ namespace ouzel
                                  std::vector<uint16_t>& indices,
                                  std::vector<graphics::Vertex>& vertices,
                                  std::shared_ptr<graphics::Texture>& texture) = 0;
+
+        // glyphs store signed distances in the alpha channel and should be drawn with SHADER_DISTANCE_FIELD
+        inline bool isDistanceField() const { return distanceField; }
+
+    protected:
+        bool distanceField = false;
     };
 }
 
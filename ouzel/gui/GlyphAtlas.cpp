@@ -0,0 +1,211 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#include <algorithm>
+#include <limits>
+#include "GlyphAtlas.hpp"
+#include "core/Engine.hpp"
+
+namespace ouzel
+{
+    static constexpr uint32_t PADDING = 1;
+    static constexpr uint32_t MAX_SIZE = 4096;
+
+    GlyphAtlas::GlyphAtlas(const Size2<uint32_t>& initSize, bool initMipmaps):
+        size(initSize),
+        mipmaps(initMipmaps),
+        data(initSize.v[0] * initSize.v[1] * 4)
+    {
+        skyline.push_back({0, 0, size.v[0]});
+
+        for (size_t i = 0; i < data.size(); i += 4)
+        {
+            data[i + 0] = 255;
+            data[i + 1] = 255;
+            data[i + 2] = 255;
+            data[i + 3] = 0;
+        }
+    }
+
+    bool GlyphAtlas::fits(size_t index, uint32_t width, uint32_t height, uint32_t& y) const
+    {
+        uint32_t x = skyline[index].x;
+        if (x + width > size.v[0]) return false;
+
+        y = 0;
+        uint32_t remaining = width;
+
+        for (size_t i = index; remaining > 0; ++i)
+        {
+            y = std::max(y, skyline[i].y);
+            if (y + height > size.v[1]) return false;
+            remaining = (skyline[i].width >= remaining) ? 0 : remaining - skyline[i].width;
+        }
+
+        return true;
+    }
+
+    bool GlyphAtlas::addGlyph(uint32_t width, uint32_t height, const uint8_t* bitmap, Vector2<uint32_t>& position)
+    {
+        uint32_t paddedWidth = width + PADDING;
+        uint32_t paddedHeight = height + PADDING;
+
+        // bottom-left heuristic: lowest top edge first, then the narrowest segment
+        size_t bestIndex = skyline.size();
+        uint32_t bestTop = std::numeric_limits<uint32_t>::max();
+        uint32_t bestWidth = std::numeric_limits<uint32_t>::max();
+        uint32_t bestY = 0;
+
+        for (size_t i = 0; i < skyline.size(); ++i)
+        {
+            uint32_t y;
+            if (fits(i, paddedWidth, paddedHeight, y))
+            {
+                if (y + paddedHeight < bestTop ||
+                    (y + paddedHeight == bestTop && skyline[i].width < bestWidth))
+                {
+                    bestIndex = i;
+                    bestTop = y + paddedHeight;
+                    bestWidth = skyline[i].width;
+                    bestY = y;
+                }
+            }
+        }
+
+        if (bestIndex == skyline.size()) return false;
+
+        position.v[0] = skyline[bestIndex].x;
+        position.v[1] = bestY;
+
+        Node node = {position.v[0], bestTop, paddedWidth};
+        skyline.insert(skyline.begin() + static_cast<std::ptrdiff_t>(bestIndex), node);
+
+        // shrink or remove the segments covered by the new one
+        for (size_t i = bestIndex + 1; i < skyline.size();)
+        {
+            uint32_t end = skyline[i - 1].x + skyline[i - 1].width;
+            if (skyline[i].x >= end) break;
+
+            uint32_t shrink = end - skyline[i].x;
+            if (skyline[i].width > shrink)
+            {
+                skyline[i].x += shrink;
+                skyline[i].width -= shrink;
+                break;
+            }
+
+            skyline.erase(skyline.begin() + static_cast<std::ptrdiff_t>(i));
+        }
+
+        for (size_t i = 0; i + 1 < skyline.size();)
+        {
+            if (skyline[i].y == skyline[i + 1].y)
+            {
+                skyline[i].width += skyline[i + 1].width;
+                skyline.erase(skyline.begin() + static_cast<std::ptrdiff_t>(i + 1));
+            }
+            else
+                ++i;
+        }
+
+        for (uint32_t row = 0; row < height; ++row)
+            for (uint32_t column = 0; column < width; ++column)
+                data[((position.v[1] + row) * size.v[0] + position.v[0] + column) * 4 + 3] = bitmap[row * width + column];
+
+        if (width && height)
+        {
+            if (dirty)
+            {
+                dirtyMin.v[0] = std::min(dirtyMin.v[0], position.v[0]);
+                dirtyMin.v[1] = std::min(dirtyMin.v[1], position.v[1]);
+                dirtyMax.v[0] = std::max(dirtyMax.v[0], position.v[0] + width);
+                dirtyMax.v[1] = std::max(dirtyMax.v[1], position.v[1] + height);
+            }
+            else
+            {
+                dirtyMin = position;
+                dirtyMax = Vector2<uint32_t>(position.v[0] + width, position.v[1] + height);
+                dirty = true;
+            }
+        }
+
+        return true;
+    }
+
+    bool GlyphAtlas::grow()
+    {
+        Size2<uint32_t> newSize = size;
+
+        if (size.v[0] <= size.v[1])
+        {
+            if (size.v[0] * 2 > MAX_SIZE) return false;
+            newSize.v[0] = size.v[0] * 2;
+            skyline.push_back({size.v[0], 0, newSize.v[0] - size.v[0]});
+        }
+        else
+        {
+            if (size.v[1] * 2 > MAX_SIZE) return false;
+            newSize.v[1] = size.v[1] * 2;
+        }
+
+        std::vector<uint8_t> newData(newSize.v[0] * newSize.v[1] * 4);
+
+        for (size_t i = 0; i < newData.size(); i += 4)
+        {
+            newData[i + 0] = 255;
+            newData[i + 1] = 255;
+            newData[i + 2] = 255;
+            newData[i + 3] = 0;
+        }
+
+        for (uint32_t row = 0; row < size.v[1]; ++row)
+            std::copy(data.begin() + row * size.v[0] * 4,
+                      data.begin() + (row + 1) * size.v[0] * 4,
+                      newData.begin() + row * newSize.v[0] * 4);
+
+        size = newSize;
+        data = std::move(newData);
+
+        // renderers that still use the old texture keep it alive, their glyphs are still in it
+        texture.reset();
+        dirty = false;
+
+        return true;
+    }
+
+    const std::shared_ptr<graphics::Texture>& GlyphAtlas::getTexture()
+    {
+        if (!texture)
+        {
+            texture = std::make_shared<graphics::Texture>(*engine->getRenderer(),
+                                                          data, size,
+                                                          mipmaps ? 0 : graphics::Texture::DYNAMIC,
+                                                          mipmaps ? 0 : 1);
+        }
+        else if (dirty)
+        {
+            if (mipmaps)
+            {
+                // mip levels can not be updated partially, upload a new texture instead
+                texture = std::make_shared<graphics::Texture>(*engine->getRenderer(),
+                                                              data, size, 0, 0);
+            }
+            else
+            {
+                Size2<uint32_t> regionSize(dirtyMax.v[0] - dirtyMin.v[0],
+                                           dirtyMax.v[1] - dirtyMin.v[1]);
+                std::vector<uint8_t> regionData(regionSize.v[0] * regionSize.v[1] * 4);
+
+                for (uint32_t row = 0; row < regionSize.v[1]; ++row)
+                    std::copy(data.begin() + ((dirtyMin.v[1] + row) * size.v[0] + dirtyMin.v[0]) * 4,
+                              data.begin() + ((dirtyMin.v[1] + row) * size.v[0] + dirtyMax.v[0]) * 4,
+                              regionData.begin() + row * regionSize.v[0] * 4);
+
+                texture->setData(regionData, dirtyMin, regionSize);
+            }
+        }
+
+        dirty = false;
+
+        return texture;
+    }
+}
@@ -0,0 +1,61 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_GUI_GLYPHATLAS_HPP
+#define OUZEL_GUI_GLYPHATLAS_HPP
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "graphics/Texture.hpp"
+#include "math/Size2.hpp"
+#include "math/Vector2.hpp"
+
+namespace ouzel
+{
+    // Alpha glyph bitmaps packed into an RGBA texture with a skyline packer. Glyphs never move once
+    // they are added, the atlas only grows to the right or to the bottom, so texture coordinates
+    // stay valid in texels. Only the region touched since the last getTexture call is uploaded.
+    class GlyphAtlas final
+    {
+    public:
+        GlyphAtlas(const Size2<uint32_t>& initSize, bool initMipmaps);
+
+        GlyphAtlas(const GlyphAtlas&) = delete;
+        GlyphAtlas& operator=(const GlyphAtlas&) = delete;
+
+        GlyphAtlas(GlyphAtlas&&) = delete;
+        GlyphAtlas& operator=(GlyphAtlas&&) = delete;
+
+        // returns false if the atlas is full
+        bool addGlyph(uint32_t width, uint32_t height, const uint8_t* bitmap, Vector2<uint32_t>& position);
+        // doubles the smaller dimension, returns false if the maximum size was reached
+        bool grow();
+
+        inline const Size2<uint32_t>& getSize() const { return size; }
+        inline const std::vector<uint8_t>& getData() const { return data; }
+
+        const std::shared_ptr<graphics::Texture>& getTexture();
+
+    private:
+        struct Node final
+        {
+            uint32_t x;
+            uint32_t y;
+            uint32_t width;
+        };
+
+        bool fits(size_t index, uint32_t width, uint32_t height, uint32_t& y) const;
+
+        Size2<uint32_t> size;
+        bool mipmaps;
+        std::vector<Node> skyline;
+        std::vector<uint8_t> data;
+        std::shared_ptr<graphics::Texture> texture;
+
+        bool dirty = false;
+        Vector2<uint32_t> dirtyMin;
+        Vector2<uint32_t> dirtyMax;
+    };
+}
+
+#endif // OUZEL_GUI_GLYPHATLAS_HPP
@@ -1,22 +1,34 @@
 // Copyright 2015-2018 Elviss Strazdins. All rights reserved.
 
 #include <cassert>
+#include <cmath>
 #include <stdexcept>
 #define STB_TRUETYPE_IMPLEMENTATION
 #include "TTFont.hpp"
 #include "core/Engine.hpp"
+#include "files/File.hpp"
+#include "files/FileSystem.hpp"
 #include "utils/UTF8.hpp"
+#include "stb_image_write.h"
 
 namespace ouzel
 {
+    static constexpr uint32_t ATLAS_SIZE = 256;
+    // distance field glyphs are rasterized once at this size and scaled to any font size
+    static constexpr float DISTANCE_FIELD_SIZE = 48.0F;
+    static constexpr int DISTANCE_FIELD_PADDING = 6;
+    static constexpr unsigned char DISTANCE_FIELD_EDGE = 128;
+
     TTFont::TTFont()
     {
     }
 
-    TTFont::TTFont(const std::vector<uint8_t>& initData, bool initMipmaps):
+    TTFont::TTFont(const std::vector<uint8_t>& initData, bool initMipmaps, bool initDistanceField):
         data(initData),
         mipmaps(initMipmaps)
     {
+        distanceField = initDistanceField;
+
         int offset = stbtt_GetFontOffsetForIndex(data.data(), 0);
 
         if (offset == -1)
@@ -28,120 +40,95 @@ namespace ouzel
         loaded = true;
     }
 
-    void TTFont::getVertices(const std::string& text,
-                             Color color,
-                             float fontSize,
-                             const Vector2<float>& anchor,
-                             std::vector<uint16_t>& indices,
-                             std::vector<graphics::Vertex>& vertices,
-                             std::shared_ptr<graphics::Texture>& texture)
+    const TTFont::Glyph* TTFont::getGlyph(SizeCache& sizeCache, float fontSize, uint32_t c)
     {
-        if (!loaded)
-            throw std::runtime_error("Font not loaded");
-
-        static constexpr uint32_t SPACING = 2;
+        auto glyphIterator = sizeCache.glyphs.find(c);
+        if (glyphIterator != sizeCache.glyphs.end())
+            return &glyphIterator->second;
 
-        struct CharDescriptor final
-        {
-            uint16_t x = 0;
-            uint16_t y = 0;
-            uint16_t width = 0;
-            uint16_t height = 0;
-            Vector2<float> offset;
-            float advance = 0;
-            std::vector<uint8_t> bitmap;
-        };
-
-        std::unordered_map<uint32_t, CharDescriptor> chars;
+        int index = stbtt_FindGlyphIndex(&font, static_cast<int>(c));
+        if (!index) return nullptr;
 
         float s = stbtt_ScaleForPixelHeight(&font, fontSize);
 
-        std::vector<uint32_t> utf32Text = utf8::toUtf32(text);
-
-        std::set<uint32_t> glyphs;
-        for (uint32_t i : utf32Text)
-            glyphs.insert(i);
-
-        uint16_t width = 0;
-        uint16_t height = 0;
-
         int ascent;
         int descent;
         int lineGap;
         stbtt_GetFontVMetrics(&font, &ascent, &descent, &lineGap);
 
-        for (uint32_t c : glyphs)
-        {
-            int w;
-            int h;
-            int xoff;
-            int yoff;
+        int advance;
+        int leftBearing;
+        stbtt_GetGlyphHMetrics(&font, index, &advance, &leftBearing);
 
-            if (int index = stbtt_FindGlyphIndex(&font, static_cast<int>(c)))
-            {
-                int advance;
-                int leftBearing;
-                stbtt_GetGlyphHMetrics(&font, index, &advance, &leftBearing);
+        Glyph glyph;
+        glyph.advance = static_cast<float>(advance * s);
 
-                CharDescriptor charDesc;
+        int w;
+        int h;
+        int xoff;
+        int yoff;
 
-                if (unsigned char* bitmap = stbtt_GetGlyphBitmapSubpixel(&font, s, s, 0.0F, 0.0F, index, &w, &h, &xoff, &yoff))
-                {
-                    charDesc.width = static_cast<uint16_t>(w);
-                    charDesc.height = static_cast<uint16_t>(h);
-                    charDesc.offset.v[0] = static_cast<float>(leftBearing * s);
-                    charDesc.offset.v[1] = static_cast<float>(yoff + (ascent - descent) * s);
-                    charDesc.bitmap = std::vector<uint8_t>(bitmap, bitmap + h * w);
-                    charDesc.x = width;
+        unsigned char* bitmap = distanceField ?
+            stbtt_GetGlyphSDF(&font, s, index, DISTANCE_FIELD_PADDING, DISTANCE_FIELD_EDGE,
+                              static_cast<float>(DISTANCE_FIELD_EDGE) / DISTANCE_FIELD_PADDING,
+                              &w, &h, &xoff, &yoff) :
+            stbtt_GetGlyphBitmapSubpixel(&font, s, s, 0.0F, 0.0F, index, &w, &h, &xoff, &yoff);
 
-                    width += static_cast<uint16_t>(w);
-                    height = height > static_cast<uint16_t>(h) ? height : static_cast<uint16_t>(h);
+        if (bitmap)
+        {
+            glyph.width = static_cast<uint16_t>(w);
+            glyph.height = static_cast<uint16_t>(h);
+            // distance field bitmaps are padded on all sides
+            glyph.offset.v[0] = static_cast<float>(leftBearing * s) - (distanceField ? DISTANCE_FIELD_PADDING : 0);
+            glyph.offset.v[1] = static_cast<float>(yoff + (ascent - descent) * s);
 
+            while (!sizeCache.atlas->addGlyph(glyph.width, glyph.height, bitmap, glyph.position))
+            {
+                if (!sizeCache.atlas->grow())
+                {
                     stbtt_FreeBitmap(bitmap, nullptr);
+                    throw std::runtime_error("Glyph atlas is full");
                 }
+            }
 
-                charDesc.advance = static_cast<float>(advance * s);
+            stbtt_FreeBitmap(bitmap, nullptr);
+        }
 
-                if (!chars.empty())
-                    width += SPACING;
+        return &(sizeCache.glyphs[c] = glyph);
+    }
 
-                chars[c] = charDesc;
-            }
-        }
+    void TTFont::getVertices(const std::string& text,
+                             Color color,
+                             float fontSize,
+                             const Vector2<float>& anchor,
+                             std::vector<uint16_t>& indices,
+                             std::vector<graphics::Vertex>& vertices,
+                             std::shared_ptr<graphics::Texture>& texture)
+    {
+        if (!loaded)
+            throw std::runtime_error("Font not loaded");
 
-        std::vector<uint8_t> textureData(width * height * 4);
+        float rasterSize = distanceField ? DISTANCE_FIELD_SIZE : fontSize;
+        SizeCache& sizeCache = getSizeCache(rasterSize);
 
-        for (uint16_t posX = 0; posX < width; ++posX)
-        {
-            for (uint16_t posY = 0; posY < height; ++posY)
-            {
-                textureData[(posY * width + posX) * 4 + 0] = 255;
-                textureData[(posY * width + posX) * 4 + 1] = 255;
-                textureData[(posY * width + posX) * 4 + 2] = 255;
-                textureData[(posY * width + posX) * 4 + 3] = 0;
-            }
-        }
+        float s = stbtt_ScaleForPixelHeight(&font, rasterSize);
 
-        for (auto& c : chars)
-        {
-            CharDescriptor& charDesc = c.second;
+        std::vector<uint32_t> utf32Text = utf8::toUtf32(text);
 
-            for (uint16_t posX = 0; posX < charDesc.width; ++posX)
-            {
-                for (uint16_t posY = 0; posY < charDesc.height; ++posY)
-                {
-                    textureData[(posY * width + posX + charDesc.x) * 4 + 0] = 255;
-                    textureData[(posY * width + posX + charDesc.x) * 4 + 1] = 255;
-                    textureData[(posY * width + posX + charDesc.x) * 4 + 2] = 255;
-                    textureData[(posY * width + posX + charDesc.x) * 4 + 3] = charDesc.bitmap[posY * charDesc.width + posX];
-                }
-            }
-        }
+        int ascent;
+        int descent;
+        int lineGap;
+        stbtt_GetFontVMetrics(&font, &ascent, &descent, &lineGap);
 
-        texture = std::make_shared<graphics::Texture>(*engine->getRenderer(),
-                                                      textureData,
-                                                      Size2<uint32_t>(width, height), 0,
-                                                      mipmaps ? 0 : 1);
+        // rasterize the glyphs that are not in the atlas yet before the atlas size is read
+        std::vector<const Glyph*> glyphs(utf32Text.size());
+        for (size_t i = 0; i < utf32Text.size(); ++i)
+            glyphs[i] = getGlyph(sizeCache, rasterSize, utf32Text[i]);
+
+        texture = sizeCache.atlas->getTexture();
+
+        float width = static_cast<float>(sizeCache.atlas->getSize().v[0]);
+        float height = static_cast<float>(sizeCache.atlas->getSize().v[1]);
 
         Vector2<float> position;
 
@@ -157,11 +144,9 @@ namespace ouzel
 
         for (auto i = utf32Text.begin(); i != utf32Text.end(); ++i)
         {
-            auto iter = chars.find(*i);
-
-            if (iter != chars.end())
+            if (const Glyph* glyph = glyphs[static_cast<size_t>(i - utf32Text.begin())])
             {
-                const CharDescriptor& f = iter->second;
+                const Glyph& f = *glyph;
 
                 uint16_t startIndex = static_cast<uint16_t>(vertices.size());
                 indices.push_back(startIndex + 0);
@@ -172,11 +157,11 @@ namespace ouzel
                 indices.push_back(startIndex + 3);
                 indices.push_back(startIndex + 2);
 
-                Vector2<float> leftTop(f.x / static_cast<float>(width),
-                                f.y / static_cast<float>(height));
+                Vector2<float> leftTop(f.position.v[0] / width,
+                                       f.position.v[1] / height);
 
-                Vector2<float> rightBottom((f.x + f.width) / static_cast<float>(width),
-                                    (f.y + f.height) / static_cast<float>(height));
+                Vector2<float> rightBottom((f.position.v[0] + f.width) / width,
+                                           (f.position.v[1] + f.height) / height);
 
                 textCoords[0] = Vector2<float>(leftTop.v[0], rightBottom.v[1]);
                 textCoords[1] = Vector2<float>(rightBottom.v[0], rightBottom.v[1]);
@@ -208,7 +193,7 @@ namespace ouzel
             {
                 float lineWidth = position.v[0];
                 position.v[0] = 0.0F;
-                position.v[1] += fontSize + lineGap;
+                position.v[1] += rasterSize + lineGap;
 
                 for (size_t c = firstChar; c < vertices.size(); ++c)
                     vertices[c].position.v[0] -= lineWidth * anchor.v[0];
@@ -218,8 +203,106 @@ namespace ouzel
         }
 
         float textHeight = position.v[1];
+        float scale = fontSize / rasterSize;
 
         for (size_t c = 0; c < vertices.size(); ++c)
+        {
             vertices[c].position.v[1] += textHeight * (1.0F - anchor.v[1]);
+
+            vertices[c].position.v[0] *= scale;
+            vertices[c].position.v[1] *= scale;
+        }
+    }
+
+    TTFont::SizeCache& TTFont::getSizeCache(float rasterSize)
+    {
+        SizeCache& sizeCache = sizeCaches[rasterSize];
+        if (!sizeCache.atlas)
+            sizeCache.atlas.reset(new GlyphAtlas(Size2<uint32_t>(ATLAS_SIZE, ATLAS_SIZE), mipmaps));
+
+        return sizeCache;
+    }
+
+    void TTFont::bake(const std::string& fontFilename,
+                      const std::string& imageFilename,
+                      const std::string& characters,
+                      float fontSize)
+    {
+        if (!loaded)
+            throw std::runtime_error("Font not loaded");
+
+        float rasterSize = distanceField ? DISTANCE_FIELD_SIZE : fontSize;
+        SizeCache& sizeCache = getSizeCache(rasterSize);
+
+        float s = stbtt_ScaleForPixelHeight(&font, rasterSize);
+
+        int ascent;
+        int descent;
+        int lineGap;
+        stbtt_GetFontVMetrics(&font, &ascent, &descent, &lineGap);
+
+        std::vector<uint32_t> utf32Characters = utf8::toUtf32(characters);
+        std::map<uint32_t, const Glyph*> glyphs;
+
+        for (uint32_t c : utf32Characters)
+            if (const Glyph* glyph = getGlyph(sizeCache, rasterSize, c))
+                glyphs[c] = glyph;
+
+        const Size2<uint32_t>& size = sizeCache.atlas->getSize();
+
+        if (!stbi_write_png(imageFilename.c_str(), static_cast<int>(size.v[0]), static_cast<int>(size.v[1]), 4,
+                            sizeCache.atlas->getData().data(), static_cast<int>(size.v[0] * 4)))
+            throw std::runtime_error("Failed to save font image to file");
+
+        std::string result = "info face=\"" + FileSystem::getFilenamePart(fontFilename) + "\" size=" +
+            std::to_string(static_cast<int>(rasterSize)) + "\n";
+
+        result += "common lineHeight=" + std::to_string(static_cast<int>(std::round(rasterSize + lineGap))) +
+            " base=" + std::to_string(static_cast<int>(std::round(ascent * s))) +
+            " scaleW=" + std::to_string(size.v[0]) +
+            " scaleH=" + std::to_string(size.v[1]) +
+            " pages=1 distanceField=" + (distanceField ? "1" : "0") + "\n";
+
+        result += "page id=0 file=\"" + FileSystem::getFilenamePart(imageFilename) + "\"\n";
+        result += "chars count=" + std::to_string(glyphs.size()) + "\n";
+
+        for (const auto& glyph : glyphs)
+        {
+            const Glyph& g = *glyph.second;
+
+            result += "char id=" + std::to_string(glyph.first) +
+                " x=" + std::to_string(g.position.v[0]) +
+                " y=" + std::to_string(g.position.v[1]) +
+                " width=" + std::to_string(g.width) +
+                " height=" + std::to_string(g.height) +
+                " xoffset=" + std::to_string(static_cast<int>(std::round(g.offset.v[0]))) +
+                " yoffset=" + std::to_string(static_cast<int>(std::round(g.offset.v[1]))) +
+                " xadvance=" + std::to_string(static_cast<int>(std::round(g.advance))) +
+                " page=0\n";
+        }
+
+        std::vector<std::pair<std::pair<uint32_t, uint32_t>, int>> kernings;
+
+        for (const auto& first : glyphs)
+        {
+            for (const auto& second : glyphs)
+            {
+                int amount = static_cast<int>(std::round(stbtt_GetCodepointKernAdvance(&font,
+                                                                                       static_cast<int>(first.first),
+                                                                                       static_cast<int>(second.first)) * s));
+                if (amount != 0)
+                    kernings.push_back(std::make_pair(std::make_pair(first.first, second.first), amount));
+            }
+        }
+
+        result += "kernings count=" + std::to_string(kernings.size()) + "\n";
+
+        for (const auto& kerning : kernings)
+            result += "kerning first=" + std::to_string(kerning.first.first) +
+                " second=" + std::to_string(kerning.first.second) +
+                " amount=" + std::to_string(kerning.second) + "\n";
+
+        File file(fontFilename, File::WRITE | File::CREATE | File::TRUNCATE);
+        file.write(result.data(), static_cast<uint32_t>(result.size()), true);
     }
 }
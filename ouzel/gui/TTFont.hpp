@@ -5,6 +5,7 @@
 
 #include "stb_truetype.h"
 #include "gui/Font.hpp"
+#include "gui/GlyphAtlas.hpp"
 
 namespace ouzel
 {
@@ -12,7 +13,7 @@ namespace ouzel
     {
     public:
         TTFont();
-        TTFont(const std::vector<uint8_t>& newData, bool newMipmaps = true);
+        TTFont(const std::vector<uint8_t>& newData, bool newMipmaps = true, bool newDistanceField = false);
 
         void getVertices(const std::string& text,
                          Color color,
@@ -24,13 +25,40 @@ namespace ouzel
 
         float getStringWidth(const std::string& text);
 
+        // writes the characters as a BMFont sheet that can be loaded without rasterizing at runtime,
+        // distance field fonts are baked at their base size and can be drawn at any size
+        void bake(const std::string& fontFilename,
+                  const std::string& imageFilename,
+                  const std::string& characters,
+                  float fontSize);
+
     private:
         int16_t getKerningPair(uint32_t, uint32_t);
 
+        struct Glyph final
+        {
+            Vector2<uint32_t> position;
+            uint16_t width = 0;
+            uint16_t height = 0;
+            Vector2<float> offset;
+            float advance = 0;
+        };
+
+        // glyphs rasterized at one font size, shared by all text using that size
+        struct SizeCache final
+        {
+            std::unique_ptr<GlyphAtlas> atlas;
+            std::unordered_map<uint32_t, Glyph> glyphs;
+        };
+
+        SizeCache& getSizeCache(float rasterSize);
+        const Glyph* getGlyph(SizeCache& sizeCache, float fontSize, uint32_t c);
+
         stbtt_fontinfo font;
         std::vector<unsigned char> data;
         bool loaded = false;
         bool mipmaps = true;
+        std::map<float, SizeCache> sizeCaches;
     };
 }
 
@@ -43,7 +43,8 @@ namespace ouzel
 #elif defined(__ANDROID__)
             inputSystem(new InputSystemAndroid(std::bind(&InputManager::eventCallback, this, std::placeholders::_1)))
 #elif defined(__linux__)
-            inputSystem(new InputSystemLinux(std::bind(&InputManager::eventCallback, this, std::placeholders::_1)))
+            inputSystem(new InputSystemLinux(std::bind(&InputManager::eventCallback, this, std::placeholders::_1),
+                                             std::bind(&InputManager::eventBatchCallback, this, std::placeholders::_1)))
 #elif defined(_WIN32)
             inputSystem(new InputSystemWin(std::bind(&InputManager::eventCallback, this, std::placeholders::_1)))
 #elif defined(__EMSCRIPTEN__)
@@ -67,6 +68,7 @@ namespace ouzel
                 eventQueue.pop();
                 lock.unlock();
 
+                eventTimestamp = p.second.timestamp;
                 p.first.set_value(handleEvent(p.second));
             }
         }
@@ -82,6 +84,15 @@ namespace ouzel
             return f;
         };
 
+        void InputManager::eventBatchCallback(std::vector<std::pair<std::promise<bool>, InputSystem::Event>>& events)
+        {
+            // all of the events of a batch are handled in the same update
+            std::unique_lock<std::mutex> lock(eventQueueMutex);
+
+            for (auto& event : events)
+                eventQueue.push(std::move(event));
+        }
+
         bool InputManager::handleEvent(const InputSystem::Event& event)
         {
             switch (event.type)
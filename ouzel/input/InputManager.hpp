@@ -45,8 +45,12 @@ namespace ouzel
             void showVirtualKeyboard();
             void hideVirtualKeyboard();
 
+            // time of the input event that is being handled, valid while the event is dispatched
+            inline std::chrono::steady_clock::time_point getEventTimestamp() const { return eventTimestamp; }
+
         private:
             std::future<bool> eventCallback(const InputSystem::Event& event);
+            void eventBatchCallback(std::vector<std::pair<std::promise<bool>, InputSystem::Event>>& events);
             bool handleEvent(const InputSystem::Event& event);
 
             std::mutex eventQueueMutex;
@@ -61,6 +65,7 @@ namespace ouzel
             std::vector<Controller*> controllers;
 
             bool discovering = false;
+            std::chrono::steady_clock::time_point eventTimestamp;
         };
     } // namespace input
 } // namespace ouzel
@@ -20,16 +20,25 @@ namespace ouzel
 
         std::future<bool> InputSystem::sendEvent(const Event& event)
         {
+            if (event.timestamp == std::chrono::steady_clock::time_point())
+            {
+                Event timestampedEvent = event;
+                timestampedEvent.timestamp = std::chrono::steady_clock::now();
+                return callback(timestampedEvent);
+            }
+
             return callback(event);
         }
 
         void InputSystem::addInputDevice(InputDevice& inputDevice)
         {
+            std::unique_lock<std::mutex> lock(inputDeviceMutex);
             inputDevices.insert(std::make_pair(inputDevice.getId(), &inputDevice));
         }
 
         void InputSystem::removeInputDevice(const InputDevice& inputDevice)
         {
+            std::unique_lock<std::mutex> lock(inputDeviceMutex);
             auto i = inputDevices.find(inputDevice.getId());
 
             if (i != inputDevices.end())
@@ -38,6 +47,7 @@ namespace ouzel
 
         InputDevice* InputSystem::getInputDevice(uint32_t id)
         {
+            std::unique_lock<std::mutex> lock(inputDeviceMutex);
             auto i = inputDevices.find(id);
 
             if (i != inputDevices.end())
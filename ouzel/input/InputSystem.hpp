@@ -3,8 +3,10 @@
 #ifndef OUZEL_INPUT_INPUTSYSTEM_HPP
 #define OUZEL_INPUT_INPUTSYSTEM_HPP
 
+#include <chrono>
 #include <cstdint>
 #include <future>
+#include <mutex>
 #include <set>
 #include <unordered_map>
 #include <vector>
@@ -124,6 +126,8 @@ namespace ouzel
                 Vector2<float> position;
                 Vector2<float> scroll;
                 float force = 1.0F;
+                // when the event happened, set by sendEvent if the system does not provide it
+                std::chrono::steady_clock::time_point timestamp;
             };
 
             explicit InputSystem(const std::function<std::future<bool>(const Event&)>& initCallback);
@@ -152,13 +156,14 @@ namespace ouzel
             }
 
         protected:
-            std::future<bool> sendEvent(const Event& event);
+            virtual std::future<bool> sendEvent(const Event& event);
             void addInputDevice(InputDevice& inputDevice);
             void removeInputDevice(const InputDevice& inputDevice);
             InputDevice* getInputDevice(uint32_t id);
 
         private:
             std::function<std::future<bool>(const Event&)> callback;
+            std::mutex inputDeviceMutex;
             std::unordered_map<uint32_t, InputDevice*> inputDevices;
 
             uintptr_t lastResourceId = 0;
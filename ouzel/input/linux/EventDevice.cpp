@@ -2,6 +2,7 @@
 
 #include <system_error>
 #include <unordered_map>
+#include <ctime>
 #include <fcntl.h>
 #include <unistd.h>
 #include <linux/input.h>
@@ -15,6 +16,12 @@
 #include "core/Engine.hpp"
 #include "utils/Log.hpp"
 
+// older kernel headers only have the timeval member
+#ifndef input_event_sec
+#  define input_event_sec time.tv_sec
+#  define input_event_usec time.tv_usec
+#endif
+
 static constexpr float THUMB_DEADZONE = 0.2F;
 
 static constexpr uint32_t BITS_PER_LONG = 8 * sizeof(long);
@@ -230,14 +237,20 @@ namespace ouzel
 {
     namespace input
     {
-        EventDevice::EventDevice(InputSystemLinux& inputSystem, const std::string& initFilename):
+        EventDevice::EventDevice(InputSystemLinux& initInputSystem, const std::string& initFilename):
+            inputSystem(initInputSystem),
             filename(initFilename)
         {
-            fd = open(filename.c_str(), O_RDONLY);
+            // non-blocking, because the input thread must never wait for a single device
+            fd = open(filename.c_str(), O_RDONLY | O_NONBLOCK);
 
             if (fd == -1)
                 throw std::system_error(errno, std::system_category(), "Failed to open device file");
 
+            // event times are compared to std::chrono::steady_clock, which uses the monotonic clock
+            int clockId = CLOCK_MONOTONIC;
+            monotonicTime = ioctl(fd, EVIOCSCLOCKID, &clockId) != -1;
+
             if (ioctl(fd, EVIOCGRAB, 1) == -1)
                 engine->log(Log::Level::WARN) << "Failed to grab device";
 
@@ -422,7 +435,10 @@ namespace ouzel
             ssize_t bytesRead = read(fd, events, sizeof(events));
 
             if (bytesRead == -1)
+            {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) return;
                 throw std::system_error(errno, std::system_category(), "Failed to read from " + filename);
+            }
 
             int count = bytesRead / sizeof(input_event);
 
@@ -430,6 +446,12 @@ namespace ouzel
             {
                 input_event& event = events[i];
 
+                if (monotonicTime)
+                    inputSystem.setEventTimestamp(std::chrono::steady_clock::time_point(std::chrono::seconds(event.input_event_sec) +
+                                                                                        std::chrono::microseconds(event.input_event_usec)));
+                else
+                    inputSystem.setEventTimestamp(std::chrono::steady_clock::now());
+
                 if (keyboardDevice)
                 {
                     switch (event.type)
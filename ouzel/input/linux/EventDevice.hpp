@@ -5,6 +5,7 @@
 
 #include <cstdint>
 #include <array>
+#include <chrono>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -24,7 +25,7 @@ namespace ouzel
         class EventDevice final
         {
         public:
-            EventDevice(InputSystemLinux& inputSystem, const std::string& initFilename);
+            EventDevice(InputSystemLinux& initInputSystem, const std::string& initFilename);
             ~EventDevice();
 
             EventDevice(const EventDevice& other) = delete;
@@ -35,13 +36,16 @@ namespace ouzel
             void update();
 
             inline int getFd() const { return fd; }
+            inline const std::string& getFilename() const { return filename; }
 
         private:
             void handleAxisChange(int32_t oldValue, int32_t newValue,
                                   int32_t min, int32_t range,
                                   Gamepad::Button negativeButton, Gamepad::Button positiveButton);
 
+            InputSystemLinux& inputSystem;
             int fd = -1;
+            bool monotonicTime = false;
             std::string filename;
             std::string name;
 
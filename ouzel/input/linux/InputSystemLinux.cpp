@@ -8,6 +8,9 @@
 #include <dirent.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
 #include <linux/joystick.h>
 #if OUZEL_SUPPORTS_X11
 #  include <X11/cursorfont.h>
@@ -16,19 +19,29 @@
 #include "CursorLinux.hpp"
 #include "core/linux/EngineLinux.hpp"
 #include "core/linux/NativeWindowLinux.hpp"
+#include "utils/Log.hpp"
+#include "utils/Utils.hpp"
 
 namespace ouzel
 {
     namespace input
     {
-        InputSystemLinux::InputSystemLinux(const std::function<std::future<bool>(const Event&)>& initCallback):
+        static const char* INPUT_DIRECTORY = "/dev/input";
+
+        // set by the input thread itself, so it does not depend on when the thread object is assigned
+        static thread_local const InputSystemLinux* currentInputSystem = nullptr;
+
+        InputSystemLinux::InputSystemLinux(const std::function<std::future<bool>(const Event&)>& initCallback,
+                                           const std::function<void(std::vector<std::pair<std::promise<bool>, Event>>&)>& initBatchCallback):
 #if OUZEL_SUPPORTS_X11
             InputSystem(initCallback),
+            batchCallback(initBatchCallback),
             keyboardDevice(new KeyboardDeviceLinux(*this, ++lastDeviceId)),
             mouseDevice(new MouseDeviceLinux(*this, ++lastDeviceId)),
             touchpadDevice(new TouchpadDevice(*this, ++lastDeviceId, true))
 #else
-            InputSystem(initCallback)
+            InputSystem(initCallback),
+            batchCallback(initBatchCallback)
 #endif
         {
 #if OUZEL_SUPPORTS_X11
@@ -47,35 +60,56 @@ namespace ouzel
                 XFreePixmap(display, pixmap);
             }
 #endif
-            DIR* dir = opendir("/dev/input");
+            epollFd = epoll_create1(EPOLL_CLOEXEC);
+            if (epollFd == -1)
+                throw std::system_error(errno, std::system_category(), "Failed to create epoll instance");
 
-            if (!dir)
-                throw std::system_error(errno, std::system_category(), "Failed to open directory");
+            wakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+            if (wakeFd == -1)
+                throw std::system_error(errno, std::system_category(), "Failed to create event file descriptor");
 
-            dirent ent;
-            dirent* p;
+            epoll_event event;
+            event.events = EPOLLIN;
+            event.data.fd = wakeFd;
+            if (epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event) == -1)
+                throw std::system_error(errno, std::system_category(), "Failed to add event file descriptor to epoll");
 
-            while (readdir_r(dir, &ent, &p) == 0 && p)
+            // without inotify new devices are only found when the discovery is started
+            notifyFd = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+            if (notifyFd != -1)
             {
-                if (strncmp("event", ent.d_name, 5) == 0)
+                if (inotify_add_watch(notifyFd, INPUT_DIRECTORY, IN_CREATE | IN_ATTRIB) != -1)
                 {
-                    try
-                    {
-                        std::string filename = std::string("/dev/input/") + ent.d_name;
-                        std::unique_ptr<EventDevice> eventDevice(new EventDevice(*this, filename));
-                        eventDevices.insert(std::make_pair(eventDevice->getFd(), std::move(eventDevice)));
-                    }
-                    catch (const std::exception&)
-                    {
-                    }
+                    event.events = EPOLLIN;
+                    event.data.fd = notifyFd;
+                    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, notifyFd, &event) == -1)
+                        throw std::system_error(errno, std::system_category(), "Failed to add inotify to epoll");
+                }
+                else
+                {
+                    engine->log(Log::Level::WARN) << "Failed to watch " << INPUT_DIRECTORY;
+                    close(notifyFd);
+                    notifyFd = -1;
                 }
             }
+            else
+                engine->log(Log::Level::WARN) << "Failed to initialize inotify";
 
-            closedir(dir);
+            inputThread = std::thread(&InputSystemLinux::run, this);
         }
 
         InputSystemLinux::~InputSystemLinux()
         {
+            running = false;
+            wake();
+            if (inputThread.joinable()) inputThread.join();
+
+            eventDevices.clear();
+
+            if (notifyFd != -1) close(notifyFd);
+            if (wakeFd != -1) close(wakeFd);
+            if (epollFd != -1) close(epollFd);
+
 #if OUZEL_SUPPORTS_X11
             EngineLinux* engineLinux = static_cast<EngineLinux*>(engine);
             if (emptyCursor != None) XFreeCursor(engineLinux->getDisplay(), emptyCursor);
@@ -88,6 +122,8 @@ namespace ouzel
             {
                 case Command::Type::START_DEVICE_DISCOVERY:
                     discovering = true;
+                    rescan = true;
+                    wake();
                     break;
                 case Command::Type::STOP_DEVICE_DISCOVERY:
                     discovering = false;
@@ -182,78 +218,155 @@ namespace ouzel
             }
         }
 
-        void InputSystemLinux::update()
+        std::future<bool> InputSystemLinux::sendEvent(const Event& event)
+        {
+            if (currentInputSystem != this)
+                return InputSystem::sendEvent(event);
+
+            std::pair<std::promise<bool>, Event> p(std::promise<bool>(), event);
+            p.second.timestamp = eventTimestamp;
+            std::future<bool> f = p.first.get_future();
+            eventBatch.push_back(std::move(p));
+
+            return f;
+        }
+
+        void InputSystemLinux::run()
         {
-            fd_set rfds;
-            struct timeval tv;
-            tv.tv_sec = 0;
-            tv.tv_usec = 0;
+            currentInputSystem = this;
+            setCurrentThreadName("Input");
 
-            FD_ZERO(&rfds);
+            discoverDevices();
 
-            int maxFd = 0;
+            epoll_event events[16];
 
-            for (const auto& i : eventDevices)
+            while (running)
             {
-                FD_SET(i.first, &rfds);
-                if (i.first > maxFd) maxFd = i.first;
-            }
+                if (!eventBatch.empty())
+                {
+                    batchCallback(eventBatch);
+                    eventBatch.clear();
+                }
 
-            int retval;
-            if ((retval = select(maxFd + 1, &rfds, nullptr, nullptr, &tv)) == -1)
-                throw std::system_error(errno, std::system_category(), "Select failed");
+                int count = epoll_wait(epollFd, events, 16, -1);
 
-            if (retval > 0)
-            {
-                for (auto i = eventDevices.begin(); i != eventDevices.end();)
+                if (count == -1)
                 {
-                    if (FD_ISSET(i->first, &rfds))
+                    if (errno == EINTR) continue;
+
+                    engine->log(Log::Level::ERR) << "Failed to wait for input events, error: " << errno;
+                    break;
+                }
+
+                for (int i = 0; i < count; ++i)
+                {
+                    int fd = events[i].data.fd;
+
+                    if (fd == wakeFd)
+                    {
+                        uint64_t value;
+                        while (read(wakeFd, &value, sizeof(value)) > 0) {}
+
+                        if (rescan.exchange(false)) discoverDevices();
+                    }
+                    else if (fd == notifyFd)
+                        handleNotifications();
+                    else
                     {
+                        auto eventDevice = eventDevices.find(fd);
+                        if (eventDevice == eventDevices.end()) continue;
+
                         try
                         {
-                            i->second->update();
-                            ++i;
+                            eventDevice->second->update();
                         }
                         catch (const std::exception&)
                         {
-                            i = eventDevices.erase(i);
+                            // the device was removed
+                            eventTimestamp = std::chrono::steady_clock::now();
+                            epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+                            eventDevices.erase(eventDevice);
                         }
                     }
-                    else
-                        ++i;
                 }
             }
+        }
+
+        void InputSystemLinux::discoverDevices()
+        {
+            DIR* dir = opendir(INPUT_DIRECTORY);
+
+            if (!dir)
+            {
+                engine->log(Log::Level::ERR) << "Failed to open " << INPUT_DIRECTORY;
+                return;
+            }
+
+            dirent ent;
+            dirent* p;
+
+            while (readdir_r(dir, &ent, &p) == 0 && p)
+            {
+                if (strncmp("event", ent.d_name, 5) == 0)
+                    openDevice(std::string(INPUT_DIRECTORY) + "/" + ent.d_name);
+            }
+
+            closedir(dir);
+        }
+
+        void InputSystemLinux::openDevice(const std::string& filename)
+        {
+            for (const auto& i : eventDevices)
+                if (i.second->getFilename() == filename) return;
 
-            if (discovering)
+            try
             {
-                DIR* dir = opendir("/dev/input");
+                eventTimestamp = std::chrono::steady_clock::now();
+                std::unique_ptr<EventDevice> eventDevice(new EventDevice(*this, filename));
 
-                if (!dir)
-                    throw std::system_error(errno, std::system_category(), "Failed to open directory");
+                epoll_event event;
+                event.events = EPOLLIN;
+                event.data.fd = eventDevice->getFd();
+                if (epoll_ctl(epollFd, EPOLL_CTL_ADD, eventDevice->getFd(), &event) == -1)
+                    throw std::system_error(errno, std::system_category(), "Failed to add device to epoll");
 
-                dirent ent;
-                dirent* p;
+                eventDevices.insert(std::make_pair(eventDevice->getFd(), std::move(eventDevice)));
+            }
+            catch (const std::exception&)
+            {
+                // not an input device or no permission to read it (yet)
+            }
+        }
+
+        void InputSystemLinux::handleNotifications()
+        {
+            alignas(inotify_event) char buffer[4096];
 
-                while (readdir_r(dir, &ent, &p) == 0 && p)
+            for (;;)
+            {
+                ssize_t bytesRead = read(notifyFd, buffer, sizeof(buffer));
+                if (bytesRead <= 0) break;
+
+                for (ssize_t offset = 0; offset < bytesRead;)
                 {
-                    if (strncmp("event", ent.d_name, 5) == 0)
-                    {
-                        try
-                        {
-                            std::string filename = std::string("/dev/input/") + ent.d_name;
-                            std::unique_ptr<EventDevice> eventDevice(new EventDevice(*this, filename));
-                            eventDevices.insert(std::make_pair(eventDevice->getFd(), std::move(eventDevice)));
-                        }
-                        catch (const std::exception&)
-                        {
-                        }
-                    }
-                }
+                    const inotify_event* notification = reinterpret_cast<const inotify_event*>(buffer + offset);
+                    offset += static_cast<ssize_t>(sizeof(inotify_event) + notification->len);
 
-                closedir(dir);
+                    // the device node can be created before its permissions are set, so attribute changes are handled too
+                    if (discovering && notification->len &&
+                        strncmp("event", notification->name, 5) == 0)
+                        openDevice(std::string(INPUT_DIRECTORY) + "/" + notification->name);
+                }
             }
         }
 
+        void InputSystemLinux::wake()
+        {
+            uint64_t value = 1;
+            if (write(wakeFd, &value, sizeof(value)) == -1)
+                engine->log(Log::Level::WARN) << "Failed to wake the input thread";
+        }
+
 #if OUZEL_SUPPORTS_X11
         void InputSystemLinux::updateCursor() const
         {
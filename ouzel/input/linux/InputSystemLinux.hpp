@@ -3,8 +3,14 @@
 #ifndef OUZEL_INPUT_INPUTSYSTEMLINUX_HPP
 #define OUZEL_INPUT_INPUTSYSTEMLINUX_HPP
 
+#include <atomic>
+#include <chrono>
 #include <memory>
+#include <string>
+#include <thread>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 #include "core/Setup.h"
 #if OUZEL_SUPPORTS_X11
 #  include <X11/X.h>
@@ -24,7 +30,8 @@ namespace ouzel
         class InputSystemLinux final: public InputSystem
         {
         public:
-            explicit InputSystemLinux(const std::function<std::future<bool>(const Event&)>& initCallback);
+            InputSystemLinux(const std::function<std::future<bool>(const Event&)>& initCallback,
+                             const std::function<void(std::vector<std::pair<std::promise<bool>, Event>>&)>& initBatchCallback);
             ~InputSystemLinux();
 
             void executeCommand(const Command& command) override;
@@ -35,16 +42,39 @@ namespace ouzel
 
             uint32_t getNextDeviceId() { return ++lastDeviceId; }
 
-            void update();
+            // called by the event devices on the input thread before the events that happened at the given time
+            inline void setEventTimestamp(std::chrono::steady_clock::time_point timestamp) { eventTimestamp = timestamp; }
 
         private:
+            // event devices are read on the input thread, the events of every wakeup are sent in one batch
+            std::future<bool> sendEvent(const Event& event) override;
+
+            void run();
+            void discoverDevices();
+            void openDevice(const std::string& filename);
+            void handleNotifications();
+            void wake();
+
 #if OUZEL_SUPPORTS_X11
             void updateCursor() const;
 #endif
 
-            bool discovering = false;
+            std::function<void(std::vector<std::pair<std::promise<bool>, Event>>&)> batchCallback;
+
+            std::atomic<bool> running{true};
+            std::atomic<bool> discovering{false};
+            std::atomic<bool> rescan{false};
+
+            int epollFd = -1;
+            int notifyFd = -1;
+            int wakeFd = -1;
+            std::thread inputThread;
+
+            // accessed only on the input thread
+            std::vector<std::pair<std::promise<bool>, Event>> eventBatch;
+            std::chrono::steady_clock::time_point eventTimestamp;
 
-            uint32_t lastDeviceId = 0;
+            std::atomic<uint32_t> lastDeviceId{0};
             std::unique_ptr<KeyboardDeviceLinux> keyboardDevice;
             std::unique_ptr<MouseDeviceLinux> mouseDevice;
             std::unique_ptr<TouchpadDevice> touchpadDevice;
@@ -1,117 +1,197 @@
 // Copyright 2015-2018 Elviss Strazdins. All rights reserved.
 
+#include <algorithm>
 #include <stdexcept>
-#include <vector>
 #include "Language.hpp"
 
 namespace ouzel
 {
-    struct TranslationInfo final
+    // hashpjw, the hash function used by GNU gettext
+    static uint32_t hashString(StringView str)
     {
-        uint32_t stringLength;
-        uint32_t stringOffset;
+        uint32_t hash = 0;
 
-        uint32_t translationLength;
-        uint32_t translationOffset;
-    };
+        for (char c : str)
+        {
+            hash = (hash << 4) + static_cast<uint8_t>(c);
+            uint32_t g = hash & 0xF0000000;
+            if (g)
+            {
+                hash ^= g >> 24;
+                hash ^= g;
+            }
+        }
+
+        return hash;
+    }
+
+    // plural entries hold all the forms separated by zeros, only the first one is used
+    static StringView firstForm(const uint8_t* data, uint32_t length)
+    {
+        const char* str = reinterpret_cast<const char*>(data);
+        const char* end = std::find(str, str + length, '\0');
+        return StringView(str, static_cast<size_t>(end - str));
+    }
+
+    static int compare(StringView a, StringView b)
+    {
+        size_t length = std::min(a.length(), b.length());
+        for (size_t i = 0; i < length; ++i)
+        {
+            if (static_cast<uint8_t>(a[i]) != static_cast<uint8_t>(b[i]))
+                return static_cast<uint8_t>(a[i]) < static_cast<uint8_t>(b[i]) ? -1 : 1;
+        }
+
+        return (a.length() == b.length()) ? 0 : (a.length() < b.length() ? -1 : 1);
+    }
 
-    Language::Language(const std::vector<uint8_t>& data)
+    Language::Language(const std::vector<uint8_t>& initData):
+        buffer(initData)
+    {
+        data = buffer.data();
+        size = static_cast<uint32_t>(buffer.size());
+        init();
+    }
+
+    Language::Language(std::vector<uint8_t>&& initData):
+        buffer(std::move(initData))
+    {
+        data = buffer.data();
+        size = static_cast<uint32_t>(buffer.size());
+        init();
+    }
+
+    Language::Language(MappedFile&& initFile):
+        file(std::move(initFile))
+    {
+        data = file.getData();
+        size = file.getSize();
+        init();
+    }
+
+    void Language::init()
     {
         constexpr uint32_t MAGIC_BIG = 0xde120495;
         constexpr uint32_t MAGIC_LITTLE = 0x950412de;
 
-        uint32_t offset = 0;
-
-        if (data.size() < 5 * sizeof(uint32_t))
+        if (size < 5 * sizeof(uint32_t))
             throw std::runtime_error("Not enough data");
 
-        uint32_t magic = *reinterpret_cast<const uint32_t*>(data.data() + offset);
-        offset += sizeof(magic);
-
-        std::function<uint32_t(const uint8_t*)> decodeUInt32;
+        uint32_t magic = static_cast<uint32_t>(data[0] | (data[1] << 8) | (data[2] << 16) | (data[3] << 24));
 
         if (magic == MAGIC_BIG)
-            decodeUInt32 = [](const uint8_t* bytes) {
-                return static_cast<uint32_t>(bytes[3] |
-                                             (bytes[2] << 8) |
-                                             (bytes[1] << 16) |
-                                             (bytes[0] << 24));
-            };
+            bigEndian = true;
         else if (magic == MAGIC_LITTLE)
-            decodeUInt32 = [](const uint8_t* bytes) {
-                return static_cast<uint32_t>(bytes[0] |
-                                             (bytes[1] << 8) |
-                                             (bytes[2] << 16) |
-                                             (bytes[3] << 24));
-            };
+            bigEndian = false;
         else
             throw std::runtime_error("Wrong magic " + std::to_string(magic));
 
-        uint32_t revision = decodeUInt32(data.data() + offset);
-        offset += sizeof(revision);
+        uint32_t revision = decodeUInt32(4);
 
         if (revision != 0)
             throw std::runtime_error("Unsupported revision " + std::to_string(revision));
 
-        uint32_t stringCount = decodeUInt32(data.data() + offset);
-        offset += sizeof(stringCount);
-
-        std::vector<TranslationInfo> translations(stringCount);
+        stringCount = decodeUInt32(8);
+        stringsOffset = decodeUInt32(12);
+        translationsOffset = decodeUInt32(16);
 
-        uint32_t stringsOffset = decodeUInt32(data.data() + offset);
-        offset += sizeof(stringsOffset);
-
-        uint32_t translationsOffset = decodeUInt32(data.data() + offset);
-        offset += sizeof(translationsOffset);
-
-        offset = stringsOffset;
-
-        if (data.size() < offset + 2 * sizeof(uint32_t) * stringCount)
-            throw std::runtime_error("Not enough data");
-
-        for (uint32_t i = 0; i < stringCount; ++i)
+        if (size >= 7 * sizeof(uint32_t))
         {
-            translations[i].stringLength = decodeUInt32(data.data() + offset);
-            offset += sizeof(translations[i].stringLength);
-
-            translations[i].stringOffset = decodeUInt32(data.data() + offset);
-            offset += sizeof(translations[i].stringOffset);
+            hashSize = decodeUInt32(20);
+            hashOffset = decodeUInt32(24);
         }
 
-        offset = translationsOffset;
+        if (size < static_cast<uint64_t>(stringsOffset) + 2 * sizeof(uint32_t) * static_cast<uint64_t>(stringCount) ||
+            size < static_cast<uint64_t>(translationsOffset) + 2 * sizeof(uint32_t) * static_cast<uint64_t>(stringCount))
+            throw std::runtime_error("Not enough data");
 
-        if (data.size() < offset + 2 * sizeof(uint32_t) * stringCount)
+        // the hash table is optional, without it the sorted original strings are searched
+        if (hashSize > 2 &&
+            size < static_cast<uint64_t>(hashOffset) + sizeof(uint32_t) * static_cast<uint64_t>(hashSize))
             throw std::runtime_error("Not enough data");
 
+        // validate the string ranges once, lookups don't have to check them
         for (uint32_t i = 0; i < stringCount; ++i)
         {
-            translations[i].translationLength = decodeUInt32(data.data() + offset);
-            offset += sizeof(translations[i].translationLength);
-
-            translations[i].translationOffset = decodeUInt32(data.data() + offset);
-            offset += sizeof(translations[i].translationOffset);
-        }
+            uint32_t stringLength = decodeUInt32(stringsOffset + i * 2 * sizeof(uint32_t));
+            uint32_t stringOffset = decodeUInt32(stringsOffset + i * 2 * sizeof(uint32_t) + sizeof(uint32_t));
+            uint32_t translationLength = decodeUInt32(translationsOffset + i * 2 * sizeof(uint32_t));
+            uint32_t translationOffset = decodeUInt32(translationsOffset + i * 2 * sizeof(uint32_t) + sizeof(uint32_t));
 
-        for (uint32_t i = 0; i < stringCount; ++i)
-        {
-            if (data.size() < translations[i].stringOffset + translations[i].stringLength ||
-                data.size() < translations[i].translationOffset + translations[i].translationLength)
+            if (size < static_cast<uint64_t>(stringOffset) + stringLength ||
+                size < static_cast<uint64_t>(translationOffset) + translationLength)
                 throw std::runtime_error("Not enough data");
+        }
+    }
 
-            std::string str(reinterpret_cast<const char*>(data.data() + translations[i].stringOffset), translations[i].stringLength);
-            std::string translation(reinterpret_cast<const char*>(data.data() + translations[i].translationOffset), translations[i].translationLength);
+    bool Language::matches(uint32_t index, StringView str) const
+    {
+        uint32_t stringLength = decodeUInt32(stringsOffset + index * 2 * sizeof(uint32_t));
+        uint32_t stringOffset = decodeUInt32(stringsOffset + index * 2 * sizeof(uint32_t) + sizeof(uint32_t));
 
-            strings[str] = translation;
-        }
+        return firstForm(data + stringOffset, stringLength) == str;
     }
 
-    std::string Language::getString(const std::string& str) const
+    StringView Language::getTranslation(uint32_t index) const
     {
-        auto i = strings.find(str);
+        uint32_t translationLength = decodeUInt32(translationsOffset + index * 2 * sizeof(uint32_t));
+        uint32_t translationOffset = decodeUInt32(translationsOffset + index * 2 * sizeof(uint32_t) + sizeof(uint32_t));
+
+        return firstForm(data + translationOffset, translationLength);
+    }
 
-        if (i != strings.end())
-            return i->second;
+    bool Language::findString(StringView str, StringView& translation) const
+    {
+        if (hashSize > 2)
+        {
+            // open addressing with double hashing, as written by msgfmt
+            uint32_t hash = hashString(str);
+            uint32_t index = hash % hashSize;
+            uint32_t increment = 1 + hash % (hashSize - 2);
+
+            for (uint32_t probe = 0; probe < hashSize; ++probe)
+            {
+                uint32_t entry = decodeUInt32(hashOffset + index * sizeof(uint32_t));
+                if (entry == 0) break;
+
+                if (entry <= stringCount && matches(entry - 1, str))
+                {
+                    translation = getTranslation(entry - 1);
+                    return true;
+                }
+
+                if (index >= hashSize - increment)
+                    index -= hashSize - increment;
+                else
+                    index += increment;
+            }
+        }
         else
-            return str;
+        {
+            uint32_t first = 0;
+            uint32_t last = stringCount;
+
+            while (first < last)
+            {
+                uint32_t middle = first + (last - first) / 2;
+
+                uint32_t stringLength = decodeUInt32(stringsOffset + middle * 2 * sizeof(uint32_t));
+                uint32_t stringOffset = decodeUInt32(stringsOffset + middle * 2 * sizeof(uint32_t) + sizeof(uint32_t));
+
+                int result = compare(firstForm(data + stringOffset, stringLength), str);
+
+                if (result == 0)
+                {
+                    translation = getTranslation(middle);
+                    return true;
+                }
+                else if (result < 0)
+                    first = middle + 1;
+                else
+                    last = middle;
+            }
+        }
+
+        return false;
     }
 }
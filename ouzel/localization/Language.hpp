@@ -4,21 +4,62 @@
 #define OUZEL_LOCALIZATION_LANGUAGE_HPP
 
 #include <cstdint>
-#include <map>
+#include <string>
 #include <vector>
+#include "files/MappedFile.hpp"
+#include "utils/StringView.hpp"
 
 namespace ouzel
 {
+    // GNU .mo catalog, strings are looked up with the catalog's own hash table directly in the
+    // loaded (or memory-mapped) data, nothing is copied
     class Language final
     {
     public:
         Language() {}
-        explicit Language(const std::vector<uint8_t>& data);
+        explicit Language(const std::vector<uint8_t>& initData);
+        explicit Language(std::vector<uint8_t>&& initData);
+        explicit Language(MappedFile&& initFile);
 
-        std::string getString(const std::string& str) const;
+        Language(const Language&) = delete;
+        Language& operator=(const Language&) = delete;
+
+        Language(Language&&) = delete;
+        Language& operator=(Language&&) = delete;
+
+        // finds the translation (the singular form for plural entries), it points to the catalog data
+        // and is valid as long as the language
+        bool findString(StringView str, StringView& translation) const;
+
+        inline uint32_t getStringCount() const { return stringCount; }
 
     private:
-        std::map<std::string, std::string> strings;
+        void init();
+
+        inline uint32_t decodeUInt32(uint32_t offset) const
+        {
+            const uint8_t* bytes = data + offset;
+
+            return bigEndian ?
+                static_cast<uint32_t>(bytes[3] | (bytes[2] << 8) | (bytes[1] << 16) | (bytes[0] << 24)) :
+                static_cast<uint32_t>(bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (bytes[3] << 24));
+        }
+
+        bool matches(uint32_t index, StringView str) const;
+        StringView getTranslation(uint32_t index) const;
+
+        std::vector<uint8_t> buffer;
+        MappedFile file;
+
+        const uint8_t* data = nullptr;
+        uint32_t size = 0;
+        bool bigEndian = false;
+
+        uint32_t stringCount = 0;
+        uint32_t stringsOffset = 0;
+        uint32_t translationsOffset = 0;
+        uint32_t hashSize = 0;
+        uint32_t hashOffset = 0;
     };
 }
 
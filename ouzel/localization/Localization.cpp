@@ -2,6 +2,7 @@
 
 #include "Localization.hpp"
 #include "Language.hpp"
+#include "core/Engine.hpp"
 
 namespace ouzel
 {
@@ -11,6 +12,32 @@ namespace ouzel
         languages[name] = language;
     }
 
+    void Localization::addLanguage(const std::string& name, std::vector<uint8_t>&& data)
+    {
+        std::shared_ptr<Language> language = std::make_shared<Language>(std::move(data));
+        languages[name] = language;
+    }
+
+    void Localization::addLanguageFile(const std::string& name, const std::string& filename)
+    {
+        FileSystem& fileSystem = engine->getFileSystem();
+
+        // same lookup order as FileSystem::readFile, archives first
+        std::shared_ptr<Language> language;
+        if (fileSystem.archiveFileExists(filename))
+            language = std::make_shared<Language>(fileSystem.readFile(filename));
+        else
+        {
+            std::string path = fileSystem.getPath(filename);
+            if (!path.empty())
+                language = std::make_shared<Language>(MappedFile(path));
+            else
+                language = std::make_shared<Language>(fileSystem.readFile(filename));
+        }
+
+        languages[name] = language;
+    }
+
     void Localization::setLanguage(const std::string& language)
     {
         auto i = languages.find(language);
@@ -21,11 +48,12 @@ namespace ouzel
             currentLanguage.reset();
     }
 
-    std::string Localization::getString(const std::string& str) const
+    StringView Localization::getString(StringView str) const
     {
-        if (currentLanguage)
-            return currentLanguage->getString(str);
-        else
-            return str;
+        StringView translation;
+        if (currentLanguage && currentLanguage->findString(str, translation))
+            return translation;
+
+        return str;
     }
 }
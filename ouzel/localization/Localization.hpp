@@ -8,6 +8,7 @@
 #include <map>
 #include <string>
 #include <vector>
+#include "utils/StringView.hpp"
 
 namespace ouzel
 {
@@ -17,8 +18,16 @@ namespace ouzel
     {
     public:
         void addLanguage(const std::string& name, const std::vector<uint8_t>& data);
+        void addLanguage(const std::string& name, std::vector<uint8_t>&& data);
+        // memory-maps the catalog if it is a regular file, otherwise reads it (e.g. from an archive)
+        void addLanguageFile(const std::string& name, const std::string& filename);
+
+        // switching only changes the current catalog, languages are parsed when added
         void setLanguage(const std::string& language);
-        std::string getString(const std::string& str) const;
+
+        // returns a view into the catalog data without copying, if there is no translation the given view
+        // is returned, so then the result refers to the caller's string and must not outlive it
+        StringView getString(StringView str) const;
 
     private:
         std::map<std::string, std::shared_ptr<Language>> languages;
@@ -0,0 +1,623 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#if defined(__ARM_NEON__)
+#  include <arm_neon.h>
+#elif defined(__SSE__)
+#  include <xmmintrin.h>
+#  if defined(__GNUC__) || defined(__clang__)
+#    include <immintrin.h>
+#    define OUZEL_BATCH_AVX 1
+#    define OUZEL_TARGET_AVX __attribute__((target("avx")))
+#  endif
+#endif
+#include "BatchMath.hpp"
+#include "MathUtils.hpp"
+
+namespace ouzel
+{
+    typedef void (*TransformPointsFunction)(const Matrix4<float>&, const Vector3<float>*, Vector3<float>*, size_t);
+    typedef void (*TransformBoxesFunction)(const Matrix4<float>&, const Box3<float>*, Box3<float>*, size_t);
+    // matrices1 is advanced by step1 matrices (0 or 1) for every result
+    typedef void (*MultiplyMatricesFunction)(const Matrix4<float>*, size_t, const Matrix4<float>*, Matrix4<float>*, size_t);
+    typedef size_t (*CullBoxesFunction)(const Frustum&, const Box3<float>*, uint8_t*, size_t);
+
+    static void transformPointsScalar(const Matrix4<float>& matrix,
+                                      const Vector3<float>* points, Vector3<float>* result, size_t count)
+    {
+        const float* m = matrix.m;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            float x = points[i].v[0];
+            float y = points[i].v[1];
+            float z = points[i].v[2];
+
+            result[i].v[0] = m[0] * x + m[4] * y + m[8] * z + m[12];
+            result[i].v[1] = m[1] * x + m[5] * y + m[9] * z + m[13];
+            result[i].v[2] = m[2] * x + m[6] * y + m[10] * z + m[14];
+        }
+    }
+
+    static void transformBoxesScalar(const Matrix4<float>& matrix,
+                                     const Box3<float>* boxes, Box3<float>* result, size_t count)
+    {
+        const float* m = matrix.m;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (boxes[i].isEmpty())
+            {
+                result[i].min = boxes[i].min;
+                result[i].max = boxes[i].max;
+                continue;
+            }
+
+            float centerX = (boxes[i].min.v[0] + boxes[i].max.v[0]) * 0.5F;
+            float centerY = (boxes[i].min.v[1] + boxes[i].max.v[1]) * 0.5F;
+            float centerZ = (boxes[i].min.v[2] + boxes[i].max.v[2]) * 0.5F;
+            float extentX = (boxes[i].max.v[0] - boxes[i].min.v[0]) * 0.5F;
+            float extentY = (boxes[i].max.v[1] - boxes[i].min.v[1]) * 0.5F;
+            float extentZ = (boxes[i].max.v[2] - boxes[i].min.v[2]) * 0.5F;
+
+            for (size_t row = 0; row < 3; ++row)
+            {
+                float center = m[row] * centerX + m[4 + row] * centerY + m[8 + row] * centerZ + m[12 + row];
+                float extent = fabsf(m[row]) * extentX + fabsf(m[4 + row]) * extentY + fabsf(m[8 + row]) * extentZ;
+
+                result[i].min.v[row] = center - extent;
+                result[i].max.v[row] = center + extent;
+            }
+        }
+    }
+
+    static void multiplyMatricesScalar(const Matrix4<float>* matrices1, size_t step1,
+                                       const Matrix4<float>* matrices2, Matrix4<float>* result, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            const float* a = matrices1[i * step1].m;
+            const float* b = matrices2[i].m;
+            float product[16];
+
+            for (size_t column = 0; column < 4; ++column)
+            {
+                for (size_t row = 0; row < 4; ++row)
+                {
+                    product[column * 4 + row] = a[row] * b[column * 4] +
+                        a[4 + row] * b[column * 4 + 1] +
+                        a[8 + row] * b[column * 4 + 2] +
+                        a[12 + row] * b[column * 4 + 3];
+                }
+            }
+
+            std::copy(std::begin(product), std::end(product), result[i].m);
+        }
+    }
+
+    static size_t cullBoxesScalar(const Frustum& frustum, const Box3<float>* boxes, uint8_t* visible, size_t count)
+    {
+        size_t visibleCount = 0;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            visible[i] = (!boxes[i].isEmpty() && frustum.isBoxInside(boxes[i])) ? 1 : 0;
+            visibleCount += visible[i];
+        }
+
+        return visibleCount;
+    }
+
+#if defined(__ARM_NEON__)
+    static inline float32x4_t loadVector3(const Vector3<float>& vector)
+    {
+        float32x4_t result = vdupq_n_f32(0.0F);
+        result = vsetq_lane_f32(vector.v[0], result, 0);
+        result = vsetq_lane_f32(vector.v[1], result, 1);
+        result = vsetq_lane_f32(vector.v[2], result, 2);
+        return result;
+    }
+
+    static inline void storeVector3(float32x4_t value, Vector3<float>& vector)
+    {
+        vector.v[0] = vgetq_lane_f32(value, 0);
+        vector.v[1] = vgetq_lane_f32(value, 1);
+        vector.v[2] = vgetq_lane_f32(value, 2);
+    }
+
+    static void transformPointsNeon(const Matrix4<float>& matrix,
+                                    const Vector3<float>* points, Vector3<float>* result, size_t count)
+    {
+        float32x4_t col0 = vld1q_f32(&matrix.m[0]);
+        float32x4_t col1 = vld1q_f32(&matrix.m[4]);
+        float32x4_t col2 = vld1q_f32(&matrix.m[8]);
+        float32x4_t col3 = vld1q_f32(&matrix.m[12]);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            float32x4_t r = vmlaq_n_f32(col3, col0, points[i].v[0]);
+            r = vmlaq_n_f32(r, col1, points[i].v[1]);
+            r = vmlaq_n_f32(r, col2, points[i].v[2]);
+            storeVector3(r, result[i]);
+        }
+    }
+
+    static void transformBoxesNeon(const Matrix4<float>& matrix,
+                                   const Box3<float>* boxes, Box3<float>* result, size_t count)
+    {
+        float32x4_t col0 = vld1q_f32(&matrix.m[0]);
+        float32x4_t col1 = vld1q_f32(&matrix.m[4]);
+        float32x4_t col2 = vld1q_f32(&matrix.m[8]);
+        float32x4_t col3 = vld1q_f32(&matrix.m[12]);
+        float32x4_t absCol0 = vabsq_f32(col0);
+        float32x4_t absCol1 = vabsq_f32(col1);
+        float32x4_t absCol2 = vabsq_f32(col2);
+        float32x4_t half = vdupq_n_f32(0.5F);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (boxes[i].isEmpty())
+            {
+                result[i].min = boxes[i].min;
+                result[i].max = boxes[i].max;
+                continue;
+            }
+
+            float32x4_t boxMin = loadVector3(boxes[i].min);
+            float32x4_t boxMax = loadVector3(boxes[i].max);
+            float32x4_t center = vmulq_f32(vaddq_f32(boxMin, boxMax), half);
+            float32x4_t extent = vmulq_f32(vsubq_f32(boxMax, boxMin), half);
+
+            float32x4_t c = vmlaq_n_f32(col3, col0, vgetq_lane_f32(center, 0));
+            c = vmlaq_n_f32(c, col1, vgetq_lane_f32(center, 1));
+            c = vmlaq_n_f32(c, col2, vgetq_lane_f32(center, 2));
+
+            float32x4_t e = vmulq_n_f32(absCol0, vgetq_lane_f32(extent, 0));
+            e = vmlaq_n_f32(e, absCol1, vgetq_lane_f32(extent, 1));
+            e = vmlaq_n_f32(e, absCol2, vgetq_lane_f32(extent, 2));
+
+            storeVector3(vsubq_f32(c, e), result[i].min);
+            storeVector3(vaddq_f32(c, e), result[i].max);
+        }
+    }
+
+    static void multiplyMatricesNeon(const Matrix4<float>* matrices1, size_t step1,
+                                     const Matrix4<float>* matrices2, Matrix4<float>* result, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            const float* a = matrices1[i * step1].m;
+            const float* b = matrices2[i].m;
+
+            float32x4_t col0 = vld1q_f32(&a[0]);
+            float32x4_t col1 = vld1q_f32(&a[4]);
+            float32x4_t col2 = vld1q_f32(&a[8]);
+            float32x4_t col3 = vld1q_f32(&a[12]);
+
+            float32x4_t products[4];
+            for (size_t column = 0; column < 4; ++column)
+            {
+                float32x4_t r = vmulq_n_f32(col0, b[column * 4]);
+                r = vmlaq_n_f32(r, col1, b[column * 4 + 1]);
+                r = vmlaq_n_f32(r, col2, b[column * 4 + 2]);
+                products[column] = vmlaq_n_f32(r, col3, b[column * 4 + 3]);
+            }
+
+            for (size_t column = 0; column < 4; ++column)
+                vst1q_f32(&result[i].m[column * 4], products[column]);
+        }
+    }
+
+    static size_t cullBoxesNeon(const Frustum& frustum, const Box3<float>* boxes, uint8_t* visible, size_t count)
+    {
+        float32x4_t a[2] = {vld1q_f32(&frustum.a[0]), vld1q_f32(&frustum.a[4])};
+        float32x4_t b[2] = {vld1q_f32(&frustum.b[0]), vld1q_f32(&frustum.b[4])};
+        float32x4_t c[2] = {vld1q_f32(&frustum.c[0]), vld1q_f32(&frustum.c[4])};
+        float32x4_t d[2] = {vld1q_f32(&frustum.d[0]), vld1q_f32(&frustum.d[4])};
+        float32x4_t absA[2] = {vld1q_f32(&frustum.absA[0]), vld1q_f32(&frustum.absA[4])};
+        float32x4_t absB[2] = {vld1q_f32(&frustum.absB[0]), vld1q_f32(&frustum.absB[4])};
+        float32x4_t absC[2] = {vld1q_f32(&frustum.absC[0]), vld1q_f32(&frustum.absC[4])};
+        float32x4_t zero = vdupq_n_f32(0.0F);
+
+        size_t visibleCount = 0;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (boxes[i].isEmpty())
+            {
+                visible[i] = 0;
+                continue;
+            }
+
+            float centerX = (boxes[i].min.v[0] + boxes[i].max.v[0]) * 0.5F;
+            float centerY = (boxes[i].min.v[1] + boxes[i].max.v[1]) * 0.5F;
+            float centerZ = (boxes[i].min.v[2] + boxes[i].max.v[2]) * 0.5F;
+            float extentX = (boxes[i].max.v[0] - boxes[i].min.v[0]) * 0.5F;
+            float extentY = (boxes[i].max.v[1] - boxes[i].min.v[1]) * 0.5F;
+            float extentZ = (boxes[i].max.v[2] - boxes[i].min.v[2]) * 0.5F;
+
+            uint32x4_t outside = vdupq_n_u32(0);
+            for (size_t half = 0; half < 2; ++half)
+            {
+                float32x4_t distance = vmlaq_n_f32(d[half], a[half], centerX);
+                distance = vmlaq_n_f32(distance, b[half], centerY);
+                distance = vmlaq_n_f32(distance, c[half], centerZ);
+                distance = vmlaq_n_f32(distance, absA[half], extentX);
+                distance = vmlaq_n_f32(distance, absB[half], extentY);
+                distance = vmlaq_n_f32(distance, absC[half], extentZ);
+                outside = vorrq_u32(outside, vcltq_f32(distance, zero));
+            }
+
+            uint32x2_t outsidePair = vorr_u32(vget_low_u32(outside), vget_high_u32(outside));
+            outsidePair = vpmax_u32(outsidePair, outsidePair);
+
+            visible[i] = vget_lane_u32(outsidePair, 0) ? 0 : 1;
+            visibleCount += visible[i];
+        }
+
+        return visibleCount;
+    }
+#elif defined(__SSE__)
+    static inline __m128 loadVector3(const Vector3<float>& vector)
+    {
+        return _mm_setr_ps(vector.v[0], vector.v[1], vector.v[2], 0.0F);
+    }
+
+    static inline void storeVector3(__m128 value, Vector3<float>& vector)
+    {
+        alignas(16) float values[4];
+        _mm_store_ps(values, value);
+        vector.v[0] = values[0];
+        vector.v[1] = values[1];
+        vector.v[2] = values[2];
+    }
+
+    static inline __m128 absolute(__m128 value)
+    {
+        return _mm_andnot_ps(_mm_set1_ps(-0.0F), value);
+    }
+
+    static void transformPointsSse(const Matrix4<float>& matrix,
+                                   const Vector3<float>* points, Vector3<float>* result, size_t count)
+    {
+        __m128 col0 = _mm_load_ps(&matrix.m[0]);
+        __m128 col1 = _mm_load_ps(&matrix.m[4]);
+        __m128 col2 = _mm_load_ps(&matrix.m[8]);
+        __m128 col3 = _mm_load_ps(&matrix.m[12]);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(col0, _mm_set1_ps(points[i].v[0])),
+                                             _mm_mul_ps(col1, _mm_set1_ps(points[i].v[1]))),
+                                  _mm_add_ps(_mm_mul_ps(col2, _mm_set1_ps(points[i].v[2])), col3));
+            storeVector3(r, result[i]);
+        }
+    }
+
+    static void transformBoxesSse(const Matrix4<float>& matrix,
+                                  const Box3<float>* boxes, Box3<float>* result, size_t count)
+    {
+        __m128 col0 = _mm_load_ps(&matrix.m[0]);
+        __m128 col1 = _mm_load_ps(&matrix.m[4]);
+        __m128 col2 = _mm_load_ps(&matrix.m[8]);
+        __m128 col3 = _mm_load_ps(&matrix.m[12]);
+        __m128 absCol0 = absolute(col0);
+        __m128 absCol1 = absolute(col1);
+        __m128 absCol2 = absolute(col2);
+        __m128 half = _mm_set1_ps(0.5F);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (boxes[i].isEmpty())
+            {
+                result[i].min = boxes[i].min;
+                result[i].max = boxes[i].max;
+                continue;
+            }
+
+            __m128 boxMin = loadVector3(boxes[i].min);
+            __m128 boxMax = loadVector3(boxes[i].max);
+            __m128 center = _mm_mul_ps(_mm_add_ps(boxMin, boxMax), half);
+            __m128 extent = _mm_mul_ps(_mm_sub_ps(boxMax, boxMin), half);
+
+            __m128 c = _mm_add_ps(_mm_add_ps(_mm_mul_ps(col0, _mm_shuffle_ps(center, center, _MM_SHUFFLE(0, 0, 0, 0))),
+                                             _mm_mul_ps(col1, _mm_shuffle_ps(center, center, _MM_SHUFFLE(1, 1, 1, 1)))),
+                                  _mm_add_ps(_mm_mul_ps(col2, _mm_shuffle_ps(center, center, _MM_SHUFFLE(2, 2, 2, 2))), col3));
+            __m128 e = _mm_add_ps(_mm_add_ps(_mm_mul_ps(absCol0, _mm_shuffle_ps(extent, extent, _MM_SHUFFLE(0, 0, 0, 0))),
+                                             _mm_mul_ps(absCol1, _mm_shuffle_ps(extent, extent, _MM_SHUFFLE(1, 1, 1, 1)))),
+                                  _mm_mul_ps(absCol2, _mm_shuffle_ps(extent, extent, _MM_SHUFFLE(2, 2, 2, 2))));
+
+            storeVector3(_mm_sub_ps(c, e), result[i].min);
+            storeVector3(_mm_add_ps(c, e), result[i].max);
+        }
+    }
+
+    static void multiplyMatricesSse(const Matrix4<float>* matrices1, size_t step1,
+                                    const Matrix4<float>* matrices2, Matrix4<float>* result, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            const float* a = matrices1[i * step1].m;
+            const float* b = matrices2[i].m;
+
+            __m128 col0 = _mm_load_ps(&a[0]);
+            __m128 col1 = _mm_load_ps(&a[4]);
+            __m128 col2 = _mm_load_ps(&a[8]);
+            __m128 col3 = _mm_load_ps(&a[12]);
+
+            __m128 products[4];
+            for (size_t column = 0; column < 4; ++column)
+            {
+                __m128 bColumn = _mm_load_ps(&b[column * 4]);
+                products[column] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(col0, _mm_shuffle_ps(bColumn, bColumn, _MM_SHUFFLE(0, 0, 0, 0))),
+                                                         _mm_mul_ps(col1, _mm_shuffle_ps(bColumn, bColumn, _MM_SHUFFLE(1, 1, 1, 1)))),
+                                              _mm_add_ps(_mm_mul_ps(col2, _mm_shuffle_ps(bColumn, bColumn, _MM_SHUFFLE(2, 2, 2, 2))),
+                                                         _mm_mul_ps(col3, _mm_shuffle_ps(bColumn, bColumn, _MM_SHUFFLE(3, 3, 3, 3)))));
+            }
+
+            for (size_t column = 0; column < 4; ++column)
+                _mm_store_ps(&result[i].m[column * 4], products[column]);
+        }
+    }
+
+    static size_t cullBoxesSse(const Frustum& frustum, const Box3<float>* boxes, uint8_t* visible, size_t count)
+    {
+        __m128 a[2] = {_mm_load_ps(&frustum.a[0]), _mm_load_ps(&frustum.a[4])};
+        __m128 b[2] = {_mm_load_ps(&frustum.b[0]), _mm_load_ps(&frustum.b[4])};
+        __m128 c[2] = {_mm_load_ps(&frustum.c[0]), _mm_load_ps(&frustum.c[4])};
+        __m128 d[2] = {_mm_load_ps(&frustum.d[0]), _mm_load_ps(&frustum.d[4])};
+        __m128 absA[2] = {_mm_load_ps(&frustum.absA[0]), _mm_load_ps(&frustum.absA[4])};
+        __m128 absB[2] = {_mm_load_ps(&frustum.absB[0]), _mm_load_ps(&frustum.absB[4])};
+        __m128 absC[2] = {_mm_load_ps(&frustum.absC[0]), _mm_load_ps(&frustum.absC[4])};
+        __m128 zero = _mm_setzero_ps();
+
+        size_t visibleCount = 0;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (boxes[i].isEmpty())
+            {
+                visible[i] = 0;
+                continue;
+            }
+
+            __m128 centerX = _mm_set1_ps((boxes[i].min.v[0] + boxes[i].max.v[0]) * 0.5F);
+            __m128 centerY = _mm_set1_ps((boxes[i].min.v[1] + boxes[i].max.v[1]) * 0.5F);
+            __m128 centerZ = _mm_set1_ps((boxes[i].min.v[2] + boxes[i].max.v[2]) * 0.5F);
+            __m128 extentX = _mm_set1_ps((boxes[i].max.v[0] - boxes[i].min.v[0]) * 0.5F);
+            __m128 extentY = _mm_set1_ps((boxes[i].max.v[1] - boxes[i].min.v[1]) * 0.5F);
+            __m128 extentZ = _mm_set1_ps((boxes[i].max.v[2] - boxes[i].min.v[2]) * 0.5F);
+
+            int outside = 0;
+            for (size_t half = 0; half < 2; ++half)
+            {
+                __m128 distance = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(a[half], centerX),
+                                                                   _mm_mul_ps(b[half], centerY)),
+                                                        _mm_add_ps(_mm_mul_ps(c[half], centerZ), d[half])),
+                                             _mm_add_ps(_mm_add_ps(_mm_mul_ps(absA[half], extentX),
+                                                                   _mm_mul_ps(absB[half], extentY)),
+                                                        _mm_mul_ps(absC[half], extentZ)));
+                outside |= _mm_movemask_ps(_mm_cmplt_ps(distance, zero));
+            }
+
+            visible[i] = outside ? 0 : 1;
+            visibleCount += visible[i];
+        }
+
+        return visibleCount;
+    }
+
+#  if defined(OUZEL_BATCH_AVX)
+    // two points are processed at once, one in each 128-bit lane
+    OUZEL_TARGET_AVX static inline __m256 broadcastLanes(float first, float second)
+    {
+        return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_set1_ps(first)), _mm_set1_ps(second), 1);
+    }
+
+    OUZEL_TARGET_AVX static void transformPointsAvx(const Matrix4<float>& matrix,
+                                                    const Vector3<float>* points, Vector3<float>* result, size_t count)
+    {
+        __m256 col0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&matrix.m[0]));
+        __m256 col1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&matrix.m[4]));
+        __m256 col2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&matrix.m[8]));
+        __m256 col3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&matrix.m[12]));
+
+        size_t i = 0;
+        for (; i + 1 < count; i += 2)
+        {
+            __m256 x = broadcastLanes(points[i].v[0], points[i + 1].v[0]);
+            __m256 y = broadcastLanes(points[i].v[1], points[i + 1].v[1]);
+            __m256 z = broadcastLanes(points[i].v[2], points[i + 1].v[2]);
+
+            __m256 r = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(col0, x), _mm256_mul_ps(col1, y)),
+                                     _mm256_add_ps(_mm256_mul_ps(col2, z), col3));
+
+            alignas(32) float values[8];
+            _mm256_store_ps(values, r);
+            result[i].v[0] = values[0];
+            result[i].v[1] = values[1];
+            result[i].v[2] = values[2];
+            result[i + 1].v[0] = values[4];
+            result[i + 1].v[1] = values[5];
+            result[i + 1].v[2] = values[6];
+        }
+
+        if (i < count)
+            transformPointsSse(matrix, points + i, result + i, count - i);
+    }
+
+    OUZEL_TARGET_AVX static void multiplyMatricesAvx(const Matrix4<float>* matrices1, size_t step1,
+                                                     const Matrix4<float>* matrices2, Matrix4<float>* result, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            const float* a = matrices1[i * step1].m;
+            const float* b = matrices2[i].m;
+
+            __m256 col0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&a[0]));
+            __m256 col1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&a[4]));
+            __m256 col2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&a[8]));
+            __m256 col3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&a[12]));
+
+            // columns 0 and 1 in the first register, 2 and 3 in the second one
+            __m256 bColumns01 = _mm256_loadu_ps(&b[0]);
+            __m256 bColumns23 = _mm256_loadu_ps(&b[8]);
+
+            __m256 products01 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(col0, _mm256_permute_ps(bColumns01, 0x00)),
+                                                            _mm256_mul_ps(col1, _mm256_permute_ps(bColumns01, 0x55))),
+                                              _mm256_add_ps(_mm256_mul_ps(col2, _mm256_permute_ps(bColumns01, 0xAA)),
+                                                            _mm256_mul_ps(col3, _mm256_permute_ps(bColumns01, 0xFF))));
+            __m256 products23 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(col0, _mm256_permute_ps(bColumns23, 0x00)),
+                                                            _mm256_mul_ps(col1, _mm256_permute_ps(bColumns23, 0x55))),
+                                              _mm256_add_ps(_mm256_mul_ps(col2, _mm256_permute_ps(bColumns23, 0xAA)),
+                                                            _mm256_mul_ps(col3, _mm256_permute_ps(bColumns23, 0xFF))));
+
+            _mm256_storeu_ps(&result[i].m[0], products01);
+            _mm256_storeu_ps(&result[i].m[8], products23);
+        }
+    }
+
+    OUZEL_TARGET_AVX static size_t cullBoxesAvx(const Frustum& frustum, const Box3<float>* boxes, uint8_t* visible, size_t count)
+    {
+        __m256 a = _mm256_loadu_ps(frustum.a);
+        __m256 b = _mm256_loadu_ps(frustum.b);
+        __m256 c = _mm256_loadu_ps(frustum.c);
+        __m256 d = _mm256_loadu_ps(frustum.d);
+        __m256 absA = _mm256_loadu_ps(frustum.absA);
+        __m256 absB = _mm256_loadu_ps(frustum.absB);
+        __m256 absC = _mm256_loadu_ps(frustum.absC);
+        __m256 zero = _mm256_setzero_ps();
+
+        size_t visibleCount = 0;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (boxes[i].isEmpty())
+            {
+                visible[i] = 0;
+                continue;
+            }
+
+            __m256 centerX = _mm256_set1_ps((boxes[i].min.v[0] + boxes[i].max.v[0]) * 0.5F);
+            __m256 centerY = _mm256_set1_ps((boxes[i].min.v[1] + boxes[i].max.v[1]) * 0.5F);
+            __m256 centerZ = _mm256_set1_ps((boxes[i].min.v[2] + boxes[i].max.v[2]) * 0.5F);
+            __m256 extentX = _mm256_set1_ps((boxes[i].max.v[0] - boxes[i].min.v[0]) * 0.5F);
+            __m256 extentY = _mm256_set1_ps((boxes[i].max.v[1] - boxes[i].min.v[1]) * 0.5F);
+            __m256 extentZ = _mm256_set1_ps((boxes[i].max.v[2] - boxes[i].min.v[2]) * 0.5F);
+
+            __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(a, centerX),
+                                                                        _mm256_mul_ps(b, centerY)),
+                                                          _mm256_add_ps(_mm256_mul_ps(c, centerZ), d)),
+                                            _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(absA, extentX),
+                                                                        _mm256_mul_ps(absB, extentY)),
+                                                          _mm256_mul_ps(absC, extentZ)));
+
+            visible[i] = _mm256_movemask_ps(_mm256_cmp_ps(distance, zero, _CMP_LT_OQ)) ? 0 : 1;
+            visibleCount += visible[i];
+        }
+
+        return visibleCount;
+    }
+#  endif
+#endif
+
+    struct BatchFunctions final
+    {
+        SimdInstructionSet instructionSet;
+        TransformPointsFunction transformPoints;
+        TransformBoxesFunction transformBoxes;
+        MultiplyMatricesFunction multiplyMatrices;
+        CullBoxesFunction cullBoxes;
+    };
+
+    static bool loadFunctions(SimdInstructionSet instructionSet, BatchFunctions& functions)
+    {
+        switch (instructionSet)
+        {
+            case SimdInstructionSet::NONE:
+                functions = {SimdInstructionSet::NONE, transformPointsScalar, transformBoxesScalar, multiplyMatricesScalar, cullBoxesScalar};
+                return true;
+#if defined(__ARM_NEON__)
+            case SimdInstructionSet::NEON:
+                if (!isSimdAvailable) return false;
+                functions = {SimdInstructionSet::NEON, transformPointsNeon, transformBoxesNeon, multiplyMatricesNeon, cullBoxesNeon};
+                return true;
+#elif defined(__SSE__)
+            case SimdInstructionSet::SSE:
+                functions = {SimdInstructionSet::SSE, transformPointsSse, transformBoxesSse, multiplyMatricesSse, cullBoxesSse};
+                return true;
+#  if defined(OUZEL_BATCH_AVX)
+            case SimdInstructionSet::AVX:
+                __builtin_cpu_init();
+                if (!__builtin_cpu_supports("avx")) return false;
+                functions = {SimdInstructionSet::AVX, transformPointsAvx, transformBoxesSse, multiplyMatricesAvx, cullBoxesAvx};
+                return true;
+#  endif
+#endif
+            default:
+                return false;
+        }
+    }
+
+    static BatchFunctions selectFunctions()
+    {
+        BatchFunctions functions;
+
+        if (!loadFunctions(SimdInstructionSet::NEON, functions) &&
+            !loadFunctions(SimdInstructionSet::AVX, functions) &&
+            !loadFunctions(SimdInstructionSet::SSE, functions))
+            loadFunctions(SimdInstructionSet::NONE, functions);
+
+        return functions;
+    }
+
+    static BatchFunctions& getFunctions()
+    {
+        static BatchFunctions functions = selectFunctions();
+        return functions;
+    }
+
+    SimdInstructionSet getBatchInstructionSet()
+    {
+        return getFunctions().instructionSet;
+    }
+
+    void setBatchInstructionSet(SimdInstructionSet instructionSet)
+    {
+        if (!loadFunctions(instructionSet, getFunctions()))
+            throw std::runtime_error("Instruction set not supported");
+    }
+
+    void transformPoints(const Matrix4<float>& matrix,
+                         const Vector3<float>* points, Vector3<float>* result, size_t count)
+    {
+        getFunctions().transformPoints(matrix, points, result, count);
+    }
+
+    void transformBoxes(const Matrix4<float>& matrix,
+                        const Box3<float>* boxes, Box3<float>* result, size_t count)
+    {
+        getFunctions().transformBoxes(matrix, boxes, result, count);
+    }
+
+    void multiplyMatrices(const Matrix4<float>& matrix,
+                          const Matrix4<float>* matrices, Matrix4<float>* result, size_t count)
+    {
+        // the matrix may be one of the results
+        Matrix4<float> first = matrix;
+        getFunctions().multiplyMatrices(&first, 0, matrices, result, count);
+    }
+
+    void multiplyMatrices(const Matrix4<float>* matrices1, const Matrix4<float>* matrices2,
+                          Matrix4<float>* result, size_t count)
+    {
+        getFunctions().multiplyMatrices(matrices1, 1, matrices2, result, count);
+    }
+
+    size_t cullBoxes(const Frustum& frustum, const Box3<float>* boxes, uint8_t* visible, size_t count)
+    {
+        return getFunctions().cullBoxes(frustum, boxes, visible, count);
+    }
+}
@@ -0,0 +1,51 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_MATH_BATCHMATH_HPP
+#define OUZEL_MATH_BATCHMATH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include "math/Box3.hpp"
+#include "math/Frustum.hpp"
+#include "math/Matrix4.hpp"
+#include "math/Vector3.hpp"
+
+namespace ouzel
+{
+    // Operations on arrays of points, boxes and matrices. The implementation is picked once at
+    // runtime from the instruction sets the CPU supports. The results may be written over the input.
+    enum class SimdInstructionSet
+    {
+        NONE,
+        SSE,
+        AVX,
+        NEON
+    };
+
+    SimdInstructionSet getBatchInstructionSet();
+    // overrides the runtime choice (e.g. to compare the implementations), must not be called while
+    // other threads use the batch functions, throws if the CPU does not support the instruction set
+    void setBatchInstructionSet(SimdInstructionSet instructionSet);
+
+    // result[i] = matrix * (points[i], 1)
+    void transformPoints(const Matrix4<float>& matrix,
+                         const Vector3<float>* points, Vector3<float>* result, size_t count);
+
+    // result[i] is the axis-aligned box enclosing the transformed boxes[i], empty boxes stay empty
+    void transformBoxes(const Matrix4<float>& matrix,
+                        const Box3<float>* boxes, Box3<float>* result, size_t count);
+
+    // result[i] = matrix * matrices[i]
+    void multiplyMatrices(const Matrix4<float>& matrix,
+                          const Matrix4<float>* matrices, Matrix4<float>* result, size_t count);
+
+    // result[i] = matrices1[i] * matrices2[i]
+    void multiplyMatrices(const Matrix4<float>* matrices1, const Matrix4<float>* matrices2,
+                          Matrix4<float>* result, size_t count);
+
+    // visible[i] is set to 1 if boxes[i] is not empty and not completely outside of the frustum,
+    // returns the number of visible boxes
+    size_t cullBoxes(const Frustum& frustum, const Box3<float>* boxes, uint8_t* visible, size_t count);
+}
+
+#endif // OUZEL_MATH_BATCHMATH_HPP
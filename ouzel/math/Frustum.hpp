@@ -0,0 +1,100 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_MATH_FRUSTUM_HPP
+#define OUZEL_MATH_FRUSTUM_HPP
+
+#include <cmath>
+#include "math/Box3.hpp"
+#include "math/Matrix4.hpp"
+#include "math/Plane.hpp"
+
+namespace ouzel
+{
+    // view frustum with a fixed number of planes, stored as a structure of arrays so that all the
+    // planes can be tested at once, the padding planes always pass
+    class Frustum final
+    {
+    public:
+        static constexpr size_t PLANE_COUNT = 6;
+        static constexpr size_t PADDED_PLANE_COUNT = 8;
+
+        Frustum()
+        {
+            for (size_t i = 0; i < PADDED_PLANE_COUNT; ++i)
+            {
+                a[i] = b[i] = c[i] = 0.0F;
+                absA[i] = absB[i] = absC[i] = 0.0F;
+                d[i] = 1.0F;
+            }
+        }
+
+        explicit Frustum(const Matrix4<float>& matrix):
+            Frustum()
+        {
+            // same order as in Matrix4::getFrustum
+            setPlane(0, matrix.getFrustumLeftPlane());
+            setPlane(1, matrix.getFrustumRightPlane());
+            setPlane(2, matrix.getFrustumBottomPlane());
+            setPlane(3, matrix.getFrustumTopPlane());
+            setPlane(4, matrix.getFrustumNearPlane());
+            setPlane(5, matrix.getFrustumFarPlane());
+        }
+
+        inline Plane<float> getPlane(size_t index) const
+        {
+            return Plane<float>(a[index], b[index], c[index], d[index]);
+        }
+
+        void setPlane(size_t index, const Plane<float>& plane)
+        {
+            a[index] = plane.v[0];
+            b[index] = plane.v[1];
+            c[index] = plane.v[2];
+            d[index] = plane.v[3];
+            absA[index] = fabsf(plane.v[0]);
+            absB[index] = fabsf(plane.v[1]);
+            absC[index] = fabsf(plane.v[2]);
+        }
+
+        bool isPointInside(const Vector3<float>& point) const
+        {
+            for (size_t i = 0; i < PLANE_COUNT; ++i)
+            {
+                if (a[i] * point.v[0] + b[i] * point.v[1] + c[i] * point.v[2] + d[i] < 0.0F)
+                    return false;
+            }
+
+            return true;
+        }
+
+        // the box is outside if its corner furthest along the plane normal is behind any of the planes
+        bool isBoxInside(const Box3<float>& box) const
+        {
+            float centerX = (box.min.v[0] + box.max.v[0]) * 0.5F;
+            float centerY = (box.min.v[1] + box.max.v[1]) * 0.5F;
+            float centerZ = (box.min.v[2] + box.max.v[2]) * 0.5F;
+            float extentX = (box.max.v[0] - box.min.v[0]) * 0.5F;
+            float extentY = (box.max.v[1] - box.min.v[1]) * 0.5F;
+            float extentZ = (box.max.v[2] - box.min.v[2]) * 0.5F;
+
+            for (size_t i = 0; i < PLANE_COUNT; ++i)
+            {
+                if (a[i] * centerX + b[i] * centerY + c[i] * centerZ + d[i] +
+                    absA[i] * extentX + absB[i] * extentY + absC[i] * extentZ < 0.0F)
+                    return false;
+            }
+
+            return true;
+        }
+
+        alignas(16) float a[PADDED_PLANE_COUNT];
+        alignas(16) float b[PADDED_PLANE_COUNT];
+        alignas(16) float c[PADDED_PLANE_COUNT];
+        alignas(16) float d[PADDED_PLANE_COUNT];
+        alignas(16) float absA[PADDED_PLANE_COUNT];
+        alignas(16) float absB[PADDED_PLANE_COUNT];
+        alignas(16) float absC[PADDED_PLANE_COUNT];
+    };
+}
+
+#endif // OUZEL_MATH_FRUSTUM_HPP
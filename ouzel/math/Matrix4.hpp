@@ -348,6 +348,7 @@ namespace ouzel
         ConvexVolume<T> getFrustum() const
         {
             ConvexVolume<T> frustum;
+            frustum.planes.reserve(6);
             frustum.planes.push_back(getFrustumLeftPlane());
             frustum.planes.push_back(getFrustumRightPlane());
             frustum.planes.push_back(getFrustumBottomPlane());
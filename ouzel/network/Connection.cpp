@@ -0,0 +1,357 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include "Connection.hpp"
+#include "Network.hpp"
+#include "utils/Utils.hpp"
+
+namespace ouzel
+{
+    namespace network
+    {
+        static constexpr uint16_t SENT_PACKET_COUNT = 1024;
+        static constexpr uint8_t CHANNEL_MASK = 0x3F;
+        static constexpr uint8_t DELIVERY_SHIFT = 6;
+
+        // packets that are older than this many packets can not be acknowledged anymore
+        static constexpr uint16_t ACK_WINDOW = 33;
+
+        static inline bool isNewer(uint16_t a, uint16_t b)
+        {
+            return static_cast<int16_t>(static_cast<uint16_t>(a - b)) > 0;
+        }
+
+        Connection::Connection(Network& initNetwork, uintptr_t initEndpointId, uint32_t initAddress, uint16_t initPort):
+            Connection([&initNetwork, initEndpointId, initAddress, initPort](const uint8_t* data, uint32_t size) {
+                initNetwork.sendTo(initEndpointId, initAddress, initPort, data, size);
+            })
+        {
+            endpointId = initEndpointId;
+            address = initAddress;
+            port = initPort;
+        }
+
+        Connection::Connection(const std::function<void(const uint8_t*, uint32_t)>& initSendFunction):
+            sendFunction(initSendFunction),
+            sentPackets(SENT_PACKET_COUNT),
+            bandwidthTime(Clock::now())
+        {
+            packet.reserve(MTU);
+        }
+
+        Connection::Delivery Connection::getDelivery(uint8_t channel) const
+        {
+            if (channel >= CHANNEL_COUNT)
+                throw std::out_of_range("Invalid channel");
+
+            return channels[channel].delivery;
+        }
+
+        void Connection::setDelivery(uint8_t channel, Delivery delivery)
+        {
+            if (channel >= CHANNEL_COUNT)
+                throw std::out_of_range("Invalid channel");
+
+            channels[channel].delivery = delivery;
+        }
+
+        void Connection::send(uint8_t channelIndex, const void* data, uint32_t size)
+        {
+            if (channelIndex >= CHANNEL_COUNT)
+                throw std::out_of_range("Invalid channel");
+
+            if (size > MAX_MESSAGE_SIZE)
+                throw std::runtime_error("Message is too large");
+
+            Channel& channel = channels[channelIndex];
+            uint16_t sequence = channel.sendSequence++;
+
+            if (channel.delivery == Delivery::RELIABLE)
+            {
+                ReliableMessage message;
+                message.sequence = sequence;
+                message.data.assign(static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + size);
+                channel.reliableMessages.push_back(std::move(message));
+            }
+            else
+            {
+                size_t offset = unreliableMessages.size();
+                unreliableMessages.resize(offset + MESSAGE_HEADER_SIZE + size);
+                uint8_t* header = unreliableMessages.data() + offset;
+                header[0] = static_cast<uint8_t>(channelIndex | (static_cast<uint8_t>(channel.delivery) << DELIVERY_SHIFT));
+                encodeBigEndian<uint16_t>(header + 1, sequence);
+                encodeBigEndian<uint16_t>(header + 3, static_cast<uint16_t>(size));
+                if (size) std::memcpy(header + MESSAGE_HEADER_SIZE, data, size);
+            }
+        }
+
+        void Connection::receive(const uint8_t* data, uint32_t size)
+        {
+            if (size < PACKET_HEADER_SIZE) return;
+
+            Clock::time_point now = Clock::now();
+            receivedBytes += size;
+
+            uint16_t sequence = decodeBigEndian<uint16_t>(data);
+            uint16_t ack = decodeBigEndian<uint16_t>(data + 2);
+            uint32_t ackBits = decodeBigEndian<uint32_t>(data + 4);
+
+            if (!remoteSequenceReceived)
+            {
+                remoteSequence = sequence;
+                receivedBits = 0;
+                remoteSequenceReceived = true;
+            }
+            else if (isNewer(sequence, remoteSequence))
+            {
+                uint16_t distance = static_cast<uint16_t>(sequence - remoteSequence);
+                if (distance < 32)
+                    receivedBits = (receivedBits << distance) | (1U << (distance - 1));
+                else if (distance == 32)
+                    receivedBits = 1U << 31;
+                else
+                    receivedBits = 0;
+
+                remoteSequence = sequence;
+            }
+            else
+            {
+                uint16_t distance = static_cast<uint16_t>(remoteSequence - sequence);
+
+                // duplicate or too old to be acknowledged
+                if (distance == 0 || distance >= ACK_WINDOW) return;
+
+                uint32_t bit = 1U << (distance - 1);
+                if (receivedBits & bit) return;
+                receivedBits |= bit;
+            }
+
+            acknowledge(ack, ackBits, now);
+
+            uint32_t offset = PACKET_HEADER_SIZE;
+            while (offset + MESSAGE_HEADER_SIZE <= size)
+            {
+                const uint8_t* header = data + offset;
+                uint8_t channelIndex = header[0] & CHANNEL_MASK;
+                uint8_t deliveryValue = header[0] >> DELIVERY_SHIFT;
+                uint16_t messageSequence = decodeBigEndian<uint16_t>(header + 1);
+                uint16_t messageSize = decodeBigEndian<uint16_t>(header + 3);
+
+                if (channelIndex >= CHANNEL_COUNT || offset + MESSAGE_HEADER_SIZE + messageSize > size)
+                    break; // malformed packet
+
+                offset += MESSAGE_HEADER_SIZE + messageSize;
+
+                // only packets with messages need an acknowledgement of their own
+                ackPending = true;
+
+                deliver(channelIndex, deliveryValue, messageSequence, header + MESSAGE_HEADER_SIZE, messageSize);
+            }
+        }
+
+        void Connection::deliver(uint8_t channelIndex, uint8_t deliveryValue, uint16_t sequence,
+                                 const uint8_t* data, uint32_t size)
+        {
+            Channel& channel = channels[channelIndex];
+
+            switch (static_cast<Delivery>(deliveryValue))
+            {
+                case Delivery::UNRELIABLE:
+                    if (messageCallback) messageCallback(channelIndex, data, size);
+                    break;
+                case Delivery::SEQUENCED:
+                    if (!channel.sequenceReceived || isNewer(sequence, channel.lastSequence))
+                    {
+                        channel.lastSequence = sequence;
+                        channel.sequenceReceived = true;
+                        if (messageCallback) messageCallback(channelIndex, data, size);
+                    }
+                    break;
+                case Delivery::RELIABLE:
+                {
+                    uint16_t distance = static_cast<uint16_t>(sequence - channel.nextReliableSequence);
+
+                    if (distance == 0)
+                    {
+                        ++channel.nextReliableSequence;
+                        if (messageCallback) messageCallback(channelIndex, data, size);
+
+                        for (auto i = channel.earlyMessages.find(channel.nextReliableSequence);
+                             i != channel.earlyMessages.end();
+                             i = channel.earlyMessages.find(channel.nextReliableSequence))
+                        {
+                            std::vector<uint8_t> message = std::move(i->second);
+                            channel.earlyMessages.erase(i);
+                            ++channel.nextReliableSequence;
+                            if (messageCallback) messageCallback(channelIndex, message.data(), static_cast<uint32_t>(message.size()));
+                        }
+                    }
+                    else if (distance < RELIABLE_WINDOW) // otherwise it was already delivered
+                        channel.earlyMessages.insert(std::make_pair(sequence, std::vector<uint8_t>(data, data + size)));
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+
+        void Connection::acknowledge(uint16_t ack, uint32_t ackBits, Clock::time_point now)
+        {
+            // the acknowledged packet must have been sent
+            if (!isNewer(localSequence, ack)) return;
+
+            for (uint16_t i = 0; i < ACK_WINDOW; ++i)
+            {
+                if (i > 0 && !(ackBits & (1U << (i - 1)))) continue;
+
+                uint16_t sequence = static_cast<uint16_t>(ack - i);
+                SentPacket& sentPacket = sentPackets[sequence % SENT_PACKET_COUNT];
+                if (!sentPacket.used || sentPacket.sequence != sequence || sentPacket.acknowledged) continue;
+
+                sentPacket.acknowledged = true;
+
+                float sample = std::chrono::duration<float>(now - sentPacket.sendTime).count();
+                if (roundTripTimeMeasured)
+                    roundTripTime += (sample - roundTripTime) * 0.1F;
+                else
+                {
+                    roundTripTime = sample;
+                    roundTripTimeMeasured = true;
+                }
+
+                for (const std::pair<uint8_t, uint16_t>& message : sentPacket.reliableMessages)
+                    acknowledgeMessage(message.first, message.second);
+            }
+
+            // packets that left the acknowledgement window without an acknowledgement are lost
+            while (isNewer(static_cast<uint16_t>(ack - (ACK_WINDOW - 1)), lossSequence))
+            {
+                const SentPacket& sentPacket = sentPackets[lossSequence % SENT_PACKET_COUNT];
+                if (sentPacket.used && sentPacket.sequence == lossSequence)
+                    packetLoss += ((sentPacket.acknowledged ? 0.0F : 1.0F) - packetLoss) * 0.1F;
+
+                ++lossSequence;
+            }
+        }
+
+        void Connection::acknowledgeMessage(uint8_t channelIndex, uint16_t sequence)
+        {
+            std::deque<ReliableMessage>& messages = channels[channelIndex].reliableMessages;
+            if (messages.empty()) return;
+
+            uint16_t index = static_cast<uint16_t>(sequence - messages.front().sequence);
+            if (index >= messages.size()) return;
+
+            messages[index].acknowledged = true;
+
+            while (!messages.empty() && messages.front().acknowledged)
+                messages.pop_front();
+        }
+
+        void Connection::update()
+        {
+            Clock::time_point now = Clock::now();
+
+            float resendTime = roundTripTimeMeasured ? std::max(0.03F, roundTripTime * 1.5F) : 0.2F;
+            Clock::duration resendDelay = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(resendTime));
+
+            uint8_t reliableChannel = 0;
+            size_t reliableIndex = 0;
+            size_t unreliableOffset = 0;
+
+            for (;;)
+            {
+                packet.resize(PACKET_HEADER_SIZE);
+                encodeBigEndian<uint16_t>(packet.data(), localSequence);
+                encodeBigEndian<uint16_t>(packet.data() + 2, remoteSequence);
+                encodeBigEndian<uint32_t>(packet.data() + 4, receivedBits);
+
+                SentPacket& sentPacket = sentPackets[localSequence % SENT_PACKET_COUNT];
+                sentPacket.reliableMessages.clear();
+
+                // reliable messages that were not sent yet or whose acknowledgement is overdue
+                for (; reliableChannel < CHANNEL_COUNT; ++reliableChannel, reliableIndex = 0)
+                {
+                    std::deque<ReliableMessage>& messages = channels[reliableChannel].reliableMessages;
+                    size_t count = std::min(messages.size(), static_cast<size_t>(RELIABLE_WINDOW));
+
+                    for (; reliableIndex < count; ++reliableIndex)
+                    {
+                        ReliableMessage& message = messages[reliableIndex];
+                        if (message.acknowledged || (message.sent && now - message.sendTime < resendDelay))
+                            continue;
+
+                        uint32_t messageSize = static_cast<uint32_t>(message.data.size());
+                        if (packet.size() + MESSAGE_HEADER_SIZE + messageSize > MTU) break;
+
+                        size_t offset = packet.size();
+                        packet.resize(offset + MESSAGE_HEADER_SIZE + messageSize);
+                        uint8_t* header = packet.data() + offset;
+                        header[0] = static_cast<uint8_t>(reliableChannel | (static_cast<uint8_t>(Delivery::RELIABLE) << DELIVERY_SHIFT));
+                        encodeBigEndian<uint16_t>(header + 1, message.sequence);
+                        encodeBigEndian<uint16_t>(header + 3, static_cast<uint16_t>(messageSize));
+                        if (messageSize) std::memcpy(header + MESSAGE_HEADER_SIZE, message.data.data(), messageSize);
+
+                        message.sent = true;
+                        message.sendTime = now;
+                        sentPacket.reliableMessages.push_back(std::make_pair(reliableChannel, message.sequence));
+                    }
+
+                    if (reliableIndex < count) break; // packet is full
+                }
+
+                while (unreliableOffset < unreliableMessages.size())
+                {
+                    uint16_t messageSize = decodeBigEndian<uint16_t>(unreliableMessages.data() + unreliableOffset + 3);
+                    uint32_t encodedSize = MESSAGE_HEADER_SIZE + messageSize;
+                    if (packet.size() + encodedSize > MTU) break;
+
+                    packet.insert(packet.end(),
+                                  unreliableMessages.begin() + static_cast<std::ptrdiff_t>(unreliableOffset),
+                                  unreliableMessages.begin() + static_cast<std::ptrdiff_t>(unreliableOffset + encodedSize));
+                    unreliableOffset += encodedSize;
+                }
+
+                bool hasMessages = packet.size() > PACKET_HEADER_SIZE;
+                if (!hasMessages && !ackPending) break;
+
+                // packets with only acknowledgements are not acknowledged and do not count in the packet loss
+                sentPacket.sequence = localSequence;
+                sentPacket.used = hasMessages;
+                sentPacket.acknowledged = false;
+                sentPacket.sendTime = now;
+
+                try
+                {
+                    sendFunction(packet.data(), static_cast<uint32_t>(packet.size()));
+                    sentBytes += static_cast<uint32_t>(packet.size());
+                }
+                catch (const std::runtime_error&)
+                {
+                    // the send queue is full, the packet is treated as lost
+                }
+
+                ++localSequence;
+                ackPending = false;
+            }
+
+            unreliableMessages.clear();
+
+            updateBandwidth(now);
+        }
+
+        void Connection::updateBandwidth(Clock::time_point now)
+        {
+            float elapsed = std::chrono::duration<float>(now - bandwidthTime).count();
+            if (elapsed < 0.5F) return;
+
+            sentBandwidth = static_cast<float>(sentBytes) / elapsed;
+            receivedBandwidth = static_cast<float>(receivedBytes) / elapsed;
+            sentBytes = 0;
+            receivedBytes = 0;
+            bandwidthTime = now;
+        }
+    } // namespace network
+} // namespace ouzel
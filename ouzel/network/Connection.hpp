@@ -0,0 +1,152 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_NETWORK_CONNECTION_HPP
+#define OUZEL_NETWORK_CONNECTION_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <vector>
+
+namespace ouzel
+{
+    namespace network
+    {
+        class Network;
+
+        // Message channels to a remote address over a UDP endpoint of Network. Messages are coalesced into
+        // packets of at most MTU bytes and every packet acknowledges the last 33 packets received from the peer.
+        class Connection final
+        {
+        public:
+            static constexpr uint32_t MTU = 1200;
+            static constexpr uint32_t PACKET_HEADER_SIZE = 8;
+            static constexpr uint32_t MESSAGE_HEADER_SIZE = 5;
+            static constexpr uint32_t MAX_MESSAGE_SIZE = MTU - PACKET_HEADER_SIZE - MESSAGE_HEADER_SIZE;
+            static constexpr uint8_t CHANNEL_COUNT = 32;
+            // maximum number of unacknowledged reliable messages of a channel in flight
+            static constexpr uint16_t RELIABLE_WINDOW = 1024;
+
+            enum class Delivery: uint8_t
+            {
+                UNRELIABLE, // may be lost or arrive out of order
+                SEQUENCED, // may be lost, messages older than the last delivered one are dropped
+                RELIABLE // resent until acknowledged and delivered in order
+            };
+
+            Connection(Network& initNetwork, uintptr_t initEndpointId, uint32_t initAddress, uint16_t initPort);
+            // sends the packets with the given function instead of a Network endpoint (e.g. over a simulated link)
+            explicit Connection(const std::function<void(const uint8_t*, uint32_t)>& initSendFunction);
+
+            Connection(const Connection&) = delete;
+            Connection& operator=(const Connection&) = delete;
+
+            Connection(Connection&&) = delete;
+            Connection& operator=(Connection&&) = delete;
+
+            inline uintptr_t getEndpointId() const { return endpointId; }
+            inline uint32_t getAddress() const { return address; }
+            inline uint16_t getPort() const { return port; }
+
+            // only the sender has to set the delivery, it is sent with every message
+            Delivery getDelivery(uint8_t channel) const;
+            void setDelivery(uint8_t channel, Delivery delivery);
+
+            inline void setMessageCallback(const std::function<void(uint8_t, const uint8_t*, uint32_t)>& callback)
+            {
+                messageCallback = callback;
+            }
+
+            // queues the message until the next update
+            void send(uint8_t channel, const void* data, uint32_t size);
+
+            // processes a datagram received from the remote address and passes its messages to the message callback
+            void receive(const uint8_t* data, uint32_t size);
+
+            // sends the queued messages, resends the unacknowledged reliable ones and acknowledges received packets
+            void update();
+
+            // smoothed round trip time in seconds
+            inline float getRoundTripTime() const { return roundTripTime; }
+            // smoothed fraction of the sent packets that were not acknowledged
+            inline float getPacketLoss() const { return packetLoss; }
+            // bytes per second
+            inline float getSentBandwidth() const { return sentBandwidth; }
+            inline float getReceivedBandwidth() const { return receivedBandwidth; }
+
+        private:
+            using Clock = std::chrono::steady_clock;
+
+            struct ReliableMessage
+            {
+                uint16_t sequence;
+                bool acknowledged = false;
+                bool sent = false;
+                Clock::time_point sendTime;
+                std::vector<uint8_t> data;
+            };
+
+            struct Channel
+            {
+                Delivery delivery = Delivery::UNRELIABLE;
+                uint16_t sendSequence = 0;
+
+                // unacknowledged reliable messages ordered by sequence
+                std::deque<ReliableMessage> reliableMessages;
+
+                uint16_t nextReliableSequence = 0;
+                std::map<uint16_t, std::vector<uint8_t>> earlyMessages; // received out of order
+                uint16_t lastSequence = 0;
+                bool sequenceReceived = false;
+            };
+
+            struct SentPacket
+            {
+                uint16_t sequence = 0;
+                bool used = false;
+                bool acknowledged = false;
+                Clock::time_point sendTime;
+                std::vector<std::pair<uint8_t, uint16_t>> reliableMessages;
+            };
+
+            void acknowledge(uint16_t ack, uint32_t ackBits, Clock::time_point now);
+            void acknowledgeMessage(uint8_t channel, uint16_t sequence);
+            void deliver(uint8_t channelIndex, uint8_t deliveryValue, uint16_t sequence,
+                         const uint8_t* data, uint32_t size);
+            void updateBandwidth(Clock::time_point now);
+
+            std::function<void(const uint8_t*, uint32_t)> sendFunction;
+            uintptr_t endpointId = 0;
+            uint32_t address = 0;
+            uint16_t port = 0;
+
+            std::function<void(uint8_t, const uint8_t*, uint32_t)> messageCallback;
+
+            Channel channels[CHANNEL_COUNT];
+            std::vector<uint8_t> unreliableMessages; // encoded messages waiting for the next update
+            std::vector<SentPacket> sentPackets;
+            std::vector<uint8_t> packet;
+
+            // starts at 1, so that the acknowledgement of a peer that has not received anything refers to no packet
+            uint16_t localSequence = 1;
+            uint16_t lossSequence = 1; // next sent packet to account in the packet loss
+            uint16_t remoteSequence = 0;
+            uint32_t receivedBits = 0; // bit n is set if packet remoteSequence - 1 - n was received
+            bool remoteSequenceReceived = false;
+            bool ackPending = false;
+
+            float roundTripTime = 0.0F;
+            bool roundTripTimeMeasured = false;
+            float packetLoss = 0.0F;
+            float sentBandwidth = 0.0F;
+            float receivedBandwidth = 0.0F;
+            uint32_t sentBytes = 0;
+            uint32_t receivedBytes = 0;
+            Clock::time_point bandwidthTime;
+        };
+    } // namespace network
+} // namespace ouzel
+
+#endif // OUZEL_NETWORK_CONNECTION_HPP
@@ -1,5 +1,9 @@
 // Copyright 2015-2018 Elviss Strazdins. All rights reserved.
 
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <stdexcept>
 #include <system_error>
 #ifdef _WIN32
 #  define WIN32_LEAN_AND_MEAN
@@ -11,19 +15,125 @@
 #else
 #  include <sys/socket.h>
 #  include <netinet/in.h>
+#  include <netinet/tcp.h>
 #  include <errno.h>
 #  include <poll.h>
 #  include <netdb.h>
 #  include <unistd.h>
+#  if defined(__linux__)
+#    include <sys/epoll.h>
+#    include <sys/eventfd.h>
+#  endif
 #endif
 #include "Network.hpp"
-#include "Client.hpp"
+#include "core/Engine.hpp"
+#include "utils/Log.hpp"
+#include "utils/Utils.hpp"
+
+#ifndef MSG_NOSIGNAL
+#  define MSG_NOSIGNAL 0
+#endif
 
 namespace ouzel
 {
     namespace network
     {
-        Network::Network()
+        class Endpoint final
+        {
+        public:
+            enum class Type
+            {
+                LISTENER,
+                CONNECTION,
+                DATAGRAM
+            };
+
+            Endpoint(uintptr_t initId, Type initType, Socket::Descriptor descriptor,
+                     uint32_t initAddress, uint16_t initPort):
+                id(initId),
+                type(initType),
+                socket(descriptor),
+                address(initAddress),
+                port(initPort)
+            {
+            }
+
+            uintptr_t id;
+            Type type;
+            Socket socket;
+            uint32_t address; // peer address of a connection
+            uint16_t port;
+            bool connecting = false;
+            bool readable = false;
+            bool writable = false;
+
+            // buffers and sizes of the data that could not be sent yet
+            std::deque<std::pair<uint32_t, uint32_t>> pending;
+            uint32_t pendingOffset = 0;
+        };
+
+        static int getLastError()
+        {
+#ifdef _WIN32
+            return WSAGetLastError();
+#else
+            return errno;
+#endif
+        }
+
+        static bool isWouldBlock(int error)
+        {
+#ifdef _WIN32
+            return error == WSAEWOULDBLOCK;
+#else
+            return error == EAGAIN || error == EWOULDBLOCK || error == EINPROGRESS;
+#endif
+        }
+
+        static sockaddr_in makeAddress(uint32_t address, uint16_t port)
+        {
+            sockaddr_in result;
+            std::memset(&result, 0, sizeof(result));
+            result.sin_family = AF_INET;
+            result.sin_addr.s_addr = htonl(address);
+            result.sin_port = htons(port);
+            return result;
+        }
+
+        static void setStreamOptions(Socket::Descriptor descriptor)
+        {
+            int value = 1;
+            setsockopt(descriptor, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&value), sizeof(value));
+#ifdef SO_NOSIGPIPE
+            setsockopt(descriptor, SOL_SOCKET, SO_NOSIGPIPE, reinterpret_cast<const char*>(&value), sizeof(value));
+#endif
+        }
+
+        static void bindSocket(Socket& socket, uint32_t address, uint16_t port)
+        {
+            sockaddr_in socketAddress = makeAddress(address, port);
+            if (::bind(socket.getDescriptor(), reinterpret_cast<sockaddr*>(&socketAddress), sizeof(socketAddress)) != 0)
+                throw std::system_error(getLastError(), std::system_category(), "Failed to bind socket");
+        }
+
+        static uint16_t getLocalPort(const Socket& socket)
+        {
+            sockaddr_in socketAddress;
+            socklen_t length = sizeof(socketAddress);
+            if (getsockname(socket.getDescriptor(), reinterpret_cast<sockaddr*>(&socketAddress), &length) != 0)
+                throw std::system_error(getLastError(), std::system_category(), "Failed to get socket address");
+
+            return ntohs(socketAddress.sin_port);
+        }
+
+        // accepting and connecting stop while the queue is this full, so that disconnect events still fit
+        static constexpr size_t CONNECT_RESERVE = Network::BUFFER_COUNT * 2;
+
+        Network::Network():
+            freeReceiveBuffers(BUFFER_COUNT),
+            freeSendBuffers(BUFFER_COUNT),
+            outgoing(BUFFER_COUNT * 2),
+            incoming(BUFFER_COUNT * 4)
         {
 #ifdef _WIN32
             WORD sockVersion = MAKEWORD(2, 2);
@@ -41,21 +151,44 @@ namespace ouzel
 
         Network::~Network()
         {
-#ifdef _WIN32
-            if (endpoint != INVALID_SOCKET)
-                closesocket(endpoint);
+            if (thread.joinable())
+            {
+                running = false;
+                wakePending = false;
+                wake();
+                thread.join();
+            }
+
+            // close the sockets that the network thread did not pick up
+            Message message;
+            while (outgoing.pop(message))
+            {
+                if (message.type == Message::Type::OPEN_LISTENER ||
+                    message.type == Message::Type::OPEN_CONNECTION ||
+                    message.type == Message::Type::OPEN_DATAGRAM)
+                    Socket socket(message.socket);
+            }
+
+            endpoints.clear();
+
+#if defined(__linux__)
+            if (eventFd != -1) ::close(eventFd);
+            if (epollFd != -1) ::close(epollFd);
+#endif
 
+#ifdef _WIN32
             if (wsaStarted) WSACleanup();
-#else
-            if (endpoint != -1)
-                close(endpoint);
 #endif
         }
 
         uint32_t Network::getAddress(const std::string& address)
         {
+            addrinfo hints;
+            std::memset(&hints, 0, sizeof(hints));
+            hints.ai_family = AF_INET;
+
             addrinfo* info;
-            int ret = getaddrinfo(address.c_str(), nullptr, nullptr, &info);
+            int ret = getaddrinfo(address.c_str(), nullptr, &hints, &info);
 
             if (ret != 0)
                 throw std::system_error(errno, std::system_category(), "Failed to get address info of " + address);
@@ -68,16 +201,883 @@ namespace ouzel
             return result;
         }
 
-        void Network::listen(const std::string& address, uint16_t port)
+        uintptr_t Network::listen(const std::string& address, uint16_t port)
         {
+            Socket socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+
+#ifndef _WIN32
+            int value = 1;
+            setsockopt(socket.getDescriptor(), SOL_SOCKET, SO_REUSEADDR, &value, sizeof(value));
+#endif
+
+            bindSocket(socket, address.empty() ? ANY_ADDRESS : getAddress(address), port);
+
+            if (::listen(socket.getDescriptor(), SOMAXCONN) != 0)
+                throw std::system_error(getLastError(), std::system_category(), "Failed to listen on socket");
+
+            uint16_t localPort = getLocalPort(socket);
+            uintptr_t endpointId = open(Message::Type::OPEN_LISTENER, socket, ANY_ADDRESS, localPort);
+            ports[endpointId] = localPort;
+            return endpointId;
         }
 
-        void Network::connect(const std::string& address, uint16_t port)
+        uintptr_t Network::connect(const std::string& address, uint16_t port)
         {
+            uint32_t remoteAddress = getAddress(address);
+
+            Socket socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+            setStreamOptions(socket.getDescriptor());
+
+            sockaddr_in socketAddress = makeAddress(remoteAddress, port);
+            if (::connect(socket.getDescriptor(), reinterpret_cast<sockaddr*>(&socketAddress), sizeof(socketAddress)) != 0)
+            {
+                int error = getLastError();
+                if (!isWouldBlock(error))
+                    throw std::system_error(error, std::system_category(), "Failed to connect to " + address);
+            }
+
+            return open(Message::Type::OPEN_CONNECTION, socket, remoteAddress, port);
+        }
+
+        uintptr_t Network::bind(const std::string& address, uint16_t port)
+        {
+            Socket socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+            bindSocket(socket, address.empty() ? ANY_ADDRESS : getAddress(address), port);
+
+            uint16_t localPort = getLocalPort(socket);
+            uintptr_t endpointId = open(Message::Type::OPEN_DATAGRAM, socket, ANY_ADDRESS, localPort);
+            ports[endpointId] = localPort;
+            return endpointId;
+        }
+
+        uint16_t Network::getPort(uintptr_t endpointId) const
+        {
+            auto i = ports.find(endpointId);
+            if (i == ports.end())
+                throw std::runtime_error("Invalid endpoint");
+
+            return i->second;
+        }
+
+        void Network::send(uintptr_t connectionId, const void* data, uint32_t size)
+        {
+            uint32_t count = (size + BUFFER_SIZE - 1) / BUFFER_SIZE;
+
+            // the data must not be split if it does not fit
+            if (freeSendBuffers.size() < count || outgoing.capacity() - outgoing.size() < count)
+                throw std::runtime_error("Network send queue is full");
+
+            const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+            for (uint32_t offset = 0; offset < size; offset += BUFFER_SIZE)
+            {
+                Message message{};
+                message.type = Message::Type::SEND;
+                message.endpointId = connectionId;
+                message.size = std::min(BUFFER_SIZE, size - offset);
+                freeSendBuffers.pop(message.buffer);
+                std::memcpy(sendStorage.data() + message.buffer * BUFFER_SIZE, bytes + offset, message.size);
+                outgoing.push(message);
+            }
+
+            wake();
+        }
+
+        void Network::sendTo(uintptr_t endpointId, uint32_t address, uint16_t port, const void* data, uint32_t size)
+        {
+            if (size > BUFFER_SIZE)
+                throw std::runtime_error("Datagram is too large");
+
+            if (freeSendBuffers.size() < 1 || outgoing.capacity() - outgoing.size() < 1)
+                throw std::runtime_error("Network send queue is full");
+
+            Message message{};
+            message.type = Message::Type::SEND;
+            message.endpointId = endpointId;
+            message.address = address;
+            message.port = port;
+            message.size = size;
+            freeSendBuffers.pop(message.buffer);
+            std::memcpy(sendStorage.data() + message.buffer * BUFFER_SIZE, data, size);
+            outgoing.push(message);
+
+            wake();
+        }
+
+        void Network::close(uintptr_t endpointId)
+        {
+            ports.erase(endpointId);
+
+            if (!running) return;
+
+            Message message{};
+            message.type = Message::Type::CLOSE;
+            message.endpointId = endpointId;
+            post(message);
         }
 
         void Network::disconnect()
         {
+            ports.clear();
+
+            if (!running) return;
+
+            Message message{};
+            message.type = Message::Type::CLOSE_ALL;
+            post(message);
+        }
+
+        void Network::update()
+        {
+            Message message;
+            while (incoming.pop(message))
+            {
+                NetworkEvent event;
+                event.endpointId = message.endpointId;
+                event.listenerId = message.listenerId;
+                event.address = message.address;
+                event.port = message.port;
+
+                switch (message.type)
+                {
+                    case Message::Type::CONNECT:
+                        event.type = Event::Type::NETWORK_CONNECT;
+                        break;
+                    case Message::Type::DISCONNECT:
+                        event.type = Event::Type::NETWORK_DISCONNECT;
+                        ports.erase(message.endpointId);
+                        break;
+                    case Message::Type::RECEIVE:
+                        event.type = Event::Type::NETWORK_RECEIVE;
+                        event.data = receiveStorage.data() + message.buffer * BUFFER_SIZE;
+                        event.size = message.size;
+                        break;
+                    default:
+                        continue;
+                }
+
+                engine->getEventDispatcher().dispatchEvent(event);
+
+                if (message.type == Message::Type::RECEIVE)
+                    freeReceiveBuffers.push(message.buffer);
+            }
+        }
+
+        uintptr_t Network::open(Message::Type type, Socket& socket, uint32_t address, uint16_t port)
+        {
+            start();
+
+            Message message{};
+            message.type = type;
+            message.endpointId = ++lastEndpointId;
+            message.socket = socket.getDescriptor();
+            message.address = address;
+            message.port = port;
+            post(message);
+
+            // the network thread owns the socket now
+            socket.release();
+
+            return message.endpointId;
+        }
+
+        void Network::post(const Message& message)
+        {
+            if (!outgoing.push(message))
+                throw std::runtime_error("Network send queue is full");
+
+            wake();
+        }
+
+        void Network::start()
+        {
+            if (running) return;
+
+            if (receiveStorage.empty())
+            {
+                receiveStorage.resize(BUFFER_SIZE * BUFFER_COUNT);
+                sendStorage.resize(BUFFER_SIZE * BUFFER_COUNT);
+                spareReceiveBuffers.reserve(BUFFER_COUNT);
+                batch.reserve(BATCH_SIZE);
+
+                for (uint32_t buffer = 0; buffer < BUFFER_COUNT; ++buffer)
+                {
+                    freeReceiveBuffers.push(buffer);
+                    freeSendBuffers.push(buffer);
+                }
+            }
+
+#if defined(__linux__)
+            epollFd = epoll_create1(EPOLL_CLOEXEC);
+            if (epollFd == -1)
+                throw std::system_error(errno, std::system_category(), "Failed to create epoll instance");
+
+            eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if (eventFd == -1)
+                throw std::system_error(errno, std::system_category(), "Failed to create event descriptor");
+
+            epoll_event event;
+            event.events = EPOLLIN;
+            event.data.u64 = 0;
+            if (epoll_ctl(epollFd, EPOLL_CTL_ADD, eventFd, &event) == -1)
+                throw std::system_error(errno, std::system_category(), "Failed to add event descriptor to epoll");
+#else
+            // a datagram to a loopback socket wakes up the poll
+            wakeSocket = Socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+            bindSocket(wakeSocket, INADDR_LOOPBACK, ANY_PORT);
+            wakePort = getLocalPort(wakeSocket);
+#endif
+
+            running = true;
+            thread = std::thread(&Network::main, this);
+        }
+
+        void Network::wake()
+        {
+            if (wakePending.exchange(true, std::memory_order_acq_rel)) return;
+
+#if defined(__linux__)
+            uint64_t value = 1;
+            if (write(eventFd, &value, sizeof(value)) == -1 && errno != EAGAIN)
+                throw std::system_error(errno, std::system_category(), "Failed to wake the network thread");
+#else
+            char value = 0;
+            sockaddr_in socketAddress = makeAddress(INADDR_LOOPBACK, wakePort);
+            sendto(wakeSocket.getDescriptor(), &value, 1, 0, reinterpret_cast<sockaddr*>(&socketAddress), sizeof(socketAddress));
+#endif
+        }
+
+        void Network::main()
+        {
+            setCurrentThreadName("Network");
+
+            try
+            {
+                bool blocked = false;
+
+#if defined(__linux__)
+                epoll_event events[64];
+#else
+                std::vector<pollfd> pollDescriptors;
+                std::vector<uintptr_t> pollEndpoints;
+#endif
+
+                while (running)
+                {
+#if defined(__linux__)
+                    int count = epoll_wait(epollFd, events, 64, blocked ? 1 : -1);
+
+                    if (count == -1)
+                    {
+                        if (errno == EINTR) continue;
+                        throw std::system_error(errno, std::system_category(), "Failed to wait for network events");
+                    }
+
+                    for (int i = 0; i < count; ++i)
+                    {
+                        if (events[i].data.u64 == 0)
+                        {
+                            uint64_t value;
+                            while (read(eventFd, &value, sizeof(value)) > 0);
+                            continue;
+                        }
+
+                        auto endpointIterator = endpoints.find(static_cast<uintptr_t>(events[i].data.u64));
+                        if (endpointIterator == endpoints.end()) continue;
+
+                        Endpoint& endpoint = *endpointIterator->second;
+                        if (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) endpoint.readable = true;
+                        if (events[i].events & (EPOLLOUT | EPOLLERR | EPOLLHUP)) endpoint.writable = true;
+                    }
+#else
+                    pollDescriptors.clear();
+                    pollEndpoints.clear();
+
+                    pollfd wakeDescriptor;
+                    wakeDescriptor.fd = wakeSocket.getDescriptor();
+                    wakeDescriptor.events = POLLIN;
+                    wakeDescriptor.revents = 0;
+                    pollDescriptors.push_back(wakeDescriptor);
+                    pollEndpoints.push_back(0);
+
+                    for (const auto& endpointPair : endpoints)
+                    {
+                        const Endpoint& endpoint = *endpointPair.second;
+
+                        pollfd descriptor;
+                        descriptor.fd = endpoint.socket.getDescriptor();
+                        descriptor.events = 0;
+                        descriptor.revents = 0;
+                        if (!blocked) descriptor.events |= POLLIN;
+                        if (endpoint.connecting || !endpoint.pending.empty()) descriptor.events |= POLLOUT;
+                        pollDescriptors.push_back(descriptor);
+                        pollEndpoints.push_back(endpointPair.first);
+                    }
+
+#  ifdef _WIN32
+                    int count = WSAPoll(pollDescriptors.data(), static_cast<ULONG>(pollDescriptors.size()), blocked ? 1 : -1);
+#  else
+                    int count = poll(pollDescriptors.data(), static_cast<nfds_t>(pollDescriptors.size()), blocked ? 1 : -1);
+#  endif
+
+                    if (count < 0)
+                    {
+                        int error = getLastError();
+#  ifndef _WIN32
+                        if (error == EINTR) continue;
+#  endif
+                        throw std::system_error(error, std::system_category(), "Failed to wait for network events");
+                    }
+
+                    for (size_t i = 0; i < pollDescriptors.size(); ++i)
+                    {
+                        short revents = pollDescriptors[i].revents;
+                        if (!revents) continue;
+
+                        if (pollEndpoints[i] == 0)
+                        {
+                            char value[16];
+                            while (recv(wakeSocket.getDescriptor(), value, sizeof(value), 0) > 0);
+                            continue;
+                        }
+
+                        auto endpointIterator = endpoints.find(pollEndpoints[i]);
+                        if (endpointIterator == endpoints.end()) continue;
+
+                        Endpoint& endpoint = *endpointIterator->second;
+                        if (revents & (POLLIN | POLLERR | POLLHUP)) endpoint.readable = true;
+                        if (revents & (POLLOUT | POLLERR | POLLHUP)) endpoint.writable = true;
+                    }
+#endif
+
+                    wakePending.exchange(false, std::memory_order_acq_rel);
+
+                    processOutgoing();
+                    blocked = processIncoming();
+                }
+            }
+            catch (const std::exception& e)
+            {
+                engine->log(Log::Level::ERR) << e.what();
+            }
+        }
+
+        void Network::processOutgoing()
+        {
+            Message message;
+            while (outgoing.pop(message))
+            {
+                switch (message.type)
+                {
+                    case Message::Type::OPEN_LISTENER:
+                    case Message::Type::OPEN_CONNECTION:
+                    case Message::Type::OPEN_DATAGRAM:
+                    {
+                        Endpoint::Type type = message.type == Message::Type::OPEN_LISTENER ? Endpoint::Type::LISTENER :
+                            message.type == Message::Type::OPEN_CONNECTION ? Endpoint::Type::CONNECTION : Endpoint::Type::DATAGRAM;
+
+                        std::unique_ptr<Endpoint> endpoint(new Endpoint(message.endpointId, type, message.socket,
+                                                                        message.address, message.port));
+                        endpoint->connecting = (type == Endpoint::Type::CONNECTION);
+
+#if defined(__linux__)
+                        // edge triggered, so every socket is read until it would block
+                        epoll_event event;
+                        event.events = EPOLLIN | EPOLLOUT | EPOLLET;
+                        event.data.u64 = message.endpointId;
+                        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, message.socket, &event) == -1)
+                            throw std::system_error(errno, std::system_category(), "Failed to add socket to epoll");
+#endif
+
+                        endpoints[message.endpointId] = std::move(endpoint);
+                        break;
+                    }
+                    case Message::Type::SEND:
+                    {
+                        auto i = endpoints.find(message.endpointId);
+                        if (i == endpoints.end())
+                        {
+                            releaseSendBuffer(message.buffer);
+                            break;
+                        }
+
+                        Endpoint& endpoint = *i->second;
+
+                        if (endpoint.type == Endpoint::Type::DATAGRAM)
+                        {
+                            if (batchEndpoint != &endpoint || batch.size() == BATCH_SIZE) flushDatagrams();
+                            batchEndpoint = &endpoint;
+                            batch.push_back(message);
+                        }
+                        else if (endpoint.type == Endpoint::Type::CONNECTION)
+                            endpoint.pending.push_back(std::make_pair(message.buffer, message.size));
+                        else
+                            releaseSendBuffer(message.buffer);
+                        break;
+                    }
+                    case Message::Type::CLOSE:
+                        closeEndpoint(message.endpointId, false);
+                        break;
+                    case Message::Type::CLOSE_ALL:
+                        while (!endpoints.empty())
+                            closeEndpoint(endpoints.begin()->first, false);
+                        break;
+                    default:
+                        break;
+                }
+            }
+
+            flushDatagrams();
+
+            for (auto i = endpoints.begin(); i != endpoints.end();)
+            {
+                // flushing can close the connection
+                Endpoint& endpoint = *i->second;
+                ++i;
+
+                if (endpoint.type == Endpoint::Type::CONNECTION && !endpoint.connecting &&
+                    endpoint.writable && !endpoint.pending.empty())
+                    flushConnection(endpoint);
+            }
+        }
+
+        bool Network::processIncoming()
+        {
+            bool blocked = false;
+
+            for (auto i = endpoints.begin(); i != endpoints.end();)
+            {
+                // receiving can close the endpoint or accept new ones
+                Endpoint& endpoint = *i->second;
+                ++i;
+
+                if (endpoint.connecting)
+                {
+                    if (!endpoint.writable) continue;
+
+                    if (incoming.capacity() - incoming.size() <= CONNECT_RESERVE)
+                    {
+                        blocked = true;
+                        continue;
+                    }
+
+                    int error = 0;
+                    socklen_t length = sizeof(error);
+                    if (getsockopt(endpoint.socket.getDescriptor(), SOL_SOCKET, SO_ERROR,
+                                   reinterpret_cast<char*>(&error), &length) != 0)
+                        error = getLastError();
+
+                    if (error)
+                    {
+                        closeEndpoint(endpoint.id, true);
+                        continue;
+                    }
+
+                    endpoint.connecting = false;
+
+                    Message message{};
+                    message.type = Message::Type::CONNECT;
+                    message.endpointId = endpoint.id;
+                    message.address = endpoint.address;
+                    message.port = endpoint.port;
+                    incoming.push(message);
+
+                    // the data sent while connecting
+                    if (!endpoint.pending.empty())
+                    {
+                        uintptr_t endpointId = endpoint.id;
+                        flushConnection(endpoint);
+                        if (endpoints.find(endpointId) == endpoints.end()) continue;
+                    }
+                }
+
+                if (!endpoint.readable) continue;
+
+                switch (endpoint.type)
+                {
+                    case Endpoint::Type::LISTENER:
+                        receiveConnections(endpoint);
+                        break;
+                    case Endpoint::Type::DATAGRAM:
+                        receiveDatagrams(endpoint);
+                        break;
+                    case Endpoint::Type::CONNECTION:
+                        receiveStream(endpoint);
+                        break;
+                }
+            }
+
+            // endpoints that are still readable ran out of buffers or queue space
+            for (const auto& endpointPair : endpoints)
+                if (endpointPair.second->readable && !endpointPair.second->connecting)
+                    blocked = true;
+
+            return blocked;
+        }
+
+        bool Network::acquireReceiveBuffer(uint32_t& buffer)
+        {
+            if (!spareReceiveBuffers.empty())
+            {
+                buffer = spareReceiveBuffers.back();
+                spareReceiveBuffers.pop_back();
+                return true;
+            }
+
+            return freeReceiveBuffers.pop(buffer);
+        }
+
+        void Network::releaseSendBuffer(uint32_t buffer)
+        {
+            freeSendBuffers.push(buffer);
+        }
+
+        void Network::flushDatagrams()
+        {
+            if (!batch.empty())
+            {
+                Socket::Descriptor descriptor = batchEndpoint->socket.getDescriptor();
+
+#if defined(__linux__)
+                mmsghdr messages[BATCH_SIZE];
+                iovec vectors[BATCH_SIZE];
+                sockaddr_in addresses[BATCH_SIZE];
+
+                for (size_t i = 0; i < batch.size(); ++i)
+                {
+                    addresses[i] = makeAddress(batch[i].address, batch[i].port);
+                    vectors[i].iov_base = sendStorage.data() + batch[i].buffer * BUFFER_SIZE;
+                    vectors[i].iov_len = batch[i].size;
+                    std::memset(&messages[i], 0, sizeof(messages[i]));
+                    messages[i].msg_hdr.msg_name = &addresses[i];
+                    messages[i].msg_hdr.msg_namelen = sizeof(addresses[i]);
+                    messages[i].msg_hdr.msg_iov = &vectors[i];
+                    messages[i].msg_hdr.msg_iovlen = 1;
+                }
+
+                // datagrams that do not fit in the socket buffer are dropped
+                unsigned int sent = 0;
+                while (sent < batch.size())
+                {
+                    int result = sendmmsg(descriptor, messages + sent, static_cast<unsigned int>(batch.size()) - sent, 0);
+                    if (result <= 0)
+                    {
+                        if (result == -1 && errno == EINTR) continue;
+                        break;
+                    }
+                    sent += static_cast<unsigned int>(result);
+                }
+#else
+                for (const Message& message : batch)
+                {
+                    sockaddr_in socketAddress = makeAddress(message.address, message.port);
+                    sendto(descriptor, reinterpret_cast<const char*>(sendStorage.data() + message.buffer * BUFFER_SIZE),
+                           static_cast<int>(message.size), 0,
+                           reinterpret_cast<sockaddr*>(&socketAddress), sizeof(socketAddress));
+                }
+#endif
+
+                for (const Message& message : batch)
+                    releaseSendBuffer(message.buffer);
+
+                batch.clear();
+            }
+
+            batchEndpoint = nullptr;
+        }
+
+        void Network::flushConnection(Endpoint& endpoint)
+        {
+            while (!endpoint.pending.empty())
+            {
+                const std::pair<uint32_t, uint32_t>& front = endpoint.pending.front();
+                const uint8_t* data = sendStorage.data() + front.first * BUFFER_SIZE + endpoint.pendingOffset;
+                uint32_t size = front.second - endpoint.pendingOffset;
+
+                auto result = ::send(endpoint.socket.getDescriptor(), reinterpret_cast<const char*>(data),
+                                     static_cast<int>(size), MSG_NOSIGNAL);
+
+                if (result < 0)
+                {
+                    int error = getLastError();
+#ifndef _WIN32
+                    if (error == EINTR) continue;
+#endif
+                    if (isWouldBlock(error))
+                        endpoint.writable = false;
+                    else
+                        closeEndpoint(endpoint.id, true);
+                    return;
+                }
+
+                endpoint.pendingOffset += static_cast<uint32_t>(result);
+
+                if (endpoint.pendingOffset == front.second)
+                {
+                    releaseSendBuffer(front.first);
+                    endpoint.pending.pop_front();
+                    endpoint.pendingOffset = 0;
+                }
+            }
+        }
+
+        void Network::receiveConnections(Endpoint& endpoint)
+        {
+            for (;;)
+            {
+                if (incoming.capacity() - incoming.size() <= CONNECT_RESERVE) return;
+
+                sockaddr_in socketAddress;
+                socklen_t length = sizeof(socketAddress);
+
+#if defined(__linux__)
+                Socket::Descriptor descriptor = accept4(endpoint.socket.getDescriptor(),
+                                                        reinterpret_cast<sockaddr*>(&socketAddress), &length,
+                                                        SOCK_NONBLOCK | SOCK_CLOEXEC);
+#else
+                Socket::Descriptor descriptor = accept(endpoint.socket.getDescriptor(),
+                                                       reinterpret_cast<sockaddr*>(&socketAddress), &length);
+#endif
+
+                if (descriptor == Socket::INVALID_DESCRIPTOR)
+                {
+                    int error = getLastError();
+#ifndef _WIN32
+                    if (error == EINTR || error == ECONNABORTED) continue;
+#endif
+                    if (!isWouldBlock(error))
+                        engine->log(Log::Level::WARN) << "Failed to accept connection, error: " << error;
+
+                    endpoint.readable = false;
+                    return;
+                }
+
+                Socket socket(descriptor);
+
+#if !defined(__linux__)
+                try
+                {
+                    Socket::setBlocking(descriptor, false);
+                }
+                catch (const std::exception& e)
+                {
+                    engine->log(Log::Level::WARN) << e.what();
+                    continue;
+                }
+#endif
+                setStreamOptions(descriptor);
+
+                uintptr_t endpointId = ++lastEndpointId;
+                uint32_t address = ntohl(socketAddress.sin_addr.s_addr);
+                uint16_t port = ntohs(socketAddress.sin_port);
+
+#if defined(__linux__)
+                epoll_event event;
+                event.events = EPOLLIN | EPOLLOUT | EPOLLET;
+                event.data.u64 = endpointId;
+                if (epoll_ctl(epollFd, EPOLL_CTL_ADD, descriptor, &event) == -1)
+                {
+                    engine->log(Log::Level::WARN) << "Failed to add socket to epoll, error: " << errno;
+                    continue;
+                }
+#endif
+
+                endpoints[endpointId].reset(new Endpoint(endpointId, Endpoint::Type::CONNECTION,
+                                                         socket.release(), address, port));
+
+                Message message{};
+                message.type = Message::Type::CONNECT;
+                message.endpointId = endpointId;
+                message.listenerId = endpoint.id;
+                message.address = address;
+                message.port = port;
+                incoming.push(message);
+            }
+        }
+
+        void Network::receiveDatagrams(Endpoint& endpoint)
+        {
+            Socket::Descriptor descriptor = endpoint.socket.getDescriptor();
+
+            for (;;)
+            {
+                uint32_t buffers[BATCH_SIZE];
+                uint32_t count = 0;
+
+                size_t space = incoming.capacity() - incoming.size();
+                while (count < BATCH_SIZE && count < space && acquireReceiveBuffer(buffers[count]))
+                    ++count;
+
+                if (count == 0) return;
+
+#if defined(__linux__)
+                mmsghdr messages[BATCH_SIZE];
+                iovec vectors[BATCH_SIZE];
+                sockaddr_in addresses[BATCH_SIZE];
+
+                for (uint32_t i = 0; i < count; ++i)
+                {
+                    vectors[i].iov_base = receiveStorage.data() + buffers[i] * BUFFER_SIZE;
+                    vectors[i].iov_len = BUFFER_SIZE;
+                    std::memset(&messages[i], 0, sizeof(messages[i]));
+                    messages[i].msg_hdr.msg_name = &addresses[i];
+                    messages[i].msg_hdr.msg_namelen = sizeof(addresses[i]);
+                    messages[i].msg_hdr.msg_iov = &vectors[i];
+                    messages[i].msg_hdr.msg_iovlen = 1;
+                }
+
+                int result = recvmmsg(descriptor, messages, count, MSG_DONTWAIT, nullptr);
+
+                if (result < 0)
+                {
+                    int error = errno;
+                    for (uint32_t i = 0; i < count; ++i)
+                        spareReceiveBuffers.push_back(buffers[i]);
+
+                    // errors like ECONNREFUSED only report an earlier send
+                    if (error == EINTR || error == ECONNREFUSED) continue;
+
+                    endpoint.readable = false;
+                    return;
+                }
+
+                uint32_t received = static_cast<uint32_t>(result);
+
+                for (uint32_t i = 0; i < count; ++i)
+                {
+                    if (i >= received || (messages[i].msg_hdr.msg_flags & MSG_TRUNC))
+                    {
+                        spareReceiveBuffers.push_back(buffers[i]);
+                        continue;
+                    }
+
+                    Message message{};
+                    message.type = Message::Type::RECEIVE;
+                    message.endpointId = endpoint.id;
+                    message.address = ntohl(addresses[i].sin_addr.s_addr);
+                    message.port = ntohs(addresses[i].sin_port);
+                    message.buffer = buffers[i];
+                    message.size = messages[i].msg_len;
+                    incoming.push(message);
+                }
+
+                // a short batch means that the socket has no more datagrams
+                if (received < count)
+                {
+                    endpoint.readable = false;
+                    return;
+                }
+#else
+                for (uint32_t i = 0; i < count; ++i)
+                {
+                    sockaddr_in socketAddress;
+                    socklen_t length = sizeof(socketAddress);
+
+                    auto result = recvfrom(descriptor, reinterpret_cast<char*>(receiveStorage.data() + buffers[i] * BUFFER_SIZE),
+                                           static_cast<int>(BUFFER_SIZE), 0,
+                                           reinterpret_cast<sockaddr*>(&socketAddress), &length);
+
+                    if (result < 0)
+                    {
+                        int error = getLastError();
+                        for (uint32_t j = i; j < count; ++j)
+                            spareReceiveBuffers.push_back(buffers[j]);
+
+                        if (isWouldBlock(error))
+                        {
+                            endpoint.readable = false;
+                            return;
+                        }
+
+                        // a truncated datagram or a report of an earlier send
+                        break;
+                    }
+
+                    Message message{};
+                    message.type = Message::Type::RECEIVE;
+                    message.endpointId = endpoint.id;
+                    message.address = ntohl(socketAddress.sin_addr.s_addr);
+                    message.port = ntohs(socketAddress.sin_port);
+                    message.buffer = buffers[i];
+                    message.size = static_cast<uint32_t>(result);
+                    incoming.push(message);
+                }
+#endif
+            }
+        }
+
+        void Network::receiveStream(Endpoint& endpoint)
+        {
+            for (;;)
+            {
+                if (incoming.capacity() - incoming.size() == 0) return;
+
+                uint32_t buffer;
+                if (!acquireReceiveBuffer(buffer)) return;
+
+                auto result = recv(endpoint.socket.getDescriptor(),
+                                   reinterpret_cast<char*>(receiveStorage.data() + buffer * BUFFER_SIZE),
+                                   static_cast<int>(BUFFER_SIZE), 0);
+
+                if (result > 0)
+                {
+                    Message message{};
+                    message.type = Message::Type::RECEIVE;
+                    message.endpointId = endpoint.id;
+                    message.address = endpoint.address;
+                    message.port = endpoint.port;
+                    message.buffer = buffer;
+                    message.size = static_cast<uint32_t>(result);
+                    incoming.push(message);
+                    continue;
+                }
+
+                spareReceiveBuffers.push_back(buffer);
+
+                if (result < 0)
+                {
+                    int error = getLastError();
+#ifndef _WIN32
+                    if (error == EINTR) continue;
+#endif
+                    if (isWouldBlock(error))
+                    {
+                        endpoint.readable = false;
+                        return;
+                    }
+                }
+
+                // closed by the peer or failed
+                closeEndpoint(endpoint.id, true);
+                return;
+            }
+        }
+
+        void Network::closeEndpoint(uintptr_t endpointId, bool notify)
+        {
+            auto i = endpoints.find(endpointId);
+            if (i == endpoints.end()) return;
+
+            Endpoint& endpoint = *i->second;
+
+            if (batchEndpoint == &endpoint) flushDatagrams();
+
+            for (const std::pair<uint32_t, uint32_t>& pending : endpoint.pending)
+                releaseSendBuffer(pending.first);
+
+            if (notify)
+            {
+                Message message{};
+                message.type = Message::Type::DISCONNECT;
+                message.endpointId = endpointId;
+                message.address = endpoint.address;
+                message.port = endpoint.port;
+                if (!incoming.push(message))
+                    engine->log(Log::Level::WARN) << "Network event queue is full, disconnect event dropped";
+            }
+
+            // closing the socket also removes it from epoll
+            endpoints.erase(i);
         }
     } // namespace network
 } // namespace ouzel
@@ -11,23 +11,37 @@
 #  undef NOMINMAX
 #endif
 
+#include <atomic>
 #include <cstdint>
+#include <map>
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
+#include "network/Socket.hpp"
+#include "utils/SpscQueue.hpp"
 
 namespace ouzel
 {
     namespace network
     {
-        class Client;
+        class Endpoint;
 
         constexpr uint32_t ANY_ADDRESS = 0;
         constexpr uint16_t ANY_PORT = 0;
 
+        // Sockets are serviced by a network thread (epoll on Linux, poll elsewhere). Received data is
+        // delivered in pooled buffers and dispatched as NetworkEvents from update() on the game thread.
         class Network final
         {
         public:
+            // larger datagrams are dropped, TCP data is delivered in chunks of at most this size
+            static constexpr uint32_t BUFFER_SIZE = 2048;
+            // number of pooled buffers for each direction
+            static constexpr uint32_t BUFFER_COUNT = 256;
+            // maximum number of datagrams passed to a single sendmmsg or recvmmsg call
+            static constexpr uint32_t BATCH_SIZE = 32;
+
             Network();
             ~Network();
 
@@ -39,19 +53,107 @@ namespace ouzel
 
             static uint32_t getAddress(const std::string& address);
 
-            void listen(const std::string& address, uint16_t port);
-            void connect(const std::string& address, uint16_t port);
+            // creates a TCP listener, accepted connections are reported with NETWORK_CONNECT events
+            uintptr_t listen(const std::string& address, uint16_t port);
+            // starts a TCP connection, NETWORK_CONNECT or NETWORK_DISCONNECT is sent when it completes
+            uintptr_t connect(const std::string& address, uint16_t port);
+            // creates a UDP endpoint
+            uintptr_t bind(const std::string& address, uint16_t port);
+
+            // local port of a listener or UDP endpoint
+            uint16_t getPort(uintptr_t endpointId) const;
+
+            // sends data over a TCP connection
+            void send(uintptr_t connectionId, const void* data, uint32_t size);
+            // sends a datagram from a UDP endpoint
+            void sendTo(uintptr_t endpointId, uint32_t address, uint16_t port, const void* data, uint32_t size);
+
+            void close(uintptr_t endpointId);
+            // closes all endpoints
             void disconnect();
 
+            // dispatches the connection and receive events, must be called on the game thread
+            void update();
+
         private:
+            struct Message
+            {
+                enum class Type: uint8_t
+                {
+                    // game thread to network thread
+                    OPEN_LISTENER,
+                    OPEN_CONNECTION,
+                    OPEN_DATAGRAM,
+                    SEND,
+                    CLOSE,
+                    CLOSE_ALL,
+
+                    // network thread to game thread
+                    CONNECT,
+                    DISCONNECT,
+                    RECEIVE
+                };
+
+                Type type;
+                uintptr_t endpointId;
+                uintptr_t listenerId;
+                Socket::Descriptor socket;
+                uint32_t address;
+                uint16_t port;
+                uint32_t buffer;
+                uint32_t size;
+            };
+
+            uintptr_t open(Message::Type type, Socket& socket, uint32_t address, uint16_t port);
+            void post(const Message& message);
+            void start();
+            void wake();
+
+            // network thread
+            void main();
+            void processOutgoing();
+            bool processIncoming();
+            bool acquireReceiveBuffer(uint32_t& buffer);
+            void releaseSendBuffer(uint32_t buffer);
+            void flushDatagrams();
+            void flushConnection(Endpoint& endpoint);
+            void receiveConnections(Endpoint& endpoint);
+            void receiveDatagrams(Endpoint& endpoint);
+            void receiveStream(Endpoint& endpoint);
+            void closeEndpoint(uintptr_t endpointId, bool notify);
+
 #ifdef _WIN32
             bool wsaStarted = false;
-            SOCKET endpoint = INVALID_SOCKET;
+#endif
+
+            std::vector<uint8_t> receiveStorage;
+            std::vector<uint8_t> sendStorage;
+            SpscQueue<uint32_t> freeReceiveBuffers; // returned by the game thread
+            SpscQueue<uint32_t> freeSendBuffers; // returned by the network thread
+            SpscQueue<Message> outgoing;
+            SpscQueue<Message> incoming;
+            std::atomic<uintptr_t> lastEndpointId{0};
+            std::atomic<bool> running{false};
+            std::atomic<bool> wakePending{false};
+
+            // game thread
+            std::map<uintptr_t, uint16_t> ports;
+
+            // network thread
+            std::map<uintptr_t, std::unique_ptr<Endpoint>> endpoints;
+            std::vector<uint32_t> spareReceiveBuffers;
+            Endpoint* batchEndpoint = nullptr;
+            std::vector<Message> batch;
+
+#if defined(__linux__)
+            int epollFd = -1;
+            int eventFd = -1;
 #else
-            int endpoint = -1;
+            Socket wakeSocket;
+            uint16_t wakePort = 0;
 #endif
 
-            std::vector<std::unique_ptr<Client>> clients;
+            std::thread thread;
         };
     } // namespace network
 } // namespace ouzel
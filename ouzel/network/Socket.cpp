@@ -1,5 +1,6 @@
 // Copyright 2015-2018 Elviss Strazdins. All rights reserved.
 
+#include <system_error>
 #ifdef _WIN32
 #  define WIN32_LEAN_AND_MEAN
 #  define NOMINMAX
@@ -11,6 +12,7 @@
 #  include <sys/socket.h>
 #  include <netinet/in.h>
 #  include <errno.h>
+#  include <fcntl.h>
 #  include <unistd.h>
 #endif
 #include "Socket.hpp"
@@ -19,50 +21,102 @@ namespace ouzel
 {
     namespace network
     {
+        static int getLastError()
+        {
+#ifdef _WIN32
+            return WSAGetLastError();
+#else
+            return errno;
+#endif
+        }
+
         Socket::Socket()
         {
         }
 
-        Socket::~Socket()
+        Socket::Socket(Descriptor initEndpoint):
+            endpoint(initEndpoint)
         {
-#ifdef _WIN32
-            if (endpoint != INVALID_SOCKET) closesocket(endpoint);
-#else
-            if (endpoint != -1) close(endpoint);
-#endif
         }
 
-        Socket::Socket(Socket&& other)
+        Socket::Socket(int domain, int type, int protocol)
         {
-            endpoint = other.endpoint;
+            endpoint = socket(domain, type, protocol);
 
-#ifdef _WIN32
-            other.endpoint = INVALID_SOCKET;
-#else
-            other.endpoint = -1;
-#endif
+            if (endpoint == INVALID_DESCRIPTOR)
+                throw std::system_error(getLastError(), std::system_category(), "Failed to create socket");
+
+            try
+            {
+                setBlocking(endpoint, false);
+            }
+            catch (...)
+            {
+                close();
+                throw;
+            }
+        }
+
+        Socket::~Socket()
+        {
+            close();
+        }
+
+        Socket::Socket(Socket&& other):
+            endpoint(other.endpoint)
+        {
+            other.endpoint = INVALID_DESCRIPTOR;
         }
 
         Socket& Socket::operator=(Socket&& other)
         {
             if (&other != this)
             {
-#ifdef _WIN32
-                if (endpoint != INVALID_SOCKET) closesocket(endpoint);
-#else
-                if (endpoint != -1) close(endpoint);
-#endif
+                close();
 
                 endpoint = other.endpoint;
+                other.endpoint = INVALID_DESCRIPTOR;
+            }
+
+            return *this;
+        }
+
+        Socket::Descriptor Socket::release()
+        {
+            Descriptor result = endpoint;
+            endpoint = INVALID_DESCRIPTOR;
+            return result;
+        }
 
+        void Socket::close()
+        {
+            if (endpoint != INVALID_DESCRIPTOR)
+            {
 #ifdef _WIN32
-                other.endpoint = INVALID_SOCKET;
+                closesocket(endpoint);
 #else
-                other.endpoint = -1;
+                ::close(endpoint);
 #endif
+                endpoint = INVALID_DESCRIPTOR;
             }
+        }
 
-            return *this;
+        void Socket::setBlocking(Descriptor descriptor, bool blocking)
+        {
+#ifdef _WIN32
+            u_long mode = blocking ? 0 : 1;
+            if (ioctlsocket(descriptor, FIONBIO, &mode) != 0)
+                throw std::system_error(WSAGetLastError(), std::system_category(), "Failed to set socket mode");
+#else
+            int flags = fcntl(descriptor, F_GETFL, 0);
+            if (flags == -1)
+                throw std::system_error(errno, std::system_category(), "Failed to get socket flags");
+
+            flags = blocking ? (flags & ~O_NONBLOCK) : (flags | O_NONBLOCK);
+
+            if (fcntl(descriptor, F_SETFL, flags) == -1)
+                throw std::system_error(errno, std::system_category(), "Failed to set socket flags");
+#endif
         }
     } // namespace network
 } // namespace ouzel
@@ -18,7 +18,18 @@ namespace ouzel
         class Socket final
         {
         public:
+#ifdef _WIN32
+            using Descriptor = SOCKET;
+            static constexpr Descriptor INVALID_DESCRIPTOR = INVALID_SOCKET;
+#else
+            using Descriptor = int;
+            static constexpr Descriptor INVALID_DESCRIPTOR = -1;
+#endif
+
             Socket();
+            explicit Socket(Descriptor initEndpoint);
+            // creates a non-blocking socket
+            Socket(int domain, int type, int protocol);
             ~Socket();
 
             Socket(const Socket&) = delete;
@@ -27,12 +38,16 @@ namespace ouzel
             Socket(Socket&& other);
             Socket& operator=(Socket&& other);
 
+            inline Descriptor getDescriptor() const { return endpoint; }
+
+            // gives up the ownership of the descriptor
+            Descriptor release();
+            void close();
+
+            static void setBlocking(Descriptor descriptor, bool blocking);
+
         private:
-#ifdef _WIN32
-            SOCKET endpoint = INVALID_SOCKET;
-#else
-            int endpoint = -1;
-#endif
+            Descriptor endpoint = INVALID_DESCRIPTOR;
         };
     } // namespace network
 } // namespace ouzel
@@ -30,13 +30,17 @@
 #include "audio/Audio.hpp"
 #include "audio/Channel.hpp"
 #include "audio/Containers.hpp"
+#include "audio/Convolver.hpp"
 #include "audio/Driver.hpp"
+#include "audio/FFT.hpp"
 #include "audio/Filter.hpp"
 #include "audio/Filters.hpp"
+#include "audio/Hrtf.hpp"
 #include "audio/Listener.hpp"
 #include "audio/Mix.hpp"
 #include "audio/OscillatorSound.hpp"
 #include "audio/PCMSound.hpp"
+#include "audio/PitchShifter.hpp"
 #include "audio/SampleFormat.hpp"
 #include "audio/SilenceSound.hpp"
 #include "audio/Sound.hpp"
@@ -53,6 +57,7 @@
 #include "files/Archive.hpp"
 #include "files/File.hpp"
 #include "files/FileSystem.hpp"
+#include "files/MappedFile.hpp"
 #include "graphics/BlendState.hpp"
 #include "graphics/Buffer.hpp"
 #include "graphics/DataType.hpp"
@@ -60,6 +65,7 @@
 #include "graphics/DrawMode.hpp"
 #include "graphics/Driver.hpp"
 #include "graphics/ImageData.hpp"
+#include "graphics/Instance.hpp"
 #include "graphics/Material.hpp"
 #include "graphics/PixelFormat.hpp"
 #include "graphics/RasterizerState.hpp"
@@ -69,6 +75,7 @@
 #include "graphics/Shader.hpp"
 #include "graphics/Texture.hpp"
 #include "graphics/Vertex.hpp"
+#include "graphics/VertexLayout.hpp"
 #include "gui/BMFont.hpp"
 #include "gui/Button.hpp"
 #include "gui/CheckBox.hpp"
@@ -90,10 +97,12 @@
 #include "input/Mouse.hpp"
 #include "input/Touchpad.hpp"
 #include "localization/Localization.hpp"
+#include "math/BatchMath.hpp"
 #include "math/Box2.hpp"
 #include "math/Box3.hpp"
 #include "math/Color.hpp"
 #include "math/ConvexVolume.hpp"
+#include "math/Frustum.hpp"
 #include "math/MathUtils.hpp"
 #include "math/Matrix4.hpp"
 #include "math/Plane.hpp"
@@ -104,6 +113,7 @@
 #include "math/Vector2.hpp"
 #include "math/Vector3.hpp"
 #include "math/Vector4.hpp"
+#include "network/Connection.hpp"
 #include "network/Network.hpp"
 #include "scene/Actor.hpp"
 #include "scene/ActorContainer.hpp"
@@ -127,6 +137,12 @@
 #include "utils/JSON.hpp"
 #include "utils/Log.hpp"
 #include "utils/OBF.hpp"
+#include "utils/OBFSchema.hpp"
+#include "utils/OBFView.hpp"
+#include "utils/OBFWriter.hpp"
+#include "utils/SpscQueue.hpp"
+#include "utils/StringView.hpp"
+#include "utils/ThreadPool.hpp"
 #include "utils/UTF8.hpp"
 #include "utils/Utils.hpp"
 #include "utils/XML.hpp"
@@ -8,6 +8,7 @@
 #include "graphics/RenderDevice.hpp"
 #include "Actor.hpp"
 #include "Layer.hpp"
+#include "math/BatchMath.hpp"
 #include "math/Matrix4.hpp"
 
 namespace ouzel
@@ -154,6 +155,13 @@ namespace ouzel
             return viewProjection;
         }
 
+        const Frustum& Camera::getFrustum() const
+        {
+            if (viewProjectionDirty) calculateViewProjection();
+
+            return frustum;
+        }
+
         const Matrix4<float>& Camera::getRenderViewProjection() const
         {
             if (viewProjectionDirty) calculateViewProjection();
@@ -181,6 +189,7 @@ namespace ouzel
                 viewProjection = projection * actor->getInverseTransform();
 
                 renderViewProjection = engine->getRenderer()->getDevice()->getProjectionTransform(renderTarget != nullptr) * viewProjection;
+                frustum = Frustum(viewProjection);
 
                 viewProjectionDirty = false;
             }
@@ -256,13 +265,18 @@ namespace ouzel
             }
             else
             {
-                Matrix4<float> modelViewProjection = getViewProjection() * boxTransform;
-
-                ConvexVolume<float> frustum = modelViewProjection.getFrustum();
-                return frustum.isBoxInside(box);
+                // the box enclosing the transformed box is tested against the cached world space frustum
+                Box3<float> worldBox;
+                transformBoxes(boxTransform, &box, &worldBox, 1);
+                return getFrustum().isBoxInside(worldBox);
             }
         }
 
+        size_t Camera::checkVisibility(const Box3<float>* boxes, uint8_t* visible, size_t count) const
+        {
+            return cullBoxes(getFrustum(), boxes, visible, count);
+        }
+
         void Camera::setViewport(const Rect<float>& newViewport)
         {
             viewport = newViewport;
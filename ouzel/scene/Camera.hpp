@@ -5,6 +5,7 @@
 
 #include <memory>
 #include "scene/Component.hpp"
+#include "math/Frustum.hpp"
 #include "math/MathUtils.hpp"
 #include "math/Rect.hpp"
 #include "graphics/DepthStencilState.hpp"
@@ -60,11 +61,15 @@ namespace ouzel
             const Matrix4<float>& getViewProjection() const;
             const Matrix4<float>& getRenderViewProjection() const;
             const Matrix4<float>& getInverseViewProjection() const;
+            // world space frustum of the view projection
+            const Frustum& getFrustum() const;
 
             Vector3<float> convertNormalizedToWorld(const Vector2<float>& normalizedPosition) const;
             Vector2<float> convertWorldToNormalized(const Vector3<float>& worldPosition) const;
 
             bool checkVisibility(const Matrix4<float>& boxTransform, const Box3<float>& box) const;
+            // checks world space boxes, returns the number of visible ones
+            size_t checkVisibility(const Box3<float>* boxes, uint8_t* visible, size_t count) const;
 
             inline const Rect<float>& getViewport() const { return viewport; }
             inline const Rect<float>& getRenderViewport() const { return renderViewport; }
@@ -140,6 +145,7 @@ namespace ouzel
             mutable bool viewProjectionDirty = true;
             mutable Matrix4<float> viewProjection;
             mutable Matrix4<float> renderViewProjection;
+            mutable Frustum frustum;
 
             mutable bool inverseViewProjectionDirty = true;
             mutable Matrix4<float> inverseViewProjection;
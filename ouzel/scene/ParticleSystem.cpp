@@ -2,6 +2,11 @@
 
 #include <cstdlib>
 #include <stdexcept>
+#if defined(__ARM_NEON__)
+#  include <arm_neon.h>
+#elif defined(__SSE2__)
+#  include <emmintrin.h>
+#endif
 #include "ParticleSystem.hpp"
 #include "core/Engine.hpp"
 #include "SceneManager.hpp"
@@ -11,6 +16,7 @@
 #include "Camera.hpp"
 #include "Layer.hpp"
 #include "utils/Utils.hpp"
+#include "math/BatchMath.hpp"
 #include "math/MathUtils.hpp"
 
 static constexpr float UPDATE_STEP = 1.0F / 60.0F;
@@ -19,10 +25,269 @@ namespace ouzel
 {
     namespace scene
     {
+        // arrays are padded to a multiple of 4 so that the SIMD kernels do not need a scalar tail
+        static inline uint32_t getPaddedCount(uint32_t count)
+        {
+            return (count + 3) & ~3U;
+        }
+
+        // values[i] += deltas[i] * step
+        static void integrate(float* values, const float* deltas, uint32_t count, float step)
+        {
+            if (isSimdAvailable)
+            {
+#if defined(__ARM_NEON__)
+                float32x4_t s = vdupq_n_f32(step);
+                for (uint32_t i = 0; i < count; i += 4)
+                    vst1q_f32(values + i, vmlaq_f32(vld1q_f32(values + i), vld1q_f32(deltas + i), s));
+                return;
+#elif defined(__SSE2__)
+                __m128 s = _mm_set1_ps(step);
+                for (uint32_t i = 0; i < count; i += 4)
+                    _mm_storeu_ps(values + i, _mm_add_ps(_mm_loadu_ps(values + i),
+                                                         _mm_mul_ps(_mm_loadu_ps(deltas + i), s)));
+                return;
+#endif
+            }
+
+            for (uint32_t i = 0; i < count; ++i)
+                values[i] += deltas[i] * step;
+        }
+
+        // sines[i] = sin(angles[i] * scale), cosines[i] = cos(angles[i] * scale)
+        static void sinCos(const float* angles, float* sines, float* cosines, uint32_t count, float scale)
+        {
+            if (isSimdAvailable)
+            {
+                // range reduction to [-PI/4, PI/4] and minimax polynomials from Cephes
+                static constexpr float TWO_OVER_PI = 0.636619772367581343075535F;
+                static constexpr float PI_OVER_2_1 = 1.5703125F;
+                static constexpr float PI_OVER_2_2 = 4.837512969970703125E-4F;
+                static constexpr float PI_OVER_2_3 = 7.54978995489188216E-8F;
+                static constexpr float SIN_1 = -1.6666654611E-1F;
+                static constexpr float SIN_2 = 8.3321608736E-3F;
+                static constexpr float SIN_3 = -1.9515295891E-4F;
+                static constexpr float COS_1 = 4.166664568298827E-2F;
+                static constexpr float COS_2 = -1.388731625493765E-3F;
+                static constexpr float COS_3 = 2.443315711809948E-5F;
+
+#if defined(__ARM_NEON__)
+                for (uint32_t i = 0; i < count; i += 4)
+                {
+                    float32x4_t x = vmulq_n_f32(vld1q_f32(angles + i), scale);
+
+                    // round to nearest quadrant
+                    float32x4_t half = vbslq_f32(vdupq_n_u32(0x80000000), x, vdupq_n_f32(0.5F));
+                    int32x4_t q = vcvtq_s32_f32(vmlaq_n_f32(half, x, TWO_OVER_PI));
+                    float32x4_t qf = vcvtq_f32_s32(q);
+
+                    float32x4_t r = vmlsq_n_f32(x, qf, PI_OVER_2_1);
+                    r = vmlsq_n_f32(r, qf, PI_OVER_2_2);
+                    r = vmlsq_n_f32(r, qf, PI_OVER_2_3);
+                    float32x4_t r2 = vmulq_f32(r, r);
+
+                    float32x4_t s = vmlaq_n_f32(vdupq_n_f32(SIN_2), r2, SIN_3);
+                    s = vmlaq_f32(vdupq_n_f32(SIN_1), s, r2);
+                    s = vmlaq_f32(r, vmulq_f32(s, r2), r);
+
+                    float32x4_t c = vmlaq_n_f32(vdupq_n_f32(COS_2), r2, COS_3);
+                    c = vmlaq_f32(vdupq_n_f32(COS_1), c, r2);
+                    c = vmulq_f32(vmulq_f32(c, r2), r2);
+                    c = vmlsq_n_f32(vaddq_f32(c, vdupq_n_f32(1.0F)), r2, 0.5F);
+
+                    uint32x4_t qu = vreinterpretq_u32_s32(q);
+                    uint32x4_t swap = vtstq_u32(qu, vdupq_n_u32(1));
+                    uint32x4_t sinSign = vshlq_n_u32(vandq_u32(qu, vdupq_n_u32(2)), 30);
+                    uint32x4_t cosSign = vshlq_n_u32(vandq_u32(vaddq_u32(qu, vdupq_n_u32(1)), vdupq_n_u32(2)), 30);
+
+                    uint32x4_t sinResult = veorq_u32(vreinterpretq_u32_f32(vbslq_f32(swap, c, s)), sinSign);
+                    uint32x4_t cosResult = veorq_u32(vreinterpretq_u32_f32(vbslq_f32(swap, s, c)), cosSign);
+
+                    vst1q_f32(sines + i, vreinterpretq_f32_u32(sinResult));
+                    vst1q_f32(cosines + i, vreinterpretq_f32_u32(cosResult));
+                }
+                return;
+#elif defined(__SSE2__)
+                for (uint32_t i = 0; i < count; i += 4)
+                {
+                    __m128 x = _mm_mul_ps(_mm_loadu_ps(angles + i), _mm_set1_ps(scale));
+
+                    // round to nearest quadrant
+                    __m128i q = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(TWO_OVER_PI)));
+                    __m128 qf = _mm_cvtepi32_ps(q);
+
+                    __m128 r = _mm_sub_ps(x, _mm_mul_ps(qf, _mm_set1_ps(PI_OVER_2_1)));
+                    r = _mm_sub_ps(r, _mm_mul_ps(qf, _mm_set1_ps(PI_OVER_2_2)));
+                    r = _mm_sub_ps(r, _mm_mul_ps(qf, _mm_set1_ps(PI_OVER_2_3)));
+                    __m128 r2 = _mm_mul_ps(r, r);
+
+                    __m128 s = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(SIN_3), r2), _mm_set1_ps(SIN_2));
+                    s = _mm_add_ps(_mm_mul_ps(s, r2), _mm_set1_ps(SIN_1));
+                    s = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(s, r2), r), r);
+
+                    __m128 c = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(COS_3), r2), _mm_set1_ps(COS_2));
+                    c = _mm_add_ps(_mm_mul_ps(c, r2), _mm_set1_ps(COS_1));
+                    c = _mm_mul_ps(_mm_mul_ps(c, r2), r2);
+                    c = _mm_add_ps(_mm_sub_ps(c, _mm_mul_ps(r2, _mm_set1_ps(0.5F))), _mm_set1_ps(1.0F));
+
+                    __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(q, _mm_set1_epi32(1)), _mm_set1_epi32(1)));
+                    __m128 sinSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(q, _mm_set1_epi32(2)), 30));
+                    __m128 cosSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(q, _mm_set1_epi32(1)), _mm_set1_epi32(2)), 30));
+
+                    __m128 sinResult = _mm_or_ps(_mm_and_ps(swap, c), _mm_andnot_ps(swap, s));
+                    __m128 cosResult = _mm_or_ps(_mm_and_ps(swap, s), _mm_andnot_ps(swap, c));
+
+                    _mm_storeu_ps(sines + i, _mm_xor_ps(sinResult, sinSign));
+                    _mm_storeu_ps(cosines + i, _mm_xor_ps(cosResult, cosSign));
+                }
+                return;
+#endif
+            }
+
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                sines[i] = sinf(angles[i] * scale);
+                cosines[i] = cosf(angles[i] * scale);
+            }
+        }
+
+        // direction += (radial + tangential + gravity) * step, position += direction * step * flip
+        static void updateGravity(float* positionX, float* positionY,
+                                  float* directionX, float* directionY,
+                                  const float* radialAcceleration, const float* tangentialAcceleration,
+                                  uint32_t count, float gravityX, float gravityY, float step, float flip)
+        {
+            if (isSimdAvailable)
+            {
+#if defined(__ARM_NEON__)
+                float32x4_t gx = vdupq_n_f32(gravityX);
+                float32x4_t gy = vdupq_n_f32(gravityY);
+                float32x4_t positionStep = vdupq_n_f32(step * flip);
+
+                for (uint32_t i = 0; i < count; i += 4)
+                {
+                    float32x4_t px = vld1q_f32(positionX + i);
+                    float32x4_t py = vld1q_f32(positionY + i);
+
+                    // reciprocal square root refined with two Newton-Raphson steps, zero for particles at the origin
+                    float32x4_t lengthSquared = vmlaq_f32(vmulq_f32(px, px), py, py);
+                    float32x4_t invLength = vrsqrteq_f32(lengthSquared);
+                    invLength = vmulq_f32(invLength, vrsqrtsq_f32(vmulq_f32(lengthSquared, invLength), invLength));
+                    invLength = vmulq_f32(invLength, vrsqrtsq_f32(vmulq_f32(lengthSquared, invLength), invLength));
+                    invLength = vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(invLength),
+                                                                vcgtq_f32(lengthSquared, vdupq_n_f32(0.0F))));
+
+                    float32x4_t rx = vmulq_f32(px, invLength);
+                    float32x4_t ry = vmulq_f32(py, invLength);
+
+                    float32x4_t radial = vld1q_f32(radialAcceleration + i);
+                    float32x4_t tangential = vld1q_f32(tangentialAcceleration + i);
+
+                    float32x4_t ax = vmlsq_f32(vmlaq_f32(gx, rx, radial), ry, tangential);
+                    float32x4_t ay = vmlaq_f32(vmlaq_f32(gy, ry, radial), rx, tangential);
+
+                    float32x4_t dx = vmlaq_n_f32(vld1q_f32(directionX + i), ax, step);
+                    float32x4_t dy = vmlaq_n_f32(vld1q_f32(directionY + i), ay, step);
+
+                    vst1q_f32(directionX + i, dx);
+                    vst1q_f32(directionY + i, dy);
+                    vst1q_f32(positionX + i, vmlaq_f32(px, dx, positionStep));
+                    vst1q_f32(positionY + i, vmlaq_f32(py, dy, positionStep));
+                }
+                return;
+#elif defined(__SSE2__)
+                __m128 gx = _mm_set1_ps(gravityX);
+                __m128 gy = _mm_set1_ps(gravityY);
+                __m128 directionStep = _mm_set1_ps(step);
+                __m128 positionStep = _mm_set1_ps(step * flip);
+
+                for (uint32_t i = 0; i < count; i += 4)
+                {
+                    __m128 px = _mm_loadu_ps(positionX + i);
+                    __m128 py = _mm_loadu_ps(positionY + i);
+
+                    // zero for particles at the origin
+                    __m128 lengthSquared = _mm_add_ps(_mm_mul_ps(px, px), _mm_mul_ps(py, py));
+                    __m128 invLength = _mm_and_ps(_mm_div_ps(_mm_set1_ps(1.0F), _mm_sqrt_ps(lengthSquared)),
+                                                  _mm_cmpgt_ps(lengthSquared, _mm_setzero_ps()));
+
+                    __m128 rx = _mm_mul_ps(px, invLength);
+                    __m128 ry = _mm_mul_ps(py, invLength);
+
+                    __m128 radial = _mm_loadu_ps(radialAcceleration + i);
+                    __m128 tangential = _mm_loadu_ps(tangentialAcceleration + i);
+
+                    __m128 ax = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(rx, radial), _mm_mul_ps(ry, tangential)), gx);
+                    __m128 ay = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ry, radial), _mm_mul_ps(rx, tangential)), gy);
+
+                    __m128 dx = _mm_add_ps(_mm_loadu_ps(directionX + i), _mm_mul_ps(ax, directionStep));
+                    __m128 dy = _mm_add_ps(_mm_loadu_ps(directionY + i), _mm_mul_ps(ay, directionStep));
+
+                    _mm_storeu_ps(directionX + i, dx);
+                    _mm_storeu_ps(directionY + i, dy);
+                    _mm_storeu_ps(positionX + i, _mm_add_ps(px, _mm_mul_ps(dx, positionStep)));
+                    _mm_storeu_ps(positionY + i, _mm_add_ps(py, _mm_mul_ps(dy, positionStep)));
+                }
+                return;
+#endif
+            }
+
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                float rx = 0.0F;
+                float ry = 0.0F;
+
+                float lengthSquared = positionX[i] * positionX[i] + positionY[i] * positionY[i];
+                if (lengthSquared > 0.0F)
+                {
+                    float invLength = 1.0F / sqrtf(lengthSquared);
+                    rx = positionX[i] * invLength;
+                    ry = positionY[i] * invLength;
+                }
+
+                float ax = rx * radialAcceleration[i] - ry * tangentialAcceleration[i] + gravityX;
+                float ay = ry * radialAcceleration[i] + rx * tangentialAcceleration[i] + gravityY;
+
+                directionX[i] += ax * step;
+                directionY[i] += ay * step;
+                positionX[i] += directionX[i] * step * flip;
+                positionY[i] += directionY[i] * step * flip;
+            }
+        }
+
+        void ParticleSystem::Particles::resize(uint32_t newSize)
+        {
+            uint32_t paddedSize = getPaddedCount(newSize);
+
+            for (std::vector<float>* attribute : {&life, &positionX, &positionY,
+                &colorRed, &colorGreen, &colorBlue, &colorAlpha,
+                &deltaColorRed, &deltaColorGreen, &deltaColorBlue, &deltaColorAlpha,
+                &angle, &size, &deltaSize, &rotation, &deltaRotation,
+                &radialAcceleration, &tangentialAcceleration,
+                &directionX, &directionY, &radius, &degreesPerSecond, &deltaRadius,
+                &rotationCos, &rotationSin})
+                attribute->assign(paddedSize, 0.0F);
+
+            localPosition.resize(paddedSize);
+        }
+
+        void ParticleSystem::Particles::move(uint32_t source, uint32_t destination)
+        {
+            for (std::vector<float>* attribute : {&life, &positionX, &positionY,
+                &colorRed, &colorGreen, &colorBlue, &colorAlpha,
+                &deltaColorRed, &deltaColorGreen, &deltaColorBlue, &deltaColorAlpha,
+                &angle, &size, &deltaSize, &rotation, &deltaRotation,
+                &radialAcceleration, &tangentialAcceleration,
+                &directionX, &directionY, &radius, &degreesPerSecond, &deltaRadius})
+                (*attribute)[destination] = (*attribute)[source];
+        }
+
         ParticleSystem::ParticleSystem():
-            Component(CLASS)
+            Component(CLASS),
+            randomGenerator(randomEngine())
         {
             shader = engine->getCache().getShader(SHADER_TEXTURE);
+            instancedShader = engine->getCache().getShader(SHADER_PARTICLE);
             blendState = engine->getCache().getBlendState(BLEND_ALPHA);
             whitePixelTexture = engine->getCache().getTexture(TEXTURE_WHITE_PIXEL);
 
@@ -41,6 +306,12 @@ namespace ouzel
             init(filename);
         }
 
+        ParticleSystem::~ParticleSystem()
+        {
+            // the worker must not outlive the particles, the exceptions are rethrown by the get
+            if (pendingUpdate.valid()) pendingUpdate.wait();
+        }
+
         void ParticleSystem::draw(const Matrix4<float>& transformMatrix,
                                   float opacity,
                                   const Matrix4<float>& renderViewProjection,
@@ -51,6 +322,8 @@ namespace ouzel
                             renderViewProjection,
                             wireframe);
 
+            waitForUpdate();
+
             if (particleCount)
             {
                 if (needsMeshUpdate)
@@ -76,19 +349,48 @@ namespace ouzel
                 vertexShaderConstants[0] = {std::begin(transform.m), std::end(transform.m)};
 
                 engine->getRenderer()->setCullMode(graphics::CullMode::NONE);
-                engine->getRenderer()->setPipelineState(blendState->getResource(), shader->getResource());
+                engine->getRenderer()->setPipelineState(blendState->getResource(),
+                                                        instanced ? instancedShader->getResource() : shader->getResource());
                 engine->getRenderer()->setShaderConstants(pixelShaderConstants,
                                                           vertexShaderConstants);
                 engine->getRenderer()->setTextures({wireframe ? whitePixelTexture->getResource() : texture->getResource()});
-                engine->getRenderer()->draw(indexBuffer->getResource(),
-                                            particleCount * 6,
-                                            sizeof(uint16_t),
-                                            vertexBuffer->getResource(),
-                                            graphics::DrawMode::TRIANGLE_LIST,
-                                            0);
+
+                if (instanced)
+                    engine->getRenderer()->draw(indexBuffer->getResource(),
+                                                6,
+                                                sizeof(uint16_t),
+                                                vertexBuffer->getResource(),
+                                                instanceBuffer->getResource(),
+                                                particleCount,
+                                                graphics::DrawMode::TRIANGLE_LIST,
+                                                0);
+                else
+                    engine->getRenderer()->draw(indexBuffer->getResource(),
+                                                particleCount * 6,
+                                                sizeof(uint16_t),
+                                                vertexBuffer->getResource(),
+                                                graphics::DrawMode::TRIANGLE_LIST,
+                                                0);
             }
         }
 
+        const Box3<float>& ParticleSystem::getBoundingBox() const
+        {
+            waitForUpdate();
+            return boundingBox;
+        }
+
+        void ParticleSystem::setParallelUpdate(bool newParallelUpdate)
+        {
+            waitForUpdate();
+            parallelUpdate = newParallelUpdate;
+        }
+
+        void ParticleSystem::waitForUpdate() const
+        {
+            if (pendingUpdate.valid()) pendingUpdate.get();
+        }
+
         void ParticleSystem::update(float delta)
         {
             timeSinceUpdate += delta;
@@ -120,134 +422,150 @@ namespace ouzel
                     if (particleSystemData.duration >= 0.0F && particleSystemData.duration < elapsed)
                     {
                         finished = true;
-                        stop();
+                        running = false;
                     }
                 }
-                else if (active && !particleCount)
-                {
-                    active = false;
-                    updateHandler.remove();
+                else if (!particleCount)
+                    break; // the finish event is dispatched by the next handleUpdate
 
-                    std::unique_ptr<AnimationEvent> finishEvent(new AnimationEvent());
-                    finishEvent->type = Event::Type::ANIMATION_FINISH;
-                    finishEvent->component = this;
-                    engine->getEventDispatcher().dispatchEvent(std::move(finishEvent));
+                step(UPDATE_STEP);
 
-                    return;
-                }
+                needsMeshUpdate = true;
+                needsBoundingBoxUpdate = true;
+            }
 
-                if (active)
-                {
-                    for (uint32_t counter = particleCount; counter > 0; --counter)
-                    {
-                        size_t i = counter - 1;
-
-                        particles[i].life -= UPDATE_STEP;
-
-                        if (particles[i].life >= 0.0F)
-                        {
-                            if (particleSystemData.emitterType == ParticleSystemData::EmitterType::GRAVITY)
-                            {
-                                Vector2<float> tmp;
-                                Vector2<float> radial;
-                                Vector2<float> tangential;
-
-                                // radial acceleration
-                                if (particles[i].position.v[0] == 0.0F || particles[i].position.v[1] == 0.0F)
-                                {
-                                    radial = particles[i].position;
-                                    radial.normalize();
-                                }
-                                tangential = radial;
-                                radial *= particles[i].radialAcceleration;
-
-                                // tangential acceleration
-                                std::swap(tangential.v[0], tangential.v[1]);
-                                tangential.v[0] *= - particles[i].tangentialAcceleration;
-                                tangential.v[1] *= particles[i].tangentialAcceleration;
-
-                                // (gravity + radial + tangential) * UPDATE_STEP
-                                tmp.v[0] = radial.v[0] + tangential.v[0] + particleSystemData.gravity.v[0];
-                                tmp.v[1] = radial.v[1] + tangential.v[1] + particleSystemData.gravity.v[1];
-                                tmp.v[0] *= UPDATE_STEP;
-                                tmp.v[1] *= UPDATE_STEP;
-
-                                particles[i].direction.v[0] += tmp.v[0];
-                                particles[i].direction.v[1] += tmp.v[1];
-                                tmp.v[0] = particles[i].direction.v[0] * UPDATE_STEP * particleSystemData.yCoordFlipped;
-                                tmp.v[1] = particles[i].direction.v[1] * UPDATE_STEP * particleSystemData.yCoordFlipped;
-                                particles[i].position.v[0] += tmp.v[0];
-                                particles[i].position.v[1] += tmp.v[1];
-                            }
-                            else
-                            {
-                                particles[i].angle += particles[i].degreesPerSecond * UPDATE_STEP;
-                                particles[i].radius += particles[i].deltaRadius * UPDATE_STEP;
-                                particles[i].position.v[0] = -cosf(particles[i].angle) * particles[i].radius;
-                                particles[i].position.v[1] = -sinf(particles[i].angle) * particles[i].radius * particleSystemData.yCoordFlipped;
-                            }
-
-                            // color r,g,b,a
-                            particles[i].colorRed += particles[i].deltaColorRed * UPDATE_STEP;
-                            particles[i].colorGreen += particles[i].deltaColorGreen * UPDATE_STEP;
-                            particles[i].colorBlue += particles[i].deltaColorBlue * UPDATE_STEP;
-                            particles[i].colorAlpha += particles[i].deltaColorAlpha * UPDATE_STEP;
-
-                            // size
-                            particles[i].size += (particles[i].deltaSize * UPDATE_STEP);
-                            particles[i].size = std::max(0.0F, particles[i].size);
-
-                            // angle
-                            particles[i].rotation += particles[i].deltaRotation * UPDATE_STEP;
-                        }
-                        else
-                        {
-                            particles[i] = particles[particleCount - 1];
-                            --particleCount;
-                        }
-                    }
+            if (needsBoundingBoxUpdate) updateBoundingBox();
+        }
 
-                    needsMeshUpdate = true;
-                    needsBoundingBoxUpdate = true;
+        void ParticleSystem::step(float delta)
+        {
+            // life first, so that the dead particles can be removed before the other attributes are updated
+            for (uint32_t counter = particleCount; counter > 0; --counter)
+            {
+                uint32_t i = counter - 1;
+
+                particles.life[i] -= delta;
+
+                if (particles.life[i] < 0.0F)
+                {
+                    --particleCount;
+                    if (i != particleCount) particles.move(particleCount, i);
                 }
             }
 
-            if (needsBoundingBoxUpdate)
+            uint32_t count = getPaddedCount(particleCount);
+            float flip = particleSystemData.yCoordFlipped ? 1.0F : 0.0F;
+
+            if (particleSystemData.emitterType == ParticleSystemData::EmitterType::GRAVITY)
             {
-                // Update bounding box
-                boundingBox.reset();
+                updateGravity(particles.positionX.data(), particles.positionY.data(),
+                              particles.directionX.data(), particles.directionY.data(),
+                              particles.radialAcceleration.data(), particles.tangentialAcceleration.data(),
+                              count, particleSystemData.gravity.v[0], particleSystemData.gravity.v[1],
+                              delta, flip);
+            }
+            else
+            {
+                integrate(particles.angle.data(), particles.degreesPerSecond.data(), count, delta);
+                integrate(particles.radius.data(), particles.deltaRadius.data(), count, delta);
 
-                if (particleSystemData.positionType == ParticleSystemData::PositionType::FREE ||
-                    particleSystemData.positionType == ParticleSystemData::PositionType::PARENT)
+                // the rotation scratch arrays are free until the mesh is generated
+                sinCos(particles.angle.data(), particles.rotationSin.data(), particles.rotationCos.data(), count, 1.0F);
+
+                for (uint32_t i = 0; i < count; ++i)
                 {
-                    if (actor)
-                    {
-                        const Matrix4<float>& inverseTransform = actor->getInverseTransform();
-
-                        for (uint32_t i = 0; i < particleCount; ++i)
-                        {
-                            Vector3<float> position = Vector3<float>(particles[i].position);
-                            inverseTransform.transformPoint(position);
-                            boundingBox.insertPoint(position);
-                        }
-                    }
+                    particles.positionX[i] = -particles.rotationCos[i] * particles.radius[i];
+                    particles.positionY[i] = -particles.rotationSin[i] * particles.radius[i] * flip;
                 }
-                else if (particleSystemData.positionType == ParticleSystemData::PositionType::GROUPED)
+            }
+
+            integrate(particles.colorRed.data(), particles.deltaColorRed.data(), count, delta);
+            integrate(particles.colorGreen.data(), particles.deltaColorGreen.data(), count, delta);
+            integrate(particles.colorBlue.data(), particles.deltaColorBlue.data(), count, delta);
+            integrate(particles.colorAlpha.data(), particles.deltaColorAlpha.data(), count, delta);
+
+            integrate(particles.size.data(), particles.deltaSize.data(), count, delta);
+            for (uint32_t i = 0; i < count; ++i)
+                particles.size[i] = std::max(0.0F, particles.size[i]);
+
+            integrate(particles.rotation.data(), particles.deltaRotation.data(), count, delta);
+        }
+
+        void ParticleSystem::updateBoundingBox()
+        {
+            boundingBox.reset();
+
+            if (particleSystemData.positionType == ParticleSystemData::PositionType::FREE ||
+                particleSystemData.positionType == ParticleSystemData::PositionType::PARENT)
+            {
+                if (hasActor)
                 {
                     for (uint32_t i = 0; i < particleCount; ++i)
-                        boundingBox.insertPoint(particles[i].position);
+                        particles.localPosition[i] = Vector3<float>(particles.positionX[i], particles.positionY[i], 0.0F);
+
+                    transformPoints(inverseTransform, particles.localPosition.data(), particles.localPosition.data(), particleCount);
+
+                    for (uint32_t i = 0; i < particleCount; ++i)
+                        boundingBox.insertPoint(particles.localPosition[i]);
                 }
             }
+            else if (particleSystemData.positionType == ParticleSystemData::PositionType::GROUPED)
+            {
+                for (uint32_t i = 0; i < particleCount; ++i)
+                    boundingBox.insertPoint(Vector3<float>(particles.positionX[i], particles.positionY[i], 0.0F));
+            }
         }
 
         bool ParticleSystem::handleUpdate(const UpdateEvent& event)
         {
-            update(event.delta);
+            waitForUpdate();
+
+            if ((!running || particleSystemData.emissionRate <= 0.0F) && particleCount == 0)
+            {
+                if (active)
+                {
+                    active = false;
+                    updateHandler.remove();
+
+                    std::unique_ptr<AnimationEvent> finishEvent(new AnimationEvent());
+                    finishEvent->type = Event::Type::ANIMATION_FINISH;
+                    finishEvent->component = this;
+                    engine->getEventDispatcher().dispatchEvent(std::move(finishEvent));
+                }
+
+                return false;
+            }
+
+            // the actor must not be accessed from the worker thread
+            hasActor = (actor != nullptr);
+
+            if (actor)
+            {
+                if (particleSystemData.positionType == ParticleSystemData::PositionType::FREE)
+                    emitterPosition = Vector2<float>(actor->convertLocalToWorld(Vector3<float>()));
+                else if (particleSystemData.positionType == ParticleSystemData::PositionType::PARENT)
+                    emitterPosition = Vector2<float>(actor->convertLocalToWorld(Vector3<float>()) - actor->getPosition());
+                else
+                    emitterPosition = Vector2<float>();
+
+                actorPosition = Vector2<float>(actor->getPosition());
+                inverseTransform = actor->getInverseTransform();
+            }
+
+            float delta = event.delta;
+
+            if (parallelUpdate)
+                pendingUpdate = engine->getThreadPool().run([this, delta]() { update(delta); });
+            else
+                update(delta);
+
             return false;
         }
 
         void ParticleSystem::init(const ParticleSystemData& newParticleSystemData)
         {
+            waitForUpdate();
+
             particleSystemData = newParticleSystemData;
 
             texture = particleSystemData.texture;
@@ -261,6 +579,8 @@ namespace ouzel
 
         void ParticleSystem::init(const std::string& filename)
         {
+            waitForUpdate();
+
             particleSystemData = *engine->getCache().getParticleSystemData(filename);
 
             texture = particleSystemData.texture;
@@ -274,6 +594,8 @@ namespace ouzel
 
         void ParticleSystem::resume()
         {
+            waitForUpdate();
+
             if (!running)
             {
                 finished = false;
@@ -297,11 +619,15 @@ namespace ouzel
 
         void ParticleSystem::stop()
         {
+            waitForUpdate();
+
             running = false;
         }
 
         void ParticleSystem::reset()
         {
+            waitForUpdate();
+
             emitCounter = 0.0F;
             elapsed = 0.0F;
             timeSinceUpdate = 0.0F;
@@ -311,10 +637,15 @@ namespace ouzel
 
         void ParticleSystem::createParticleMesh()
         {
-            indices.reserve(particleSystemData.maxParticles * 6);
-            vertices.reserve(particleSystemData.maxParticles * 4);
+            instanced = instancedShader && engine->getRenderer()->getDevice()->isInstancingSupported();
+
+            // the quad corners are scaled, rotated and moved by the particle
+            uint16_t quadCount = instanced ? 1 : particleSystemData.maxParticles;
 
-            for (uint16_t i = 0; i < particleSystemData.maxParticles; ++i)
+            indices.clear();
+            indices.reserve(quadCount * 6);
+
+            for (uint16_t i = 0; i < quadCount; ++i)
             {
                 indices.push_back(i * 4 + 0);
                 indices.push_back(i * 4 + 1);
@@ -322,15 +653,6 @@ namespace ouzel
                 indices.push_back(i * 4 + 1);
                 indices.push_back(i * 4 + 3);
                 indices.push_back(i * 4 + 2);
-
-                vertices.push_back(graphics::Vertex(Vector3<float>(-1.0F, -1.0F, 0.0F), Color::WHITE,
-                                                    Vector2<float>(0.0F, 1.0F), Vector3<float>(0.0F, 0.0F, -1.0F)));
-                vertices.push_back(graphics::Vertex(Vector3<float>(1.0F, -1.0F, 0.0F), Color::WHITE,
-                                                    Vector2<float>(1.0F, 1.0F), Vector3<float>(0.0F, 0.0F, -1.0F)));
-                vertices.push_back(graphics::Vertex(Vector3<float>(-1.0F, 1.0F, 0.0F), Color::WHITE,
-                                                    Vector2<float>(0.0F, 0.0F), Vector3<float>(0.0F, 0.0F, -1.0F)));
-                vertices.push_back(graphics::Vertex(Vector3<float>(1.0F, 1.0F, 0.0F), Color::WHITE,
-                                                    Vector2<float>(1.0F, 0.0F), Vector3<float>(0.0F, 0.0F, -1.0F)));
             }
 
             indexBuffer = std::make_shared<graphics::Buffer>(*engine->getRenderer(),
@@ -338,62 +660,108 @@ namespace ouzel
                                                              indices.data(),
                                                              static_cast<uint32_t>(getVectorSize(indices)));
 
-            vertexBuffer = std::make_shared<graphics::Buffer>(*engine->getRenderer(),
-                                                              graphics::Buffer::Usage::VERTEX,
-                                                              graphics::Buffer::DYNAMIC,
-                                                              vertices.data(),
-                                                              static_cast<uint32_t>(getVectorSize(vertices)));
+            if (instanced)
+            {
+                std::vector<graphics::Vertex> vertices = {
+                    graphics::Vertex(Vector3<float>(-1.0F, -1.0F, 0.0F), Color::WHITE,
+                                     Vector2<float>(0.0F, 1.0F), Vector3<float>(0.0F, 0.0F, -1.0F)),
+                    graphics::Vertex(Vector3<float>(1.0F, -1.0F, 0.0F), Color::WHITE,
+                                     Vector2<float>(1.0F, 1.0F), Vector3<float>(0.0F, 0.0F, -1.0F)),
+                    graphics::Vertex(Vector3<float>(-1.0F, 1.0F, 0.0F), Color::WHITE,
+                                     Vector2<float>(0.0F, 0.0F), Vector3<float>(0.0F, 0.0F, -1.0F)),
+                    graphics::Vertex(Vector3<float>(1.0F, 1.0F, 0.0F), Color::WHITE,
+                                     Vector2<float>(1.0F, 0.0F), Vector3<float>(0.0F, 0.0F, -1.0F))
+                };
+
+                vertexBuffer = std::make_shared<graphics::Buffer>(*engine->getRenderer(),
+                                                                  graphics::Buffer::Usage::VERTEX, 0,
+                                                                  vertices.data(),
+                                                                  static_cast<uint32_t>(getVectorSize(vertices)));
+
+                instanceBuffer = std::make_shared<graphics::Buffer>(*engine->getRenderer(),
+                                                                    graphics::VertexLayout(graphics::Instance::ATTRIBUTES),
+                                                                    graphics::Buffer::DYNAMIC,
+                                                                    static_cast<uint32_t>(particleSystemData.maxParticles * sizeof(graphics::Instance)));
+            }
+            else
+            {
+                // only the live particles are uploaded every frame
+                vertexBuffer = std::make_shared<graphics::Buffer>(*engine->getRenderer(),
+                                                                  graphics::Buffer::Usage::VERTEX,
+                                                                  graphics::Buffer::DYNAMIC,
+                                                                  static_cast<uint32_t>(particleSystemData.maxParticles * 4 * sizeof(graphics::Vertex)));
+
+                instanceBuffer.reset();
+            }
 
+            particleCount = 0;
             particles.resize(particleSystemData.maxParticles);
         }
 
         void ParticleSystem::updateParticleMesh()
         {
-            if (actor)
+            if (hasActor)
             {
-                for (uint32_t counter = particleCount; counter > 0; --counter)
-                {
-                    size_t i = counter - 1;
-
-                    Vector2<float> position;
+                Vector2<float> offset;
+                if (particleSystemData.positionType == ParticleSystemData::PositionType::PARENT)
+                    offset = actorPosition;
 
-                    if (particleSystemData.positionType == ParticleSystemData::PositionType::FREE)
-                        position = particles[i].position;
-                    else if (particleSystemData.positionType == ParticleSystemData::PositionType::PARENT)
-                        position = Vector2<float>(actor->getPosition()) + particles[i].position;
-
-                    float size_2 = particles[i].size / 2.0F;
-                    Vector2<float> v1(-size_2, -size_2);
-                    Vector2<float> v2(size_2, size_2);
-
-                    float r = -degToRad(particles[i].rotation);
-                    float cr = cosf(r);
-                    float sr = sinf(r);
+                if (instanced)
+                {
+                    graphics::Instance* instances = static_cast<graphics::Instance*>(instanceBuffer->map(particleCount * sizeof(graphics::Instance)));
 
-                    Vector2<float> a(v1.v[0] * cr - v1.v[1] * sr, v1.v[0] * sr + v1.v[1] * cr);
-                    Vector2<float> b(v2.v[0] * cr - v1.v[1] * sr, v2.v[0] * sr + v1.v[1] * cr);
-                    Vector2<float> c(v2.v[0] * cr - v2.v[1] * sr, v2.v[0] * sr + v2.v[1] * cr);
-                    Vector2<float> d(v1.v[0] * cr - v2.v[1] * sr, v1.v[0] * sr + v2.v[1] * cr);
+                    for (uint32_t i = 0; i < particleCount; ++i)
+                    {
+                        Color color(static_cast<uint8_t>(particles.colorRed[i] * 255),
+                                    static_cast<uint8_t>(particles.colorGreen[i] * 255),
+                                    static_cast<uint8_t>(particles.colorBlue[i] * 255),
+                                    static_cast<uint8_t>(particles.colorAlpha[i] * 255));
+
+                        new (&instances[i]) graphics::Instance(Vector2<float>(particles.positionX[i] + offset.v[0],
+                                                                              particles.positionY[i] + offset.v[1]),
+                                                               particles.size[i] / 2.0F,
+                                                               -degToRad(particles.rotation[i]),
+                                                               color);
+                    }
 
-                    Color color(static_cast<uint8_t>(particles[i].colorRed * 255),
-                                static_cast<uint8_t>(particles[i].colorGreen * 255),
-                                static_cast<uint8_t>(particles[i].colorBlue * 255),
-                                static_cast<uint8_t>(particles[i].colorAlpha * 255));
+                    instanceBuffer->unmap();
+                    return;
+                }
 
-                    vertices[i * 4 + 0].position = Vector3<float>(a + position);
-                    vertices[i * 4 + 0].color = color;
+                uint32_t count = getPaddedCount(particleCount);
+                sinCos(particles.rotation.data(), particles.rotationSin.data(), particles.rotationCos.data(),
+                       count, -PI / 180.0F);
 
-                    vertices[i * 4 + 1].position = Vector3<float>(b + position);
-                    vertices[i * 4 + 1].color = color;
+                graphics::Vertex* vertices = static_cast<graphics::Vertex*>(vertexBuffer->map(particleCount * 4 * sizeof(graphics::Vertex)));
 
-                    vertices[i * 4 + 2].position = Vector3<float>(d + position);
-                    vertices[i * 4 + 2].color = color;
+                const Vector3<float> normal(0.0F, 0.0F, -1.0F);
 
-                    vertices[i * 4 + 3].position = Vector3<float>(c + position);
-                    vertices[i * 4 + 3].color = color;
+                for (uint32_t i = 0; i < particleCount; ++i)
+                {
+                    float x = particles.positionX[i] + offset.v[0];
+                    float y = particles.positionY[i] + offset.v[1];
+
+                    float size_2 = particles.size[i] / 2.0F;
+                    float cr = particles.rotationCos[i] * size_2;
+                    float sr = particles.rotationSin[i] * size_2;
+
+                    Color color(static_cast<uint8_t>(particles.colorRed[i] * 255),
+                                static_cast<uint8_t>(particles.colorGreen[i] * 255),
+                                static_cast<uint8_t>(particles.colorBlue[i] * 255),
+                                static_cast<uint8_t>(particles.colorAlpha[i] * 255));
+
+                    // corners (-1, -1), (1, -1), (-1, 1), (1, 1) rotated and scaled
+                    new (&vertices[i * 4 + 0]) graphics::Vertex(Vector3<float>(x - cr + sr, y - sr - cr, 0.0F), color,
+                                                                Vector2<float>(0.0F, 1.0F), normal);
+                    new (&vertices[i * 4 + 1]) graphics::Vertex(Vector3<float>(x + cr + sr, y + sr - cr, 0.0F), color,
+                                                                Vector2<float>(1.0F, 1.0F), normal);
+                    new (&vertices[i * 4 + 2]) graphics::Vertex(Vector3<float>(x - cr - sr, y - sr + cr, 0.0F), color,
+                                                                Vector2<float>(0.0F, 0.0F), normal);
+                    new (&vertices[i * 4 + 3]) graphics::Vertex(Vector3<float>(x + cr - sr, y + sr + cr, 0.0F), color,
+                                                                Vector2<float>(1.0F, 0.0F), normal);
                 }
 
-                vertexBuffer->setData(vertices.data(), static_cast<uint32_t>(getVectorSize(vertices)));
+                vertexBuffer->unmap();
             }
         }
 
@@ -402,78 +770,65 @@ namespace ouzel
             if (particleCount + count > particleSystemData.maxParticles)
                 count = particleSystemData.maxParticles - particleCount;
 
-            if (count && actor)
+            if (count && hasActor)
             {
-                Vector2<float> position;
-
-                if (particleSystemData.positionType == ParticleSystemData::PositionType::FREE)
-                    position = Vector2<float>(actor->convertLocalToWorld(Vector3<float>()));
-                else if (particleSystemData.positionType == ParticleSystemData::PositionType::PARENT)
-                    position = Vector2<float>(actor->convertLocalToWorld(Vector3<float>()) - actor->getPosition());
+                std::uniform_real_distribution<float> variance{-1.0F, 1.0F};
 
                 for (uint32_t i = particleCount; i < particleCount + count; ++i)
                 {
-                    if (particleSystemData.emitterType == ParticleSystemData::EmitterType::GRAVITY)
-                    {
-                        particles[i].life = fmaxf(particleSystemData.particleLifespan + particleSystemData.particleLifespanVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine), 0.0F);
+                    float life = fmaxf(particleSystemData.particleLifespan + particleSystemData.particleLifespanVariance * variance(randomGenerator), 0.0F);
+                    particles.life[i] = life;
+
+                    particles.positionX[i] = particleSystemData.sourcePosition.v[0] + emitterPosition.v[0] + particleSystemData.sourcePositionVariance.v[0] * variance(randomGenerator);
+                    particles.positionY[i] = particleSystemData.sourcePosition.v[1] + emitterPosition.v[1] + particleSystemData.sourcePositionVariance.v[1] * variance(randomGenerator);
 
-                        particles[i].position = particleSystemData.sourcePosition + position + Vector2<float>(particleSystemData.sourcePositionVariance.v[0] * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine),
-                                                                                                       particleSystemData.sourcePositionVariance.v[1] * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine));
+                    particles.size[i] = fmaxf(particleSystemData.startParticleSize + particleSystemData.startParticleSizeVariance * variance(randomGenerator), 0.0F);
 
-                        particles[i].size = fmaxf(particleSystemData.startParticleSize + particleSystemData.startParticleSizeVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine), 0.0F);
+                    float finishSize = fmaxf(particleSystemData.finishParticleSize + particleSystemData.finishParticleSizeVariance * variance(randomGenerator), 0.0F);
+                    particles.deltaSize[i] = (finishSize - particles.size[i]) / life;
 
-                        float finishSize = fmaxf(particleSystemData.finishParticleSize + particleSystemData.finishParticleSizeVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine), 0.0F);
-                        particles[i].deltaSize = (finishSize - particles[i].size) / particles[i].life;
+                    particles.colorRed[i] = clamp(particleSystemData.startColorRed + particleSystemData.startColorRedVariance * variance(randomGenerator), 0.0F, 1.0F);
+                    particles.colorGreen[i] = clamp(particleSystemData.startColorGreen + particleSystemData.startColorGreenVariance * variance(randomGenerator), 0.0F, 1.0F);
+                    particles.colorBlue[i] = clamp(particleSystemData.startColorBlue + particleSystemData.startColorBlueVariance * variance(randomGenerator), 0.0F, 1.0F);
+                    particles.colorAlpha[i] = clamp(particleSystemData.startColorAlpha + particleSystemData.startColorAlphaVariance * variance(randomGenerator), 0.0F, 1.0F);
 
-                        particles[i].colorRed = clamp(particleSystemData.startColorRed + particleSystemData.startColorRedVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine), 0.0F, 1.0F);
-                        particles[i].colorGreen = clamp(particleSystemData.startColorGreen + particleSystemData.startColorGreenVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine), 0.0F, 1.0F);
-                        particles[i].colorBlue = clamp(particleSystemData.startColorBlue + particleSystemData.startColorBlueVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine), 0.0F, 1.0F);
-                        particles[i].colorAlpha = clamp(particleSystemData.startColorAlpha + particleSystemData.startColorAlphaVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine), 0.0F, 1.0F);
+                    float finishColorRed = clamp(particleSystemData.finishColorRed + particleSystemData.finishColorRedVariance * variance(randomGenerator), 0.0F, 1.0F);
+                    float finishColorGreen = clamp(particleSystemData.finishColorGreen + particleSystemData.finishColorGreenVariance * variance(randomGenerator), 0.0F, 1.0F);
+                    float finishColorBlue = clamp(particleSystemData.finishColorBlue + particleSystemData.finishColorBlueVariance * variance(randomGenerator), 0.0F, 1.0F);
+                    float finishColorAlpha = clamp(particleSystemData.finishColorAlpha + particleSystemData.finishColorAlphaVariance * variance(randomGenerator), 0.0F, 1.0F);
 
-                        float finishColorRed = clamp(particleSystemData.finishColorRed + particleSystemData.finishColorRedVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine), 0.0F, 1.0F);
-                        float finishColorGreen = clamp(particleSystemData.finishColorGreen + particleSystemData.finishColorGreenVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine), 0.0F, 1.0F);
-                        float finishColorBlue = clamp(particleSystemData.finishColorBlue + particleSystemData.finishColorBlueVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine), 0.0F, 1.0F);
-                        float finishColorAlpha = clamp(particleSystemData.finishColorAlpha + particleSystemData.finishColorAlphaVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine), 0.0F, 1.0F);
+                    particles.deltaColorRed[i] = (finishColorRed - particles.colorRed[i]) / life;
+                    particles.deltaColorGreen[i] = (finishColorGreen - particles.colorGreen[i]) / life;
+                    particles.deltaColorBlue[i] = (finishColorBlue - particles.colorBlue[i]) / life;
+                    particles.deltaColorAlpha[i] = (finishColorAlpha - particles.colorAlpha[i]) / life;
 
-                        particles[i].deltaColorRed = (finishColorRed - particles[i].colorRed) / particles[i].life;
-                        particles[i].deltaColorGreen = (finishColorGreen - particles[i].colorGreen) / particles[i].life;
-                        particles[i].deltaColorBlue = (finishColorBlue - particles[i].colorBlue) / particles[i].life;
-                        particles[i].deltaColorAlpha = (finishColorAlpha - particles[i].colorAlpha) / particles[i].life;
+                    particles.rotation[i] = particleSystemData.startRotation + particleSystemData.startRotationVariance * variance(randomGenerator);
 
-                        particles[i].rotation = particleSystemData.startRotation + particleSystemData.startRotationVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine);
+                    float finishRotation = particleSystemData.finishRotation + particleSystemData.finishRotationVariance * variance(randomGenerator);
+                    particles.deltaRotation[i] = (finishRotation - particles.rotation[i]) / life;
 
-                        float finishRotation = particleSystemData.finishRotation + particleSystemData.finishRotationVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine);
-                        particles[i].deltaRotation = (finishRotation - particles[i].rotation) / particles[i].life;
+                    if (particleSystemData.emitterType == ParticleSystemData::EmitterType::GRAVITY)
+                    {
+                        particles.radialAcceleration[i] = particleSystemData.radialAcceleration + particleSystemData.radialAcceleration * variance(randomGenerator);
+                        particles.tangentialAcceleration[i] = particleSystemData.tangentialAcceleration + particleSystemData.tangentialAcceleration * variance(randomGenerator);
 
-                        particles[i].radialAcceleration = particleSystemData.radialAcceleration + particleSystemData.radialAcceleration * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine);
-                        particles[i].tangentialAcceleration = particleSystemData.tangentialAcceleration + particleSystemData.tangentialAcceleration * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine);
+                        float a = degToRad(particleSystemData.angle + particleSystemData.angleVariance * variance(randomGenerator));
+                        float s = particleSystemData.speed + particleSystemData.speedVariance * variance(randomGenerator);
+                        Vector2<float> dir(cosf(a) * s, sinf(a) * s);
+                        particles.directionX[i] = dir.v[0];
+                        particles.directionY[i] = dir.v[1];
 
                         if (particleSystemData.rotationIsDir)
-                        {
-                            float a = degToRad(particleSystemData.angle + particleSystemData.angleVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine));
-                            Vector2<float> v(cosf(a), sinf(a));
-                            float s = particleSystemData.speed + particleSystemData.speedVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine);
-                            Vector2<float> dir = v * s;
-                            particles[i].direction = dir;
-                            particles[i].rotation = -radToDeg(dir.getAngle());
-                        }
-                        else
-                        {
-                            float a = degToRad(particleSystemData.angle + particleSystemData.angleVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine));
-                            Vector2<float> v(cosf(a), sinf(a));
-                            float s = particleSystemData.speed + particleSystemData.speedVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine);
-                            Vector2<float> dir = v * s;
-                            particles[i].direction = dir;
-                        }
+                            particles.rotation[i] = -radToDeg(dir.getAngle());
                     }
                     else
                     {
-                        particles[i].radius = particleSystemData.maxRadius + particleSystemData.maxRadiusVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine);
-                        particles[i].angle = degToRad(particleSystemData.angle + particleSystemData.angleVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine));
-                        particles[i].degreesPerSecond = degToRad(particleSystemData.rotatePerSecond + particleSystemData.rotatePerSecondVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine));
+                        particles.radius[i] = particleSystemData.maxRadius + particleSystemData.maxRadiusVariance * variance(randomGenerator);
+                        particles.angle[i] = degToRad(particleSystemData.angle + particleSystemData.angleVariance * variance(randomGenerator));
+                        particles.degreesPerSecond[i] = degToRad(particleSystemData.rotatePerSecond + particleSystemData.rotatePerSecondVariance * variance(randomGenerator));
 
-                        float endRadius = particleSystemData.minRadius + particleSystemData.minRadiusVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine);
-                        particles[i].deltaRadius = (endRadius - particles[i].radius) / particles[i].life;
+                        float endRadius = particleSystemData.minRadius + particleSystemData.minRadiusVariance * variance(randomGenerator);
+                        particles.deltaRadius[i] = (endRadius - particles.radius[i]) / life;
                     }
                 }
 
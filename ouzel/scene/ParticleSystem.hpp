@@ -3,14 +3,18 @@
 #ifndef OUZEL_SCENE_PARTICLESYSTEM_HPP
 #define OUZEL_SCENE_PARTICLESYSTEM_HPP
 
+#include <future>
+#include <random>
 #include <string>
 #include <vector>
 #include <functional>
 #include "scene/Component.hpp"
 #include "scene/ParticleSystemData.hpp"
 #include "math/Vector2.hpp"
+#include "math/Vector3.hpp"
 #include "math/Color.hpp"
 #include "events/EventHandler.hpp"
+#include "graphics/Instance.hpp"
 #include "graphics/Vertex.hpp"
 #include "graphics/BlendState.hpp"
 #include "graphics/Buffer.hpp"
@@ -29,12 +33,15 @@ namespace ouzel
             ParticleSystem();
             explicit ParticleSystem(const ParticleSystemData& initParticleSystemData);
             explicit ParticleSystem(const std::string& filename);
+            ~ParticleSystem();
 
             void draw(const Matrix4<float>& transformMatrix,
                       float opacity,
                       const Matrix4<float>& renderViewProjection,
                       bool wireframe) override;
 
+            const Box3<float>& getBoundingBox() const override;
+
             void init(const ParticleSystemData& newParticleSystemData);
             void init(const std::string& filename);
 
@@ -42,14 +49,26 @@ namespace ouzel
             void stop();
             void reset();
 
-            bool isRunning() const { return running; }
+            bool isRunning() const { waitForUpdate(); return running; }
             bool isActive() const { return active; }
 
             inline ParticleSystemData::PositionType getPositionType() const { return particleSystemData.positionType; }
-            inline void setPositionType(ParticleSystemData::PositionType newPositionType) { particleSystemData.positionType = newPositionType; }
+            inline void setPositionType(ParticleSystemData::PositionType newPositionType)
+            {
+                waitForUpdate();
+                particleSystemData.positionType = newPositionType;
+            }
+
+            // if enabled, the simulation runs on a worker thread in parallel with other particle systems
+            // and is waited for when the particles are needed for drawing
+            inline bool isParallelUpdate() const { return parallelUpdate; }
+            void setParallelUpdate(bool newParallelUpdate);
 
         private:
             void update(float delta);
+            void step(float delta);
+            void updateBoundingBox();
+            void waitForUpdate() const;
             bool handleUpdate(const UpdateEvent& event);
 
             void createParticleMesh();
@@ -60,54 +79,80 @@ namespace ouzel
             ParticleSystemData particleSystemData;
 
             std::shared_ptr<graphics::Shader> shader;
+            std::shared_ptr<graphics::Shader> instancedShader;
             std::shared_ptr<graphics::BlendState> blendState;
             std::shared_ptr<graphics::Texture> texture;
             std::shared_ptr<graphics::Texture> whitePixelTexture;
 
-            struct Particle final
+            // particle attributes stored as separate arrays, so that they can be updated with SIMD
+            struct Particles final
             {
-                float life = 0.0F;
+                void resize(uint32_t size);
+                void move(uint32_t source, uint32_t destination);
+
+                std::vector<float> life;
+
+                std::vector<float> positionX;
+                std::vector<float> positionY;
 
-                Vector2<float> position;
+                std::vector<float> colorRed;
+                std::vector<float> colorGreen;
+                std::vector<float> colorBlue;
+                std::vector<float> colorAlpha;
 
-                float colorRed = 0.0F;
-                float colorGreen = 0.0F;
-                float colorBlue = 0.0F;
-                float colorAlpha = 0.0F;
+                std::vector<float> deltaColorRed;
+                std::vector<float> deltaColorGreen;
+                std::vector<float> deltaColorBlue;
+                std::vector<float> deltaColorAlpha;
 
-                float deltaColorRed = 0.0F;
-                float deltaColorGreen = 0.0F;
-                float deltaColorBlue = 0.0F;
-                float deltaColorAlpha = 0.0F;
+                std::vector<float> angle;
 
-                float angle = 0.0F;
-                float speed = 0.0F;
+                std::vector<float> size;
+                std::vector<float> deltaSize;
 
-                float size = 0.0F;
-                float deltaSize = 0.0F;
+                std::vector<float> rotation;
+                std::vector<float> deltaRotation;
 
-                float rotation = 0.0F;
-                float deltaRotation = 0.0F;
+                std::vector<float> radialAcceleration;
+                std::vector<float> tangentialAcceleration;
 
-                float radialAcceleration = 0.0F;
-                float tangentialAcceleration = 0.0F;
+                std::vector<float> directionX;
+                std::vector<float> directionY;
+                std::vector<float> radius;
+                std::vector<float> degreesPerSecond;
+                std::vector<float> deltaRadius;
 
-                Vector2<float> direction;
-                float radius = 0.0F;
-                float degreesPerSecond = 0.0F;
-                float deltaRadius = 0.0F;
+                // scratch space for the mesh generation
+                std::vector<float> rotationCos;
+                std::vector<float> rotationSin;
+                // scratch space for the bounding box calculation
+                std::vector<Vector3<float>> localPosition;
             };
 
-            std::vector<Particle> particles;
+            Particles particles;
 
             std::shared_ptr<graphics::Buffer> indexBuffer;
             std::shared_ptr<graphics::Buffer> vertexBuffer;
+            std::shared_ptr<graphics::Buffer> instanceBuffer;
+
+            // particles are drawn as instances of a single quad if the renderer supports it
+            bool instanced = false;
 
             std::vector<uint16_t> indices;
-            std::vector<graphics::Vertex> vertices;
 
             uint32_t particleCount = 0;
 
+            std::mt19937 randomGenerator;
+
+            // actor state captured on the main thread for the update
+            Vector2<float> emitterPosition;
+            Vector2<float> actorPosition;
+            Matrix4<float> inverseTransform;
+            bool hasActor = false;
+
+            bool parallelUpdate = false;
+            mutable std::future<void> pendingUpdate;
+
             float emitCounter = 0.0F;
             float elapsed = 0.0F;
             float timeSinceUpdate = 0.0F;
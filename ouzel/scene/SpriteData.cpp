@@ -70,10 +70,16 @@ namespace ouzel
                                                              indices.data(),
                                                              static_cast<uint32_t>(getVectorSize(indices)));
 
+            // frames that extend past the texture (e.g. tiled with a repeating texture) have texture
+            // coordinates outside of the range that the compact layout can store
+            const graphics::VertexLayout& layout = graphics::VertexLayout::COMPACT_2D.canPack(vertices) ?
+                graphics::VertexLayout::COMPACT_2D : graphics::VertexLayout::STANDARD;
+            std::vector<uint8_t> vertexData = layout.pack(vertices);
+
             vertexBuffer = std::make_shared<graphics::Buffer>(*engine->getRenderer(),
-                                                              graphics::Buffer::Usage::VERTEX,0,
-                                                              vertices.data(),
-                                                              static_cast<uint32_t>(getVectorSize(vertices)));
+                                                              layout, 0,
+                                                              vertexData,
+                                                              static_cast<uint32_t>(vertexData.size()));
         }
 
         SpriteData::Frame::Frame(const std::string& frameName,
@@ -22,7 +22,7 @@ namespace ouzel
             textAnchor(initTextAnchor),
             color(initColor)
         {
-            shader = engine->getCache().getShader(SHADER_TEXTURE);
+            distanceFieldShader = engine->getCache().getShader(SHADER_DISTANCE_FIELD);
             blendState = engine->getCache().getBlendState(BLEND_ALPHA);
             whitePixelTexture = engine->getCache().getTexture(TEXTURE_WHITE_PIXEL);
 
@@ -31,11 +31,12 @@ namespace ouzel
                                                              graphics::Buffer::DYNAMIC);
 
             vertexBuffer = std::make_shared<graphics::Buffer>(*engine->getRenderer(),
-                                                              graphics::Buffer::Usage::VERTEX,
+                                                              graphics::VertexLayout::COMPACT_2D,
                                                               graphics::Buffer::DYNAMIC);
 
             font = engine->getCache().getFont(fontFile);
 
+            updateShader();
             updateText();
         }
 
@@ -43,9 +44,18 @@ namespace ouzel
         {
             font = engine->getCache().getFont(fontFile);
 
+            updateShader();
             updateText();
         }
 
+        void TextRenderer::updateShader()
+        {
+            if (font && font->isDistanceField() && distanceFieldShader)
+                shader = distanceFieldShader;
+            else
+                shader = engine->getCache().getShader(SHADER_TEXTURE);
+        }
+
         void TextRenderer::setTextAnchor(const Vector2<float>& newTextAnchor)
         {
             textAnchor = newTextAnchor;
@@ -73,7 +83,8 @@ namespace ouzel
             if (needsMeshUpdate)
             {
                 indexBuffer->setData(indices.data(), static_cast<uint32_t>(getVectorSize(indices)));
-                vertexBuffer->setData(vertices.data(), static_cast<uint32_t>(getVectorSize(vertices)));
+                graphics::VertexLayout::COMPACT_2D.pack(vertices, vertexData);
+                vertexBuffer->setData(vertexData.data(), static_cast<uint32_t>(vertexData.size()));
 
                 needsMeshUpdate = false;
             }
@@ -84,6 +95,13 @@ namespace ouzel
             std::vector<std::vector<float>> fragmentShaderConstants(1);
             fragmentShaderConstants[0] = {std::begin(colorVector), std::end(colorVector)};
 
+            if (shader == distanceFieldShader)
+            {
+                float outlineColorVector[] = {outlineColor.normR(), outlineColor.normG(), outlineColor.normB(), outlineColor.normA() * opacity};
+                fragmentShaderConstants.push_back({std::begin(outlineColorVector), std::end(outlineColorVector)});
+                fragmentShaderConstants.push_back({outlineWidth});
+            }
+
             std::vector<std::vector<float>> vertexShaderConstants(1);
             vertexShaderConstants[0] = {std::begin(modelViewProj.m), std::end(modelViewProj.m)};
 
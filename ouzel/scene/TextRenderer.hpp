@@ -46,6 +46,13 @@ namespace ouzel
             inline Color getColor() const { return color; }
             void setColor(Color newColor);
 
+            // outline of distance field fonts, the width is in distance field units from 0 to 0.5
+            inline Color getOutlineColor() const { return outlineColor; }
+            inline void setOutlineColor(Color newOutlineColor) { outlineColor = newOutlineColor; }
+
+            inline float getOutlineWidth() const { return outlineWidth; }
+            inline void setOutlineWidth(float newOutlineWidth) { outlineWidth = newOutlineWidth; }
+
             inline const std::shared_ptr<graphics::Shader>& getShader() const { return shader; }
             inline void setShader(const std::shared_ptr<graphics::Shader>& newShader) { shader = newShader; }
 
@@ -54,8 +61,10 @@ namespace ouzel
 
         private:
             void updateText();
+            void updateShader();
 
             std::shared_ptr<graphics::Shader> shader;
+            std::shared_ptr<graphics::Shader> distanceFieldShader;
             std::shared_ptr<graphics::BlendState> blendState;
 
             std::shared_ptr<graphics::Buffer> indexBuffer;
@@ -71,8 +80,11 @@ namespace ouzel
 
             std::vector<uint16_t> indices;
             std::vector<graphics::Vertex> vertices;
+            std::vector<uint8_t> vertexData;
 
             Color color = Color::WHITE;
+            Color outlineColor = Color::BLACK;
+            float outlineWidth = 0.0F;
 
             bool needsMeshUpdate = false;
         };
@@ -1,5 +1,6 @@
 // Copyright 2015-2018 Elviss Strazdins. All rights reserved.
 
+#include <cstring>
 #include <stdexcept>
 #include "OBF.hpp"
 #include "Utils.hpp"
@@ -54,7 +55,7 @@ namespace ouzel
             if (buffer.size() - offset < sizeof(float))
                 throw std::runtime_error("Not enough data");
 
-            result = *reinterpret_cast<const float*>(buffer.data() + offset);
+            std::memcpy(&result, buffer.data() + offset, sizeof(result));
 
             return sizeof(result);
         }
@@ -64,7 +65,7 @@ namespace ouzel
             if (buffer.size() - offset < sizeof(double))
                 throw std::runtime_error("Not enough data");
 
-            result = *reinterpret_cast<const double*>(buffer.data() + offset);
+            std::memcpy(&result, buffer.data() + offset, sizeof(result));
 
             return sizeof(result);
         }
@@ -162,7 +163,7 @@ namespace ouzel
             return offset - originalOffset;
         }
 
-        static uint32_t readArray(const std::vector<uint8_t>& buffer, uint32_t offset, std::vector<Value>& result)
+        static uint32_t readIndexedObject(const std::vector<uint8_t>& buffer, uint32_t offset, std::map<uint32_t, Value>& result)
         {
             uint32_t originalOffset = offset;
 
@@ -173,6 +174,50 @@ namespace ouzel
 
             offset += sizeof(count);
 
+            // keys are stored in the table, each entry is followed by the offset of the value
+            if ((buffer.size() - offset) / (sizeof(uint32_t) * 2) < count)
+                throw std::runtime_error("Not enough data");
+
+            uint32_t tableOffset = offset;
+            offset += count * sizeof(uint32_t) * 2;
+
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                uint32_t key = decodeBigEndian<uint32_t>(buffer.data() + tableOffset + i * sizeof(uint32_t) * 2);
+
+                Value node;
+
+                uint32_t ret = node.decode(buffer, offset);
+
+                offset += ret;
+
+                result[key] = node;
+            }
+
+            return offset - originalOffset;
+        }
+
+        static uint32_t readArray(const std::vector<uint8_t>& buffer, uint32_t offset, std::vector<Value>& result,
+                                  bool indexed = false)
+        {
+            uint32_t originalOffset = offset;
+
+            if (buffer.size() - offset < sizeof(uint32_t))
+                throw std::runtime_error("Not enough data");
+
+            uint32_t count = decodeBigEndian<uint32_t>(buffer.data() + offset);
+
+            offset += sizeof(count);
+
+            if (indexed)
+            {
+                // the offset table is only needed for random access
+                if ((buffer.size() - offset) / sizeof(uint32_t) < count)
+                    throw std::runtime_error("Not enough data");
+
+                offset += count * sizeof(uint32_t);
+            }
+
             for (uint32_t i = 0; i < count; ++i)
             {
                 Value node;
@@ -186,7 +231,8 @@ namespace ouzel
             return offset - originalOffset;
         }
 
-        static uint32_t readDictionary(const std::vector<uint8_t>& buffer, uint32_t offset, std::map<std::string, Value>& result)
+        static uint32_t readDictionary(const std::vector<uint8_t>& buffer, uint32_t offset, std::map<std::string, Value>& result,
+                                       bool indexed = false)
         {
             uint32_t originalOffset = offset;
 
@@ -197,6 +243,14 @@ namespace ouzel
 
             offset += sizeof(count);
 
+            if (indexed)
+            {
+                if ((buffer.size() - offset) / sizeof(uint32_t) < count)
+                    throw std::runtime_error("Not enough data");
+
+                offset += count * sizeof(uint32_t);
+            }
+
             for (uint32_t i = 0; i < count; ++i)
             {
                 if (buffer.size() - offset < sizeof(uint16_t))
@@ -523,6 +577,27 @@ namespace ouzel
                     ret = readDictionary(buffer, offset, dictionaryValue);
                     break;
                 }
+                case Marker::INDEXED_ARRAY:
+                {
+                    type = Type::ARRAY;
+
+                    ret = readArray(buffer, offset, arrayValue, true);
+                    break;
+                }
+                case Marker::INDEXED_OBJECT:
+                {
+                    type = Type::OBJECT;
+
+                    ret = readIndexedObject(buffer, offset, objectValue);
+                    break;
+                }
+                case Marker::INDEXED_DICTIONARY:
+                {
+                    type = Type::DICTIONARY;
+
+                    ret = readDictionary(buffer, offset, dictionaryValue, true);
+                    break;
+                }
                 default:
                     throw std::runtime_error("Unsupported marker");
             }
@@ -36,7 +36,10 @@ namespace ouzel
                 BYTE_ARRAY,
                 OBJECT,
                 ARRAY,
-                DICTIONARY
+                DICTIONARY,
+                INDEXED_ARRAY,
+                INDEXED_OBJECT,
+                INDEXED_DICTIONARY
             };
 
             enum class Type
@@ -0,0 +1,535 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include "OBFSchema.hpp"
+
+namespace ouzel
+{
+    namespace obf
+    {
+        // bits are written starting from the least significant bit of each byte
+        class Schema::BitWriter final
+        {
+        public:
+            explicit BitWriter(std::vector<uint8_t>& initBuffer):
+                buffer(initBuffer), start(initBuffer.size())
+            {
+            }
+
+            inline size_t getPosition() const { return position; }
+            inline uint32_t getSize() const { return static_cast<uint32_t>(buffer.size() - start); }
+
+            void write(uint64_t value, uint32_t count)
+            {
+                while (count)
+                {
+                    size_t byteIndex = start + (position >> 3);
+                    uint32_t bitOffset = static_cast<uint32_t>(position & 7);
+                    if (byteIndex == buffer.size()) buffer.push_back(0);
+
+                    uint32_t n = std::min(8 - bitOffset, count);
+                    buffer[byteIndex] |= static_cast<uint8_t>((value & ((1U << n) - 1)) << bitOffset);
+                    value >>= n;
+                    count -= n;
+                    position += n;
+                }
+            }
+
+            void writeSize(uint32_t size)
+            {
+                while (size >= 0x80)
+                {
+                    write((size & 0x7F) | 0x80, 8);
+                    size >>= 7;
+                }
+
+                write(size, 8);
+            }
+
+            // discards everything written after the position
+            void rewind(size_t newPosition)
+            {
+                buffer.resize(start + (newPosition + 7) / 8);
+                if (newPosition & 7) buffer.back() &= static_cast<uint8_t>((1U << (newPosition & 7)) - 1);
+                position = newPosition;
+            }
+
+        private:
+            std::vector<uint8_t>& buffer;
+            size_t start;
+            size_t position = 0;
+        };
+
+        class Schema::BitReader final
+        {
+        public:
+            BitReader(const std::vector<uint8_t>& initBuffer, uint32_t initStart):
+                buffer(initBuffer), start(initStart)
+            {
+            }
+
+            inline uint32_t getSize() const { return static_cast<uint32_t>((position + 7) / 8); }
+
+            // number of bits left in the buffer
+            inline uint64_t getRemaining() const
+            {
+                uint64_t total = start < buffer.size() ? static_cast<uint64_t>(buffer.size() - start) * 8 : 0;
+                return total > position ? total - position : 0;
+            }
+
+            uint64_t read(uint32_t count)
+            {
+                uint64_t result = 0;
+                uint32_t shift = 0;
+
+                while (count)
+                {
+                    size_t byteIndex = start + (position >> 3);
+                    uint32_t bitOffset = static_cast<uint32_t>(position & 7);
+                    if (byteIndex >= buffer.size())
+                        throw std::runtime_error("Not enough data");
+
+                    uint32_t n = std::min(8 - bitOffset, count);
+                    result |= static_cast<uint64_t>((buffer[byteIndex] >> bitOffset) & ((1U << n) - 1)) << shift;
+                    shift += n;
+                    count -= n;
+                    position += n;
+                }
+
+                return result;
+            }
+
+            uint32_t readSize()
+            {
+                uint32_t result = 0;
+
+                for (uint32_t shift = 0; shift < 32; shift += 7)
+                {
+                    uint32_t byte = static_cast<uint32_t>(read(8));
+                    result |= (byte & 0x7F) << shift;
+                    if (!(byte & 0x80)) return result;
+                }
+
+                throw std::runtime_error("Invalid size");
+            }
+
+        private:
+            const std::vector<uint8_t>& buffer;
+            size_t start;
+            size_t position = 0;
+        };
+
+        static inline uint64_t getMask(uint32_t bits)
+        {
+            return bits >= 64 ? std::numeric_limits<uint64_t>::max() : (uint64_t(1) << bits) - 1;
+        }
+
+        static bool matches(Schema::Type type, const Value& value)
+        {
+            switch (type)
+            {
+                case Schema::Type::INT: return value.getType() == Value::Type::INT;
+                case Schema::Type::FLOAT:
+                case Schema::Type::QUANTIZED_FLOAT: return value.isFloatType();
+                case Schema::Type::STRING: return value.getType() == Value::Type::STRING;
+                case Schema::Type::BYTE_ARRAY: return value.getType() == Value::Type::BYTE_ARRAY;
+                case Schema::Type::OBJECT: return value.getType() == Value::Type::OBJECT;
+                case Schema::Type::ARRAY: return value.getType() == Value::Type::ARRAY;
+                default: return false;
+            }
+        }
+
+        static uint32_t getFloatBits(const Value& value)
+        {
+            float f = value.isFloatType() ? value.as<float>() : 0.0F;
+            uint32_t result;
+            std::memcpy(&result, &f, sizeof(result));
+            return result;
+        }
+
+        static const Value emptyValue;
+
+        Schema Schema::integer(uint32_t bits, bool isSigned)
+        {
+            if (bits == 0 || bits > 64)
+                throw std::out_of_range("Invalid bit count");
+
+            Schema result(Type::INT);
+            result.bits = bits;
+            result.isSigned = isSigned;
+            return result;
+        }
+
+        Schema Schema::floatingPoint()
+        {
+            Schema result(Type::FLOAT);
+            result.bits = 32;
+            return result;
+        }
+
+        Schema Schema::quantized(double minimum, double maximum, double precision)
+        {
+            if (!(maximum > minimum) || !(precision > 0.0))
+                throw std::out_of_range("Invalid quantization range");
+
+            double steps = std::ceil((maximum - minimum) / precision);
+
+            Schema result(Type::QUANTIZED_FLOAT);
+            result.bits = 1;
+            while (result.bits < 32 && static_cast<double>(getMask(result.bits)) < steps) ++result.bits;
+            result.minimum = minimum;
+            result.precision = precision;
+            return result;
+        }
+
+        Schema Schema::string(uint32_t maximumSize)
+        {
+            Schema result(Type::STRING);
+            result.maximumSize = maximumSize;
+            return result;
+        }
+
+        Schema Schema::byteArray(uint32_t maximumSize)
+        {
+            Schema result(Type::BYTE_ARRAY);
+            result.maximumSize = maximumSize;
+            return result;
+        }
+
+        Schema Schema::object()
+        {
+            return Schema(Type::OBJECT);
+        }
+
+        Schema Schema::array(const Schema& element, uint32_t maximumSize)
+        {
+            Schema result(Type::ARRAY);
+            result.bits = 1;
+            while (result.bits < 32 && getMask(result.bits) < maximumSize) ++result.bits;
+            result.maximumSize = maximumSize;
+            result.element.push_back(element);
+            return result;
+        }
+
+        Schema& Schema::add(uint32_t key, const Schema& field)
+        {
+            if (type != Type::OBJECT)
+                throw std::runtime_error("Fields can be added only to objects");
+
+            fields.push_back(std::make_pair(key, field));
+            return *this;
+        }
+
+        uint32_t Schema::encodeDelta(const Value& base, const Value& current, std::vector<uint8_t>& buffer) const
+        {
+            BitWriter writer(buffer);
+            encodeField(&base, current, writer);
+            return writer.getSize();
+        }
+
+        uint32_t Schema::decodeDelta(const std::vector<uint8_t>& buffer, Value& value, uint32_t offset) const
+        {
+            BitReader reader(buffer, offset);
+            decodeField(value, true, reader);
+            return reader.getSize();
+        }
+
+        uint64_t Schema::quantize(const Value& value) const
+        {
+            double v = value.isFloatType() ? value.as<double>() : 0.0;
+            double steps = std::round((v - minimum) / precision);
+            if (!(steps > 0.0)) return 0; // also NaN
+            return std::min(static_cast<uint64_t>(std::min(steps, 4294967295.0)), getMask(bits));
+        }
+
+        uint64_t Schema::getMinimumBits() const
+        {
+            switch (type)
+            {
+                case Type::INT:
+                case Type::FLOAT:
+                case Type::QUANTIZED_FLOAT:
+                case Type::ARRAY:
+                    return bits;
+                case Type::STRING:
+                case Type::BYTE_ARRAY:
+                    return 8; // the size
+                case Type::OBJECT:
+                {
+                    uint64_t result = 0;
+                    for (const std::pair<uint32_t, Schema>& field : fields)
+                        result += field.second.getMinimumBits();
+                    return result;
+                }
+                default:
+                    return 0;
+            }
+        }
+
+        // A field whose base is present starts with a bit telling whether it changed. A field without a base
+        // (or with a base of a different type) is written in full. Returns false if nothing changed.
+        bool Schema::encodeField(const Value* base, const Value& current, BitWriter& writer) const
+        {
+            if (base && !matches(type, *base)) base = nullptr;
+
+            switch (type)
+            {
+                case Type::INT:
+                case Type::FLOAT:
+                case Type::QUANTIZED_FLOAT:
+                {
+                    uint64_t value;
+                    uint64_t baseValue = 0;
+
+                    if (type == Type::INT)
+                    {
+                        value = (current.isIntType() ? current.as<uint64_t>() : 0) & getMask(bits);
+                        if (base) baseValue = base->as<uint64_t>() & getMask(bits);
+                    }
+                    else if (type == Type::FLOAT)
+                    {
+                        value = getFloatBits(current);
+                        if (base) baseValue = getFloatBits(*base);
+                    }
+                    else
+                    {
+                        value = quantize(current);
+                        if (base) baseValue = quantize(*base);
+                    }
+
+                    if (base)
+                    {
+                        if (value == baseValue)
+                        {
+                            writer.write(0, 1);
+                            return false;
+                        }
+
+                        writer.write(1, 1);
+                    }
+
+                    writer.write(value, bits);
+                    return true;
+                }
+                case Type::STRING:
+                {
+                    static const std::string emptyString;
+                    const std::string& value = current.isStringType() ? current.as<std::string>() : emptyString;
+
+                    if (value.size() > maximumSize)
+                        throw std::runtime_error("String is too long");
+
+                    if (base)
+                    {
+                        if (value == base->as<std::string>())
+                        {
+                            writer.write(0, 1);
+                            return false;
+                        }
+
+                        writer.write(1, 1);
+                    }
+
+                    writer.writeSize(static_cast<uint32_t>(value.size()));
+                    for (char c : value) writer.write(static_cast<uint8_t>(c), 8);
+                    return true;
+                }
+                case Type::BYTE_ARRAY:
+                {
+                    static const Value::ByteArray emptyByteArray;
+                    const Value::ByteArray& value = current.getType() == Value::Type::BYTE_ARRAY ?
+                        current.as<Value::ByteArray>() : emptyByteArray;
+
+                    if (value.size() > maximumSize)
+                        throw std::runtime_error("Byte array is too large");
+
+                    if (base)
+                    {
+                        if (value == base->as<Value::ByteArray>())
+                        {
+                            writer.write(0, 1);
+                            return false;
+                        }
+
+                        writer.write(1, 1);
+                    }
+
+                    writer.writeSize(static_cast<uint32_t>(value.size()));
+                    for (uint8_t b : value) writer.write(b, 8);
+                    return true;
+                }
+                case Type::OBJECT:
+                {
+                    size_t position = writer.getPosition();
+                    if (base) writer.write(1, 1);
+
+                    const Value::Object* baseObject = base ? &base->as<Value::Object>() : nullptr;
+                    const Value::Object* currentObject = current.getType() == Value::Type::OBJECT ?
+                        &current.as<Value::Object>() : nullptr;
+
+                    bool changed = false;
+
+                    for (const std::pair<uint32_t, Schema>& field : fields)
+                    {
+                        const Value* baseField = nullptr;
+                        if (baseObject)
+                        {
+                            auto i = baseObject->find(field.first);
+                            if (i != baseObject->end()) baseField = &i->second;
+                        }
+
+                        const Value* currentField = &emptyValue;
+                        if (currentObject)
+                        {
+                            auto i = currentObject->find(field.first);
+                            if (i != currentObject->end()) currentField = &i->second;
+                        }
+
+                        if (field.second.encodeField(baseField, *currentField, writer))
+                            changed = true;
+                    }
+
+                    if (base && !changed)
+                    {
+                        writer.rewind(position);
+                        writer.write(0, 1);
+                        return false;
+                    }
+
+                    return true;
+                }
+                case Type::ARRAY:
+                {
+                    static const Value::Array emptyArray;
+                    const Value::Array& currentArray = current.getType() == Value::Type::ARRAY ?
+                        current.as<Value::Array>() : emptyArray;
+                    const Value::Array& baseArray = base ? base->as<Value::Array>() : emptyArray;
+
+                    if (currentArray.size() > maximumSize)
+                        throw std::runtime_error("Array is too large");
+
+                    size_t position = writer.getPosition();
+                    if (base) writer.write(1, 1);
+
+                    writer.write(currentArray.size(), bits);
+                    bool changed = currentArray.size() != baseArray.size();
+
+                    for (size_t i = 0; i < currentArray.size(); ++i)
+                    {
+                        const Value* baseElement = i < baseArray.size() ? &baseArray[i] : nullptr;
+                        if (element.front().encodeField(baseElement, currentArray[i], writer))
+                            changed = true;
+                    }
+
+                    if (base && !changed)
+                    {
+                        writer.rewind(position);
+                        writer.write(0, 1);
+                        return false;
+                    }
+
+                    return true;
+                }
+                default:
+                    return false;
+            }
+        }
+
+        void Schema::decodeField(Value& value, bool present, BitReader& reader) const
+        {
+            // mirrors the base check of the encoder, because the value equals the base
+            if (present && !matches(type, value)) present = false;
+
+            if (present && !reader.read(1)) return;
+
+            switch (type)
+            {
+                case Type::INT:
+                {
+                    uint64_t result = reader.read(bits);
+                    if (isSigned && bits < 64 && (result >> (bits - 1)) & 1)
+                        result |= ~getMask(bits);
+                    value = result;
+                    break;
+                }
+                case Type::FLOAT:
+                {
+                    uint32_t floatBits = static_cast<uint32_t>(reader.read(32));
+                    float result;
+                    std::memcpy(&result, &floatBits, sizeof(result));
+                    value = result;
+                    break;
+                }
+                case Type::QUANTIZED_FLOAT:
+                    value = minimum + static_cast<double>(reader.read(bits)) * precision;
+                    break;
+                case Type::STRING:
+                {
+                    uint32_t size = reader.readSize();
+                    if (size > maximumSize)
+                        throw std::runtime_error("String is too long");
+                    if (static_cast<uint64_t>(size) * 8 > reader.getRemaining())
+                        throw std::runtime_error("Not enough data");
+
+                    std::string result(size, '\0');
+                    for (char& c : result) c = static_cast<char>(reader.read(8));
+                    value = result;
+                    break;
+                }
+                case Type::BYTE_ARRAY:
+                {
+                    uint32_t size = reader.readSize();
+                    if (size > maximumSize)
+                        throw std::runtime_error("Byte array is too large");
+                    if (static_cast<uint64_t>(size) * 8 > reader.getRemaining())
+                        throw std::runtime_error("Not enough data");
+
+                    Value::ByteArray& result = value.as<Value::ByteArray>();
+                    result.resize(size);
+                    for (uint8_t& b : result) b = static_cast<uint8_t>(reader.read(8));
+                    break;
+                }
+                case Type::OBJECT:
+                {
+                    if (!present) value = Value::Type::OBJECT;
+                    Value::Object& object = value.as<Value::Object>();
+
+                    for (const std::pair<uint32_t, Schema>& field : fields)
+                    {
+                        auto i = object.find(field.first);
+                        bool fieldPresent = present && i != object.end();
+                        Value& fieldValue = (i != object.end()) ? i->second : object[field.first];
+                        field.second.decodeField(fieldValue, fieldPresent, reader);
+                    }
+                    break;
+                }
+                case Type::ARRAY:
+                {
+                    if (!present) value = Value::Type::ARRAY;
+                    Value::Array& array = value.as<Value::Array>();
+
+                    size_t baseSize = array.size();
+                    uint64_t size = reader.read(bits);
+                    if (size > maximumSize)
+                        throw std::runtime_error("Array is too large");
+                    // the elements without a base are written in full
+                    if (size > baseSize &&
+                        (size - baseSize) * element.front().getMinimumBits() > reader.getRemaining())
+                        throw std::runtime_error("Not enough data");
+
+                    array.resize(static_cast<size_t>(size));
+
+                    for (size_t i = 0; i < array.size(); ++i)
+                        element.front().decodeField(array[i], i < baseSize, reader);
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+    } // namespace obf
+} // namespace ouzel
@@ -0,0 +1,78 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_UTILS_OBFSCHEMA_HPP
+#define OUZEL_UTILS_OBFSCHEMA_HPP
+
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+#include "utils/OBF.hpp"
+
+namespace ouzel
+{
+    namespace obf
+    {
+        // Describes the layout of a Value for bit-packed delta encoding. Every field that did not change
+        // since the base value costs one bit, integers are stored in the given number of bits and floats
+        // are quantized to the given precision.
+        class Schema final
+        {
+        public:
+            enum class Type
+            {
+                INT,
+                FLOAT, // full precision 32-bit float
+                QUANTIZED_FLOAT,
+                STRING,
+                BYTE_ARRAY,
+                OBJECT,
+                ARRAY
+            };
+
+            static Schema integer(uint32_t bits = 64, bool isSigned = false);
+            static Schema floatingPoint();
+            static Schema quantized(double minimum, double maximum, double precision);
+            // the maximum sizes are also enforced when decoding, so a corrupt delta can not make the decoder
+            // allocate more than the schema allows
+            static Schema string(uint32_t maximumSize = std::numeric_limits<uint32_t>::max());
+            static Schema byteArray(uint32_t maximumSize = std::numeric_limits<uint32_t>::max());
+            static Schema object();
+            static Schema array(const Schema& element, uint32_t maximumSize);
+
+            // adds a field of an object
+            Schema& add(uint32_t key, const Schema& field);
+
+            inline Type getType() const { return type; }
+            inline uint32_t getBits() const { return bits; }
+
+            // appends the difference between base and current to the buffer, returns the number of bytes written
+            uint32_t encodeDelta(const Value& base, const Value& current, std::vector<uint8_t>& buffer) const;
+            // updates the value, which must be equal to the base of the delta, in place
+            uint32_t decodeDelta(const std::vector<uint8_t>& buffer, Value& value, uint32_t offset = 0) const;
+
+        private:
+            class BitWriter;
+            class BitReader;
+
+            explicit Schema(Type initType): type(initType) {}
+
+            bool encodeField(const Value* base, const Value& current, BitWriter& writer) const;
+            void decodeField(Value& value, bool present, BitReader& reader) const;
+            uint64_t quantize(const Value& value) const;
+            // the least number of bits a field without a base can be encoded in
+            uint64_t getMinimumBits() const;
+
+            Type type;
+            uint32_t bits = 0;
+            uint32_t maximumSize = 0;
+            bool isSigned = false;
+            double minimum = 0.0;
+            double precision = 1.0;
+            std::vector<std::pair<uint32_t, Schema>> fields;
+            std::vector<Schema> element;
+        };
+    } // namespace obf
+} // namespace ouzel
+
+#endif // OUZEL_UTILS_OBFSCHEMA_HPP
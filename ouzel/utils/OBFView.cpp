@@ -0,0 +1,535 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#include <stdexcept>
+#include "OBFView.hpp"
+#include "Utils.hpp"
+
+namespace ouzel
+{
+    namespace obf
+    {
+        static constexpr uint32_t MAX_DEPTH = 256;
+
+        static inline void checkSize(uint32_t size, uint32_t offset, uint64_t needed)
+        {
+            if (size - offset < needed)
+                throw std::runtime_error("Not enough data");
+        }
+
+        static Value::Type getMarkerType(Value::Marker marker)
+        {
+            switch (marker)
+            {
+                case Value::Marker::NONE: return Value::Type::NONE;
+                case Value::Marker::INT8:
+                case Value::Marker::INT16:
+                case Value::Marker::INT32:
+                case Value::Marker::INT64: return Value::Type::INT;
+                case Value::Marker::FLOAT: return Value::Type::FLOAT;
+                case Value::Marker::DOUBLE: return Value::Type::DOUBLE;
+                case Value::Marker::STRING:
+                case Value::Marker::LONG_STRING: return Value::Type::STRING;
+                case Value::Marker::BYTE_ARRAY: return Value::Type::BYTE_ARRAY;
+                case Value::Marker::OBJECT:
+                case Value::Marker::INDEXED_OBJECT: return Value::Type::OBJECT;
+                case Value::Marker::ARRAY:
+                case Value::Marker::INDEXED_ARRAY: return Value::Type::ARRAY;
+                case Value::Marker::DICTIONARY:
+                case Value::Marker::INDEXED_DICTIONARY: return Value::Type::DICTIONARY;
+                default:
+                    throw std::runtime_error("Unsupported marker");
+            }
+        }
+
+        static inline uint32_t getTableEntrySize(Value::Marker marker)
+        {
+            switch (marker)
+            {
+                case Value::Marker::INDEXED_ARRAY:
+                case Value::Marker::INDEXED_DICTIONARY: return sizeof(uint32_t);
+                case Value::Marker::INDEXED_OBJECT: return sizeof(uint32_t) * 2;
+                default: return 0;
+            }
+        }
+
+        static inline int compareKeys(const uint8_t* key1, uint32_t length1, const char* key2, uint32_t length2)
+        {
+            int result = std::memcmp(key1, key2, (length1 < length2) ? length1 : length2);
+            if (result != 0) return result;
+            return (length1 < length2) ? -1 : (length1 > length2) ? 1 : 0;
+        }
+
+        View::View(const uint8_t* initData, uint32_t initSize):
+            data(initData), size(initSize)
+        {
+            validate(data, size, 0, 0);
+            marker = static_cast<Value::Marker>(data[0]);
+            type = getMarkerType(marker);
+        }
+
+        View::View(const uint8_t* initData, uint32_t initSize, uint32_t initOffset):
+            data(initData), size(initSize), offset(initOffset),
+            marker(static_cast<Value::Marker>(data[offset])),
+            type(getMarkerType(marker))
+        {
+        }
+
+        uint32_t View::validate(const uint8_t* data, uint32_t size, uint32_t offset, uint32_t depth)
+        {
+            if (depth > MAX_DEPTH)
+                throw std::runtime_error("Maximum nesting depth exceeded");
+
+            uint32_t originalOffset = offset;
+
+            checkSize(size, offset, 1);
+            Value::Marker marker = static_cast<Value::Marker>(data[offset]);
+            offset += 1;
+
+            switch (marker)
+            {
+                case Value::Marker::NONE:
+                    break;
+                case Value::Marker::INT8:
+                    checkSize(size, offset, sizeof(uint8_t));
+                    offset += sizeof(uint8_t);
+                    break;
+                case Value::Marker::INT16:
+                    checkSize(size, offset, sizeof(uint16_t));
+                    offset += sizeof(uint16_t);
+                    break;
+                case Value::Marker::INT32:
+                    checkSize(size, offset, sizeof(uint32_t));
+                    offset += sizeof(uint32_t);
+                    break;
+                case Value::Marker::INT64:
+                    checkSize(size, offset, sizeof(uint64_t));
+                    offset += sizeof(uint64_t);
+                    break;
+                case Value::Marker::FLOAT:
+                    checkSize(size, offset, sizeof(float));
+                    offset += sizeof(float);
+                    break;
+                case Value::Marker::DOUBLE:
+                    checkSize(size, offset, sizeof(double));
+                    offset += sizeof(double);
+                    break;
+                case Value::Marker::STRING:
+                {
+                    checkSize(size, offset, sizeof(uint16_t));
+                    uint16_t length = decodeBigEndian<uint16_t>(data + offset);
+                    offset += sizeof(length);
+                    checkSize(size, offset, length);
+                    offset += length;
+                    break;
+                }
+                case Value::Marker::LONG_STRING:
+                case Value::Marker::BYTE_ARRAY:
+                {
+                    checkSize(size, offset, sizeof(uint32_t));
+                    uint32_t length = decodeBigEndian<uint32_t>(data + offset);
+                    offset += sizeof(length);
+                    checkSize(size, offset, length);
+                    offset += length;
+                    break;
+                }
+                case Value::Marker::OBJECT:
+                case Value::Marker::ARRAY:
+                case Value::Marker::DICTIONARY:
+                {
+                    checkSize(size, offset, sizeof(uint32_t));
+                    uint32_t count = decodeBigEndian<uint32_t>(data + offset);
+                    offset += sizeof(count);
+
+                    for (uint32_t i = 0; i < count; ++i)
+                    {
+                        if (marker == Value::Marker::OBJECT)
+                        {
+                            checkSize(size, offset, sizeof(uint32_t));
+                            offset += sizeof(uint32_t);
+                        }
+                        else if (marker == Value::Marker::DICTIONARY)
+                        {
+                            checkSize(size, offset, sizeof(uint16_t));
+                            uint16_t length = decodeBigEndian<uint16_t>(data + offset);
+                            offset += sizeof(length);
+                            checkSize(size, offset, length);
+                            offset += length;
+                        }
+
+                        offset += validate(data, size, offset, depth + 1);
+                    }
+                    break;
+                }
+                case Value::Marker::INDEXED_ARRAY:
+                case Value::Marker::INDEXED_OBJECT:
+                case Value::Marker::INDEXED_DICTIONARY:
+                {
+                    checkSize(size, offset, sizeof(uint32_t));
+                    uint32_t count = decodeBigEndian<uint32_t>(data + offset);
+                    offset += sizeof(count);
+
+                    uint32_t entrySize = getTableEntrySize(marker);
+                    checkSize(size, offset, static_cast<uint64_t>(count) * entrySize);
+                    const uint8_t* table = data + offset;
+                    offset += count * entrySize;
+
+                    uint32_t elementsOffset = offset;
+
+                    // entries must be stored in the order of the table and keys must be sorted for the binary search to work
+                    for (uint32_t i = 0; i < count; ++i)
+                    {
+                        const uint8_t* tableEntry = table + i * entrySize;
+                        uint32_t entryOffset = decodeBigEndian<uint32_t>(tableEntry + entrySize - sizeof(uint32_t));
+
+                        if (entryOffset != offset - elementsOffset)
+                            throw std::runtime_error("Invalid offset table");
+
+                        if (marker == Value::Marker::INDEXED_OBJECT)
+                        {
+                            if (i > 0 && decodeBigEndian<uint32_t>(tableEntry - entrySize) >= decodeBigEndian<uint32_t>(tableEntry))
+                                throw std::runtime_error("Object keys are not sorted");
+                        }
+                        else if (marker == Value::Marker::INDEXED_DICTIONARY)
+                        {
+                            checkSize(size, offset, sizeof(uint16_t));
+                            uint16_t length = decodeBigEndian<uint16_t>(data + offset);
+                            checkSize(size, offset + sizeof(uint16_t), length);
+
+                            if (i > 0)
+                            {
+                                uint32_t previousOffset = elementsOffset + decodeBigEndian<uint32_t>(tableEntry - entrySize);
+                                uint16_t previousLength = decodeBigEndian<uint16_t>(data + previousOffset);
+                                if (compareKeys(data + previousOffset + sizeof(uint16_t), previousLength,
+                                                reinterpret_cast<const char*>(data + offset + sizeof(uint16_t)), length) >= 0)
+                                    throw std::runtime_error("Dictionary keys are not sorted");
+                            }
+
+                            offset += sizeof(uint16_t) + length;
+                        }
+
+                        offset += validate(data, size, offset, depth + 1);
+                    }
+                    break;
+                }
+                default:
+                    throw std::runtime_error("Unsupported marker");
+            }
+
+            return offset - originalOffset;
+        }
+
+        uint32_t View::skip(const uint8_t* data, uint32_t offset)
+        {
+            uint32_t originalOffset = offset;
+
+            Value::Marker marker = static_cast<Value::Marker>(data[offset]);
+            offset += 1;
+
+            switch (marker)
+            {
+                case Value::Marker::NONE: break;
+                case Value::Marker::INT8: offset += sizeof(uint8_t); break;
+                case Value::Marker::INT16: offset += sizeof(uint16_t); break;
+                case Value::Marker::INT32: offset += sizeof(uint32_t); break;
+                case Value::Marker::INT64: offset += sizeof(uint64_t); break;
+                case Value::Marker::FLOAT: offset += sizeof(float); break;
+                case Value::Marker::DOUBLE: offset += sizeof(double); break;
+                case Value::Marker::STRING:
+                    offset += sizeof(uint16_t) + decodeBigEndian<uint16_t>(data + offset);
+                    break;
+                case Value::Marker::LONG_STRING:
+                case Value::Marker::BYTE_ARRAY:
+                    offset += sizeof(uint32_t) + decodeBigEndian<uint32_t>(data + offset);
+                    break;
+                case Value::Marker::OBJECT:
+                case Value::Marker::ARRAY:
+                case Value::Marker::DICTIONARY:
+                {
+                    uint32_t count = decodeBigEndian<uint32_t>(data + offset);
+                    offset += sizeof(count);
+
+                    for (uint32_t i = 0; i < count; ++i)
+                    {
+                        if (marker == Value::Marker::OBJECT)
+                            offset += sizeof(uint32_t);
+                        else if (marker == Value::Marker::DICTIONARY)
+                            offset += sizeof(uint16_t) + decodeBigEndian<uint16_t>(data + offset);
+
+                        offset += skip(data, offset);
+                    }
+                    break;
+                }
+                case Value::Marker::INDEXED_ARRAY:
+                case Value::Marker::INDEXED_OBJECT:
+                case Value::Marker::INDEXED_DICTIONARY:
+                {
+                    uint32_t count = decodeBigEndian<uint32_t>(data + offset);
+                    offset += sizeof(count);
+
+                    uint32_t entrySize = getTableEntrySize(marker);
+                    const uint8_t* table = data + offset;
+                    offset += count * entrySize;
+
+                    // only the last element has to be skipped
+                    if (count > 0)
+                    {
+                        offset += decodeBigEndian<uint32_t>(table + count * entrySize - sizeof(uint32_t));
+
+                        if (marker == Value::Marker::INDEXED_DICTIONARY)
+                            offset += sizeof(uint16_t) + decodeBigEndian<uint16_t>(data + offset);
+
+                        offset += skip(data, offset);
+                    }
+                    break;
+                }
+                default:
+                    break;
+            }
+
+            return offset - originalOffset;
+        }
+
+        uint32_t View::getEncodedSize() const
+        {
+            return data ? skip(data, offset) : 0;
+        }
+
+        uint64_t View::getInt() const
+        {
+            const uint8_t* value = data + offset + 1;
+
+            switch (marker)
+            {
+                case Value::Marker::INT8: return *value;
+                case Value::Marker::INT16: return decodeBigEndian<uint16_t>(value);
+                case Value::Marker::INT32: return decodeBigEndian<uint32_t>(value);
+                case Value::Marker::INT64: return decodeBigEndian<uint64_t>(value);
+                default: return 0;
+            }
+        }
+
+        double View::getDouble() const
+        {
+            const uint8_t* value = data + offset + 1;
+
+            // the data is not guaranteed to be aligned
+            if (marker == Value::Marker::FLOAT)
+            {
+                float result;
+                std::memcpy(&result, value, sizeof(result));
+                return result;
+            }
+            else if (marker == Value::Marker::DOUBLE)
+            {
+                double result;
+                std::memcpy(&result, value, sizeof(result));
+                return result;
+            }
+            else
+                return 0.0;
+        }
+
+        const char* View::getStringData() const
+        {
+            assert(type == Value::Type::STRING);
+
+            if (marker == Value::Marker::STRING)
+                return reinterpret_cast<const char*>(data + offset + 1 + sizeof(uint16_t));
+            else
+                return reinterpret_cast<const char*>(data + offset + 1 + sizeof(uint32_t));
+        }
+
+        uint32_t View::getStringLength() const
+        {
+            assert(type == Value::Type::STRING);
+
+            if (marker == Value::Marker::STRING)
+                return decodeBigEndian<uint16_t>(data + offset + 1);
+            else
+                return decodeBigEndian<uint32_t>(data + offset + 1);
+        }
+
+        const uint8_t* View::getByteArrayData() const
+        {
+            assert(type == Value::Type::BYTE_ARRAY);
+
+            return data + offset + 1 + sizeof(uint32_t);
+        }
+
+        uint32_t View::getByteArraySize() const
+        {
+            assert(type == Value::Type::BYTE_ARRAY);
+
+            return decodeBigEndian<uint32_t>(data + offset + 1);
+        }
+
+        uint32_t View::getSize() const
+        {
+            assert(type == Value::Type::OBJECT || type == Value::Type::ARRAY || type == Value::Type::DICTIONARY);
+
+            if (type != Value::Type::OBJECT && type != Value::Type::ARRAY && type != Value::Type::DICTIONARY)
+                return 0;
+
+            return decodeBigEndian<uint32_t>(data + offset + 1);
+        }
+
+        uint32_t View::getElementOffset(uint32_t index) const
+        {
+            uint32_t entryOffset = offset + 1 + sizeof(uint32_t);
+
+            if (isIndexed())
+            {
+                uint32_t count = decodeBigEndian<uint32_t>(data + offset + 1);
+                uint32_t entrySize = getTableEntrySize(marker);
+                const uint8_t* tableEntry = data + entryOffset + index * entrySize;
+
+                return entryOffset + count * entrySize + decodeBigEndian<uint32_t>(tableEntry + entrySize - sizeof(uint32_t));
+            }
+
+            for (uint32_t i = 0; i < index; ++i)
+            {
+                if (marker == Value::Marker::OBJECT)
+                    entryOffset += sizeof(uint32_t);
+                else if (marker == Value::Marker::DICTIONARY)
+                    entryOffset += sizeof(uint16_t) + decodeBigEndian<uint16_t>(data + entryOffset);
+
+                entryOffset += skip(data, entryOffset);
+            }
+
+            return entryOffset;
+        }
+
+        View View::getElement(uint32_t index) const
+        {
+            if (index >= getSize()) return View();
+
+            uint32_t elementOffset = getElementOffset(index);
+
+            if (marker == Value::Marker::OBJECT)
+                elementOffset += sizeof(uint32_t);
+            else if (marker == Value::Marker::DICTIONARY || marker == Value::Marker::INDEXED_DICTIONARY)
+                elementOffset += sizeof(uint16_t) + decodeBigEndian<uint16_t>(data + elementOffset);
+
+            return View(data, size, elementOffset);
+        }
+
+        uint32_t View::getObjectKey(uint32_t index) const
+        {
+            assert(type == Value::Type::OBJECT);
+            assert(index < getSize());
+
+            if (marker == Value::Marker::INDEXED_OBJECT)
+                return decodeBigEndian<uint32_t>(data + offset + 1 + sizeof(uint32_t) + index * sizeof(uint32_t) * 2);
+            else
+                return decodeBigEndian<uint32_t>(data + getElementOffset(index));
+        }
+
+        const char* View::getDictionaryKey(uint32_t index, uint32_t& length) const
+        {
+            assert(type == Value::Type::DICTIONARY);
+            assert(index < getSize());
+
+            uint32_t entryOffset = getElementOffset(index);
+            length = decodeBigEndian<uint16_t>(data + entryOffset);
+            return reinterpret_cast<const char*>(data + entryOffset + sizeof(uint16_t));
+        }
+
+        View View::operator[](uint32_t key) const
+        {
+            assert(type == Value::Type::OBJECT || type == Value::Type::ARRAY);
+
+            if (type == Value::Type::ARRAY)
+                return getElement(key);
+            else if (marker == Value::Marker::INDEXED_OBJECT)
+            {
+                uint32_t count = getSize();
+                const uint8_t* table = data + offset + 1 + sizeof(uint32_t);
+                uint32_t first = 0;
+                uint32_t last = count;
+
+                while (first < last)
+                {
+                    uint32_t middle = first + (last - first) / 2;
+                    uint32_t middleKey = decodeBigEndian<uint32_t>(table + middle * sizeof(uint32_t) * 2);
+
+                    if (middleKey == key)
+                        return getElement(middle);
+                    else if (middleKey < key)
+                        first = middle + 1;
+                    else
+                        last = middle;
+                }
+            }
+            else if (marker == Value::Marker::OBJECT)
+            {
+                uint32_t count = getSize();
+                uint32_t entryOffset = offset + 1 + sizeof(uint32_t);
+
+                for (uint32_t i = 0; i < count; ++i)
+                {
+                    uint32_t entryKey = decodeBigEndian<uint32_t>(data + entryOffset);
+                    entryOffset += sizeof(uint32_t);
+
+                    if (entryKey == key)
+                        return View(data, size, entryOffset);
+
+                    entryOffset += skip(data, entryOffset);
+                }
+            }
+
+            return View();
+        }
+
+        bool View::hasElement(uint32_t key) const
+        {
+            return (*this)[key].type != Value::Type::NONE;
+        }
+
+        View View::find(const char* key, uint32_t length) const
+        {
+            assert(type == Value::Type::DICTIONARY);
+
+            if (marker == Value::Marker::INDEXED_DICTIONARY)
+            {
+                uint32_t first = 0;
+                uint32_t last = getSize();
+
+                while (first < last)
+                {
+                    uint32_t middle = first + (last - first) / 2;
+                    uint32_t entryOffset = getElementOffset(middle);
+                    uint16_t entryLength = decodeBigEndian<uint16_t>(data + entryOffset);
+                    int result = compareKeys(data + entryOffset + sizeof(uint16_t), entryLength, key, length);
+
+                    if (result == 0)
+                        return View(data, size, entryOffset + sizeof(uint16_t) + entryLength);
+                    else if (result < 0)
+                        first = middle + 1;
+                    else
+                        last = middle;
+                }
+            }
+            else if (marker == Value::Marker::DICTIONARY)
+            {
+                uint32_t count = getSize();
+                uint32_t entryOffset = offset + 1 + sizeof(uint32_t);
+
+                for (uint32_t i = 0; i < count; ++i)
+                {
+                    uint16_t entryLength = decodeBigEndian<uint16_t>(data + entryOffset);
+                    entryOffset += sizeof(uint16_t);
+
+                    bool found = compareKeys(data + entryOffset, entryLength, key, length) == 0;
+                    entryOffset += entryLength;
+
+                    if (found)
+                        return View(data, size, entryOffset);
+
+                    entryOffset += skip(data, entryOffset);
+                }
+            }
+
+            return View();
+        }
+    } // namespace obf
+} // namespace ouzel
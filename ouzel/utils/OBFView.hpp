@@ -0,0 +1,121 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_UTILS_OBFVIEW_HPP
+#define OUZEL_UTILS_OBFVIEW_HPP
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "utils/OBF.hpp"
+
+namespace ouzel
+{
+    namespace obf
+    {
+        // Non-owning, read-only view of an encoded OBF value.
+        // The buffer is validated once on construction, after that all accessors work directly on the
+        // encoded data without allocating. Elements of indexed arrays are accessed in O(1), keys of
+        // indexed objects and dictionaries in O(log n), plain containers are scanned linearly.
+        // The buffer must outlive the view and all the views returned by it.
+        class View final
+        {
+        public:
+            View() {}
+            View(const uint8_t* initData, uint32_t initSize);
+            explicit View(const std::vector<uint8_t>& buffer):
+                View(buffer.data(), static_cast<uint32_t>(buffer.size()))
+            {
+            }
+
+            inline Value::Type getType() const { return type; }
+            inline bool isIntType() const { return type == Value::Type::INT; }
+            inline bool isFloatType() const { return type == Value::Type::FLOAT || type == Value::Type::DOUBLE; }
+            inline bool isStringType() const { return type == Value::Type::STRING; }
+            inline bool isIndexed() const
+            {
+                return marker == Value::Marker::INDEXED_ARRAY ||
+                    marker == Value::Marker::INDEXED_OBJECT ||
+                    marker == Value::Marker::INDEXED_DICTIONARY;
+            }
+
+            // size of the encoded value in bytes
+            uint32_t getEncodedSize() const;
+
+            template<typename T, typename std::enable_if<std::is_integral<T>::value>::type* = nullptr>
+            T as() const
+            {
+                assert(type == Value::Type::INT);
+                return static_cast<T>(getInt());
+            }
+
+            template<typename T, typename std::enable_if<std::is_floating_point<T>::value>::type* = nullptr>
+            T as() const
+            {
+                assert(type == Value::Type::FLOAT || type == Value::Type::DOUBLE);
+                return static_cast<T>(getDouble());
+            }
+
+            template<typename T, typename std::enable_if<std::is_same<T, std::string>::value>::type* = nullptr>
+            std::string as() const
+            {
+                assert(type == Value::Type::STRING);
+                return std::string(getStringData(), getStringLength());
+            }
+
+            // string data is not null-terminated
+            const char* getStringData() const;
+            uint32_t getStringLength() const;
+
+            const uint8_t* getByteArrayData() const;
+            uint32_t getByteArraySize() const;
+
+            // number of elements of an array, object or dictionary
+            uint32_t getSize() const;
+
+            // element at the given position of an array, object or dictionary
+            View getElement(uint32_t index) const;
+            // key at the given position of an object
+            uint32_t getObjectKey(uint32_t index) const;
+            // key at the given position of a dictionary, not null-terminated
+            const char* getDictionaryKey(uint32_t index, uint32_t& length) const;
+
+            View operator[](uint32_t key) const;
+            View operator[](const std::string& key) const
+            {
+                return find(key.data(), static_cast<uint32_t>(key.length()));
+            }
+            View operator[](const char* key) const
+            {
+                return find(key, static_cast<uint32_t>(std::strlen(key)));
+            }
+
+            bool hasElement(uint32_t key) const;
+            bool hasElement(const std::string& key) const
+            {
+                return find(key.data(), static_cast<uint32_t>(key.length())).type != Value::Type::NONE;
+            }
+
+        private:
+            View(const uint8_t* initData, uint32_t initSize, uint32_t initOffset);
+
+            static uint32_t validate(const uint8_t* data, uint32_t size, uint32_t offset, uint32_t depth);
+            static uint32_t skip(const uint8_t* data, uint32_t offset);
+
+            uint64_t getInt() const;
+            double getDouble() const;
+            uint32_t getElementOffset(uint32_t index) const;
+            View find(const char* key, uint32_t length) const;
+
+            const uint8_t* data = nullptr;
+            uint32_t size = 0;
+            uint32_t offset = 0;
+            Value::Marker marker = Value::Marker::NONE;
+            Value::Type type = Value::Type::NONE;
+        };
+    } // namespace obf
+} // namespace ouzel
+
+#endif // OUZEL_UTILS_OBFVIEW_HPP
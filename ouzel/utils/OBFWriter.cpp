@@ -0,0 +1,407 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include "OBFWriter.hpp"
+#include "Utils.hpp"
+
+namespace ouzel
+{
+    namespace obf
+    {
+        static constexpr uint32_t FLUSH_SIZE = 65536;
+
+        Writer::Writer(const std::string& filename, bool initIndexed):
+            file(filename, File::WRITE | File::CREATE | File::TRUNCATE),
+            indexed(initIndexed)
+        {
+            buffer.reserve(FLUSH_SIZE);
+        }
+
+        Writer::~Writer()
+        {
+            // destructor must not throw, call finish to get the errors
+            if (!finished)
+            {
+                try
+                {
+                    flush();
+                }
+                catch (...)
+                {
+                }
+            }
+        }
+
+        void Writer::put(const void* data, uint32_t size)
+        {
+            buffer.insert(buffer.end(),
+                          static_cast<const uint8_t*>(data),
+                          static_cast<const uint8_t*>(data) + size);
+            offset += size;
+
+            if (buffer.size() >= FLUSH_SIZE) flush();
+        }
+
+        void Writer::putMarker(Value::Marker marker)
+        {
+            uint8_t data = static_cast<uint8_t>(marker);
+            put(&data, sizeof(data));
+        }
+
+        void Writer::flush()
+        {
+            if (!buffer.empty())
+            {
+                file.write(buffer.data(), static_cast<uint32_t>(buffer.size()), true);
+                buffer.clear();
+            }
+        }
+
+        void Writer::beginValue()
+        {
+            if (finished)
+                throw std::runtime_error("Writer is finished");
+
+            if (containers.empty())
+            {
+                if (offset != 0)
+                    throw std::runtime_error("Root value already written");
+
+                return;
+            }
+
+            Container& container = containers.back();
+
+            if (container.written >= container.count)
+                throw std::runtime_error("Too many elements in container");
+
+            if (container.marker == Value::Marker::INDEXED_ARRAY)
+                encodeBigEndian<uint32_t>(container.table.data() + container.written * sizeof(uint32_t),
+                                          offset - container.elementsOffset);
+            else if (container.marker != Value::Marker::ARRAY)
+            {
+                if (!container.keyWritten)
+                    throw std::runtime_error("Key expected");
+
+                if (container.marker == Value::Marker::INDEXED_OBJECT)
+                {
+                    uint8_t* tableEntry = container.table.data() + container.written * sizeof(uint32_t) * 2;
+                    encodeBigEndian<uint32_t>(tableEntry, container.lastKey);
+                    encodeBigEndian<uint32_t>(tableEntry + sizeof(uint32_t), offset - container.elementsOffset);
+                }
+            }
+
+            ++container.written;
+            container.keyWritten = false;
+        }
+
+        void Writer::beginContainer(Value::Marker marker, uint32_t count)
+        {
+            beginValue();
+
+            Container container;
+            container.marker = marker;
+            container.count = count;
+            container.written = 0;
+            container.keyWritten = false;
+            container.lastKey = 0;
+
+            putMarker(marker);
+
+            uint8_t countData[sizeof(uint32_t)];
+            encodeBigEndian<uint32_t>(countData, count);
+            put(countData, sizeof(countData));
+
+            container.tableOffset = offset;
+
+            if (marker == Value::Marker::INDEXED_ARRAY ||
+                marker == Value::Marker::INDEXED_DICTIONARY)
+                container.table.resize(count * sizeof(uint32_t));
+            else if (marker == Value::Marker::INDEXED_OBJECT)
+                container.table.resize(count * sizeof(uint32_t) * 2);
+
+            // reserve space for the table, it is filled in when the container is closed
+            if (!container.table.empty())
+                put(container.table.data(), static_cast<uint32_t>(container.table.size()));
+
+            container.elementsOffset = offset;
+
+            containers.push_back(std::move(container));
+        }
+
+        void Writer::writeNone()
+        {
+            beginValue();
+            putMarker(Value::Marker::NONE);
+        }
+
+        void Writer::writeInt(uint64_t value)
+        {
+            beginValue();
+
+            uint8_t data[sizeof(uint64_t)];
+
+            if (value > std::numeric_limits<uint32_t>::max())
+            {
+                putMarker(Value::Marker::INT64);
+                encodeBigEndian<uint64_t>(data, value);
+                put(data, sizeof(uint64_t));
+            }
+            else if (value > std::numeric_limits<uint16_t>::max())
+            {
+                putMarker(Value::Marker::INT32);
+                encodeBigEndian<uint32_t>(data, static_cast<uint32_t>(value));
+                put(data, sizeof(uint32_t));
+            }
+            else if (value > std::numeric_limits<uint8_t>::max())
+            {
+                putMarker(Value::Marker::INT16);
+                encodeBigEndian<uint16_t>(data, static_cast<uint16_t>(value));
+                put(data, sizeof(uint16_t));
+            }
+            else
+            {
+                putMarker(Value::Marker::INT8);
+                data[0] = static_cast<uint8_t>(value);
+                put(data, sizeof(uint8_t));
+            }
+        }
+
+        void Writer::writeFloat(float value)
+        {
+            beginValue();
+            putMarker(Value::Marker::FLOAT);
+            put(&value, sizeof(value));
+        }
+
+        void Writer::writeDouble(double value)
+        {
+            beginValue();
+            putMarker(Value::Marker::DOUBLE);
+            put(&value, sizeof(value));
+        }
+
+        void Writer::writeString(const std::string& value)
+        {
+            writeString(value.data(), static_cast<uint32_t>(value.length()));
+        }
+
+        void Writer::writeString(const char* value, uint32_t length)
+        {
+            beginValue();
+
+            if (length > std::numeric_limits<uint16_t>::max())
+            {
+                putMarker(Value::Marker::LONG_STRING);
+                uint8_t lengthData[sizeof(uint32_t)];
+                encodeBigEndian<uint32_t>(lengthData, length);
+                put(lengthData, sizeof(lengthData));
+            }
+            else
+            {
+                putMarker(Value::Marker::STRING);
+                uint8_t lengthData[sizeof(uint16_t)];
+                encodeBigEndian<uint16_t>(lengthData, static_cast<uint16_t>(length));
+                put(lengthData, sizeof(lengthData));
+            }
+
+            put(value, length);
+        }
+
+        void Writer::writeByteArray(const void* value, uint32_t size)
+        {
+            beginValue();
+            putMarker(Value::Marker::BYTE_ARRAY);
+
+            uint8_t sizeData[sizeof(uint32_t)];
+            encodeBigEndian<uint32_t>(sizeData, size);
+            put(sizeData, sizeof(sizeData));
+
+            put(value, size);
+        }
+
+        void Writer::write(const Value& value)
+        {
+            switch (value.getType())
+            {
+                case Value::Type::NONE:
+                    writeNone();
+                    break;
+                case Value::Type::INT:
+                    writeInt(value.as<uint64_t>());
+                    break;
+                case Value::Type::FLOAT:
+                    writeFloat(value.as<float>());
+                    break;
+                case Value::Type::DOUBLE:
+                    writeDouble(value.as<double>());
+                    break;
+                case Value::Type::STRING:
+                    writeString(value.as<std::string>());
+                    break;
+                case Value::Type::BYTE_ARRAY:
+                {
+                    const Value::ByteArray& byteArray = value.as<Value::ByteArray>();
+                    writeByteArray(byteArray.data(), static_cast<uint32_t>(byteArray.size()));
+                    break;
+                }
+                case Value::Type::OBJECT:
+                {
+                    const Value::Object& object = value.as<Value::Object>();
+                    beginObject(static_cast<uint32_t>(object.size()));
+                    for (const auto& i : object)
+                    {
+                        writeKey(i.first);
+                        write(i.second);
+                    }
+                    end();
+                    break;
+                }
+                case Value::Type::ARRAY:
+                {
+                    const Value::Array& array = value.as<Value::Array>();
+                    beginArray(static_cast<uint32_t>(array.size()));
+                    for (const auto& i : array)
+                        write(i);
+                    end();
+                    break;
+                }
+                case Value::Type::DICTIONARY:
+                {
+                    const Value::Dictionary& dictionary = value.as<Value::Dictionary>();
+                    beginDictionary(static_cast<uint32_t>(dictionary.size()));
+                    for (const auto& i : dictionary)
+                    {
+                        writeKey(i.first);
+                        write(i.second);
+                    }
+                    end();
+                    break;
+                }
+                default:
+                    throw std::runtime_error("Unsupported type");
+            }
+        }
+
+        void Writer::beginArray(uint32_t count)
+        {
+            beginContainer(indexed ? Value::Marker::INDEXED_ARRAY : Value::Marker::ARRAY, count);
+        }
+
+        void Writer::beginObject(uint32_t count)
+        {
+            beginContainer(indexed ? Value::Marker::INDEXED_OBJECT : Value::Marker::OBJECT, count);
+        }
+
+        void Writer::beginDictionary(uint32_t count)
+        {
+            beginContainer(indexed ? Value::Marker::INDEXED_DICTIONARY : Value::Marker::DICTIONARY, count);
+        }
+
+        void Writer::writeKey(uint32_t key)
+        {
+            if (containers.empty() ||
+                (containers.back().marker != Value::Marker::OBJECT &&
+                 containers.back().marker != Value::Marker::INDEXED_OBJECT))
+                throw std::runtime_error("Not writing an object");
+
+            Container& container = containers.back();
+
+            if (container.keyWritten)
+                throw std::runtime_error("Value expected");
+
+            if (container.marker == Value::Marker::INDEXED_OBJECT)
+            {
+                if (container.written > 0 && key <= container.lastKey)
+                    throw std::runtime_error("Keys must be written in ascending order");
+            }
+            else
+            {
+                uint8_t keyData[sizeof(uint32_t)];
+                encodeBigEndian<uint32_t>(keyData, key);
+                put(keyData, sizeof(keyData));
+            }
+
+            container.lastKey = key;
+            container.keyWritten = true;
+        }
+
+        void Writer::writeKey(const std::string& key)
+        {
+            if (containers.empty() ||
+                (containers.back().marker != Value::Marker::DICTIONARY &&
+                 containers.back().marker != Value::Marker::INDEXED_DICTIONARY))
+                throw std::runtime_error("Not writing a dictionary");
+
+            Container& container = containers.back();
+
+            if (container.keyWritten)
+                throw std::runtime_error("Value expected");
+
+            if (key.length() > std::numeric_limits<uint16_t>::max())
+                throw std::runtime_error("Key is too long");
+
+            if (container.marker == Value::Marker::INDEXED_DICTIONARY)
+            {
+                if (container.written > 0 && key.compare(container.lastDictionaryKey) <= 0)
+                    throw std::runtime_error("Keys must be written in ascending order");
+
+                if (container.written < container.count)
+                    encodeBigEndian<uint32_t>(container.table.data() + container.written * sizeof(uint32_t),
+                                              offset - container.elementsOffset);
+
+                container.lastDictionaryKey = key;
+            }
+
+            uint8_t lengthData[sizeof(uint16_t)];
+            encodeBigEndian<uint16_t>(lengthData, static_cast<uint16_t>(key.length()));
+            put(lengthData, sizeof(lengthData));
+            put(key.data(), static_cast<uint32_t>(key.length()));
+
+            container.keyWritten = true;
+        }
+
+        void Writer::end()
+        {
+            if (containers.empty())
+                throw std::runtime_error("No container to end");
+
+            Container& container = containers.back();
+
+            if (container.written != container.count || container.keyWritten)
+                throw std::runtime_error("Container element count mismatch");
+
+            if (!container.table.empty())
+            {
+                uint32_t bufferOffset = offset - static_cast<uint32_t>(buffer.size());
+
+                // patch the table in place if it has not been flushed yet
+                if (container.tableOffset >= bufferOffset)
+                    std::memcpy(buffer.data() + (container.tableOffset - bufferOffset),
+                                container.table.data(), container.table.size());
+                else
+                {
+                    flush();
+                    file.seek(static_cast<int32_t>(container.tableOffset), File::BEGIN);
+                    file.write(container.table.data(), static_cast<uint32_t>(container.table.size()), true);
+                    file.seek(0, File::END);
+                }
+            }
+
+            containers.pop_back();
+        }
+
+        void Writer::finish()
+        {
+            if (finished) return;
+
+            if (!containers.empty())
+                throw std::runtime_error("Not all containers are closed");
+
+            flush();
+            finished = true;
+        }
+    } // namespace obf
+} // namespace ouzel
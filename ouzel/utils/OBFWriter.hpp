@@ -0,0 +1,82 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_UTILS_OBFWRITER_HPP
+#define OUZEL_UTILS_OBFWRITER_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "files/File.hpp"
+#include "utils/OBF.hpp"
+
+namespace ouzel
+{
+    namespace obf
+    {
+        // Streaming OBF encoder that writes directly to a file without building a Value tree.
+        // Containers are opened with their element count and closed with end(). Each element of an
+        // object or a dictionary must be preceded by writeKey(). If indexed is true, containers are
+        // written with offset tables for random access through View and keys must be written in
+        // ascending order.
+        class Writer final
+        {
+        public:
+            Writer(const std::string& filename, bool initIndexed = true);
+            ~Writer();
+
+            Writer(const Writer&) = delete;
+            Writer& operator=(const Writer&) = delete;
+
+            Writer(Writer&&) = delete;
+            Writer& operator=(Writer&&) = delete;
+
+            void writeNone();
+            void writeInt(uint64_t value);
+            void writeFloat(float value);
+            void writeDouble(double value);
+            void writeString(const std::string& value);
+            void writeString(const char* value, uint32_t length);
+            void writeByteArray(const void* value, uint32_t size);
+            void write(const Value& value);
+
+            void beginArray(uint32_t count);
+            void beginObject(uint32_t count);
+            void beginDictionary(uint32_t count);
+            void writeKey(uint32_t key);
+            void writeKey(const std::string& key);
+            void end();
+
+            // flushes the buffered data, all containers must be closed
+            void finish();
+
+        private:
+            struct Container final
+            {
+                Value::Marker marker;
+                uint32_t count;
+                uint32_t written;
+                uint32_t tableOffset;
+                uint32_t elementsOffset;
+                bool keyWritten;
+                uint32_t lastKey;
+                std::string lastDictionaryKey;
+                std::vector<uint8_t> table;
+            };
+
+            void beginValue();
+            void beginContainer(Value::Marker marker, uint32_t count);
+            void put(const void* data, uint32_t size);
+            void putMarker(Value::Marker marker);
+            void flush();
+
+            File file;
+            bool indexed;
+            bool finished = false;
+            uint32_t offset = 0;
+            std::vector<uint8_t> buffer;
+            std::vector<Container> containers;
+        };
+    } // namespace obf
+} // namespace ouzel
+
+#endif // OUZEL_UTILS_OBFWRITER_HPP
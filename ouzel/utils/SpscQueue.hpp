@@ -0,0 +1,69 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_UTILS_SPSCQUEUE_HPP
+#define OUZEL_UTILS_SPSCQUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace ouzel
+{
+    // fixed size lock-free queue for exactly one producer thread and one consumer thread
+    template<class T>
+    class SpscQueue final
+    {
+    public:
+        explicit SpscQueue(size_t capacity)
+        {
+            size_t size = 1;
+            while (size < capacity) size <<= 1;
+
+            values.resize(size);
+            mask = size - 1;
+        }
+
+        SpscQueue(const SpscQueue&) = delete;
+        SpscQueue& operator=(const SpscQueue&) = delete;
+
+        // producer only, returns false if the queue is full
+        bool push(const T& value)
+        {
+            size_t write = writeIndex.load(std::memory_order_relaxed);
+            if (write - readIndex.load(std::memory_order_acquire) == values.size())
+                return false;
+
+            values[write & mask] = value;
+            writeIndex.store(write + 1, std::memory_order_release);
+            return true;
+        }
+
+        // consumer only, returns false if the queue is empty
+        bool pop(T& value)
+        {
+            size_t read = readIndex.load(std::memory_order_relaxed);
+            if (read == writeIndex.load(std::memory_order_acquire))
+                return false;
+
+            value = values[read & mask];
+            readIndex.store(read + 1, std::memory_order_release);
+            return true;
+        }
+
+        // the producer sees an upper bound and the consumer a lower bound of the element count
+        size_t size() const
+        {
+            return writeIndex.load(std::memory_order_acquire) - readIndex.load(std::memory_order_acquire);
+        }
+
+        size_t capacity() const { return values.size(); }
+
+    private:
+        std::vector<T> values;
+        size_t mask = 0;
+        std::atomic<size_t> readIndex{0};
+        std::atomic<size_t> writeIndex{0};
+    };
+}
+
+#endif // OUZEL_UTILS_SPSCQUEUE_HPP
@@ -0,0 +1,59 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_UTILS_STRINGVIEW_HPP
+#define OUZEL_UTILS_STRINGVIEW_HPP
+
+#include <cstring>
+#include <string>
+
+namespace ouzel
+{
+    // non-owning reference to a character range, the referenced data must outlive the view
+    class StringView final
+    {
+    public:
+        StringView() {}
+        StringView(const char* initData, size_t initLength):
+            viewData(initData), viewLength(initLength)
+        {
+        }
+        StringView(const char* str):
+            viewData(str), viewLength(std::strlen(str))
+        {
+        }
+        StringView(const std::string& str):
+            viewData(str.data()), viewLength(str.length())
+        {
+        }
+
+        inline const char* data() const { return viewData; }
+        inline size_t length() const { return viewLength; }
+        inline size_t size() const { return viewLength; }
+        inline bool empty() const { return viewLength == 0; }
+
+        inline const char* begin() const { return viewData; }
+        inline const char* end() const { return viewData + viewLength; }
+
+        inline char operator[](size_t index) const { return viewData[index]; }
+
+        inline std::string str() const { return std::string(viewData, viewLength); }
+        inline operator std::string() const { return str(); }
+
+        inline bool operator==(const StringView& other) const
+        {
+            return viewLength == other.viewLength &&
+                (viewLength == 0 || std::memcmp(viewData, other.viewData, viewLength) == 0);
+        }
+
+        inline bool operator!=(const StringView& other) const
+        {
+            return !(*this == other);
+        }
+
+    private:
+        const char* viewData = "";
+        size_t viewLength = 0;
+    };
+}
+
+#endif // OUZEL_UTILS_STRINGVIEW_HPP
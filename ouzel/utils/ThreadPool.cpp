@@ -0,0 +1,284 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#include <algorithm>
+#include <system_error>
+#include "ThreadPool.hpp"
+#include "Utils.hpp"
+
+namespace ouzel
+{
+    static constexpr uint32_t PINNED = 0x01;
+    static constexpr uint32_t LOW_PRIORITY = 0x02;
+
+    static thread_local const ThreadPool* currentPool = nullptr;
+    static thread_local uint32_t currentWorker = 0;
+
+    ThreadPool::ThreadPool(uint32_t threadCount)
+    {
+#if !defined(__EMSCRIPTEN__)
+        if (threadCount == 0)
+        {
+            uint32_t hardwareThreads = std::thread::hardware_concurrency();
+            threadCount = (hardwareThreads > 1) ? hardwareThreads - 1 : 1;
+        }
+
+        for (uint32_t i = 0; i < threadCount; ++i)
+            workers.push_back(std::unique_ptr<Worker>(new Worker()));
+
+        // all deques must exist before any worker tries to steal
+        for (uint32_t i = 0; i < threadCount; ++i)
+            workers[i]->thread = std::thread(&ThreadPool::work, this, i);
+#else
+        (void)threadCount;
+#endif
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        running = false;
+        lock.unlock();
+        sleepCondition.notify_all();
+
+        for (const std::unique_ptr<Worker>& worker : workers)
+            if (worker->thread.joinable()) worker->thread.join();
+    }
+
+    std::future<void> ThreadPool::run(const std::function<void()>& task)
+    {
+        // std::function must be copyable, but packaged_task is move-only
+        std::shared_ptr<std::packaged_task<void()>> packagedTask = std::make_shared<std::packaged_task<void()>>(task);
+        std::future<void> result = packagedTask->get_future();
+
+        Job job;
+        job.function = [packagedTask]() { (*packagedTask)(); };
+        push(std::move(job));
+
+        return result;
+    }
+
+    void ThreadPool::run(const std::function<void()>& function, Counter& counter, const char* name)
+    {
+        counter.value.fetch_add(1, std::memory_order_relaxed);
+
+        Job job;
+        job.function = function;
+        job.counter = &counter;
+        job.name = name;
+        push(std::move(job));
+    }
+
+    void ThreadPool::runAfter(Counter& dependency, const std::function<void()>& function, Counter& counter,
+                              const char* name)
+    {
+        counter.value.fetch_add(1, std::memory_order_relaxed);
+
+        Job job;
+        job.function = function;
+        job.counter = &counter;
+        job.name = name;
+
+        std::unique_lock<std::mutex> lock(dependency.mutex);
+        if (dependency.value.load(std::memory_order_acquire) != 0)
+        {
+            dependency.continuations.push_back(std::move(job));
+            return;
+        }
+        lock.unlock();
+
+        push(std::move(job));
+    }
+
+    void ThreadPool::wait(Counter& counter)
+    {
+        uint32_t workerIndex = getCurrentWorker();
+
+        while (!counter.isDone())
+        {
+            Job job;
+            if (pop(workerIndex, job))
+                execute(job, workerIndex);
+            else
+                std::this_thread::yield();
+        }
+
+        // the thread that finished the last job could still hold the mutex
+        std::lock_guard<std::mutex> lock(counter.mutex);
+    }
+
+    void ThreadPool::parallelFor(uint32_t begin, uint32_t end, uint32_t grainSize,
+                                 const std::function<void(uint32_t, uint32_t)>& function,
+                                 const char* name)
+    {
+        if (grainSize == 0) grainSize = 1;
+
+        Counter counter;
+
+        for (uint32_t first = begin; first < end;)
+        {
+            uint32_t last = (end - first > grainSize) ? first + grainSize : end;
+            run([&function, first, last]() { function(first, last); }, counter, name);
+            first = last;
+        }
+
+        wait(counter);
+    }
+
+    void ThreadPool::pinThreads()
+    {
+        configure(PINNED);
+    }
+
+    void ThreadPool::lowerThreadPriority()
+    {
+        configure(LOW_PRIORITY);
+    }
+
+    // the workers apply the settings to themselves
+    void ThreadPool::configure(uint32_t flags)
+    {
+        configuration.fetch_or(flags);
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        lock.unlock();
+        sleepCondition.notify_all();
+    }
+
+    uint32_t ThreadPool::getCurrentWorker() const
+    {
+        return currentPool == this ? currentWorker : getThreadCount();
+    }
+
+    void ThreadPool::push(Job&& job)
+    {
+        if (workers.empty())
+        {
+            execute(job, 0);
+            return;
+        }
+
+        uint32_t workerIndex = getCurrentWorker();
+        if (workerIndex == getThreadCount())
+            workerIndex = nextWorker.fetch_add(1, std::memory_order_relaxed) % getThreadCount();
+
+        // counted before it is visible, so that a worker never sees a job without it
+        queuedJobs.fetch_add(1);
+
+        Worker& worker = *workers[workerIndex];
+        std::unique_lock<std::mutex> lock(worker.mutex);
+        worker.jobs.push_back(std::move(job));
+        lock.unlock();
+
+        if (sleepingWorkers.load())
+        {
+            std::unique_lock<std::mutex> sleepLock(sleepMutex);
+            sleepLock.unlock();
+            sleepCondition.notify_one();
+        }
+    }
+
+    bool ThreadPool::pop(uint32_t workerIndex, Job& job)
+    {
+        uint32_t threadCount = getThreadCount();
+
+        if (workerIndex < threadCount)
+        {
+            Worker& worker = *workers[workerIndex];
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            if (!worker.jobs.empty())
+            {
+                job = std::move(worker.jobs.back());
+                worker.jobs.pop_back();
+                queuedJobs.fetch_sub(1);
+                return true;
+            }
+        }
+
+        for (uint32_t i = 1; i <= threadCount; ++i)
+        {
+            Worker& victim = *workers[(workerIndex + i) % threadCount];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.jobs.empty())
+            {
+                job = std::move(victim.jobs.front());
+                victim.jobs.pop_front();
+                queuedJobs.fetch_sub(1);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void ThreadPool::execute(Job& job, uint32_t workerIndex)
+    {
+        Profiler* currentProfiler = profiler.load(std::memory_order_acquire);
+
+        if (currentProfiler) currentProfiler->beginJob(job.name, workerIndex);
+        job.function();
+        if (currentProfiler) currentProfiler->endJob(job.name, workerIndex);
+
+        if (job.counter) finish(*job.counter);
+    }
+
+    void ThreadPool::finish(Counter& counter)
+    {
+        std::vector<Job> continuations;
+
+        std::unique_lock<std::mutex> lock(counter.mutex);
+        if (counter.value.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            continuations.swap(counter.continuations);
+        lock.unlock();
+
+        for (Job& continuation : continuations)
+            push(std::move(continuation));
+    }
+
+    void ThreadPool::work(uint32_t workerIndex)
+    {
+        setCurrentThreadName("Worker");
+
+        currentPool = this;
+        currentWorker = workerIndex;
+
+        uint32_t applied = 0;
+
+        for (;;)
+        {
+            uint32_t flags = configuration.load();
+            if (flags != applied)
+            {
+                try
+                {
+                    if ((flags & PINNED) && !(applied & PINNED))
+                        setCurrentThreadAffinity((workerIndex + 1) % std::max(std::thread::hardware_concurrency(), 1U));
+                    if ((flags & LOW_PRIORITY) && !(applied & LOW_PRIORITY))
+                        setCurrentThreadLowPriority();
+                }
+                catch (const std::system_error&)
+                {
+                    // the settings are only hints
+                }
+
+                applied = flags;
+            }
+
+            Job job;
+            if (pop(workerIndex, job))
+            {
+                execute(job, workerIndex);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            if (!running) break;
+
+            sleepingWorkers.fetch_add(1);
+            while (running && queuedJobs.load() == 0 && configuration.load() == applied)
+                sleepCondition.wait(lock);
+            sleepingWorkers.fetch_sub(1);
+
+            if (!running) break;
+        }
+    }
+}
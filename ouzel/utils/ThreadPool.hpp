@@ -0,0 +1,131 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_UTILS_THREADPOOL_HPP
+#define OUZEL_UTILS_THREADPOOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ouzel
+{
+    // Work-stealing job scheduler. Every worker has its own deque: it takes the newest jobs from the back,
+    // idle workers steal the oldest jobs from the front of the other deques. Threads that wait for
+    // a counter execute jobs in the meantime.
+    class ThreadPool final
+    {
+    public:
+        class Counter;
+
+    private:
+        struct Job
+        {
+            std::function<void()> function;
+            Counter* counter = nullptr;
+            const char* name = nullptr;
+        };
+
+    public:
+        // number of unfinished jobs, must not be destroyed before it was waited for
+        class Counter final
+        {
+        public:
+            Counter() = default;
+
+            Counter(const Counter&) = delete;
+            Counter& operator=(const Counter&) = delete;
+
+            Counter(Counter&&) = delete;
+            Counter& operator=(Counter&&) = delete;
+
+            inline bool isDone() const { return value.load(std::memory_order_acquire) == 0; }
+
+        private:
+            friend ThreadPool;
+
+            std::atomic<uint32_t> value{0};
+            std::mutex mutex;
+            std::vector<Job> continuations; // jobs that wait for the counter to reach zero
+        };
+
+        class Profiler
+        {
+        public:
+            virtual ~Profiler() {}
+
+            // thread is the index of the worker or the thread count for other threads
+            virtual void beginJob(const char* name, uint32_t thread) = 0;
+            virtual void endJob(const char* name, uint32_t thread) = 0;
+        };
+
+        // 0 threads means one worker per hardware thread except the calling one
+        explicit ThreadPool(uint32_t threadCount = 0);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        ThreadPool(ThreadPool&&) = delete;
+        ThreadPool& operator=(ThreadPool&&) = delete;
+
+        // runs the task on a worker thread, or immediately if there are no workers
+        std::future<void> run(const std::function<void()>& task);
+
+        // runs the job on a worker thread, the counter is not zero until the job finishes
+        void run(const std::function<void()>& job, Counter& counter, const char* name = nullptr);
+        // runs the job after the dependency reaches zero
+        void runAfter(Counter& dependency, const std::function<void()>& job, Counter& counter,
+                      const char* name = nullptr);
+        // executes jobs until the counter reaches zero
+        void wait(Counter& counter);
+
+        // calls the function with ranges of at most grainSize indices in parallel and waits for all of them
+        void parallelFor(uint32_t begin, uint32_t end, uint32_t grainSize,
+                         const std::function<void(uint32_t, uint32_t)>& function,
+                         const char* name = nullptr);
+
+        // pins every worker to its own core, leaving the first core to the calling thread (no-op on Apple platforms)
+        void pinThreads();
+        void lowerThreadPriority();
+
+        inline void setProfiler(Profiler* newProfiler) { profiler.store(newProfiler, std::memory_order_release); }
+
+        inline uint32_t getThreadCount() const { return static_cast<uint32_t>(workers.size()); }
+
+    private:
+        struct Worker
+        {
+            std::mutex mutex;
+            std::deque<Job> jobs;
+            std::thread thread;
+        };
+
+        void push(Job&& job);
+        bool pop(uint32_t workerIndex, Job& job);
+        void execute(Job& job, uint32_t workerIndex);
+        void finish(Counter& counter);
+        void configure(uint32_t flags);
+        uint32_t getCurrentWorker() const;
+        void work(uint32_t workerIndex);
+
+        std::vector<std::unique_ptr<Worker>> workers;
+        std::atomic<uint32_t> queuedJobs{0};
+        std::atomic<uint32_t> sleepingWorkers{0};
+        std::atomic<uint32_t> nextWorker{0};
+        std::atomic<uint32_t> configuration{0};
+        std::atomic<Profiler*> profiler{nullptr};
+
+        std::mutex sleepMutex;
+        std::condition_variable sleepCondition;
+        bool running = true;
+    };
+}
+
+#endif // OUZEL_UTILS_THREADPOOL_HPP
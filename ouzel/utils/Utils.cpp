@@ -1,5 +1,6 @@
 // Copyright 2015-2018 Elviss Strazdins. All rights reserved.
 
+#include <cerrno>
 #include <system_error>
 #if defined(_WIN32)
 #  define WIN32_LEAN_AND_MEAN
@@ -9,6 +10,12 @@
 #  undef NOMINMAX
 #else
 #  include <pthread.h>
+#  if defined(__linux__)
+#    include <sched.h>
+#    include <sys/resource.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+#  endif
 #endif
 #include "Utils.hpp"
 
@@ -55,6 +62,40 @@ namespace ouzel
         if (error != 0)
             throw std::system_error(error, std::system_category(), "Failed to set thread name");
 #  endif
+#endif
+    }
+
+    void setCurrentThreadLowPriority()
+    {
+#if defined(_WIN32)
+        if (!SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL))
+            throw std::system_error(static_cast<int>(GetLastError()), std::system_category(), "Failed to set thread priority");
+#elif defined(__APPLE__)
+        int error = pthread_set_qos_class_self_np(QOS_CLASS_UTILITY, 0);
+        if (error != 0)
+            throw std::system_error(error, std::system_category(), "Failed to set thread priority");
+#elif defined(__linux__)
+        // on Linux the nice value is per thread
+        if (setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 10) == -1)
+            throw std::system_error(errno, std::system_category(), "Failed to set thread priority");
+#endif
+    }
+
+    void setCurrentThreadAffinity(uint32_t cpu)
+    {
+#if defined(_WIN32)
+        if (!SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(1) << cpu))
+            throw std::system_error(static_cast<int>(GetLastError()), std::system_category(), "Failed to set thread affinity");
+#elif defined(__linux__)
+        // sched_setaffinity also works on Android, which lacks pthread_setaffinity_np
+        cpu_set_t cpuSet;
+        CPU_ZERO(&cpuSet);
+        CPU_SET(cpu, &cpuSet);
+        if (sched_setaffinity(0, sizeof(cpuSet), &cpuSet) == -1)
+            throw std::system_error(errno, std::system_category(), "Failed to set thread affinity");
+#else
+        // Apple platforms only support affinity tags, not pinning
+        (void)cpu;
 #endif
     }
 }
@@ -29,7 +29,7 @@ namespace ouzel
         T result = 0;
 
         for (uintptr_t i = 0; i < sizeof(T); ++i)
-            result |= static_cast<T>(bytes[sizeof(buffer) - i - 1] << (i * 8));
+            result |= static_cast<T>(static_cast<T>(bytes[sizeof(T) - i - 1]) << (i * 8));
 
         return result;
     }
@@ -41,7 +41,7 @@ namespace ouzel
         T result = 0;
 
         for (uintptr_t i = 0; i < sizeof(T); ++i)
-            result |= static_cast<T>(bytes[i] << (i * 8));
+            result |= static_cast<T>(static_cast<T>(bytes[i]) << (i * 8));
 
         return result;
     }
@@ -82,6 +82,8 @@ namespace ouzel
     }
 
     void setCurrentThreadName(const std::string& name);
+    void setCurrentThreadLowPriority();
+    void setCurrentThreadAffinity(uint32_t cpu);
 }
 
 #endif // OUZEL_UTILS_UTILS_HPP
@@ -44,7 +44,7 @@ GUISample::GUISample():
     label1.setPosition(Vector2<float>(-88.0F, 108.0F));
     layer.addChild(&label1);
 
-    engine->getLocalization().addLanguage("latvian", engine->getFileSystem().readFile("lv.mo"));
+    engine->getLocalization().addLanguageFile("latvian", "lv.mo");
     engine->getLocalization().setLanguage("latvian");
 
     label2.setText(engine->getLocalization().getString("Ouzel"));
@@ -0,0 +1,18 @@
+#version 330
+uniform vec4 color;
+uniform vec4 outlineColor;
+uniform float outlineWidth;
+uniform sampler2D texture0;
+in vec4 exColor;
+in vec2 exTexCoord;
+out vec4 outColor;
+void main()
+{
+    float dist = texture(texture0, exTexCoord).a;
+    float smoothing = fwidth(dist);
+    float alpha = smoothstep(0.5 - smoothing, 0.5 + smoothing, dist);
+    float outlineAlpha = smoothstep(0.5 - outlineWidth - smoothing, 0.5 - outlineWidth + smoothing, dist);
+    float fill = alpha / max(outlineAlpha, 0.0001);
+    vec4 fillColor = exColor * color;
+    outColor = vec4(mix(outlineColor.rgb, fillColor.rgb, fill), mix(outlineColor.a, fillColor.a, fill) * outlineAlpha);
+}
@@ -0,0 +1,18 @@
+#extension GL_OES_standard_derivatives : enable
+precision mediump float;
+uniform lowp vec4 color;
+uniform lowp vec4 outlineColor;
+uniform float outlineWidth;
+uniform lowp sampler2D texture0;
+varying lowp vec4 exColor;
+varying vec2 exTexCoord;
+void main()
+{
+    float dist = texture2D(texture0, exTexCoord).a;
+    float smoothing = fwidth(dist);
+    float alpha = smoothstep(0.5 - smoothing, 0.5 + smoothing, dist);
+    float outlineAlpha = smoothstep(0.5 - outlineWidth - smoothing, 0.5 - outlineWidth + smoothing, dist);
+    float fill = alpha / max(outlineAlpha, 0.0001);
+    vec4 fillColor = exColor * color;
+    gl_FragColor = vec4(mix(outlineColor.rgb, fillColor.rgb, fill), mix(outlineColor.a, fillColor.a, fill) * outlineAlpha);
+}
@@ -0,0 +1,18 @@
+precision highp float;
+attribute vec3 position0;
+attribute vec2 texCoord0;
+attribute vec4 instanceTransform0;
+attribute vec4 instanceColor0;
+uniform mat4 modelViewProj;
+varying lowp vec4 exColor;
+varying vec2 exTexCoord;
+void main()
+{
+    float c = cos(instanceTransform0.w) * instanceTransform0.z;
+    float s = sin(instanceTransform0.w) * instanceTransform0.z;
+    vec2 position = vec2(position0.x * c - position0.y * s,
+                         position0.x * s + position0.y * c) + instanceTransform0.xy;
+    gl_Position = modelViewProj * vec4(position, 0.0, 1.0);
+    exColor = instanceColor0;
+    exTexCoord = texCoord0;
+}
@@ -0,0 +1,19 @@
+#version 300 es
+precision highp float;
+in vec3 position0;
+in vec2 texCoord0;
+in vec4 instanceTransform0;
+in vec4 instanceColor0;
+uniform mat4 modelViewProj;
+out lowp vec4 exColor;
+out vec2 exTexCoord;
+void main()
+{
+    float c = cos(instanceTransform0.w) * instanceTransform0.z;
+    float s = sin(instanceTransform0.w) * instanceTransform0.z;
+    vec2 position = vec2(position0.x * c - position0.y * s,
+                         position0.x * s + position0.y * c) + instanceTransform0.xy;
+    gl_Position = modelViewProj * vec4(position, 0.0, 1.0);
+    exColor = instanceColor0;
+    exTexCoord = texCoord0;
+}
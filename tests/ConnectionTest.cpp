@@ -0,0 +1,179 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include "LoopbackSocket.hpp"
+#include "network/Connection.hpp"
+
+using namespace ouzel;
+
+static const uint32_t MESSAGE_COUNT = 5000;
+static const uint32_t MESSAGES_PER_UPDATE = 40;
+static const std::chrono::seconds TIMEOUT(30);
+
+enum Channel: uint8_t
+{
+    RELIABLE_CHANNEL = 0,
+    SEQUENCED_CHANNEL = 1,
+    UNRELIABLE_CHANNEL = 2
+};
+
+struct Scenario
+{
+    const char* name;
+    float loss;
+    float latency;
+    float jitter;
+};
+
+// reliable messages carry their index and have a size that depends on it
+static uint32_t getMessageSize(uint32_t index)
+{
+    return 4 + index % 50;
+}
+
+static bool run(const Scenario& scenario)
+{
+    LoopbackSocket socketA(scenario.loss, 0.05F, scenario.latency, scenario.jitter, 1);
+    LoopbackSocket socketB(scenario.loss, 0.05F, scenario.latency, scenario.jitter, 2);
+
+    network::Connection connectionA([&socketA](const uint8_t* data, uint32_t size) { socketA.send(data, size); });
+    network::Connection connectionB([&socketB](const uint8_t* data, uint32_t size) { socketB.send(data, size); });
+    socketA.setReceiver(&connectionB);
+    socketB.setReceiver(&connectionA);
+
+    connectionA.setDelivery(RELIABLE_CHANNEL, network::Connection::Delivery::RELIABLE);
+    connectionA.setDelivery(SEQUENCED_CHANNEL, network::Connection::Delivery::SEQUENCED);
+    connectionB.setDelivery(RELIABLE_CHANNEL, network::Connection::Delivery::RELIABLE);
+
+    bool success = true;
+    uint32_t receivedA = 0;
+    uint32_t receivedB = 0;
+    uint32_t sequencedCount = 0;
+    uint32_t lastSequenced = 0;
+    uint32_t unreliableCount = 0;
+
+    connectionA.setMessageCallback([&](uint8_t channel, const uint8_t* data, uint32_t size) {
+        uint32_t index;
+        std::memcpy(&index, data, sizeof(index));
+
+        if (channel != RELIABLE_CHANNEL || size != 4 || index != receivedA)
+        {
+            std::printf("  B->A: unexpected message %u on channel %u, expected %u\n", index, channel, receivedA);
+            success = false;
+        }
+        ++receivedA;
+    });
+
+    connectionB.setMessageCallback([&](uint8_t channel, const uint8_t* data, uint32_t size) {
+        uint32_t index;
+        std::memcpy(&index, data, sizeof(index));
+
+        switch (channel)
+        {
+            case RELIABLE_CHANNEL:
+                if (index != receivedB || size != getMessageSize(index))
+                {
+                    std::printf("  A->B: reliable message %u (%u bytes) out of order, expected %u\n", index, size, receivedB);
+                    success = false;
+                }
+                ++receivedB;
+                break;
+            case SEQUENCED_CHANNEL:
+                if (sequencedCount && index <= lastSequenced)
+                {
+                    std::printf("  A->B: sequenced message %u after %u\n", index, lastSequenced);
+                    success = false;
+                }
+                lastSequenced = index;
+                ++sequencedCount;
+                break;
+            case UNRELIABLE_CHANNEL:
+                ++unreliableCount;
+                break;
+            default:
+                std::printf("  A->B: message on unused channel %u\n", channel);
+                success = false;
+        }
+    });
+
+    uint32_t sentA = 0;
+    uint32_t sentB = 0;
+    uint32_t updates = 0;
+
+    auto start = std::chrono::steady_clock::now();
+
+    while (receivedA < MESSAGE_COUNT || receivedB < MESSAGE_COUNT)
+    {
+        if (std::chrono::steady_clock::now() - start > TIMEOUT)
+        {
+            std::printf("  timed out, A->B %u/%u, B->A %u/%u\n", receivedB, MESSAGE_COUNT, receivedA, MESSAGE_COUNT);
+            success = false;
+            break;
+        }
+
+        uint8_t buffer[64] = {};
+        for (uint32_t i = 0; i < MESSAGES_PER_UPDATE && sentA < MESSAGE_COUNT; ++i, ++sentA)
+        {
+            std::memcpy(buffer, &sentA, sizeof(sentA));
+            connectionA.send(RELIABLE_CHANNEL, buffer, getMessageSize(sentA));
+        }
+
+        for (uint32_t i = 0; i < MESSAGES_PER_UPDATE && sentB < MESSAGE_COUNT; ++i, ++sentB)
+            connectionB.send(RELIABLE_CHANNEL, &sentB, sizeof(sentB));
+
+        connectionA.send(SEQUENCED_CHANNEL, &updates, sizeof(updates));
+        connectionA.send(UNRELIABLE_CHANNEL, &updates, sizeof(updates));
+        ++updates;
+
+        socketA.update();
+        socketB.update();
+        connectionA.update();
+        connectionB.update();
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    float duration = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+
+    if (sequencedCount == 0 && scenario.loss < 1.0F)
+    {
+        std::printf("  no sequenced messages arrived\n");
+        success = false;
+    }
+
+    if (unreliableCount > updates + socketA.getDuplicatedCount())
+    {
+        std::printf("  more unreliable messages arrived than were sent\n");
+        success = false;
+    }
+
+    std::printf("%s: %s in %.2f s\n", scenario.name, success ? "passed" : "FAILED", duration);
+    std::printf("  A sent %u packets (%.1f messages per packet), %u dropped, %u duplicated\n",
+                socketA.getSentCount(),
+                static_cast<float>(MESSAGE_COUNT + 2 * updates) / static_cast<float>(socketA.getSentCount()),
+                socketA.getDroppedCount(), socketA.getDuplicatedCount());
+    std::printf("  sequenced %u/%u, unreliable %u/%u\n", sequencedCount, updates, unreliableCount, updates);
+    std::printf("  A round trip %.3f s, packet loss %.3f\n", connectionA.getRoundTripTime(), connectionA.getPacketLoss());
+
+    return success;
+}
+
+int main()
+{
+    const Scenario scenarios[] = {
+        {"no loss, 10 ms", 0.0F, 0.01F, 0.0F},
+        {"20% loss, 50+-30 ms", 0.2F, 0.05F, 0.03F},
+        {"40% loss, 100+-80 ms", 0.4F, 0.1F, 0.08F}
+    };
+
+    bool success = true;
+
+    for (const Scenario& scenario : scenarios)
+        if (!run(scenario)) success = false;
+
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,106 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_TESTS_LOOPBACKSOCKET_HPP
+#define OUZEL_TESTS_LOOPBACKSOCKET_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "network/Connection.hpp"
+
+namespace ouzel
+{
+    // Simulated datagram link to a Connection. Datagrams are dropped, duplicated and delayed by
+    // the latency plus a random jitter, so they can also arrive out of order.
+    class LoopbackSocket final
+    {
+    public:
+        LoopbackSocket(float initLoss, float initDuplication, float initLatency, float initJitter, uint32_t seed):
+            loss(initLoss), duplication(initDuplication), latency(initLatency), jitter(initJitter),
+            generator(seed)
+        {
+        }
+
+        inline void setReceiver(network::Connection* newReceiver) { receiver = newReceiver; }
+
+        void send(const uint8_t* data, uint32_t size)
+        {
+            ++sentCount;
+
+            if (distribution(generator) < loss)
+            {
+                ++droppedCount;
+                return;
+            }
+
+            uint32_t copies = 1;
+            if (distribution(generator) < duplication)
+            {
+                ++duplicatedCount;
+                copies = 2;
+            }
+
+            for (uint32_t i = 0; i < copies; ++i)
+            {
+                float delay = latency + distribution(generator) * jitter;
+
+                Datagram datagram;
+                datagram.time = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(delay));
+                datagram.data.assign(data, data + size);
+                datagrams.push_back(datagram);
+            }
+        }
+
+        // delivers the datagrams whose delay has passed
+        void update()
+        {
+            Clock::time_point now = Clock::now();
+
+            for (auto i = datagrams.begin(); i != datagrams.end();)
+            {
+                if (i->time <= now)
+                {
+                    std::vector<uint8_t> data = std::move(i->data);
+                    i = datagrams.erase(i);
+
+                    if (receiver) receiver->receive(data.data(), static_cast<uint32_t>(data.size()));
+                    ++deliveredCount;
+                }
+                else
+                    ++i;
+            }
+        }
+
+        inline uint32_t getSentCount() const { return sentCount; }
+        inline uint32_t getDroppedCount() const { return droppedCount; }
+        inline uint32_t getDuplicatedCount() const { return duplicatedCount; }
+        inline uint32_t getDeliveredCount() const { return deliveredCount; }
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        struct Datagram
+        {
+            Clock::time_point time;
+            std::vector<uint8_t> data;
+        };
+
+        float loss;
+        float duplication;
+        float latency;
+        float jitter;
+        std::mt19937 generator;
+        std::uniform_real_distribution<float> distribution{0.0F, 1.0F};
+
+        network::Connection* receiver = nullptr;
+        std::vector<Datagram> datagrams;
+
+        uint32_t sentCount = 0;
+        uint32_t droppedCount = 0;
+        uint32_t duplicatedCount = 0;
+        uint32_t deliveredCount = 0;
+    };
+}
+
+#endif // OUZEL_TESTS_LOOPBACKSOCKET_HPP
@@ -0,0 +1,275 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "core/Engine.hpp"
+#include "events/EventHandler.hpp"
+#include "network/Network.hpp"
+
+using namespace ouzel;
+
+static const std::chrono::seconds TIMEOUT(10);
+
+// Network dispatches its events through the engine, which is not initialized, so no window or
+// renderer is created
+class TestEngine final: public Engine
+{
+public:
+    void runOnMainThread(const std::function<void()>& func) override
+    {
+        func();
+    }
+};
+
+struct Received
+{
+    uint32_t address;
+    uint16_t port;
+    std::vector<uint8_t> data;
+};
+
+class Recorder final
+{
+public:
+    explicit Recorder(network::Network& initNetwork):
+        network(initNetwork)
+    {
+        handler.networkHandler = std::bind(&Recorder::handleEvent, this, std::placeholders::_1);
+        engine->getEventDispatcher().addEventHandler(&handler);
+    }
+
+    // updates the network until the condition is met or the time runs out
+    bool waitFor(const std::function<bool()>& condition)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        while (!condition())
+        {
+            if (std::chrono::steady_clock::now() - start > TIMEOUT) return false;
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            // also adds the handler, like the engine's update loop does
+            engine->getEventDispatcher().dispatchEvents();
+            network.update();
+        }
+
+        return true;
+    }
+
+    std::map<uintptr_t, std::vector<Received>> received;
+    std::map<uintptr_t, uintptr_t> accepted; // listener of the accepted connections
+    std::vector<uintptr_t> connected;
+    std::vector<uintptr_t> disconnected;
+
+private:
+    bool handleEvent(const NetworkEvent& event)
+    {
+        switch (event.type)
+        {
+            case Event::Type::NETWORK_CONNECT:
+                if (event.listenerId) accepted[event.endpointId] = event.listenerId;
+                else connected.push_back(event.endpointId);
+                break;
+            case Event::Type::NETWORK_DISCONNECT:
+                disconnected.push_back(event.endpointId);
+                break;
+            case Event::Type::NETWORK_RECEIVE:
+            {
+                Received datagram;
+                datagram.address = event.address;
+                datagram.port = event.port;
+                datagram.data.assign(event.data, event.data + event.size);
+                received[event.endpointId].push_back(datagram);
+                break;
+            }
+            default:
+                break;
+        }
+
+        return false;
+    }
+
+    network::Network& network;
+    EventHandler handler;
+};
+
+static bool check(bool condition, const char* message)
+{
+    if (!condition) printf("Failed: %s\n", message);
+    return condition;
+}
+
+// the datagrams have different sizes and are filled with their index
+static std::vector<uint8_t> getDatagram(uint32_t index)
+{
+    return std::vector<uint8_t>(1 + (index * 37) % 1000, static_cast<uint8_t>(index));
+}
+
+static bool checkDatagrams(const std::vector<Received>& datagrams, uint32_t count, uint32_t address, uint16_t port)
+{
+    if (datagrams.size() != count) return false;
+
+    // loopback keeps the order of the datagrams
+    for (uint32_t i = 0; i < count; ++i)
+        if (datagrams[i].data != getDatagram(i) || datagrams[i].port != port ||
+            datagrams[i].address != address)
+            return false;
+
+    return true;
+}
+
+static bool testDatagrams(network::Network& network, Recorder& recorder)
+{
+    // more datagrams than fit into a single batch
+    const uint32_t count = network::Network::BATCH_SIZE * 3 + 5;
+    const uint32_t address = network::Network::getAddress("127.0.0.1");
+
+    uintptr_t receiver = network.bind("127.0.0.1", network::ANY_PORT);
+    uintptr_t sender = network.bind("127.0.0.1", network::ANY_PORT);
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        std::vector<uint8_t> datagram = getDatagram(i);
+        network.sendTo(sender, address, network.getPort(receiver), datagram.data(), static_cast<uint32_t>(datagram.size()));
+    }
+
+    bool result = check(recorder.waitFor([&recorder, receiver, count]() {
+                            return recorder.received[receiver].size() >= count;
+                        }), "all datagrams received");
+    result &= check(checkDatagrams(recorder.received[receiver], count, address, network.getPort(sender)), "datagram contents");
+
+    network.close(sender);
+    network.close(receiver);
+
+    return result;
+}
+
+static bool testConnection(network::Network& network, Recorder& recorder)
+{
+    uintptr_t listener = network.listen("127.0.0.1", network::ANY_PORT);
+    uintptr_t client = network.connect("127.0.0.1", network.getPort(listener));
+
+    // sent while connecting and split into several buffers
+    std::vector<uint8_t> data(network::Network::BUFFER_SIZE * 5 + 123);
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = static_cast<uint8_t>(i * 7);
+
+    network.send(client, data.data(), static_cast<uint32_t>(data.size()));
+
+    bool result = check(recorder.waitFor([&recorder, client]() {
+                            return std::find(recorder.connected.begin(), recorder.connected.end(), client) != recorder.connected.end();
+                        }), "client connected");
+    result &= check(recorder.waitFor([&recorder]() { return !recorder.accepted.empty(); }), "connection accepted");
+    if (!result) return false;
+
+    uintptr_t server = recorder.accepted.begin()->first;
+    result &= check(recorder.accepted.begin()->second == listener, "accepted by the listener");
+
+    std::vector<uint8_t> stream;
+    result &= check(recorder.waitFor([&recorder, &stream, server, &data]() {
+                        stream.clear();
+                        for (const Received& chunk : recorder.received[server])
+                            stream.insert(stream.end(), chunk.data.begin(), chunk.data.end());
+                        return stream.size() >= data.size();
+                    }), "all data received");
+    result &= check(stream == data, "stream contents");
+
+    // the peer sees the connection closing
+    network.close(client);
+    result &= check(recorder.waitFor([&recorder, server]() {
+                        return std::find(recorder.disconnected.begin(), recorder.disconnected.end(), server) != recorder.disconnected.end();
+                    }), "server disconnected");
+
+    network.close(listener);
+
+    return result;
+}
+
+static bool testCloseWithPendingBatch(network::Network& network, Recorder& recorder)
+{
+    const uint32_t count = network::Network::BATCH_SIZE / 2;
+    const uint32_t address = network::Network::getAddress("127.0.0.1");
+
+    uintptr_t receiver = network.bind("127.0.0.1", network::ANY_PORT);
+    uintptr_t sender = network.bind("127.0.0.1", network::ANY_PORT);
+    uint16_t senderPort = network.getPort(sender);
+
+    // the close is queued right behind the datagrams, so they are still in the batch when it is processed
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        std::vector<uint8_t> datagram = getDatagram(i);
+        network.sendTo(sender, address, network.getPort(receiver), datagram.data(), static_cast<uint32_t>(datagram.size()));
+    }
+    network.close(sender);
+
+    bool result = check(recorder.waitFor([&recorder, receiver, count]() {
+                            return recorder.received[receiver].size() >= count;
+                        }), "batched datagrams sent before closing");
+    result &= check(checkDatagrams(recorder.received[receiver], count, address, senderPort), "batched datagram contents");
+
+    bool thrown = false;
+    try
+    {
+        network.getPort(sender);
+    }
+    catch (const std::runtime_error&)
+    {
+        thrown = true;
+    }
+    result &= check(thrown, "closed endpoint has no port");
+
+    // sends to the closed endpoint are dropped
+    std::vector<uint8_t> datagram = getDatagram(0);
+    network.sendTo(sender, address, network.getPort(receiver), datagram.data(), static_cast<uint32_t>(datagram.size()));
+
+    // every send buffer must have been returned, so a burst of all of them fits
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    uintptr_t other = network.bind("127.0.0.1", network::ANY_PORT);
+    try
+    {
+        for (uint32_t i = 0; i < network::Network::BUFFER_COUNT; ++i)
+            network.sendTo(other, address, network.getPort(receiver), datagram.data(), static_cast<uint32_t>(datagram.size()));
+    }
+    catch (const std::runtime_error&)
+    {
+        result &= check(false, "send buffers returned");
+    }
+
+    network.close(other);
+    network.close(receiver);
+
+    return result;
+}
+
+int main()
+{
+    TestEngine testEngine;
+    network::Network network;
+    Recorder recorder(network);
+
+    bool result = true;
+
+    try
+    {
+        result &= testDatagrams(network, recorder);
+        result &= testConnection(network, recorder);
+        result &= testCloseWithPendingBatch(network, recorder);
+    }
+    catch (const std::exception& e)
+    {
+        printf("Failed: %s\n", e.what());
+        return EXIT_FAILURE;
+    }
+
+    if (!result) return EXIT_FAILURE;
+
+    printf("Network test passed\n");
+    return EXIT_SUCCESS;
+}
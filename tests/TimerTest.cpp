@@ -0,0 +1,172 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "core/Timer.hpp"
+
+using namespace ouzel;
+
+static bool check(bool condition, const char* message)
+{
+    if (!condition) printf("Failed: %s\n", message);
+    return condition;
+}
+
+// timers far enough in the future start on the upper levels and have to be moved down to fire
+static bool testCascade()
+{
+    Timer timer;
+
+    // the first level covers 256 ticks of a millisecond, every further level 256 times more
+    const float delays[] = {0.1F, 0.3F, 70.0F, 17000.0F};
+    std::vector<double> fired(4, -1.0);
+    std::vector<uint32_t> counts(4, 0);
+
+    for (size_t i = 0; i < 4; ++i)
+        timer.schedule(delays[i], [&timer, &fired, &counts, i]() {
+            fired[i] = timer.getRealTime();
+            ++counts[i];
+        }, 0.0F, Timer::Time::REAL);
+
+    // steps that do not line up with the slots
+    const float step = 0.37F;
+    while (timer.getRealTime() < 17001.0) timer.update(Timer::Time::REAL, step);
+
+    bool result = true;
+    for (size_t i = 0; i < 4; ++i)
+    {
+        result &= check(counts[i] == 1, "cascaded timer fired once");
+        result &= check(fired[i] >= delays[i] - 0.001 && fired[i] < delays[i] + step + 0.001,
+                        "cascaded timer fired in the update that reached its time");
+    }
+    result &= check(timer.getCount() == 0, "fired timers released");
+
+    // one update that crosses all the levels at once
+    uint32_t count = 0;
+    timer.schedule(20000.0F, [&count]() { ++count; }, 0.0F, Timer::Time::REAL);
+    timer.schedule(0.5F, [&count]() { ++count; }, 0.0F, Timer::Time::REAL);
+    timer.update(Timer::Time::REAL, 19999.0F);
+    result &= check(count == 1, "only the earlier timer fired in a long update");
+    timer.update(Timer::Time::REAL, 2.0F);
+    result &= check(count == 2, "the later timer fired after the long update");
+
+    // repeating timers are reinserted on the level of their interval
+    uint32_t repeats = 0;
+    timer.schedule(0.1F, [&repeats]() { ++repeats; }, 0.1F, Timer::Time::REAL);
+    for (uint32_t frame = 0; frame < 600; ++frame)
+        timer.update(Timer::Time::REAL, 1.0F / 60.0F);
+    result &= check(repeats >= 99 && repeats <= 100, "repeating timer fired every interval");
+
+    return result;
+}
+
+static bool testCancel()
+{
+    Timer timer;
+    bool result = true;
+
+    uint32_t fired = 0;
+    uint64_t canceled = timer.schedule(1.0F, [&fired]() { ++fired; });
+    uint64_t kept = timer.schedule(1.0F, [&fired]() { fired += 10; });
+    uint64_t upper = timer.schedule(100.0F, [&fired]() { fired += 100; });
+
+    result &= check(timer.cancel(canceled), "cancel a scheduled timer");
+    result &= check(!timer.cancel(canceled), "cancel a canceled timer");
+    result &= check(!timer.isScheduled(canceled), "canceled timer is not scheduled");
+    result &= check(timer.cancel(upper), "cancel a timer on an upper level");
+
+    // the freed entry is reused, the old handle must not refer to the new timer
+    uint64_t reused = timer.schedule(2.0F, [&fired]() { fired += 1000; });
+    result &= check(!timer.isScheduled(canceled) && timer.isScheduled(reused), "handle of a reused entry");
+    result &= check(!timer.cancel(canceled), "cancel with the handle of a reused entry");
+
+    for (uint32_t frame = 0; frame < 60 * 120; ++frame)
+        timer.update(Timer::Time::GAME, 1.0F / 60.0F);
+
+    result &= check(fired == 1010, "only the timers that were not canceled fired");
+    result &= check(!timer.cancel(kept), "cancel a fired timer");
+
+    // a repeating timer stops when it cancels itself
+    uint32_t repeats = 0;
+    uint64_t repeating = 0;
+    repeating = timer.schedule(0.1F, [&timer, &repeats, &repeating]() {
+        if (++repeats == 3) timer.cancel(repeating);
+    }, 0.1F);
+
+    // a timer cancels a later one that is due in the same update
+    uint32_t victimFired = 0;
+    uint64_t victim = timer.schedule(0.5F, [&victimFired]() { ++victimFired; });
+    timer.schedule(0.49F, [&timer, &victim]() { timer.cancel(victim); });
+
+    for (uint32_t frame = 0; frame < 120; ++frame)
+        timer.update(Timer::Time::GAME, 1.0F / 60.0F);
+
+    result &= check(repeats == 3, "repeating timer canceled in its callback");
+    result &= check(victimFired == 0, "timer canceled by another timer");
+    result &= check(timer.getCount() == 0, "all timers released");
+
+    return result;
+}
+
+static bool testTimes()
+{
+    Timer timer;
+    bool result = true;
+
+    uint32_t gameFired = 0;
+    uint32_t realFired = 0;
+    timer.schedule(1.0F, [&gameFired]() { ++gameFired; }, 0.0F, Timer::Time::GAME);
+    timer.schedule(1.0F, [&realFired]() { ++realFired; }, 0.0F, Timer::Time::REAL);
+
+    // the engine advances the real time by the measured frame time and the game time by the
+    // simulation steps, which can fall behind after a slow frame
+    timer.update(Timer::Time::REAL, 1.5F);
+    timer.update(Timer::Time::GAME, 0.05F);
+    result &= check(realFired == 1 && gameFired == 0, "real time advanced separately");
+    result &= check(timer.getRealTime() > 1.49 && timer.getRealTime() < 1.51, "real time");
+    result &= check(timer.getGameTime() > 0.049 && timer.getGameTime() < 0.051, "game time");
+
+    // the game time stops while paused
+    timer.setPaused(true);
+    timer.update(Timer::Time::GAME, 2.0F);
+    timer.update(Timer::Time::REAL, 2.0F);
+    result &= check(gameFired == 0, "game timer does not fire while paused");
+    result &= check(timer.getGameTime() > 0.049 && timer.getGameTime() < 0.051, "game time stopped");
+    timer.setPaused(false);
+
+    timer.update(Timer::Time::GAME, 1.0F);
+    result &= check(gameFired == 1, "game timer fired after unpausing");
+
+    // the game time is scaled
+    timer.setTimeScale(2.0F);
+    uint32_t scaledFired = 0;
+    timer.schedule(1.0F, [&scaledFired]() { ++scaledFired; });
+    uint32_t unscaledFired = 0;
+    timer.schedule(1.0F, [&unscaledFired]() { ++unscaledFired; }, 0.0F, Timer::Time::REAL);
+
+    for (uint32_t frame = 0; frame < 33; ++frame)
+    {
+        timer.update(Timer::Time::REAL, 1.0F / 60.0F);
+        timer.update(Timer::Time::GAME, 1.0F / 60.0F);
+    }
+
+    result &= check(scaledFired == 1, "scaled game timer fired after half the time");
+    result &= check(unscaledFired == 0, "real timer is not scaled");
+
+    return result;
+}
+
+int main()
+{
+    bool result = true;
+
+    result &= testCascade();
+    result &= testCancel();
+    result &= testTimes();
+
+    if (!result) return EXIT_FAILURE;
+
+    printf("Timer test passed\n");
+    return EXIT_SUCCESS;
+}
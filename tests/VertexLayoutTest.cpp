@@ -0,0 +1,78 @@
+// Copyright 2015-2018 Elviss Strazdins. All rights reserved.
+
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <vector>
+#include "graphics/VertexLayout.hpp"
+#include "math/Rect.hpp"
+#include "math/Size2.hpp"
+
+using namespace ouzel;
+
+// vertices of a sprite frame with the texture coordinates of the given rectangle inside a texture
+static std::vector<graphics::Vertex> getFrameVertices(const Rect<float>& frameRectangle, const Size2<float>& textureSize)
+{
+    Vector2<float> leftTop(frameRectangle.position.v[0] / textureSize.v[0],
+                           frameRectangle.position.v[1] / textureSize.v[1]);
+    Vector2<float> rightBottom((frameRectangle.position.v[0] + frameRectangle.size.v[0]) / textureSize.v[0],
+                               (frameRectangle.position.v[1] + frameRectangle.size.v[1]) / textureSize.v[1]);
+
+    return {
+        graphics::Vertex(Vector3<float>(0.0F, 0.0F, 0.0F), Color::WHITE,
+                         Vector2<float>(leftTop.v[0], rightBottom.v[1]), Vector3<float>(0.0F, 0.0F, -1.0F)),
+        graphics::Vertex(Vector3<float>(frameRectangle.size.v[0], 0.0F, 0.0F), Color::WHITE,
+                         Vector2<float>(rightBottom.v[0], rightBottom.v[1]), Vector3<float>(0.0F, 0.0F, -1.0F)),
+        graphics::Vertex(Vector3<float>(0.0F, frameRectangle.size.v[1], 0.0F), Color::WHITE,
+                         Vector2<float>(leftTop.v[0], leftTop.v[1]), Vector3<float>(0.0F, 0.0F, -1.0F)),
+        graphics::Vertex(Vector3<float>(frameRectangle.size.v[0], frameRectangle.size.v[1], 0.0F), Color::WHITE,
+                         Vector2<float>(rightBottom.v[0], leftTop.v[1]), Vector3<float>(0.0F, 0.0F, -1.0F))
+    };
+}
+
+static bool check(bool condition, const char* message)
+{
+    if (!condition) printf("Failed: %s\n", message);
+    return condition;
+}
+
+int main()
+{
+    bool result = true;
+    Size2<float> textureSize(64.0F, 64.0F);
+
+    // a frame inside of the texture fits the compact layout
+    std::vector<graphics::Vertex> inside = getFrameVertices(Rect<float>(16.0F, 16.0F, 32.0F, 32.0F), textureSize);
+    result &= check(graphics::VertexLayout::COMPACT_2D.canPack(inside), "frame inside of the texture can be packed compactly");
+
+    std::vector<uint8_t> data = graphics::VertexLayout::COMPACT_2D.pack(inside);
+    result &= check(data.size() == inside.size() * graphics::VertexLayout::COMPACT_2D.getStride(), "compact frame size");
+
+    // a frame that repeats the texture four times has texture coordinates up to 4
+    std::vector<graphics::Vertex> tiled = getFrameVertices(Rect<float>(0.0F, 0.0F, 256.0F, 256.0F), textureSize);
+    result &= check(!graphics::VertexLayout::COMPACT_2D.canPack(tiled), "tiled frame can't be packed compactly");
+    result &= check(graphics::VertexLayout::STANDARD.canPack(tiled), "tiled frame can be packed with floats");
+
+    bool thrown = false;
+    try
+    {
+        graphics::VertexLayout::COMPACT_2D.pack(tiled);
+    }
+    catch (const std::out_of_range&)
+    {
+        thrown = true;
+    }
+    result &= check(thrown, "packing a tiled frame compactly throws");
+
+    data = graphics::VertexLayout::STANDARD.pack(tiled);
+    result &= check(data.size() == tiled.size() * graphics::VertexLayout::STANDARD.getStride(), "standard frame size");
+
+    // negative texture coordinates (frame offset before the texture's origin) don't fit either
+    std::vector<graphics::Vertex> offset = getFrameVertices(Rect<float>(-32.0F, 0.0F, 64.0F, 64.0F), textureSize);
+    result &= check(!graphics::VertexLayout::COMPACT_2D.canPack(offset), "frame before the texture can't be packed compactly");
+
+    if (!result) return EXIT_FAILURE;
+
+    printf("Vertex layout test passed\n");
+    return EXIT_SUCCESS;
+}